@@ -18,11 +18,13 @@
 #include "graph_filtering.hh"
 
 #include <boost/python.hpp>
-#include <boost/graph/betweenness_centrality.hpp>
 
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_util.hh"
+#include "random.hh"
+
+#include "graph_betweenness.hh"
 
 using namespace std;
 using namespace boost;
@@ -80,24 +82,15 @@ struct get_betweenness
     template <class Graph, class EdgeBetweenness, class VertexBetweenness>
     void operator()(Graph& g,
                     std::vector<size_t>& pivots,
-                    GraphInterface::vertex_index_map_t index_map,
                     EdgeBetweenness edge_betweenness,
                     VertexBetweenness vertex_betweenness,
-                    bool normalize, size_t n) const
+                    bool normalize, size_t n, size_t max_eindex,
+                    double epsilon, double delta) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<size_t> distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-        brandes_betweenness_centrality
+        parallel_betweenness<size_t>
             (g, pivots, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), index_map),
-             make_iterator_property_map(distance_map.begin(), index_map),
-             make_iterator_property_map(dependency_map.begin(), index_map),
-             make_iterator_property_map(path_count_map.begin(), index_map),
-             index_map);
+             boost::detail::graph::brandes_unweighted_shortest_paths(),
+             n, max_eindex, epsilon, delta);
         if (normalize)
             normalize_betweenness(g, pivots, edge_betweenness, vertex_betweenness, n);
     }
@@ -106,33 +99,25 @@ struct get_betweenness
 struct get_weighted_betweenness
 {
     typedef void result_type;
-    template <class Graph, class EdgeBetweenness, class VertexBetweenness,
-              class VertexIndexMap>
+    template <class Graph, class EdgeBetweenness, class VertexBetweenness>
     void operator()(Graph& g, std::vector<size_t>& pivots,
-                    VertexIndexMap vertex_index,
                     EdgeBetweenness edge_betweenness,
                     VertexBetweenness vertex_betweenness,
                     boost::any weight_map, bool normalize,
-                    size_t n, size_t max_eindex) const
+                    size_t n, size_t max_eindex, double epsilon,
+                    double delta) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<typename property_traits<EdgeBetweenness>::value_type>
-            distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
+        typedef typename property_traits<EdgeBetweenness>::value_type val_t;
 
         typename EdgeBetweenness::checked_t weight =
             any_cast<typename EdgeBetweenness::checked_t>(weight_map);
+        auto uweight = weight.get_unchecked(max_eindex + 1);
 
-        brandes_betweenness_centrality
+        parallel_betweenness<val_t>
             (g, pivots, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), vertex_index),
-             make_iterator_property_map(distance_map.begin(), vertex_index),
-             make_iterator_property_map(dependency_map.begin(), vertex_index),
-             make_iterator_property_map(path_count_map.begin(), vertex_index),
-             vertex_index, weight.get_unchecked(max_eindex+1));
+             boost::detail::graph::brandes_dijkstra_shortest_paths
+                 <decltype(uweight)>(uweight),
+             n, max_eindex, epsilon, delta);
         if (normalize)
             normalize_betweenness(g, pivots, edge_betweenness, vertex_betweenness, n);
     }
@@ -142,7 +127,7 @@ void betweenness(GraphInterface& g, std::vector<size_t>& pivots,
                  boost::any weight,
                  boost::any edge_betweenness,
                  boost::any vertex_betweenness,
-                 bool normalize)
+                 bool normalize, double epsilon, double delta, rng_t& rng)
 {
     if (!belongs<edge_floating_properties>()(edge_betweenness))
         throw ValueException("edge property must be of floating point value"
@@ -152,16 +137,20 @@ void betweenness(GraphInterface& g, std::vector<size_t>& pivots,
         throw ValueException("vertex property must be of floating point value"
                              " type");
 
+    // the pivots are sampled in random order
+    if (epsilon > 0)
+        std::shuffle(pivots.begin(), pivots.end(), rng);
+
     if (!weight.empty())
     {
         run_action<>()
             (g, std::bind<>(get_weighted_betweenness(),
                             std::placeholders::_1,
                             std::ref(pivots),
-                            g.get_vertex_index(),
                             std::placeholders::_2,
                             std::placeholders::_3, weight, normalize,
-                            g.get_num_vertices(), g.get_edge_index_range()),
+                            g.get_num_vertices(), g.get_edge_index_range(),
+                            epsilon, delta),
              edge_floating_properties(),
              vertex_floating_properties())
             (edge_betweenness, vertex_betweenness);
@@ -170,10 +159,10 @@ void betweenness(GraphInterface& g, std::vector<size_t>& pivots,
     {
         run_action<>()
             (g, std::bind<void>(get_betweenness(), std::placeholders::_1,
-                                std::ref(pivots),
-                                g.get_vertex_index(), std::placeholders::_2,
+                                std::ref(pivots), std::placeholders::_2,
                                 std::placeholders::_3, normalize,
-                                g.get_num_vertices()),
+                                g.get_num_vertices(), g.get_edge_index_range(),
+                                epsilon, delta),
              edge_floating_properties(),
              vertex_floating_properties())
             (edge_betweenness, vertex_betweenness);
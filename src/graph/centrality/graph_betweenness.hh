@@ -0,0 +1,259 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BETWEENNESS_HH
+#define GRAPH_BETWEENNESS_HH
+
+#include <stack>
+#include <memory>
+#include <cmath>
+
+#include <boost/graph/betweenness_centrality.hpp>
+
+#include "graph_util.hh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Parallel Brandes betweenness
+// ============================
+//
+// The single-source passes are distributed between the threads. Each thread
+// keeps its own search state, which is reset incrementally as the vertices are
+// popped in the dependency accumulation, and accumulates the vertex and edge
+// dependencies in private buffers, which are summed at the end. Hence no
+// synchronization is needed during the passes.
+//
+// If an error bound epsilon is given, the pivots are processed in batches of
+// doubling size, and the computation stops as soon as the normalized
+// betweenness of every vertex is within epsilon of its exact value with
+// probability at least 1 - delta. This uses the empirical Bernstein bound on
+// the per-source normalized dependencies, which lie in [0, 1], together with a
+// union bound over all vertices and batches. The pivots are expected to be
+// given in random order, and only the ones which were used are kept.
+
+template <class Graph, class Dist, class Val>
+struct betweenness_state
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+    betweenness_state(size_t N, size_t E, bool moments)
+        : incoming(N), distance(N), dependency(N), path_count(N),
+          vbetweenness(N), ebetweenness(E), vmoment(moments ? N : 0) {}
+
+    vector<vector<edge_t>> incoming;
+    vector<Dist> distance;
+    vector<Val> dependency;
+    vector<size_t> path_count;
+    stack<vertex_t> ordered_vertices;
+
+    vector<Val> vbetweenness;
+    vector<Val> ebetweenness;
+    vector<Val> vmoment;      // sum of squared normalized dependencies
+};
+
+template <class Graph, class State, class ShortestPaths>
+void betweenness_source(const Graph& g,
+                        typename graph_traits<Graph>::vertex_descriptor s,
+                        State& state, ShortestPaths& shortest_paths,
+                        double norm)
+{
+    auto vindex = get(vertex_index, g);
+    auto eindex = get(edge_index, g);
+
+    auto incoming = make_iterator_property_map(state.incoming.begin(), vindex);
+    auto distance = make_iterator_property_map(state.distance.begin(), vindex);
+    auto path_count = make_iterator_property_map(state.path_count.begin(),
+                                                 vindex);
+
+    state.path_count[s] = 1;
+    shortest_paths(g, s, state.ordered_vertices, incoming, distance,
+                   path_count, vindex);
+
+    typedef typename std::remove_reference<decltype(state.dependency[s])>::type
+        val_t;
+    auto& ordered = state.ordered_vertices;
+    while (!ordered.empty())
+    {
+        auto u = ordered.top();
+        ordered.pop();
+
+        val_t& dep_u = state.dependency[u];
+        for (const auto& e : state.incoming[u])
+        {
+            auto v = source(e, g);
+            val_t factor = val_t(state.path_count[v]) /
+                val_t(state.path_count[u]);
+            factor *= val_t(1) + dep_u;
+            state.dependency[v] += factor;
+            state.ebetweenness[eindex[e]] += factor;
+        }
+
+        if (u != s)
+        {
+            state.vbetweenness[u] += dep_u;
+            if (!state.vmoment.empty())
+                state.vmoment[u] += (dep_u * norm) * (dep_u * norm);
+        }
+
+        // the predecessors of u are all popped after it, so its state is not
+        // needed anymore
+        state.incoming[u].clear();
+        state.path_count[u] = 0;
+        dep_u = 0;
+    }
+}
+
+// Returns the number of pivots which were used.
+template <class Dist, class Graph, class VBetweenness, class EBetweenness,
+          class ShortestPaths>
+size_t parallel_betweenness(const Graph& g, vector<size_t>& pivots,
+                            VBetweenness vbetweenness,
+                            EBetweenness ebetweenness,
+                            ShortestPaths shortest_paths, size_t n,
+                            size_t max_eindex, double epsilon, double delta)
+{
+    typedef typename property_traits<VBetweenness>::value_type val_t;
+    typedef betweenness_state<Graph, Dist, val_t> state_t;
+
+    size_t N = num_vertices(g);
+    size_t E = max_eindex + 1;
+    size_t P = pivots.size();
+    bool sample = epsilon > 0 && n > 2;
+    double norm = (n > 2) ? 1. / (n - 2) : 0;
+
+    size_t nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    vector<std::unique_ptr<state_t>> states(nthreads);
+
+    // number of pivots in the first batch, and log-confidence of each bound
+    size_t batch = P;
+    double L = 0;
+    if (sample)
+    {
+        double k0 = 3 * log(3 * n / delta) / epsilon;
+        size_t rounds = 1;
+        for (double k = k0; k < P; k *= 2)
+            ++rounds;
+        L = log(3 * n * rounds / delta);
+        batch = std::min(std::max(size_t(ceil(3 * L / epsilon)), nthreads), P);
+    }
+
+    size_t done = 0;
+    while (done < P)
+    {
+        size_t end = std::min(done + batch, P);
+
+        #pragma omp parallel if (is_parallel_worth((end - done) * double(N + E)))
+        {
+            size_t tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            auto& state = states[tid];
+            if (!state)
+                state = std::make_unique<state_t>(N, E, sample);
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = done; i < end; ++i)
+            {
+                auto s = vertex(pivots[i], g);
+                if (s == graph_traits<Graph>::null_vertex())
+                    continue;
+                betweenness_source(g, s, *state, shortest_paths, norm);
+            }
+        }
+
+        done = end;
+        if (!sample || done == P)
+            break;
+
+        double k = done;
+        double max_err = 0;
+        #pragma omp parallel if (is_parallel_worth(N * nthreads)) \
+            reduction(max:max_err)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 double m = 0, m2 = 0;
+                 for (auto& state : states)
+                 {
+                     if (!state)
+                         continue;
+                     m += state->vbetweenness[v];
+                     m2 += state->vmoment[v];
+                 }
+                 m *= norm / k;
+                 double var = std::max(m2 / k - m * m, 0.);
+                 double err = sqrt(2 * var * L / k) + 3 * L / k;
+                 max_err = std::max(err, max_err);
+             });
+
+        if (max_err <= epsilon)
+            break;
+        batch = done;
+    }
+    pivots.resize(done);
+
+    bool undirected =
+        std::is_convertible<typename graph_traits<Graph>::directed_category,
+                            undirected_tag>::value;
+    val_t scale = undirected ? val_t(.5) : val_t(1);
+
+    auto eindex = get(edge_index, g);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             val_t x = 0;
+             for (auto& state : states)
+             {
+                 if (state)
+                     x += state->vbetweenness[v];
+             }
+             put(vbetweenness, v, x * scale);
+         });
+
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             val_t x = 0;
+             for (auto& state : states)
+             {
+                 if (state)
+                     x += state->ebetweenness[eindex[e]];
+             }
+             put(ebetweenness, e, x * scale);
+         });
+
+    return done;
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_BETWEENNESS_HH
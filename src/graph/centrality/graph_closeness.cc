@@ -22,6 +22,8 @@
 
 #include "graph_closeness.hh"
 
+#include "random.hh"
+
 #include <functional>
 #include <boost/python.hpp>
 
@@ -33,7 +35,7 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
 {
     if (weight.empty())
     {
-        run_action<>()(gi,
+        run_action<all_graph_views_frozen>()(gi,
                        std::bind(get_closeness(), std::placeholders::_1,
                                  gi.get_vertex_index(), no_weightS(),
                                  std::placeholders::_2, harmonic, norm),
@@ -41,7 +43,7 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
     }
     else
     {
-        run_action<>()(gi,
+        run_action<all_graph_views_frozen>()(gi,
                        std::bind(get_closeness(), std::placeholders::_1,
                                  gi.get_vertex_index(), std::placeholders::_2,
                                  std::placeholders::_3, harmonic, norm),
@@ -50,7 +52,57 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
     }
 }
 
+void do_get_labeling_closeness(GraphInterface& gi, PrunedLandmarkLabeling& pll,
+                               boost::any closeness, bool harmonic, bool norm,
+                               size_t n_samples, rng_t& rng)
+{
+    if (pll.get_num_vertices() != gi.get_num_vertices(false))
+        throw ValueException("distance labeling does not match the graph");
+
+    run_action<>()(gi,
+                   [&](auto& g, auto c)
+                   {
+                       get_labeling_closeness()
+                           (g, pll, c, harmonic, norm, n_samples, rng);
+                   },
+                   writable_vertex_scalar_properties())(closeness);
+}
+
+void do_get_closeness_pivots(GraphInterface& gi, boost::any weight,
+                             boost::any closeness, boost::any err,
+                             bool harmonic, bool norm, size_t n_pivots,
+                             double delta, rng_t& rng)
+{
+    typedef vprop_map_t<double>::type vmap_t;
+    auto c = boost::any_cast<vmap_t>(closeness).get_unchecked();
+    auto e = boost::any_cast<vmap_t>(err).get_unchecked();
+
+    if (weight.empty())
+    {
+        run_action<all_graph_views_frozen>()
+            (gi,
+             [&](auto& g)
+             {
+                 get_closeness_pivots()(g, no_weightS(), c, e, harmonic, norm,
+                                        n_pivots, delta, rng);
+             })();
+    }
+    else
+    {
+        run_action<all_graph_views_frozen>()
+            (gi,
+             [&](auto& g, auto w)
+             {
+                 get_closeness_pivots()(g, w, c, e, harmonic, norm,
+                                        n_pivots, delta, rng);
+             },
+             edge_scalar_properties())(weight);
+    }
+}
+
 void export_closeness()
 {
     boost::python::def("closeness", &do_get_closeness);
+    boost::python::def("labeling_closeness", &do_get_labeling_closeness);
+    boost::python::def("closeness_pivots", &do_get_closeness_pivots);
 }
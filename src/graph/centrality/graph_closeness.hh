@@ -27,6 +27,11 @@
 
 #include "histogram.hh"
 #include "hash_map_wrap.hh"
+#include "graph_bfs.hh"
+#include "graph_landmark_labeling.hh"
+#include "random.hh"
+#include "parallel_rng.hh"
+#include "../topology/graph_delta_stepping.hh"
 
 namespace graph_tool
 {
@@ -56,54 +61,121 @@ struct get_closeness
     {
         using namespace boost;
 
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
 
-        get_vertex_dists_t get_vertex_dists;
         size_t HN = HardNumVertices()(g);
-        parallel_vertex_loop
-            (g,
-             [&](auto v)
-             {
-                 unchecked_vector_property_map<val_type,VertexIndex>
-                     dist_map(vertex_index, num_vertices(g));
+        auto set_closeness = [&](auto v, double sum, size_t comp_size)
+            {
+                closeness[v] = sum;
+                if (!harmonic)
+                    closeness[v] = 1 / closeness[v];
+
+                if (norm)
+                {
+                    if (harmonic)
+                        closeness[v] /= HN - 1;
+                    else
+                        closeness[v] *= comp_size - 1;
+                }
+            };
+
+        if constexpr (std::is_same<WeightMap, no_weightS>::value)
+        {
+            // unweighted version: multi-source BFS, from 64 sources at a
+            // time, with the sums accumulated per thread
+            constexpr size_t B = multi_source_bfs<Graph>::max_sources;
+            vector<size_t> sources;
+            for (auto v : vertices_range(g))
+                sources.push_back(v);
 
-                 for (auto u : vertices_range(g))
-                     dist_map[u] = numeric_limits<val_type>::max();
+            multi_source_bfs<Graph> bfs(g);
+            std::array<double, B> sum;
+            std::array<size_t, B> comp_size;
 
-                 dist_map[v] = 0;
+            #pragma omp parallel if (is_parallel_worth(g, bfs_kernel))
+            {
+                std::array<double, B> lsum;
+                std::array<size_t, B> lcomp_size;
+                auto visit = [&](auto, uint64_t mask, size_t d)
+                    {
+                        for (; mask != 0; mask &= mask - 1)
+                        {
+                            size_t j = __builtin_ctzll(mask);
+                            ++lcomp_size[j];
+                            if (d == 0)
+                                continue;
+                            if (!harmonic)
+                                lsum[j] += d;
+                            else
+                                lsum[j] += 1. / d;
+                        }
+                    };
 
-                 size_t comp_size = 0;
-                 get_vertex_dists(g, v, vertex_index, dist_map, weights, comp_size);
+                for (size_t i = 0; i < sources.size(); i += B)
+                {
+                    size_t n = std::min(B, sources.size() - i);
 
-                 closeness[v] = 0;
-                 for (auto v2 : vertices_range(g))
+                    #pragma omp single
+                    {
+                        sum.fill(0);
+                        comp_size.fill(0);
+                    }
+                    lsum.fill(0);
+                    lcomp_size.fill(0);
+
+                    bfs.run_no_spawn(sources.data() + i, n, visit);
+
+                    #pragma omp critical (closeness)
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        sum[j] += lsum[j];
+                        comp_size[j] += lcomp_size[j];
+                    }
+                    #pragma omp barrier
+
+                    #pragma omp single
+                    for (size_t j = 0; j < n; ++j)
+                        set_closeness(vertex(sources[i + j], g), sum[j],
+                                      comp_size[j]);
+                }
+            }
+        }
+        else
+        {
+            get_dists_djk get_vertex_dists;
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
                  {
-                     if (v2 != v && dist_map[v2] != numeric_limits<val_type>::max())
+                     unchecked_vector_property_map<val_type,VertexIndex>
+                         dist_map(vertex_index, num_vertices(g));
+
+                     for (auto u : vertices_range(g))
+                         dist_map[u] = numeric_limits<val_type>::max();
+
+                     dist_map[v] = 0;
+
+                     size_t comp_size = 0;
+                     get_vertex_dists(g, v, vertex_index, dist_map, weights,
+                                      comp_size);
+
+                     double sum = 0;
+                     for (auto v2 : vertices_range(g))
                      {
-                         if (!harmonic)
-                             closeness[v] += dist_map[v2];
-                         else
-                             closeness[v] += 1. / dist_map[v2];
+                         if (v2 != v &&
+                             dist_map[v2] != numeric_limits<val_type>::max())
+                         {
+                             if (!harmonic)
+                                 sum += dist_map[v2];
+                             else
+                                 sum += 1. / dist_map[v2];
+                         }
                      }
-                 }
 
-                 if (!harmonic)
-                     closeness[v] = 1 / closeness[v];
-
-                 if (norm)
-                 {
-                     if (harmonic)
-                         closeness[v] /= HN - 1;
-                     else
-                         closeness[v] *= comp_size - 1;
-                 }
-             });
+                     set_closeness(v, sum, comp_size);
+                 });
+        }
     }
 
 
@@ -139,53 +211,313 @@ struct get_closeness
                                     weight_map(weights).distance_map(dist_map).visitor(vis));
         }
     };
+};
+
+// Closeness from a distance labeling of the graph, with the distances to all
+// the other vertices, or to n_samples of them chosen at random, in which case
+// the sums and component sizes are extrapolated.
 
-    template <class DistMap>
-    class component_bfs_visitor: public boost::bfs_visitor<>
+struct get_labeling_closeness
+{
+    template <class Graph, class Closeness, class RNG>
+    void operator()(const Graph& g, const PrunedLandmarkLabeling& pll,
+                    Closeness closeness, bool harmonic, bool norm,
+                    size_t n_samples, RNG& rng) const
     {
-    public:
-        //component_visitor() { }
-        component_bfs_visitor(DistMap dist_map, size_t& comp_size)
-            : _dist_map(dist_map), _comp_size(comp_size) { }
+        vector<size_t> vs;
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+        size_t HN = vs.size();
 
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex, const Graph&)
-        {
-            ++_comp_size;
-        }
+        auto set_closeness = [&](auto v, double sum, double comp_size)
+            {
+                closeness[v] = sum;
+                if (!harmonic)
+                    closeness[v] = 1 / closeness[v];
+
+                if (norm)
+                {
+                    if (harmonic)
+                        closeness[v] /= HN - 1;
+                    else
+                        closeness[v] *= comp_size - 1;
+                }
+            };
+
+        auto add = [&](size_t v, size_t u, double& sum, size_t& reached)
+            {
+                auto d = pll.query(v, u);
+                if (d == PrunedLandmarkLabeling::inf)
+                    return;
+                ++reached;
+                if (!harmonic)
+                    sum += d;
+                else
+                    sum += 1. / d;
+            };
 
-        template <class Edge, class Graph>
-        void tree_edge(Edge e, const Graph& g)
+        if (n_samples == 0 || HN < 2)
         {
-            _dist_map[target(e, g)] = _dist_map[source(e, g)] + 1;
+            #pragma omp parallel if (is_parallel_worth(HN * HN * \
+                                                       pll_query_kernel.get_cost()))
+            parallel_loop_no_spawn
+                (vs,
+                 [&](size_t, auto v)
+                 {
+                     double sum = 0;
+                     size_t reached = 0;
+                     for (auto u : vs)
+                     {
+                         if (u != v)
+                             add(v, u, sum, reached);
+                     }
+                     set_closeness(v, sum, reached + 1);
+                 });
         }
+        else
+        {
+            parallel_rng<RNG>::init(rng);
 
-    private:
-        DistMap _dist_map;
-        size_t& _comp_size;
-    };
+            #pragma omp parallel if (is_parallel_worth(HN * n_samples * \
+                                                       pll_query_kernel.get_cost()))
+            {
+                auto& rng_ = parallel_rng<RNG>::get(rng);
+                uniform_int_distribution<size_t> sample(0, HN - 2);
+                double f = double(HN - 1) / n_samples;
 
+                parallel_loop_no_spawn
+                    (vs,
+                     [&](size_t i, auto v)
+                     {
+                         double sum = 0;
+                         size_t reached = 0;
+                         for (size_t j = 0; j < n_samples; ++j)
+                         {
+                             size_t k = sample(rng_);
+                             if (k >= i)
+                                 ++k;
+                             add(v, vs[k], sum, reached);
+                         }
+                         set_closeness(v, f * sum, 1 + f * reached);
+                     });
+            }
+        }
+    }
+};
+
+// Approximate closeness from k pivots sampled uniformly with replacement
+// [eppstein-fast-2004]. The distances d(v, p) from every vertex to the pivots
+// are obtained from searches on the reversed graph, and the sums of the
+// distances (or their inverses) and the component sizes are extrapolated
+// from them. Since the sampled terms are independent and bounded, Hoeffding's
+// inequality gives, with probability at least 1 - delta, an error bound for
+// every vertex: the terms 1 / d lie in [0, 1], and the distances d(v, u) in
+// [0, d(v, a) + ecc(a)] for every vertex a in the same strongly connected
+// component as v, where ecc(a) is the largest distance from a. The first
+// pivots are taken as such "anchors", for which a forward search is done as
+// well.
+//
+// [eppstein-fast-2004] D. Eppstein, J. Wang, "Fast approximation of
+//    centrality", Journal of Graph Algorithms and Applications 8 (1),
+//    pp. 39-45, 2004, DOI: 10.7155/jgaa.00081
 
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
+struct get_closeness_pivots
+{
+    template <class Graph, class WeightMap, class Closeness, class Err,
+              class RNG>
+    void operator()(const Graph& g, WeightMap weights, Closeness closeness,
+                    Err err, bool harmonic, bool norm, size_t n_pivots,
+                    double delta, RNG& rng) const
     {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS, size_t& comp_size) const
+        using namespace boost;
+        constexpr double inf = numeric_limits<double>::infinity();
+
+        vector<size_t> vs;
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+        size_t HN = vs.size();
+        if (HN == 0 || n_pivots == 0)
+            return;
+
+        vector<size_t> pivots;
+        uniform_int_distribution<size_t> sample(0, HN - 1);
+        for (size_t i = 0; i < n_pivots; ++i)
+            pivots.push_back(vs[sample(rng)]);
+
+        size_t N = num_vertices(g);
+        vector<double> S(N), H(N), C(N), R(N, inf);
+
+        auto run = [&](auto& rg)
+            {
+                if constexpr (std::is_same<WeightMap, no_weightS>::value)
+                {
+                    // unweighted version: multi-source BFS, from 64 pivots
+                    // at a time, the first 64 of which are anchors
+                    constexpr size_t B = multi_source_bfs<Graph>::max_sources;
+                    multi_source_bfs<Graph> fbfs(g);
+                    multi_source_bfs<std::remove_reference_t<decltype(rg)>>
+                        rbfs(rg);
+                    vector<uint64_t> reach(N);
+                    std::array<double, B> ecc;
+                    ecc.fill(0);
+
+                    size_t n = std::min(B, pivots.size());
+                    #pragma omp parallel if (is_parallel_worth(g, bfs_kernel))
+                    {
+                        std::array<double, B> lecc;
+                        lecc.fill(0);
+                        fbfs.run_no_spawn
+                            (pivots.data(), n,
+                             [&](auto v, uint64_t mask, size_t d)
+                             {
+                                 reach[v] |= mask;
+                                 for (; mask != 0; mask &= mask - 1)
+                                 {
+                                     size_t j = __builtin_ctzll(mask);
+                                     lecc[j] = std::max(lecc[j], double(d));
+                                 }
+                             });
+                        #pragma omp critical (closeness_pivots)
+                        for (size_t j = 0; j < n; ++j)
+                            ecc[j] = std::max(ecc[j], lecc[j]);
+                        #pragma omp barrier
+
+                        for (size_t i = 0; i < pivots.size(); i += B)
+                        {
+                            bool anchor = (i == 0);
+                            rbfs.run_no_spawn
+                                (pivots.data() + i,
+                                 std::min(B, pivots.size() - i),
+                                 [&](auto v, uint64_t mask, size_t d)
+                                 {
+                                     double c = __builtin_popcountll(mask);
+                                     C[v] += c;
+                                     if (d > 0)
+                                     {
+                                         S[v] += c * d;
+                                         H[v] += c / d;
+                                     }
+                                     if (!anchor)
+                                         return;
+                                     for (uint64_t x = mask & reach[v]; x != 0;
+                                          x &= x - 1)
+                                     {
+                                         size_t j = __builtin_ctzll(x);
+                                         R[v] = std::min(R[v], d + ecc[j]);
+                                     }
+                                 });
+                        }
+                    }
+                }
+                else
+                {
+                    // weighted version: one parallel delta-stepping search
+                    // per pivot, the first 8 of which are anchors
+                    constexpr size_t n_anchors = 8;
+                    double width = get_delta_stepping_width(g, weights);
+                    vector<double> dist(N), fdist(N);
+                    vector<size_t> pred(N);
+
+                    auto search = [&](auto& g, size_t s, vector<double>& d)
+                        {
+                            std::fill(d.begin(), d.end(), inf);
+                            d[s] = 0;
+                            delta_stepping(g, s, d.data(), pred.data(),
+                                           weights, width, inf,
+                                           [](double) { return false; });
+                        };
+
+                    for (size_t i = 0; i < pivots.size(); ++i)
+                    {
+                        bool anchor = (i < n_anchors);
+                        double ecc = 0;
+                        if (anchor)
+                        {
+                            search(g, pivots[i], fdist);
+                            for (auto v : vs)
+                            {
+                                if (fdist[v] < inf)
+                                    ecc = std::max(ecc, fdist[v]);
+                            }
+                        }
+                        search(rg, pivots[i], dist);
+
+                        parallel_loop
+                            (vs,
+                             [&](size_t, auto v)
+                             {
+                                 double d = dist[v];
+                                 if (d == inf)
+                                     return;
+                                 C[v] += 1;
+                                 if (d > 0)
+                                 {
+                                     S[v] += d;
+                                     H[v] += 1. / d;
+                                 }
+                                 if (anchor && fdist[v] < inf)
+                                     R[v] = std::min(R[v], d + ecc);
+                             });
+                    }
+                }
+            };
+
+        if constexpr (is_directed_::apply<Graph>::type::value)
         {
-            using namespace boost;
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef gt_hash_map<vertex_t,default_color_type,
-                                DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-            component_bfs_visitor<DistanceMap> vis(dist_map, comp_size);
-            breadth_first_visit(g, s, visitor(vis).
-                                color_map(color_map));
+            reversed_graph<Graph> rg(g);
+            run(rg);
         }
-    };
+        else
+        {
+            run(g);
+        }
+
+        // Hoeffding bounds, with delta split between the sums and the
+        // component sizes in the non-harmonic case
+        double k = pivots.size();
+        double e = sqrt(log((harmonic ? 2 : 4) / delta) / (2 * k));
+        double f = HN / k;
+
+        parallel_loop
+            (vs,
+             [&](size_t, auto v)
+             {
+                 if (harmonic)
+                 {
+                     double c = f * H[v];
+                     double ec = HN * e;
+                     if (norm)
+                     {
+                         c /= HN - 1;
+                         ec /= HN - 1;
+                     }
+                     closeness[v] = c;
+                     err[v] = ec;
+                     return;
+                 }
+
+                 double s = f * S[v];
+                 double n = f * C[v];
+                 double c = 1 / s;
+                 if (norm)
+                     c *= n - 1;
+                 closeness[v] = c;
+
+                 double s_lo = std::max(s - HN * R[v] * e, 0.);
+                 double s_hi = s + HN * R[v] * e;
+                 double n_lo = std::max(n - HN * e, 1.);
+                 double n_hi = std::min(n + HN * e, double(HN));
+                 double c_lo = 1 / s_hi;
+                 double c_hi = 1 / s_lo;
+                 if (norm)
+                 {
+                     c_lo *= n_lo - 1;
+                     c_hi *= n_hi - 1;
+                 }
+                 err[v] = (R[v] < inf && s_lo > 0) ?
+                     std::max(c - c_lo, c_hi - c) : inf;
+             });
+    }
 };
 
 } // boost namespace
@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_spmv.hh"
 
 namespace graph_tool
 {
@@ -36,79 +37,54 @@ struct get_eigentrust
                     double epslon, size_t max_iter, size_t& iter) const
     {
         using namespace boost;
-        typedef typename property_traits<TrustMap>::value_type c_type;
         typedef typename property_traits<InferredTrustMap>::value_type t_type;
 
-        InferredTrustMap t_temp(vertex_index, num_vertices(g));
-
         // Norm c values
-        InferredTrustMap c_sum(vertex_index);
-        if (graph_tool::is_directed(g))
-        {
-            TrustMap c_temp(edge_index, c.get_storage().size());
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     c_type sum = 0;
-                     for (const auto& e : out_edges_range(v, g))
-                         sum += get(c, e);
-                     if (sum > 0)
-                     {
-                         for (const auto& e : out_edges_range(v, g))
-                             put(c_temp, e, get(c, e) / sum);
-                     }
-                 });
-            c = c_temp;
-        }
-        else
-        {
-            c_sum.reserve(num_vertices(g));
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     c_sum[v] = 0;
-                     for (const auto& e : out_edges_range(v, g))
-                         c_sum[v] += c[e];
-                 });
-        }
+        InferredTrustMap c_sum(vertex_index, num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 c_sum[v] = 0;
+                 for (const auto& e : out_edges_range(v, g))
+                     c_sum[v] += get(c, e);
+                 if (!graph_tool::is_directed(g))
+                     c_sum[v] = abs(c_sum[v]);
+             });
+
+        spmv_matrix<t_type> A(g,
+                              [&](const auto& e)
+                              {
+                                  t_type sum = c_sum[source(e, g)];
+                                  if (sum > 0)
+                                      return t_type(get(c, e)) / sum;
+                                  return t_type(0);
+                              });
 
         // init inferred trust t
-        auto V = HardNumVertices()(g);
-        parallel_vertex_loop(g, [&](auto v) { t[v] = 1.0/V; });
+        size_t N = A.size();
+        vector<t_type> x(N, 1.0 / N), y(N);
 
         t_type delta = epslon + 1;
         iter = 0;
         while (delta >= epslon)
         {
+            A.multiply(x.data(), y.data());
+
             delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N * spmv_vector_kernel.get_cost())) \
                 reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     t_temp[v] = 0;
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         auto s = source(e, g);
-                         if (!graph_tool::is_directed(g))
-                             t_temp[v] += get(c, e) * t[s] / abs(c_sum[s]);
-                         else
-                             t_temp[v] += get(c, e) * t[s];
-                     }
-                     delta += abs(t_temp[v] - t[v]);
-                 });
-            swap(t_temp, t);
+            for (size_t i = 0; i < N; ++i)
+                delta += abs(y[i] - x[i]);
+            swap(x, y);
 
             ++iter;
             if (max_iter > 0 && iter== max_iter)
                 break;
         }
 
-        if (iter % 2 != 0)
-            parallel_vertex_loop(g, [&](auto v) {t[v] = t_temp[v];});
+        A.put_vector(t, x.data());
     }
 };
 
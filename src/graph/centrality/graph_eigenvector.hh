@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_spmv.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -48,51 +49,46 @@ struct get_eigenvector
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
-        CentralityMap c_temp(vertex_index, num_vertices(g));
+        spmv_matrix<t_type> A(g, [&](const auto& e) { return get(w, e); });
+
+        size_t N = A.size();
+        vector<t_type> x(N), y(N);
+        A.get_vector(c, x.data());
 
         t_type norm = 0;
         t_type delta = epsilon + 1;
         size_t iter = 0;
         while (delta >= epsilon)
         {
+            A.multiply(x.data(), y.data());
+
             norm = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N * spmv_vector_kernel.get_cost())) \
                 reduction(+:norm)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     c_temp[v] = 0;
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         auto s = source(e, g);
-                         c_temp[v] += get(w, e) * c[s];
-                     }
-                     norm += power(c_temp[v], 2);
-                 });
+            for (size_t i = 0; i < N; ++i)
+                norm += power(y[i], 2);
 
             norm = sqrt(norm);
 
             delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N * spmv_vector_kernel.get_cost())) \
                 reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     c_temp[v] /= norm;
-                     delta += abs(c_temp[v] - c[v]);
-                 });
+            for (size_t i = 0; i < N; ++i)
+            {
+                y[i] /= norm;
+                delta += abs(y[i] - x[i]);
+            }
 
-            swap(c_temp, c);
+            swap(x, y);
 
             ++iter;
             if (max_iter > 0 && iter == max_iter)
                 break;
         }
 
-        if (iter % 2 != 0)
-            parallel_vertex_loop(g, [&](auto v) { c[v] = c_temp[v]; });
+        A.put_vector(c, x.data());
 
         eig = norm;
     }
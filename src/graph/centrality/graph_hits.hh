@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_spmv.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -48,18 +49,16 @@ struct get_hits
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
-        CentralityMap x_temp(vertex_index, num_vertices(g));
-        CentralityMap y_temp(vertex_index, num_vertices(g));
+        // authorities are gathered from the in-neighbors, and hubs from the
+        // out-neighbors, with the same vertex numbering
+        spmv_matrix<t_type> A(g, [&](const auto& e) { return get(w, e); });
+        spmv_matrix<t_type> AT(g, [&](const auto& e) { return get(w, e); },
+                               true, A);
 
         // init centrality
-        auto V = HardNumVertices()(g);
-        parallel_vertex_loop
-            (g,
-             [&](auto v)
-             {
-                 x[v] = 1.0 / V;
-                 y[v] = 1.0 / V;
-             });
+        size_t N = A.size();
+        vector<t_type> x_(N, 1.0 / N), y_(N, 1.0 / N);
+        vector<t_type> x_temp(N), y_temp(N);
 
         t_type x_norm = 0, y_norm = 0;
 
@@ -67,66 +66,44 @@ struct get_hits
         size_t iter = 0;
         while (delta >= epsilon)
         {
-            x_norm = 0, y_norm=0;
+            A.multiply(y_.data(), x_temp.data());
+            AT.multiply(x_.data(), y_temp.data());
 
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            x_norm = 0, y_norm=0;
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N * spmv_vector_kernel.get_cost())) \
                 reduction(+:x_norm, y_norm)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     x_temp[v] = 0;
-                     for (const auto& ie : in_or_out_edges_range(v, g))
-                     {
-                         auto s = source(ie, g);
-                         x_temp[v] += get(w, ie) * y[s];
-                     }
-                     x_norm += power(x_temp[v], 2);
-
-                     y_temp[v] = 0;
-
-                     for (const auto& e : out_edges_range(v, g))
-                     {
-                         auto s = target(e, g);
-                         y_temp[v] += get(w, e) * x[s];
-                     }
-                     y_norm += power(y_temp[v], 2);
-                 });
+            for (size_t i = 0; i < N; ++i)
+            {
+                x_norm += power(x_temp[i], 2);
+                y_norm += power(y_temp[i], 2);
+            }
 
             x_norm = sqrt(x_norm);
             y_norm = sqrt(y_norm);
 
             delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N * spmv_vector_kernel.get_cost())) \
                 reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     x_temp[v] /= x_norm;
-                     y_temp[v] /= y_norm;
-                     delta += abs(x_temp[v] - x[v]);
-                     delta += abs(y_temp[v] - y[v]);
-                 });
-
-            swap(x_temp, x);
-            swap(y_temp, y);
+            for (size_t i = 0; i < N; ++i)
+            {
+                x_temp[i] /= x_norm;
+                y_temp[i] /= y_norm;
+                delta += abs(x_temp[i] - x_[i]);
+                delta += abs(y_temp[i] - y_[i]);
+            }
+
+            swap(x_temp, x_);
+            swap(y_temp, y_);
 
             ++iter;
             if (max_iter > 0 && iter== max_iter)
                 break;
         }
 
-        if (iter % 2 != 0)
-        {
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     x[v] = x_temp[v];
-                     y[v] = y_temp[v];
-                 });
-        }
+        A.put_vector(x, x_.data());
+        A.put_vector(y, y_.data());
 
         eig = x_norm;
     }
@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_spmv.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -48,38 +49,37 @@ struct get_katz
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
-        CentralityMap c_temp(vertex_index, num_vertices(g));
+        spmv_matrix<t_type> A(g,
+                              [&](const auto& e) { return alpha * get(w, e); });
+
+        size_t N = A.size();
+        vector<t_type> x(N), y(N), b(N);
+        A.get_vector(c, x.data());
+        A.get_vector(beta, b.data());
 
         t_type delta = epsilon + 1;
         size_t iter = 0;
         while (delta >= epsilon)
         {
+            A.multiply(x.data(), y.data());
+
             delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N * spmv_vector_kernel.get_cost())) \
                 reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     c_temp[v] = get(beta, v);
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         auto s = source(e, g);
-                         c_temp[v] += alpha * get(w, e) * c[s];
-                     }
-                     delta += abs(c_temp[v] - c[v]);
-                 });
-            swap(c_temp, c);
+            for (size_t i = 0; i < N; ++i)
+            {
+                y[i] += b[i];
+                delta += abs(y[i] - x[i]);
+            }
+            swap(x, y);
 
             ++iter;
             if (max_iter > 0 && iter == max_iter)
                 break;
         }
 
-        if (iter % 2 != 0)
-        {
-            parallel_vertex_loop(g, [&](auto v) {c_temp[v] = c[v];});
-        }
+        A.put_vector(c, x.data());
     }
 };
 
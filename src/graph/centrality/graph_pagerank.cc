@@ -55,7 +55,7 @@ size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
         weight = weight_map_t();
 
     size_t iter;
-    run_action<>()
+    run_action<all_graph_views_frozen>()
         (g, std::bind(get_pagerank(),
                       std::placeholders::_1, g.get_vertex_index(), std::placeholders::_2,
                       std::placeholders::_3, std::placeholders::_4, d,
@@ -65,9 +65,113 @@ size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
     return iter;
 }
 
+size_t pagerank_update(GraphInterface& g, boost::any rank, boost::any pers,
+                       boost::any weight, double d, double epsilon,
+                       size_t max_iter, boost::python::object oadded,
+                       boost::python::object oremoved)
+{
+    if (!belongs<vertex_floating_properties>()(rank))
+        throw ValueException("rank vertex property must have a floating-point value type");
+
+    if (!pers.empty() && !belongs<vertex_scalar_properties>()(pers))
+        throw ValueException("personalization vertex property must have a scalar value type");
+
+    typedef ConstantPropertyMap<double, GraphInterface::vertex_t> pers_map_t;
+    typedef boost::mpl::push_back<vertex_scalar_properties, pers_map_t>::type
+        pers_props_t;
+
+    if(pers.empty())
+        pers = pers_map_t(1.0 / g.get_num_vertices());
+
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    auto added = get_array<double, 2>(oadded);
+    auto removed = get_array<double, 2>(oremoved);
+
+    size_t iter;
+    run_action<>()
+        (g, std::bind(get_pagerank_update(),
+                      std::placeholders::_1, g.get_vertex_index(), std::placeholders::_2,
+                      std::placeholders::_3, std::placeholders::_4, d,
+                      epsilon, max_iter, std::ref(added), std::ref(removed),
+                      std::ref(iter)),
+         vertex_floating_properties(),
+         pers_props_t(), weight_props_t())(rank, pers, weight);
+    return iter;
+}
+
+void pagerank_multi(GraphInterface& g, boost::any weight, double d,
+                    double epsilon, size_t max_iter, size_t block,
+                    boost::python::object opers, boost::python::object orank,
+                    boost::python::object oiters)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    auto pers = get_array<double, 2>(opers);
+    auto rank = get_array<double, 2>(orank);
+    auto iters = get_array<int64_t, 1>(oiters);
+
+    run_action<all_graph_views_frozen>()
+        (g, [&](auto& graph, auto& w)
+            {
+                get_pagerank_multi()
+                    (graph, g.get_vertex_index(), w, pers, rank, iters, d,
+                     epsilon, max_iter, block);
+            },
+         weight_props_t())(weight);
+}
+
+boost::python::object pagerank_push(GraphInterface& g, boost::any weight,
+                                    double d, double epsilon,
+                                    boost::python::object opers,
+                                    boost::python::object oiters)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    auto pers = get_array<double, 2>(opers);
+    auto iters = get_array<int64_t, 1>(oiters);
+
+    vector<std::array<double, 3>> rank;
+    run_action<all_graph_views_frozen>()
+        (g, [&](auto& graph, auto& w)
+            {
+                get_pagerank_push()
+                    (graph, g.get_vertex_index(), w, pers, rank, iters, d,
+                     epsilon);
+            },
+         weight_props_t())(weight);
+    return wrap_vector_owned<double, 3>(rank);
+}
 
 void export_pagerank()
 {
     using namespace boost::python;
     def("get_pagerank", &pagerank);
+    def("get_pagerank_update", &pagerank_update);
+    def("get_pagerank_multi", &pagerank_multi);
+    def("get_pagerank_push", &pagerank_push);
 }
@@ -21,12 +21,19 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "hash_map_wrap.hh"
+#include "numpy_bind.hh"
+#include "graph_spmv.hh"
+
+#include <deque>
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+inline const openmp_kernel pagerank_kernel("pagerank", 1);
+
 struct get_pagerank
 {
     template <class Graph, class VertexIndex, class RankMap, class PerMap,
@@ -37,17 +44,30 @@ struct get_pagerank
     {
         typedef typename property_traits<RankMap>::value_type rank_type;
 
-        RankMap r_temp(vertex_index, num_vertices(g));
         RankMap deg(vertex_index, num_vertices(g));
 
         // init degs
+        parallel_vertex_loop
+            (g, [&](auto v) { put(deg, v, out_degreeS()(v, g, weight)); });
+
+        // A[v][s] = w(s -> v) / k(s)
+        spmv_matrix<rank_type> A(g,
+                                 [&](const auto& e)
+                                 {
+                                     return get(weight, e) /
+                                         get(deg, source(e, g));
+                                 });
+
+        size_t N = A.size();
+        vector<rank_type> x(N), y(N), p(N);
+        A.get_vector(rank, x.data());
+        A.get_vector(pers, p.data());
+
         std::vector<size_t> sinks;
-        for (auto v : vertices_range(g))
+        for (size_t i = 0; i < N; ++i)
         {
-            auto k = out_degreeS()(v, g, weight);
-            put(deg, v, k);
-            if (k == 0)
-                sinks.push_back(v);
+            if (get(deg, A.get_vertex(i)) == 0)
+                sinks.push_back(i);
         }
 
         rank_type delta = epsilon + 1;
@@ -55,46 +75,494 @@ struct get_pagerank
         iter = 0;
         while (delta >= epsilon)
         {
-            delta = 0;
-
             double p_sink = 0;
-            #pragma omp parallel if (sinks.size() > OPENMP_MIN_THRESH)      \
+            #pragma omp parallel if (is_parallel_worth(sinks.size()))       \
                 reduction(+:p_sink)
             parallel_loop_no_spawn
                 (sinks,
-                 [&](auto, auto v){ p_sink += get(rank, v); });
-
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)   \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     rank_type r = p_sink * get(pers, v);
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         auto s = source(e, g);
-                         r += (get(rank, s) * get(weight, e)) / get(deg, s);
-                     }
+                 [&](auto, auto i){ p_sink += x[i]; });
 
-                     put(r_temp, v, (1.0 - d) * get(pers, v) + d * r);
+            A.multiply(x.data(), y.data(), 1, pagerank_kernel);
 
-                     delta += abs(get(r_temp, v) - get(rank, v));
-                 });
-            swap(r_temp, rank);
+            delta = 0;
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N)) reduction(+:delta)
+            for (size_t i = 0; i < N; ++i)
+            {
+                y[i] = (1.0 - d) * p[i] + d * (y[i] + p_sink * p[i]);
+                delta += abs(y[i] - x[i]);
+            }
+            swap(x, y);
             ++iter;
             if (max_iter > 0 && iter == max_iter)
                 break;
         }
 
-        if (iter % 2 != 0)
+        A.put_vector(rank, x.data());
+    }
+};
+
+// Batched personalized PageRank
+// ------------------------------
+//
+// The personalization vectors are given as rows of (index, vertex, value) in
+// `pers', and are normalized to sum to one. The results are written to
+// rank[index][vertex], and the number of iterations to iters[index].
+
+template <class Graph>
+vector<vector<pair<size_t, double>>>
+get_pers_vectors(Graph& g, multi_array_ref<double, 2>& pers, size_t k)
+{
+    vector<vector<pair<size_t, double>>> seeds(k);
+    for (size_t i = 0; i < pers.shape()[0]; ++i)
+    {
+        size_t j = pers[i][0];
+        size_t v = pers[i][1];
+        if (j >= k)
+            throw ValueException("invalid personalization index: " +
+                                 lexical_cast<string>(j));
+        if (v >= num_vertices(g) || !is_valid_vertex(vertex(v, g), g))
+            throw ValueException("invalid vertex: " + lexical_cast<string>(v));
+        seeds[j].emplace_back(v, pers[i][2]);
+    }
+
+    for (size_t j = 0; j < k; ++j)
+    {
+        double sum = 0;
+        for (auto& vx : seeds[j])
+            sum += vx.second;
+        if (sum <= 0)
+            throw ValueException("personalization vector " +
+                                 lexical_cast<string>(j) +
+                                 " must have a positive sum");
+        for (auto& vx : seeds[j])
+            vx.second /= sum;
+    }
+    return seeds;
+}
+
+// The vectors are iterated together, in blocks of at most `block', sharing
+// each pass over the edges. As soon as a vector converges its slot in the
+// block is reused by the next pending one.
+
+struct get_pagerank_multi
+{
+    template <class Graph, class VertexIndex, class Weight>
+    void operator()(Graph& g, VertexIndex vertex_index, Weight weight,
+                    multi_array_ref<double, 2>& pers,
+                    multi_array_ref<double, 2>& rank,
+                    multi_array_ref<int64_t, 1>& iters, double damping,
+                    double epsilon, size_t max_iter, size_t block) const
+    {
+        typedef typename vprop_map_t<double>::type::unchecked_t deg_t;
+
+        size_t k = rank.shape()[0];
+        auto seeds = get_pers_vectors(g, pers, k);
+
+        deg_t deg(vertex_index, num_vertices(g));
+        parallel_vertex_loop
+            (g, [&](auto v) { put(deg, v, out_degreeS()(v, g, weight)); });
+
+        spmv_matrix<double> A(g,
+                              [&](const auto& e)
+                              {
+                                  return get(weight, e) /
+                                      get(deg, source(e, g));
+                              });
+
+        size_t N = A.size();
+        size_t B = std::max(std::min(block, k), size_t(1));
+        vector<double> x(N * B), y(N * B), p(N * B);
+        vector<double> p_sink(B), delta(B);
+
+        std::vector<size_t> sinks;
+        for (size_t i = 0; i < N; ++i)
         {
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     put(rank, v, get(r_temp, v));
-                 });
+            if (get(deg, A.get_vertex(i)) == 0)
+                sinks.push_back(i);
+        }
+
+        constexpr size_t null = numeric_limits<size_t>::max();
+        vector<size_t> slot(B, null);
+        size_t next = 0;
+        size_t active = 0;
+        auto load = [&](size_t j)
+            {
+                #pragma omp parallel for schedule(static) \
+                    if (is_parallel_worth(N))
+                for (size_t i = 0; i < N; ++i)
+                    x[i * B + j] = p[i * B + j] = 0;
+                if (next == k)
+                {
+                    slot[j] = null;
+                    return;
+                }
+                slot[j] = next++;
+                for (auto& vx : seeds[slot[j]])
+                {
+                    size_t i = A.get_row(vx.first) * B + j;
+                    x[i] = p[i] += vx.second;
+                }
+                iters[slot[j]] = 0;
+                ++active;
+            };
+        for (size_t j = 0; j < B; ++j)
+            load(j);
+
+        double d = damping;
+        double* ps = p_sink.data();
+        double* dt = delta.data();
+        while (active > 0)
+        {
+            std::fill(p_sink.begin(), p_sink.end(), 0);
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(sinks.size() * B)) reduction(+:ps[:B])
+            for (size_t l = 0; l < sinks.size(); ++l)
+            {
+                for (size_t j = 0; j < B; ++j)
+                    ps[j] += x[sinks[l] * B + j];
+            }
+
+            A.multiply(x.data(), y.data(), B, pagerank_kernel);
+
+            std::fill(delta.begin(), delta.end(), 0);
+            #pragma omp parallel for schedule(static) \
+                if (is_parallel_worth(N * B)) reduction(+:dt[:B])
+            for (size_t i = 0; i < N; ++i)
+            {
+                #pragma omp simd
+                for (size_t j = 0; j < B; ++j)
+                {
+                    size_t l = i * B + j;
+                    y[l] = (1.0 - d) * p[l] + d * (y[l] + ps[j] * p[l]);
+                    dt[j] += abs(y[l] - x[l]);
+                }
+            }
+            swap(x, y);
+
+            for (size_t j = 0; j < B; ++j)
+            {
+                if (slot[j] == null)
+                    continue;
+                auto s = slot[j];
+                ++iters[s];
+                if (delta[j] >= epsilon &&
+                    (max_iter == 0 || size_t(iters[s]) < max_iter))
+                    continue;
+                #pragma omp parallel for schedule(static) \
+                    if (is_parallel_worth(N))
+                for (size_t i = 0; i < N; ++i)
+                    rank[s][A.get_vertex(i)] = x[i * B + j];
+                --active;
+                load(j);
+            }
+        }
+    }
+};
+
+// Approximate personalized PageRank by local pushes [andersen-local-2006]:
+// each vector is handled by a single thread, which keeps the residual and the
+// solution only for the vertices reached. The residual of a vertex u is pushed
+// to its out-neighbors only while it exceeds epsilon * k(u), where k(u) is the
+// weighted out-degree (or one, for sinks), so that the work is independent of
+// the size of the graph. The nonzero values are appended to `rank' as rows of
+// (index, vertex, value).
+
+struct get_pagerank_push
+{
+    template <class Graph, class VertexIndex, class Weight>
+    void operator()(Graph& g, VertexIndex vertex_index, Weight weight,
+                    multi_array_ref<double, 2>& pers,
+                    vector<std::array<double, 3>>& rank,
+                    multi_array_ref<int64_t, 1>& iters, double damping,
+                    double epsilon) const
+    {
+        typedef typename vprop_map_t<double>::type::unchecked_t deg_t;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        size_t k = iters.shape()[0];
+        auto seeds = get_pers_vectors(g, pers, k);
+
+        deg_t deg(vertex_index, num_vertices(g));
+        parallel_vertex_loop
+            (g, [&](auto v) { put(deg, v, out_degreeS()(v, g, weight)); });
+
+        double d = damping;
+
+        #pragma omp parallel if (k > 1)
+        {
+            gt_hash_map<vertex_t, double> r, x;
+            std::deque<vertex_t> queue;
+            vector<std::array<double, 3>> lrank;
+
+            auto thres = [&](auto v)
+                {
+                    double kv = get(deg, v);
+                    return epsilon * ((kv > 0) ? kv : 1);
+                };
+
+            auto add = [&](auto v, double dr)
+                {
+                    auto& rv = r[v];
+                    bool below = rv < thres(v);
+                    rv += dr;
+                    if (below && rv >= thres(v))
+                        queue.push_back(v);
+                };
+
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t s = 0; s < k; ++s)
+            {
+                r.clear();
+                x.clear();
+                for (auto& vx : seeds[s])
+                    add(vertex(vx.first, g), vx.second);
+
+                size_t n_push = 0;
+                while (!queue.empty())
+                {
+                    auto u = queue.front();
+                    queue.pop_front();
+                    double ru = r[u];
+                    r[u] = 0;
+                    x[u] += (1 - d) * ru;
+                    ++n_push;
+
+                    double ku = get(deg, u);
+                    if (ku == 0)
+                    {
+                        for (auto& vx : seeds[s])
+                            add(vertex(vx.first, g), d * ru * vx.second);
+                        continue;
+                    }
+
+                    for (const auto& e : out_edges_range(u, g))
+                        add(target(e, g), d * ru * get(weight, e) / ku);
+                }
+
+                iters[s] = n_push;
+                for (auto& vx : x)
+                    lrank.push_back({double(s), double(vx.first), vx.second});
+            }
+
+            #pragma omp critical (pagerank_push)
+            rank.insert(rank.end(), lrank.begin(), lrank.end());
+        }
+    }
+};
+
+// Incremental PageRank
+// --------------------
+//
+// Given the PageRank of a graph which was subsequently modified by inserting
+// the edges in `added` and removing the ones in `removed` (given as rows of
+// source, target and weight), the solution is updated by Gauss-Southwell
+// pushes, instead of restarting the power iteration. Assuming the previous
+// solution had converged, its residual in the modified graph is obtained
+// exactly from the changed edges and the out-edges of their sources alone. The
+// residual is then pushed along the out-edges in parallel rounds, from all
+// vertices where it exceeds epsilon / N, so that only the part of the graph
+// affected by the changes is visited. The mass pushed from sinks is
+// distributed to all vertices according to the personalization, which is done
+// lazily, only when it might exceed the threshold.
+
+struct get_pagerank_update
+{
+    template <class Graph, class VertexIndex, class RankMap, class PerMap,
+              class Weight>
+    void operator()(Graph& g, VertexIndex vertex_index, RankMap rank,
+                    PerMap pers, Weight weight, double damping, double epsilon,
+                    size_t max_iter, multi_array_ref<double, 2>& added,
+                    multi_array_ref<double, 2>& removed, size_t& iter) const
+    {
+        typedef typename property_traits<RankMap>::value_type rank_type;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        size_t N = num_vertices(g);
+        rank_type d = damping;
+        rank_type tau = epsilon / std::max(N, size_t(1));
+
+        RankMap r(vertex_index, N);    // residuals
+        rank_type sink = 0;            // undistributed sink mass
+
+        // changed out-edges, grouped by source
+        struct change_t
+        {
+            vertex_t t;
+            rank_type w;
+            bool add;
+        };
+        gt_hash_map<vertex_t, vector<change_t>> changes;
+        auto add_changes = [&](auto& edges, bool add)
+            {
+                for (size_t i = 0; i < edges.shape()[0]; ++i)
+                {
+                    vertex_t s = edges[i][0];
+                    vertex_t t = edges[i][1];
+                    rank_type w = (edges.shape()[1] > 2) ? edges[i][2] : 1;
+                    if (s >= N || t >= N)
+                        throw ValueException("invalid vertex in edge list: (" +
+                                             lexical_cast<string>(s) + ", " +
+                                             lexical_cast<string>(t) + ")");
+                    changes[s].push_back({t, w, add});
+                    if (!graph_tool::is_directed(g))
+                        changes[t].push_back({s, w, add});
+                }
+            };
+        add_changes(added, true);
+        add_changes(removed, false);
+
+        vector<vertex_t> frontier;
+        vector<uint8_t> queued(N, false);
+        auto enqueue = [&](vertex_t v)
+            {
+                if (!queued[v] && abs(r[v]) > tau)
+                {
+                    queued[v] = true;
+                    frontier.push_back(v);
+                }
+            };
+
+        // residual of the previous solution in the modified graph
+        for (auto& uc : changes)
+        {
+            auto u = uc.first;
+            rank_type x = get(rank, u);
+
+            rank_type k = out_degreeS()(u, g, weight);
+            rank_type k_old = k;
+            size_t n_old = out_degree(u, g);
+            rank_type k_scale = abs(k);
+            for (auto& c : uc.second)
+            {
+                if (c.add)
+                {
+                    k_old -= c.w;
+                    --n_old;
+                }
+                else
+                {
+                    k_old += c.w;
+                    ++n_old;
+                }
+                k_scale += abs(c.w);
+            }
+
+            // k_old is reconstructed by subtraction, so that a vanishing
+            // weighted degree is only zero up to the rounding error of the
+            // sums, which would otherwise give a spurious sink-less vertex
+            // with a huge residual
+            size_t n_terms = out_degree(u, g) + uc.second.size();
+            bool sink_new = (k == 0);
+            bool sink_old = (n_old == 0 ||
+                             abs(k_old) <= (n_terms * k_scale *
+                                            numeric_limits<rank_type>::epsilon()));
+
+            for (const auto& e : out_edges_range(u, g))
+            {
+                auto t = target(e, g);
+                rank_type dr = 0;
+                if (!sink_new)
+                    dr += x * get(weight, e) / k;
+                if (!sink_old)
+                    dr -= x * get(weight, e) / k_old;
+                r[t] += d * dr;
+            }
+
+            if (!sink_old)
+            {
+                // the edges in the loop above which did not exist, and the
+                // ones which do not exist anymore
+                for (auto& c : uc.second)
+                    r[c.t] += d * (c.add ? 1 : -1) * x * c.w / k_old;
+            }
+
+            sink += x * (int(sink_new) - int(sink_old));
+
+            for (const auto& e : out_edges_range(u, g))
+                enqueue(target(e, g));
+            for (auto& c : uc.second)
+                enqueue(c.t);
+        }
+
+        rank_type max_pers = 0;
+        #pragma omp parallel if (is_parallel_worth(N)) reduction(max:max_pers)
+        parallel_vertex_loop_no_spawn
+            (g, [&](auto v) { max_pers = std::max(max_pers,
+                                                  rank_type(get(pers, v))); });
+
+        iter = 0;
+        while (true)
+        {
+            // distribute the sink mass, if it is not negligible
+            if (abs(d * sink) * max_pers > tau)
+            {
+                #pragma omp parallel if (is_parallel_worth(N))
+                parallel_vertex_loop_no_spawn
+                    (g, [&](auto v) { r[v] += d * sink * get(pers, v); });
+                sink = 0;
+                for (auto v : vertices_range(g))
+                    enqueue(v);
+            }
+
+            if (frontier.empty() || (max_iter > 0 && iter == max_iter))
+                break;
+
+            vector<vertex_t> next;
+            rank_type dsink = 0;
+            double work = frontier.size() *
+                (num_edges(g) / double(std::max(N, size_t(1))) + 1);
+            #pragma omp parallel if (is_parallel_worth(work)) reduction(+:dsink)
+            {
+                vector<vertex_t> lnext;
+                parallel_loop_no_spawn
+                    (frontier,
+                     [&](size_t, auto u)
+                     {
+                         #pragma omp atomic write
+                         queued[u] = false;
+                         rank_type x;
+                         #pragma omp atomic capture
+                         {
+                             x = r[u];
+                             r[u] = 0;
+                         }
+                         if (x == 0)
+                             return;
+                         rank[u] += x;
+
+                         rank_type k = out_degreeS()(u, g, weight);
+                         if (k == 0)
+                         {
+                             dsink += x;
+                             return;
+                         }
+
+                         for (const auto& e : out_edges_range(u, g))
+                         {
+                             auto t = target(e, g);
+                             rank_type dr = d * x * get(weight, e) / k;
+                             rank_type nr;
+                             #pragma omp atomic capture
+                             nr = r[t] += dr;
+                             if (abs(nr) <= tau)
+                                 continue;
+                             uint8_t was_queued;
+                             #pragma omp atomic capture
+                             {
+                                 was_queued = queued[t];
+                                 queued[t] = true;
+                             }
+                             if (!was_queued)
+                                 lnext.push_back(t);
+                         }
+                     });
+                #pragma omp critical (pagerank_update)
+                next.insert(next.end(), lnext.begin(), lnext.end());
+            }
+            sink += dsink;
+            frontier.swap(next);
+            ++iter;
         }
     }
 };
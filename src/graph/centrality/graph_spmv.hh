@@ -0,0 +1,298 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SPMV_HH
+#define GRAPH_SPMV_HH
+
+#include <algorithm>
+#include <limits>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+
+// Sparse matrix-vector products for power iterations
+// ==================================================
+//
+// spmv_matrix<Value> holds the matrix with entries A[v][u] = coef(e) for every
+// edge e in in_or_out_edges_range(v, g), with u = source(e, g), or, if
+// transposed, for every e in out_edges_range(v, g), with u = target(e, g). The
+// coefficients are evaluated only once, when the matrix is built, and the
+// entries are laid out for repeated products y = A x:
+//
+// - The vertices are renumbered in decreasing order of the number of entries
+//   in their columns, so that the values of x which are read most often are
+//   packed together in memory. All vectors passed to the matrix use this
+//   numbering (see get_vector() and put_vector()).
+//
+// - The rows are split in panels of consecutive vertices, which are handed
+//   out to the threads. Inside a panel the entries are sorted by column, so
+//   that x is traversed in a single forward sweep, and the partial sums are
+//   accumulated in a buffer of the size of the panel, which stays in cache.
+//
+// Several vectors can be multiplied at once. They are stored interleaved,
+// i.e. component j of the value of vertex i is at x[i * k + j], so that every
+// entry of the matrix is loaded once for all of them, and the innermost loop
+// over the k components is vectorized.
+
+inline const openmp_kernel spmv_kernel("spmv", 1);
+
+// cost per row of the vector operations between products, such as the
+// normalization and the convergence check of the power iterations
+inline const openmp_kernel spmv_vector_kernel("spmv_vector", 2);
+
+template <class Value>
+class spmv_matrix
+{
+public:
+    typedef Value value_type;
+
+    template <class Graph, class Coef>
+    spmv_matrix(const Graph& g, Coef&& coef, bool transpose = false)
+    {
+        size_t N = num_vertices(g);
+        _index.resize(N, _null);
+        for (auto v : vertices_range(g))
+        {
+            _index[v] = _vertices.size();
+            _vertices.push_back(v);
+        }
+
+        vector<size_t> count(N, 0);
+        size_t n = _vertices.size();
+        #pragma omp parallel for schedule(runtime) \
+            if (is_parallel_worth(g, spmv_kernel))
+        for (size_t i = 0; i < n; ++i)
+        {
+            for_each_entry(g, _vertices[i], transpose,
+                           [&](auto, auto u)
+                           {
+                               #pragma omp atomic
+                               ++count[u];
+                           });
+        }
+
+        stable_sort(_vertices.begin(), _vertices.end(),
+                    [&](auto u, auto v) { return count[u] > count[v]; });
+        for (size_t i = 0; i < n; ++i)
+            _index[_vertices[i]] = i;
+
+        build(g, coef, transpose);
+    }
+
+    // Uses the same vertex numbering as the matrix `other', so that both can
+    // operate on the same vectors.
+    template <class Graph, class Coef>
+    spmv_matrix(const Graph& g, Coef&& coef, bool transpose,
+                const spmv_matrix& other)
+        : _vertices(other._vertices), _index(other._index)
+    {
+        build(g, coef, transpose);
+    }
+
+    // Number of rows (and columns) of the matrix.
+    size_t size() const { return _vertices.size(); }
+
+    // Number of nonzero entries.
+    size_t nnz() const { return _col.size(); }
+
+    // Vertex corresponding to row i.
+    size_t get_vertex(size_t i) const { return _vertices[i]; }
+
+    // Row corresponding to vertex v.
+    size_t get_row(size_t v) const { return _index[v]; }
+
+    // Sets x[i * k + j] = m[v], for every row i of vertex v.
+    template <class Map>
+    void get_vector(Map m, Value* x, size_t k = 1, size_t j = 0) const
+    {
+        size_t n = size();
+        #pragma omp parallel for schedule(static) if (is_parallel_worth(n))
+        for (size_t i = 0; i < n; ++i)
+            x[i * k + j] = get(m, _vertices[i]);
+    }
+
+    // Sets m[v] = x[i * k + j], for every row i of vertex v.
+    template <class Map>
+    void put_vector(Map m, const Value* x, size_t k = 1, size_t j = 0) const
+    {
+        size_t n = size();
+        #pragma omp parallel for schedule(static) if (is_parallel_worth(n))
+        for (size_t i = 0; i < n; ++i)
+            put(m, _vertices[i], x[i * k + j]);
+    }
+
+    // Computes y = A x, for k interleaved vectors. The arrays x and y must
+    // not overlap.
+    void multiply(const Value* x, Value* y, size_t k = 1,
+                  const openmp_kernel& kernel = spmv_kernel) const
+    {
+        size_t np = _panel_rows.size() - 1;
+        double work = (size() + nnz()) * k * kernel.get_cost();
+        #pragma omp parallel if (is_parallel_worth(work))
+        {
+            vector<Value> buf;
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t p = 0; p < np; ++p)
+            {
+                size_t r = _panel_rows[p];
+                size_t nr = _panel_rows[p + 1] - r;
+                buf.assign(nr * k, 0);
+                Value* b = buf.data();
+                size_t begin = _panel_entries[p];
+                size_t end = _panel_entries[p + 1];
+                if (k == 1)
+                {
+                    for (size_t l = begin; l < end; ++l)
+                        b[_row[l]] += _coef[l] * x[_col[l]];
+                }
+                else
+                {
+                    for (size_t l = begin; l < end; ++l)
+                    {
+                        const Value* xl = x + _col[l] * k;
+                        Value* bl = b + size_t(_row[l]) * k;
+                        Value c = _coef[l];
+                        #pragma omp simd
+                        for (size_t j = 0; j < k; ++j)
+                            bl[j] += c * xl[j];
+                    }
+                }
+                copy(buf.begin(), buf.end(), y + r * k);
+            }
+        }
+    }
+
+private:
+    template <class Graph, class F>
+    static void for_each_entry(const Graph& g, size_t v, bool transpose, F&& f)
+    {
+        if (transpose)
+        {
+            for (const auto& e : out_edges_range(v, g))
+                f(e, target(e, g));
+        }
+        else
+        {
+            for (const auto& e : in_or_out_edges_range(v, g))
+                f(e, source(e, g));
+        }
+    }
+
+    template <class Graph, class Coef>
+    void build(const Graph& g, Coef& coef, bool transpose)
+    {
+        size_t n = size();
+
+        vector<size_t> row_count(n);
+        #pragma omp parallel for schedule(runtime) \
+            if (is_parallel_worth(g, spmv_kernel))
+        for (size_t i = 0; i < n; ++i)
+        {
+            size_t c = 0;
+            for_each_entry(g, _vertices[i], transpose,
+                           [&](auto, auto) { ++c; });
+            row_count[i] = c;
+        }
+
+        _panel_rows.clear();
+        _panel_entries.clear();
+        _panel_rows.push_back(0);
+        _panel_entries.push_back(0);
+        size_t nr = 0, ne = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            ++nr;
+            ne += row_count[i];
+            if (nr == _max_panel_rows || ne - _panel_entries.back() >=
+                _max_panel_entries || i + 1 == n)
+            {
+                _panel_rows.push_back(i + 1);
+                _panel_entries.push_back(ne);
+                nr = 0;
+            }
+        }
+
+        _col.resize(ne);
+        _row.resize(ne);
+        _coef.resize(ne);
+
+        size_t np = _panel_rows.size() - 1;
+        #pragma omp parallel if (is_parallel_worth(g, spmv_kernel))
+        {
+            struct entry_t
+            {
+                size_t col;
+                uint16_t row;
+                Value coef;
+            };
+            vector<entry_t> entries;
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t p = 0; p < np; ++p)
+            {
+                entries.clear();
+                size_t r = _panel_rows[p];
+                for (size_t i = r; i < _panel_rows[p + 1]; ++i)
+                {
+                    for_each_entry(g, _vertices[i], transpose,
+                                   [&](const auto& e, auto u)
+                                   {
+                                       entries.push_back({_index[u],
+                                                          uint16_t(i - r),
+                                                          Value(coef(e))});
+                                   });
+                }
+                sort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b)
+                     {
+                         return (a.col < b.col ||
+                                 (a.col == b.col && a.row < b.row));
+                     });
+                size_t l = _panel_entries[p];
+                for (auto& x : entries)
+                {
+                    _col[l] = x.col;
+                    _row[l] = x.row;
+                    _coef[l] = x.coef;
+                    ++l;
+                }
+            }
+        }
+    }
+
+    static constexpr size_t _null = numeric_limits<size_t>::max();
+    static constexpr size_t _max_panel_rows = 4096;
+    static constexpr size_t _max_panel_entries = 1 << 16;
+
+    vector<size_t> _vertices;      // row -> vertex
+    vector<size_t> _index;         // vertex -> row
+
+    vector<size_t> _panel_rows;    // first row of each panel
+    vector<size_t> _panel_entries; // first entry of each panel
+
+    vector<size_t> _col;
+    vector<uint16_t> _row;         // relative to the first row of the panel
+    vector<Value> _coef;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_SPMV_HH
@@ -63,7 +63,7 @@ void local_clustering(GraphInterface& g, boost::any prop, boost::any weight)
     if(weight.empty())
         weight = weight_map_t();
 
-    run_action<>()
+    run_action<all_graph_views_frozen>()
         (g, std::bind(set_clustering_to_property(),
                       std::placeholders::_1,
                       std::placeholders::_2,
@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include "hash_map_wrap.hh"
+#include "graph_util.hh"
 #include <boost/mpl/if.hpp>
 
 #ifdef _OPENMP
@@ -43,6 +44,9 @@ namespace graph_tool
 using namespace boost;
 using namespace std;
 
+// cost of counting the triangles of a vertex, per out-neighbour
+inline const openmp_kernel clustering_kernel("clustering", 8);
+
 // calculates the number of triangles to which v belongs
 template <class Graph, class EWeight, class VProp>
 auto get_triangles(typename graph_traits<Graph>::vertex_descriptor v,
@@ -97,7 +101,7 @@ struct get_global_clustering
         val_t triangles = 0, n = 0;
         vector<val_t> mask(num_vertices(g), 0);
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+        #pragma omp parallel if (is_parallel_worth(g, clustering_kernel)) \
             firstprivate(mask) reduction(+:triangles, n)
         parallel_vertex_loop_no_spawn
                 (g,
@@ -112,7 +116,7 @@ struct get_global_clustering
         // "jackknife" variance
         c_err = 0.0;
         double cerr = 0.0;
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+        #pragma omp parallel if (is_parallel_worth(g, clustering_kernel)) \
             firstprivate(mask) reduction(+:cerr)
         parallel_vertex_loop_no_spawn
                 (g,
@@ -136,7 +140,7 @@ struct set_clustering_to_property
         typedef typename property_traits<EWeight>::value_type val_t;
         vector<val_t> mask(num_vertices(g), false);
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+        #pragma omp parallel if (is_parallel_worth(g, clustering_kernel)) \
             firstprivate(mask)
         parallel_vertex_loop_no_spawn
             (g,
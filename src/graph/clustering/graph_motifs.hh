@@ -30,6 +30,9 @@ namespace graph_tool
 {
 namespace mpl = boost::mpl;
 
+// cost of enumerating the subgraphs around a vertex, per out-neighbour
+inline const openmp_kernel motifs_kernel("motifs", 100);
+
 template <class Value>
 void insert_sorted(std::vector<Value>& v, const Value& val)
 {
@@ -358,8 +361,9 @@ struct get_all_motifs
         }
 
         size_t N = (p < 1) ? V.size() : num_vertices(g);
-        #pragma omp parallel for if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            private(sig)
+        double work = (num_vertices(g) + num_edges(g)) * std::min(p, 1.) *
+            motifs_kernel.get_cost();
+        #pragma omp parallel for if (is_parallel_worth(work)) private(sig)
         for (size_t i = 0; i < N; ++i)
         {
             std::vector<std::vector<typename boost::graph_traits<Graph>::vertex_descriptor> >
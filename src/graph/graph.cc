@@ -113,3 +113,25 @@ void GraphInterface::clear_edges()
 {
     run_action<>()(*this, std::bind(do_clear_edges(), std::placeholders::_1))();
 }
+
+// this will build a read-only snapshot of the graph, which is stored
+// contiguously in memory, and which will be used by the algorithms that
+// support it, until the graph is modified
+void GraphInterface::freeze()
+{
+    unfreeze();
+    _frozen = std::make_shared<frozen_graph_t>(*_mg);
+}
+
+void GraphInterface::unfreeze()
+{
+    // drop the cached views of the previous snapshot
+    if (_graph_views.size() > detail::n_views::value)
+        _graph_views.resize(detail::n_views::value);
+    _frozen.reset();
+}
+
+bool GraphInterface::is_frozen() const
+{
+    return _frozen != nullptr && _frozen->matches(*_mg);
+}
@@ -26,6 +26,7 @@
 #include <deque>
 
 #include "graph_adjacency.hh"
+#include "graph_frozen.hh"
 
 #include <boost/graph/graph_traits.hpp>
 
@@ -108,6 +109,11 @@ public:
                             boost::any prop_tgt);
     void shrink_to_fit() { _mg->shrink_to_fit(); }
 
+    // frozen (read-only, contiguous) snapshot of the graph
+    void freeze();
+    void unfreeze();
+    bool is_frozen() const;
+
     //
     // python interface
     //
@@ -119,18 +125,23 @@ public:
 
     // I/O
     void write_to_file(std::string s, boost::python::object pf, std::string format,
-                       boost::python::list properties);
+                       boost::python::list properties, int gt_version);
     boost::python::tuple read_from_file(std::string s, boost::python::object pf,
                                         std::string format,
                                         boost::python::list ignore_vp,
                                         boost::python::list ignore_ep,
-                                        boost::python::list ignore_gp);
+                                        boost::python::list ignore_gp,
+                                        bool lazy);
+    boost::python::object read_property_from_file(std::string s,
+                                                  std::string key_type,
+                                                  std::string name);
 
     //
     // Internal types
     //
 
     typedef boost::adj_list<size_t> multigraph_t;
+    typedef boost::frozen_adj_list<size_t> frozen_graph_t;
     typedef boost::graph_traits<multigraph_t>::vertex_descriptor vertex_t;
     typedef boost::graph_traits<multigraph_t>::edge_descriptor edge_t;
 
@@ -145,11 +156,17 @@ public:
     vertex_index_map_t get_vertex_index()   {return _vertex_index;}
     edge_index_map_t   get_edge_index()     {return _edge_index;}
     size_t             get_edge_index_range() {return _mg->get_edge_index_range();}
+    size_t             get_num_modifications() {return _mg->get_num_modifications();}
+    size_t             get_instance_id() {return _mg->get_instance_id();}
 
     graph_index_map_t  get_graph_index()  {return graph_index_map_t(0);}
 
     // Gets the encapsulated graph view. See graph_filtering.cc for details
     boost::any get_graph_view() const;
+
+    // Same as above, but returns a view of the frozen snapshot instead, if it
+    // is available and the graph is not filtered
+    boost::any get_frozen_graph_view() const;
     std::vector<boost::any>& get_graph_views() {return _graph_views;}
 
 private:
@@ -161,6 +178,9 @@ private:
     // this is the main graph
     std::shared_ptr<multigraph_t> _mg;
 
+    // frozen snapshot of the main graph, if requested
+    std::shared_ptr<frozen_graph_t> _frozen;
+
     // vertex index map
     vertex_index_map_t _vertex_index;
 
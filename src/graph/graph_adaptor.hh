@@ -453,6 +453,16 @@ add_edge(typename graph_traits<undirected_adaptor<Graph> >::vertex_descriptor u,
     return add_edge(u, v, ep, g.original_graph());
 }
 
+//==============================================================================
+// add_edges(begin,end,g,f)
+//==============================================================================
+template <class Graph, class Iter, class F>
+inline
+void add_edges(Iter begin, Iter end, undirected_adaptor<Graph>& g, F&& f)
+{
+    add_edges(begin, end, g.original_graph(), std::forward<F>(f));
+}
+
 //==============================================================================
 // remove_edge(u,v,g)
 //==============================================================================
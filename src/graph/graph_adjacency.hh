@@ -18,6 +18,8 @@
 #ifndef GRAPH_ADJACENCY_HH
 #define GRAPH_ADJACENCY_HH
 
+#include "config.h"
+
 #include <vector>
 #include <deque>
 #include <utility>
@@ -25,6 +27,8 @@
 #include <iostream>
 #include <tuple>
 #include <functional>
+#include <stdexcept>
+#include <atomic>
 #include <boost/iterator.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/range/irange.hpp>
@@ -145,6 +149,15 @@ template <class Vertex>
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
 add_edge(Vertex s, Vertex t, adj_list<Vertex>& g);
 
+template <class Vertex, class Iter, class F>
+void add_edges(Iter begin, Iter end, adj_list<Vertex>& g, F&& f);
+
+template <class Vertex, class Iter>
+void add_edges(Iter begin, Iter end, adj_list<Vertex>& g);
+
+template <class Vertex, class F>
+void add_out_edges(adj_list<Vertex>& g, F&& get_targets);
+
 template <class Vertex>
 void remove_edge(Vertex s, Vertex t, adj_list<Vertex>& g);
 
@@ -166,11 +179,34 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
 // template parameter. It achieves about half as much memory as
 // boost::adjacency_list with an edge index property map and the same integer
 // type.
+//
+// The integers actually kept in the edge lists are of type
+// adj_list_index<Vertex>::type, which by default is the same as Vertex. If
+// graph-tool is configured with --enable-compact-adjacency, adj_list<size_t>
+// will instead store them as uint32_t, which halves the memory used by the
+// edge lists (8 instead of 16 bytes per edge endpoint) while keeping all
+// descriptors as size_t. In this case the number of vertices and the edge
+// index range are limited to 2^32 - 1, and exceeding them will raise
+// std::overflow_error.
 
 // The complexity guarantees and iterator invalidation rules are the same as
 // boost::adjacency_list with vector storage selectors for both vertex and edge
 // lists.
 
+template <class Vertex>
+struct adj_list_index
+{
+    typedef Vertex type;
+};
+
+#ifdef COMPACT_ADJACENCY
+template <>
+struct adj_list_index<size_t>
+{
+    typedef uint32_t type;
+};
+#endif
+
 namespace detail
 {
 template <class Vertex>
@@ -198,6 +234,31 @@ struct adj_edge_descriptor
 
     Vertex s, t, idx;
 };
+
+// Process-wide unique identifier, drawn anew on construction, copy and
+// assignment, so that it is shared by no two objects, past or present.
+class instance_id
+{
+public:
+    instance_id(): _id(next()) {}
+    instance_id(const instance_id&): _id(next()) {}
+    instance_id& operator=(const instance_id&)
+    {
+        _id = next();
+        return *this;
+    }
+
+    size_t get() const { return _id; }
+
+private:
+    static size_t next()
+    {
+        static std::atomic<size_t> count(0);
+        return count.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    size_t _id;
+};
 } // namespace detail
 
 template <class Vertex = size_t>
@@ -206,21 +267,23 @@ class adj_list
 public:
     struct graph_tag {};
     typedef Vertex vertex_t;
+    typedef typename adj_list_index<Vertex>::type index_t;
 
     typedef detail::adj_edge_descriptor<Vertex> edge_descriptor;
 
-    typedef std::vector<std::pair<vertex_t, vertex_t> > edge_list_t;
+    typedef std::vector<std::pair<index_t, index_t> > edge_list_t;
     typedef std::vector<std::pair<size_t, edge_list_t>> vertex_list_t;
     typedef typename integer_range<Vertex>::iterator vertex_iterator;
 
-    adj_list(): _n_edges(0), _edge_index_range(0), _keep_epos(false) {}
+    adj_list(): _n_edges(0), _edge_index_range(0), _keep_epos(false),
+                _n_mods(0) {}
 
     struct get_vertex
     {
         get_vertex() {}
         typedef Vertex result_type;
         __attribute__((always_inline))
-        Vertex operator()(const std::pair<vertex_t, vertex_t>& v) const
+        Vertex operator()(const std::pair<index_t, index_t>& v) const
         { return v.first; }
     };
 
@@ -273,12 +336,12 @@ public:
     {
         template <class Iter>
         static edge_descriptor def(vertex_t src,
-                                   const std::pair<vertex_t, vertex_t>& v,
+                                   const std::pair<index_t, index_t>& v,
                                    Iter&&)
         { return edge_descriptor(src, v.first, v.second); }
 
         static edge_descriptor def(vertex_t src,
-                                   const std::pair<vertex_t, vertex_t>& v)
+                                   const std::pair<index_t, index_t>& v)
         { return def(src, v, nullptr); }
     };
 
@@ -286,12 +349,12 @@ public:
     {
         template <class Iter>
         static edge_descriptor def(vertex_t tgt,
-                                   const std::pair<vertex_t, vertex_t>& v,
+                                   const std::pair<index_t, index_t>& v,
                                    Iter&&)
         { return edge_descriptor(v.first, tgt, v.second); }
 
         static edge_descriptor def(vertex_t tgt,
-                                   const std::pair<vertex_t, vertex_t>& v)
+                                   const std::pair<index_t, index_t>& v)
         { return def(tgt, v, nullptr); }
     };
 
@@ -304,7 +367,7 @@ public:
     {
         template <class I>
         static edge_descriptor def(vertex_t u,
-                                   const std::pair<vertex_t, vertex_t>& v,
+                                   const std::pair<index_t, index_t>& v,
                                    const I& i)
         {
             const Iter& iter = reinterpret_cast<const Iter&>(i);
@@ -399,6 +462,7 @@ public:
 
     void reindex_edges()
     {
+        _n_mods++;
         _free_indexes.clear();
         _edge_index_range = 0;
         for (auto& es : _edges)
@@ -442,8 +506,22 @@ public:
 
     size_t get_edge_index_range() const { return _edge_index_range; }
 
+    // number of structural modifications since construction; together with
+    // the instance id, this can be used to detect whether a graph has changed
+    size_t get_num_modifications() const { return _n_mods; }
+
+    // identifier of this graph instance, which is never reused: it is drawn
+    // anew whenever the graph is constructed, copied or assigned to
+    size_t get_instance_id() const { return _id.get(); }
+
     static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
 
+    // largest vertex or edge index that can be stored in the edge lists
+    static constexpr size_t max_index()
+    {
+        return std::numeric_limits<index_t>::max() - 1;
+    }
+
     void shrink_to_fit()
     {
         _edges.shrink_to_fit();
@@ -506,6 +584,8 @@ private:
                                       // memory use
     bool _keep_epos;
     std::vector<std::pair<uint32_t, uint32_t>> _epos; // out, in
+    size_t _n_mods;
+    detail::instance_id _id;
 
     void rebuild_epos()
     {
@@ -607,6 +687,12 @@ private:
     friend std::pair<edge_descriptor, bool>
     add_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
 
+    template <class V, class Iter, class F>
+    friend void add_edges(Iter begin, Iter end, adj_list<V>& g, F&& f);
+
+    template <class V, class F>
+    friend void add_out_edges(adj_list<V>& g, F&& get_targets);
+
     friend void remove_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
 
     friend void remove_edge<>(const edge_descriptor& e, adj_list<Vertex>& g);
@@ -923,6 +1009,10 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
     Vertex idx;
     if (g._free_indexes.empty())
     {
+        if (sizeof(typename adj_list<Vertex>::index_t) < sizeof(Vertex) &&
+            g._edge_index_range > adj_list<Vertex>::max_index())
+            throw std::overflow_error("edge index range exceeds the capacity "
+                                      "of the compact adjacency storage");
         idx = g._edge_index_range++;
     }
     else
@@ -955,6 +1045,7 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
     t_es.emplace_back(s, idx);
 
     g._n_edges++;
+    g._n_mods++;
 
     if (g._keep_epos)
     {
@@ -973,6 +1064,269 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
     return {edge_descriptor(s, t, idx), true};
 }
 
+// Inserts all edges in the range [begin, end), given as (source, target)
+// pairs, at once, and then calls f(i, e) for the i-th inserted edge e. The edge
+// lists of all affected vertices are resized only once, and the edge indexes
+// are assigned in the same way as successive calls to add_edge(). The in- and
+// out-lists are also the same: since add_edge() makes room for a new out-edge
+// of a vertex by moving its first in-edge to the back, the new in-edges are
+// scattered by target in insertion order, together with the number of
+// out-edges their target had received before them, and the affected in-lists
+// are then replayed accordingly. The vertices must already exist. Complexity:
+// O(V + n + m), where n is the number of inserted edges and m the number of
+// previous in-edges of the affected vertices, hence for small n this falls
+// back to add_edge().
+template <class Vertex, class Iter, class F>
+void add_edges(Iter begin, Iter end, adj_list<Vertex>& g, F&& f)
+{
+    typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
+
+    size_t N = g._edges.size();
+    size_t E = std::distance(begin, end);
+
+    if (E < N / 16)
+    {
+        size_t i = 0;
+        for (; begin != end; ++begin)
+        {
+            auto e = add_edge(Vertex(std::get<0>(*begin)),
+                              Vertex(std::get<1>(*begin)), g).first;
+            f(i++, e);
+        }
+        return;
+    }
+
+    if (sizeof(typename adj_list<Vertex>::index_t) < sizeof(Vertex) &&
+        E > g._free_indexes.size() &&
+        g._edge_index_range + (E - g._free_indexes.size()) >
+        adj_list<Vertex>::max_index() + 1)
+        throw std::overflow_error("edge index range exceeds the capacity "
+                                  "of the compact adjacency storage");
+
+    // counting pass
+    std::vector<size_t> out_pos(N), in_pos(N);
+    for (auto iter = begin; iter != end; ++iter)
+    {
+        out_pos[std::get<0>(*iter)]++;
+        in_pos[std::get<1>(*iter)]++;
+    }
+
+    // offsets of the new in-edges of each vertex, grouped by target
+    std::vector<size_t> in_begin(N + 1);
+    for (size_t v = 0; v < N; ++v)
+        in_begin[v + 1] = in_begin[v] + in_pos[v];
+
+    // make room for the new entries, and move the in-lists out of the way of
+    // the new out-edges; afterwards out_pos holds the position where the next
+    // new out-edge of each vertex will be put
+    for (size_t v = 0; v < N; ++v)
+    {
+        size_t k_out = out_pos[v];
+        size_t k_in = in_pos[v];
+        if (k_out == 0 && k_in == 0)
+            continue;
+        auto& pos = g._edges[v].first;
+        auto& es = g._edges[v].second;
+        size_t n_in = es.size() - pos;
+        es.resize(es.size() + k_out + k_in);
+        std::move_backward(es.begin() + pos, es.begin() + pos + n_in,
+                           es.begin() + pos + n_in + k_out);
+        out_pos[v] = pos;
+        pos += k_out;
+    }
+
+    // edge indexes are taken from the free list first
+    size_t n_free = std::min(E, g._free_indexes.size());
+    std::vector<size_t> free_indexes(g._free_indexes.begin(),
+                                     g._free_indexes.begin() + n_free);
+    g._free_indexes.erase(g._free_indexes.begin(),
+                          g._free_indexes.begin() + n_free);
+    size_t erange = g._edge_index_range;
+    auto get_idx = [&](size_t i) -> Vertex
+        { return (i < n_free) ? free_indexes[i] : erange + (i - n_free); };
+
+    // fill pass: the out-edges are put directly in place, and the in-edges are
+    // scattered by target, each with the number of out-edges its target had
+    // received up to and including this edge
+    std::vector<std::tuple<Vertex, Vertex, size_t>> in_es(E);
+    std::vector<size_t> in_next(in_begin.begin(), in_begin.end() - 1);
+    std::vector<size_t> n_rot(N);
+    size_t i = 0;
+    for (auto iter = begin; iter != end; ++iter)
+    {
+        Vertex s = std::get<0>(*iter);
+        Vertex t = std::get<1>(*iter);
+        Vertex idx = get_idx(i++);
+        g._edges[s].second[out_pos[s]++] = {t, idx};
+        n_rot[s]++;
+        in_es[in_next[t]++] = {s, idx, n_rot[t]};
+    }
+
+    // replay the in-lists: every new out-edge moves the first in-edge to the
+    // back, and every new in-edge is appended
+    typedef typename adj_list<Vertex>::edge_list_t::value_type entry_t;
+    std::vector<entry_t> queue;
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (in_begin[v] == in_begin[v + 1] && n_rot[v] == 0)
+            continue;
+        auto& pos = g._edges[v].first;
+        auto& es = g._edges[v].second;
+        size_t k_in = in_begin[v + 1] - in_begin[v];
+        queue.assign(es.begin() + pos, es.end() - k_in);
+        size_t front = 0, rot = 0;
+        auto rotate = [&](size_t r)
+        {
+            for (; rot < r; ++rot)
+            {
+                if (front < queue.size())
+                {
+                    queue.push_back(queue[front]);
+                    front++;
+                }
+            }
+        };
+        for (size_t j = in_begin[v]; j < in_begin[v + 1]; ++j)
+        {
+            auto& [s, idx, r] = in_es[j];
+            rotate(r);
+            queue.emplace_back(s, idx);
+        }
+        rotate(n_rot[v]);
+        std::copy(queue.begin() + front, queue.end(), es.begin() + pos);
+    }
+
+    g._edge_index_range += E - n_free;
+    g._n_edges += E;
+    g._n_mods++;
+
+    if (g._keep_epos)
+        g.rebuild_epos();
+
+    // the graph is consistent at this point, even if f throws
+    i = 0;
+    for (; begin != end; ++begin)
+    {
+        Vertex s = std::get<0>(*begin);
+        Vertex t = std::get<1>(*begin);
+        f(i, edge_descriptor(s, t, get_idx(i)));
+        i++;
+    }
+}
+
+template <class Vertex, class Iter>
+void add_edges(Iter begin, Iter end, adj_list<Vertex>& g)
+{
+    add_edges(begin, end, g, [](size_t, auto&&){});
+}
+
+// Inserts, for every vertex v in turn, the out-edges to the vertices in the
+// range returned by get_targets(v). The result is the same as add_edges() with
+// the pairs (v, u) in this order, but the pairs need not be stored: the
+// out-list of each vertex is extended once, as its targets are obtained, and
+// the in-lists are filled afterwards from the new out-edges, using only O(V)
+// additional memory besides a copy of the in-list being replayed. If
+// get_targets() throws, the edges inserted so far are removed again. The
+// targets must already exist.
+template <class Vertex, class F>
+void add_out_edges(adj_list<Vertex>& g, F&& get_targets)
+{
+    size_t N = g._edges.size();
+    std::vector<size_t> k_out(N), k_in(N);  // new out- and in-edges
+
+    // edge indexes are taken from the free list first
+    size_t n_free = g._free_indexes.size();
+    size_t erange = g._edge_index_range;
+    auto get_idx = [&](size_t i) -> Vertex
+        { return (i < n_free) ? g._free_indexes[i] : erange + (i - n_free); };
+
+    size_t E = 0;
+    try
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto&& us = get_targets(Vertex(v));
+            size_t k = std::distance(std::begin(us), std::end(us));
+            if (k == 0)
+                continue;
+            if (sizeof(typename adj_list<Vertex>::index_t) < sizeof(Vertex) &&
+                E + k > n_free &&
+                erange + (E + k - n_free) > adj_list<Vertex>::max_index() + 1)
+                throw std::overflow_error("edge index range exceeds the "
+                                          "capacity of the compact adjacency "
+                                          "storage");
+            auto& pos = g._edges[v].first;
+            auto& es = g._edges[v].second;
+            es.insert(es.begin() + pos, k, {});
+            for (auto u : us)
+            {
+                es[pos++] = {Vertex(u), get_idx(E++)};
+                k_in[u]++;
+            }
+            k_out[v] = k;
+        }
+    }
+    catch (...)
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (k_out[v] == 0)
+                continue;
+            auto& pos = g._edges[v].first;
+            auto& es = g._edges[v].second;
+            es.erase(es.begin() + pos - k_out[v], es.begin() + pos);
+            pos -= k_out[v];
+        }
+        throw;
+    }
+
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (k_in[v] > 0)
+            g._edges[v].second.reserve(g._edges[v].second.size() + k_in[v]);
+    }
+
+    // fill the in-lists as add_edge() would: every new out-edge of v moves the
+    // first in-edge of v to the back, and the in-edges from the vertices
+    // before (after) v are already there (will be appended later)
+    typedef typename adj_list<Vertex>::edge_list_t::value_type entry_t;
+    std::vector<entry_t> queue;
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (k_out[v] == 0)
+            continue;
+        size_t pos = g._edges[v].first;
+        auto& es = g._edges[v].second;
+        queue.assign(es.begin() + pos, es.end());
+        size_t front = 0;
+        for (size_t j = pos - k_out[v]; j < pos; ++j)
+        {
+            if (front < queue.size())
+            {
+                queue.push_back(queue[front]);
+                front++;
+            }
+            auto oe = es[j];
+            if (oe.first == v)
+                queue.emplace_back(Vertex(v), oe.second);
+            else
+                g._edges[oe.first].second.emplace_back(Vertex(v), oe.second);
+        }
+        es.resize(pos + queue.size() - front);
+        std::copy(queue.begin() + front, queue.end(), es.begin() + pos);
+    }
+
+    size_t n_used = std::min(E, n_free);
+    g._free_indexes.erase(g._free_indexes.begin(),
+                          g._free_indexes.begin() + n_used);
+    g._edge_index_range += E - n_used;
+    g._n_edges += E;
+    g._n_mods++;
+
+    if (g._keep_epos)
+        g.rebuild_epos();
+}
+
 template <class Vertex>
 void remove_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
 {
@@ -1046,13 +1400,19 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
 
     g._free_indexes.push_back(idx);
     g._n_edges--;
+    g._n_mods++;
 }
 
 template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 Vertex add_vertex(adj_list<Vertex>& g)
 {
+    if (sizeof(typename adj_list<Vertex>::index_t) < sizeof(Vertex) &&
+        g._edges.size() > adj_list<Vertex>::max_index())
+        throw std::overflow_error("number of vertices exceeds the capacity "
+                                  "of the compact adjacency storage");
     g._edges.emplace_back();
+    g._n_mods++;
     return g._edges.size() - 1;
 }
 
@@ -1125,6 +1485,7 @@ void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
         es.erase(iter, es.begin() + pos);
         pos = iter - es.begin();
         g._n_edges -= k;
+        g._n_mods++;
     }
     else
     {
@@ -1161,6 +1522,7 @@ void remove_vertex(Vertex v, adj_list<Vertex>& g)
 {
     clear_vertex(v, g);
     g._edges.erase(g._edges.begin() + v);
+    g._n_mods++;
 
     size_t N = g._edges.size();
     #pragma omp parallel for schedule(runtime) if (N > 100)
@@ -1224,6 +1586,7 @@ void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
         }
     }
     g._edges.pop_back();
+    g._n_mods++;
 }
 
 
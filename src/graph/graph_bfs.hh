@@ -0,0 +1,482 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BFS_HH
+#define GRAPH_BFS_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "graph.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Parallel unweighted breadth-first searches
+// ==========================================
+//
+// Both searches below are level-synchronous: all the vertices at distance d
+// from the source(s) are found in a single parallel step, from the vertices
+// at distance d - 1 (the frontier). Each step is performed in one of two
+// directions [beamer-direction-optimizing-2012]:
+//
+// - top-down, where the out-neighbors of the frontier vertices are claimed
+//   with atomic operations, which is cheap while the frontier is small;
+//
+// - bottom-up, where every vertex not yet visited scans its in-neighbors (or
+//   neighbors, if undirected) until it finds one in the frontier, which
+//   requires no atomics and avoids most edge checks once the frontier is a
+//   large fraction of the graph.
+//
+// A step is done bottom-up when the number of edges leaving the frontier
+// exceeds 1 / bfs_alpha of the edges still to be checked, and top-down again
+// when the frontier has fewer than 1 / bfs_beta of the vertices.
+//
+// [beamer-direction-optimizing-2012] S. Beamer, K. Asanović, D. Patterson,
+//    "Direction-optimizing breadth-first search", SC '12, 2012,
+//    DOI: 10.1109/SC.2012.50
+
+inline const openmp_kernel bfs_kernel("bfs", 1);
+
+constexpr size_t bfs_alpha = 14;
+constexpr size_t bfs_beta = 24;
+
+// Single-source search: discover(v, u, d) is called exactly once for every
+// vertex v at distance 0 < d <= max_dist from s, with u the vertex in the
+// frontier from which it was reached. It can be called concurrently for
+// different vertices. The search ends when no new vertices are found, or when
+// stop() returns true, which is checked between levels.
+
+template <class Graph, class Discover, class Stop>
+void parallel_bfs(const Graph& g, size_t s, size_t max_dist,
+                  Discover&& discover, Stop&& stop)
+{
+    constexpr uint64_t one = 1;
+    size_t N = num_vertices(g);
+    size_t W = (N + 63) / 64;
+
+    std::vector<uint64_t> visited(W), front, next;
+    std::vector<size_t> frontier = {s}, nfrontier;
+
+    // the filtered-out vertices are never visited; m_u counts the edges of
+    // the vertices not yet expanded
+    size_t m_u = 0;
+    #pragma omp parallel for schedule(runtime) \
+        if (is_parallel_worth(N)) reduction(+:m_u)
+    for (size_t w = 0; w < W; ++w)
+    {
+        size_t end = std::min((w + 1) * 64, N);
+        for (size_t i = w * 64; i < end; ++i)
+        {
+            auto v = vertex(i, g);
+            if (is_valid_vertex(v, g))
+                m_u += out_degree(v, g);
+            else
+                visited[w] |= one << (i % 64);
+        }
+    }
+
+    visited[s / 64] |= one << (s % 64);
+    size_t n_f = 1;
+    size_t m_f = out_degree(vertex(s, g), g);
+    bool bottom_up = false;
+
+    for (size_t d = 1; d <= max_dist && n_f > 0; ++d)
+    {
+        if (stop())
+            break;
+
+        m_u -= std::min(m_f, m_u);
+
+        if (!bottom_up && m_f > m_u / bfs_alpha)
+        {
+            front.assign(W, 0);
+            next.resize(W);
+            #pragma omp parallel for schedule(runtime) \
+                if (is_parallel_worth(frontier.size()))
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                auto u = frontier[i];
+                #pragma omp atomic
+                front[u / 64] |= one << (u % 64);
+            }
+            bottom_up = true;
+        }
+        else if (bottom_up && n_f < N / bfs_beta)
+        {
+            frontier.clear();
+            #pragma omp parallel if (is_parallel_worth(W))
+            {
+                std::vector<size_t> lfrontier;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t w = 0; w < W; ++w)
+                {
+                    for (uint64_t x = front[w]; x != 0; x &= x - 1)
+                        lfrontier.push_back(w * 64 + __builtin_ctzll(x));
+                }
+                #pragma omp critical (parallel_bfs)
+                frontier.insert(frontier.end(), lfrontier.begin(),
+                                lfrontier.end());
+            }
+            bottom_up = false;
+        }
+
+        size_t n_next = 0;
+        size_t m_next = 0;
+        if (!bottom_up)
+        {
+            nfrontier.clear();
+            #pragma omp parallel if (is_parallel_worth((frontier.size() + m_f) * \
+                                                       bfs_kernel.get_cost())) \
+                reduction(+:n_next, m_next)
+            {
+                std::vector<size_t> lfrontier;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    auto u = vertex(frontier[i], g);
+                    for (auto v : out_neighbors_range(u, g))
+                    {
+                        size_t j = v;
+                        uint64_t b = one << (j % 64);
+                        uint64_t old;
+                        #pragma omp atomic read
+                        old = visited[j / 64];
+                        if (old & b)
+                            continue;
+                        #pragma omp atomic capture
+                        {
+                            old = visited[j / 64];
+                            visited[j / 64] |= b;
+                        }
+                        if (old & b)
+                            continue;
+                        discover(v, u, d);
+                        lfrontier.push_back(j);
+                        m_next += out_degree(v, g);
+                    }
+                }
+                n_next += lfrontier.size();
+                #pragma omp critical (parallel_bfs)
+                nfrontier.insert(nfrontier.end(), lfrontier.begin(),
+                                 lfrontier.end());
+            }
+            swap(frontier, nfrontier);
+        }
+        else
+        {
+            #pragma omp parallel for schedule(runtime) \
+                if (is_parallel_worth((N + m_u) * bfs_kernel.get_cost())) \
+                reduction(+:n_next, m_next)
+            for (size_t w = 0; w < W; ++w)
+            {
+                uint64_t found = 0;
+                for (uint64_t x = ~visited[w]; x != 0; x &= x - 1)
+                {
+                    size_t b = __builtin_ctzll(x);
+                    size_t i = w * 64 + b;
+                    if (i >= N)
+                        break;
+                    auto v = vertex(i, g);
+                    for (auto u : in_or_out_neighbors_range(v, g))
+                    {
+                        size_t j = u;
+                        if ((front[j / 64] & (one << (j % 64))) == 0)
+                            continue;
+                        discover(v, u, d);
+                        found |= one << b;
+                        ++n_next;
+                        m_next += out_degree(v, g);
+                        break;
+                    }
+                }
+                visited[w] |= found;
+                next[w] = found;
+            }
+            swap(front, next);
+        }
+
+        n_f = n_next;
+        m_f = m_next;
+    }
+}
+
+template <class Graph, class Discover>
+void parallel_bfs(const Graph& g, size_t s, size_t max_dist,
+                  Discover&& discover)
+{
+    parallel_bfs(g, s, max_dist, std::forward<Discover>(discover),
+                 []() { return false; });
+}
+
+// Given the distances level(v) from s found by a parallel search (with
+// level(v) == d only for the vertices at distance d), this calls
+// discover(v, u) for every vertex v != s at distance 0 < d <= max_dist, in the
+// same order and with the same predecessor u as a sequential breadth-first
+// search: level by level, and within a level in the order of the first vertex
+// of the previous level with an edge to v, and then of that edge. The listing
+// stops if discover() returns false. Every level is ordered in parallel, but
+// discover() is called by a single thread.
+
+template <class Graph, class Level, class Discover>
+void bfs_discovery_order(const Graph& g, size_t s, size_t max_dist,
+                         Level&& level, Discover&& discover)
+{
+    constexpr size_t null = std::numeric_limits<size_t>::max();
+    constexpr size_t done = null - 1;
+    size_t N = num_vertices(g);
+
+    // position in the frontier of the first vertex with an edge to v
+    std::vector<size_t> first(N, null);
+    std::vector<size_t> frontier = {s};
+    std::vector<std::vector<std::pair<size_t, size_t>>> found;
+
+    for (size_t d = 1; d <= max_dist && !frontier.empty(); ++d)
+    {
+        size_t nthreads = 1;
+        #pragma omp parallel if (is_parallel_worth(frontier.size() * \
+                                                   bfs_kernel.get_cost()))
+        {
+            size_t tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+            #pragma omp single
+            nthreads = omp_get_num_threads();
+#endif
+            #pragma omp single
+            found.resize(nthreads);
+            auto& lfound = found[tid];
+            lfound.clear();
+
+            #pragma omp for schedule(static)
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                for (auto v : out_neighbors_range(vertex(frontier[i], g), g))
+                {
+                    if (level(v) != d)
+                        continue;
+                    size_t j = v;
+                    size_t old = first[j];
+                    while (i < old &&
+                           !__atomic_compare_exchange_n(&first[j], &old, i,
+                                                        false,
+                                                        __ATOMIC_RELAXED,
+                                                        __ATOMIC_RELAXED));
+                }
+            }
+
+            // with a static schedule, every thread gets a contiguous block
+            // of the frontier, in order
+            #pragma omp for schedule(static)
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                auto u = frontier[i];
+                for (auto v : out_neighbors_range(vertex(u, g), g))
+                {
+                    size_t j = v;
+                    if (first[j] != i)
+                        continue;
+                    first[j] = done;
+                    lfound.emplace_back(j, u);
+                }
+            }
+        }
+
+        frontier.clear();
+        for (size_t t = 0; t < nthreads; ++t)
+        {
+            for (auto& vu : found[t])
+            {
+                if (!discover(vertex(vu.first, g), vertex(vu.second, g)))
+                    return;
+                frontier.push_back(vu.first);
+            }
+        }
+    }
+}
+
+// Multi-source bit-parallel search [then-more-2014]: up to 64 searches are
+// performed together, from different sources, keeping for every vertex a
+// 64-bit word with the searches that have already reached it, and another
+// with the ones that reached it in the last level. Each edge is thus traversed
+// once per level for all the searches, instead of once per search. This is
+// most efficient for all-pairs computations on graphs with small diameter.
+//
+// visit(v, mask, d) is called once for every vertex v and distance d, with the
+// bits of mask set for the searches (i.e. the indices of the sources) that
+// reached v at distance d. It can be called concurrently for different
+// vertices.
+//
+// [then-more-2014] M. Then, M. Kaufmann, F. Chirigati, et al., "The More the
+//    Merrier: Efficient Multi-Source Graph Traversal", Proceedings of the
+//    VLDB Endowment 8 (4), 2014, DOI: 10.14778/2735496.2735507
+
+template <class Graph>
+class multi_source_bfs
+{
+public:
+    static constexpr size_t max_sources = 64;
+
+    multi_source_bfs(const Graph& g)
+        : _g(g), _N(num_vertices(g)), _seen(_N), _front(_N), _next(_N),
+          _m(0), _m_f(0), _nm_f(0)
+    {
+        size_t m = 0;
+        #pragma omp parallel if (is_parallel_worth(_N)) reduction(+:m)
+        parallel_vertex_loop_no_spawn
+            (g, [&](auto v) { m += out_degree(v, g); });
+        _m = m;
+    }
+
+    // Searches from sources[0], ..., sources[n-1], with n <= max_sources.
+    // This must be called by all the threads of the current team, or outside
+    // of a parallel region.
+    template <class Visit>
+    void run_no_spawn(const size_t* sources, size_t n, Visit&& visit)
+    {
+        constexpr uint64_t one = 1;
+        const auto& g = _g;
+        uint64_t full = (n < 64) ? (one << n) - 1 : ~uint64_t(0);
+
+        #pragma omp for schedule(runtime)
+        for (size_t v = 0; v < _N; ++v)
+            _seen[v] = _front[v] = _next[v] = 0;
+
+        #pragma omp single
+        {
+            _frontier.clear();
+            _m_f = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto s = sources[i];
+                if (_front[s] == 0)
+                {
+                    _frontier.push_back(s);
+                    _m_f += out_degree(vertex(s, g), g);
+                }
+                _seen[s] |= one << i;
+                _front[s] |= one << i;
+            }
+        }
+
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < _frontier.size(); ++i)
+            visit(vertex(_frontier[i], g), _front[_frontier[i]], 0);
+
+        for (size_t d = 1; !_frontier.empty(); ++d)
+        {
+            std::vector<size_t> lfrontier;
+            size_t m_f = 0;
+
+            if (_m_f < _m / bfs_alpha)
+            {
+                // top-down
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < _frontier.size(); ++i)
+                {
+                    auto u = vertex(_frontier[i], g);
+                    uint64_t mask = _front[u];
+                    for (auto v : out_neighbors_range(u, g))
+                    {
+                        uint64_t x = mask & ~_seen[v];
+                        if (x == 0)
+                            continue;
+                        uint64_t old;
+                        #pragma omp atomic capture
+                        {
+                            old = _next[v];
+                            _next[v] |= x;
+                        }
+                        if (old == 0)
+                            lfrontier.push_back(v);
+                    }
+                }
+            }
+            else
+            {
+                // bottom-up
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < _N; ++i)
+                {
+                    if (_seen[i] == full)
+                        continue;
+                    auto v = vertex(i, g);
+                    if (!is_valid_vertex(v, g))
+                        continue;
+                    uint64_t x = 0;
+                    for (auto u : in_or_out_neighbors_range(v, g))
+                        x |= _front[u];
+                    x &= ~_seen[i];
+                    if (x == 0)
+                        continue;
+                    _next[i] = x;
+                    lfrontier.push_back(i);
+                }
+            }
+
+            for (auto v : lfrontier)
+            {
+                _seen[v] |= _next[v];
+                m_f += out_degree(vertex(v, g), g);
+                visit(vertex(v, g), _next[v], d);
+            }
+
+            #pragma omp critical (multi_source_bfs)
+            {
+                _nfrontier.insert(_nfrontier.end(), lfrontier.begin(),
+                                  lfrontier.end());
+                _nm_f += m_f;
+            }
+
+            #pragma omp barrier
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < _frontier.size(); ++i)
+                _front[_frontier[i]] = 0;
+
+            #pragma omp single
+            {
+                swap(_front, _next);
+                swap(_frontier, _nfrontier);
+                _nfrontier.clear();
+                _m_f = _nm_f;
+                _nm_f = 0;
+            }
+        }
+    }
+
+    template <class Visit>
+    void run(const size_t* sources, size_t n, Visit&& visit)
+    {
+        #pragma omp parallel if (is_parallel_worth(_g, bfs_kernel))
+        run_no_spawn(sources, n, visit);
+    }
+
+private:
+    const Graph& _g;
+    size_t _N;
+    std::vector<uint64_t> _seen, _front, _next;
+    std::vector<size_t> _frontier, _nfrontier;
+    size_t _m, _m_f, _nm_f;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_BFS_HH
@@ -443,6 +443,7 @@ void copy_external_edge_property(const GraphInterface& src,
 void export_python_interface();
 
 void export_openmp();
+void export_stream_writer();
 
 BOOST_PYTHON_MODULE(libgraph_tool_core)
 {
@@ -476,6 +477,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
 
     def("graph_filtering_enabled", &graph_filtering_enabled);
     export_openmp();
+    export_stream_writer();
 
     boost::mpl::for_each<boost::mpl::push_back<scalar_types,string>::type>(export_vector_types());
     export_vector_types()(size_t(), "size_t");
@@ -506,14 +508,21 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("re_index_vertex_property",  &GraphInterface::re_index_vertex_property)
         .def("write_to_file", &GraphInterface::write_to_file)
         .def("read_from_file",&GraphInterface::read_from_file)
+        .def("read_property_from_file",
+             &GraphInterface::read_property_from_file)
         .def("degree_map", &GraphInterface::degree_map)
         .def("clear", &GraphInterface::clear)
         .def("clear_edges", &GraphInterface::clear_edges)
         .def("get_vertex_index", &GraphInterface::get_vertex_index)
         .def("get_edge_index", &GraphInterface::get_edge_index)
         .def("get_edge_index_range", &GraphInterface::get_edge_index_range)
+        .def("get_num_modifications", &GraphInterface::get_num_modifications)
+        .def("get_instance_id", &GraphInterface::get_instance_id)
         .def("re_index_edges", &GraphInterface::re_index_edges)
         .def("shrink_to_fit", &GraphInterface::shrink_to_fit)
+        .def("freeze", &GraphInterface::freeze)
+        .def("unfreeze", &GraphInterface::unfreeze)
+        .def("is_frozen", &GraphInterface::is_frozen)
         .def("get_graph_index", &GraphInterface::get_graph_index)
         .def("copy_vertex_property", &GraphInterface::copy_vertex_property)
         .def("copy_edge_property", &GraphInterface::copy_edge_property)
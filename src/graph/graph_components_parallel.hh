@@ -0,0 +1,514 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_COMPONENTS_PARALLEL_HH
+#define GRAPH_COMPONENTS_PARALLEL_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/strong_components.hpp>
+
+#include "graph.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Parallel connected components
+// =============================
+//
+// Both functions below fill a vector with a representative vertex for every
+// vertex of the graph, which is the same for all the vertices of the same
+// component. The vertices that are filtered out are their own
+// representatives.
+//
+// The weak components of undirected graphs are found with a union-find
+// structure, where the trees are joined by lock-free hooking of the larger
+// root to the smaller one, followed by path compression [sutton-afforest-2018].
+// Only the first few edges of every vertex are processed at first, after which
+// the largest component is identified by sampling, and the remaining edges of
+// its vertices are skipped, since the edges leaving it are also found from the
+// other end. The roots are always the smallest vertex of each component.
+//
+// The strong components of directed graphs are found by repeatedly removing
+// the vertices without in- or out-neighbors among the remaining ones, which
+// are components by themselves ("trimming"), by a forward-backward search from
+// a vertex of large degree, which finds the largest component, and by
+// coloring [slota-bfs-2014]: every vertex propagates the largest vertex index
+// that reaches it, until no color changes, after which the vertices of color
+// c that reach c backwards through vertices of the same color form its
+// component. All searches are level-synchronous and parallel. When coloring
+// stops paying off, the remaining vertices are handled by Tarjan's serial
+// algorithm (the "Multistep" method of [slota-bfs-2014]).
+//
+// [sutton-afforest-2018] M. Sutton, T. Ben-Nun, A. Barak, "Optimizing
+//    Parallel Graph Connectivity Computation via Subgraph Sampling",
+//    IPDPS 2018, DOI: 10.1109/IPDPS.2018.00012
+// [slota-bfs-2014] G. M. Slota, S. Rajamanickam, K. Madduri, "BFS and
+//    Coloring-Based Parallel Algorithms for Strongly Connected Components and
+//    Related Problems", IPDPS 2014, DOI: 10.1109/IPDPS.2014.64
+
+inline const openmp_kernel components_kernel("components", 1);
+
+namespace components_detail
+{
+
+template <class T>
+T load(const T& x)
+{
+    T y;
+    #pragma omp atomic read
+    y = x;
+    return y;
+}
+
+template <class T>
+void store(T& x, T y)
+{
+    #pragma omp atomic write
+    x = y;
+}
+
+// on failure, expected is updated with the current value
+template <class T>
+bool compare_exchange(T& x, T& expected, T desired)
+{
+    return __atomic_compare_exchange_n(&x, &expected, desired, false,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+// Removes from the list the vertices for which remove(v) is true.
+template <class Remove>
+void compact(std::vector<size_t>& vs, Remove&& remove)
+{
+    std::vector<size_t> nvs;
+    #pragma omp parallel if (is_parallel_worth(vs.size()))
+    {
+        std::vector<size_t> lvs;
+        #pragma omp for schedule(runtime) nowait
+        for (size_t i = 0; i < vs.size(); ++i)
+        {
+            if (!remove(vs[i]))
+                lvs.push_back(vs[i]);
+        }
+        #pragma omp critical (parallel_components)
+        nvs.insert(nvs.end(), lvs.begin(), lvs.end());
+    }
+    vs.swap(nvs);
+}
+
+// Level-synchronous search from the vertices in frontier, through the edges
+// (u, v) with v in neighbors(u) for which follow(u, v) is true. The vertices
+// reached, including the sources, are set in mark, and appended to reached.
+template <class Graph, class Neighbors, class Follow>
+void reach(const Graph& g, std::vector<size_t> frontier,
+           std::vector<uint8_t>& mark, Neighbors&& neighbors, Follow&& follow,
+           std::vector<size_t>& reached)
+{
+    for (auto v : frontier)
+        mark[v] = true;
+    reached.insert(reached.end(), frontier.begin(), frontier.end());
+
+    std::vector<size_t> next;
+    while (!frontier.empty())
+    {
+        next.clear();
+        #pragma omp parallel if (is_parallel_worth(frontier.size() * \
+                                                   components_kernel.get_cost()))
+        {
+            std::vector<size_t> lnext;
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                auto u = vertex(frontier[i], g);
+                for (auto v : neighbors(u))
+                {
+                    if (load(mark[v]) || !follow(u, v))
+                        continue;
+                    if (__atomic_exchange_n(&mark[v], uint8_t(true),
+                                            __ATOMIC_RELAXED))
+                        continue;
+                    lnext.push_back(v);
+                }
+            }
+            #pragma omp critical (parallel_components)
+            next.insert(next.end(), lnext.begin(), lnext.end());
+        }
+        reached.insert(reached.end(), next.begin(), next.end());
+        frontier.swap(next);
+    }
+}
+
+} // namespace components_detail
+
+template <class Graph>
+void parallel_connected_components(const Graph& g, std::vector<size_t>& comp)
+{
+    using namespace components_detail;
+
+    constexpr size_t neighbor_rounds = 2;
+    constexpr size_t n_samples = 1024;
+
+    size_t N = num_vertices(g);
+    comp.resize(N);
+
+    #pragma omp parallel for schedule(runtime) if (is_parallel_worth(N))
+    for (size_t v = 0; v < N; ++v)
+        comp[v] = v;
+
+    auto link = [&](size_t u, size_t v)
+        {
+            size_t p1 = load(comp[u]);
+            size_t p2 = load(comp[v]);
+            while (p1 != p2)
+            {
+                size_t high = std::max(p1, p2);
+                size_t low = std::min(p1, p2);
+                size_t p_high = load(comp[high]);
+                if (p_high == low ||
+                    (p_high == high && compare_exchange(comp[high], p_high, low)))
+                    break;
+                p1 = load(comp[load(comp[high])]);
+                p2 = load(comp[low]);
+            }
+        };
+
+    auto compress = [&]()
+        {
+            #pragma omp parallel for schedule(runtime) if (is_parallel_worth(N))
+            for (size_t v = 0; v < N; ++v)
+            {
+                while (true)
+                {
+                    size_t p = load(comp[v]);
+                    size_t pp = load(comp[p]);
+                    if (p == pp)
+                        break;
+                    store(comp[v], pp);
+                }
+            }
+        };
+
+    for (size_t r = 0; r < neighbor_rounds; ++r)
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t k = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                 {
+                     if (k++ < r)
+                         continue;
+                     link(v, u);
+                     break;
+                 }
+             }, components_kernel);
+        compress();
+    }
+
+    // most frequent root among evenly spread vertices
+    std::unordered_map<size_t, size_t> count;
+    size_t c = N;
+    size_t c_max = 0;
+    for (size_t i = 0; N > 0 && i < n_samples; ++i)
+    {
+        size_t v = (i * 2654435761ul) % N;
+        if (!is_valid_vertex(vertex(v, g), g))
+            continue;
+        auto& n = count[comp[v]];
+        if (++n > c_max)
+        {
+            c_max = n;
+            c = comp[v];
+        }
+    }
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             if (load(comp[v]) == c)
+                 return;
+             size_t k = 0;
+             for (auto u : out_neighbors_range(v, g))
+             {
+                 if (k++ < neighbor_rounds)
+                     continue;
+                 link(v, u);
+             }
+         }, components_kernel);
+    compress();
+}
+
+template <class Graph>
+void parallel_strong_components(const Graph& g, std::vector<size_t>& comp)
+{
+    using namespace components_detail;
+
+    constexpr size_t unset = std::numeric_limits<size_t>::max();
+
+    size_t N = num_vertices(g);
+    comp.assign(N, unset);
+
+    std::vector<size_t> active;
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (is_valid_vertex(vertex(v, g), g))
+            active.push_back(v);
+        else
+            comp[v] = v;
+    }
+
+    auto is_set = [&](auto v) { return load(comp[v]) != unset; };
+    auto out = [&](auto u) { return out_neighbors_range(u, g); };
+    auto in = [&](auto u) { return in_or_out_neighbors_range(u, g); };
+
+    auto trim = [&]()
+        {
+            while (!active.empty())
+            {
+                size_t n = 0;
+                #pragma omp parallel for schedule(runtime) \
+                    if (is_parallel_worth(active.size() * \
+                                          components_kernel.get_cost())) \
+                    reduction(+:n)
+                for (size_t i = 0; i < active.size(); ++i)
+                {
+                    auto v = vertex(active[i], g);
+                    auto has_active = [&](auto&& range)
+                        {
+                            for (auto u : range)
+                            {
+                                if (u != v && !is_set(u))
+                                    return true;
+                            }
+                            return false;
+                        };
+                    if (has_active(out(v)) && has_active(in(v)))
+                        continue;
+                    store(comp[v], size_t(v));
+                    ++n;
+                }
+                compact(active, is_set);
+
+                // further passes are left to the other steps if they remove
+                // too few vertices, as happens for long chains
+                if (n * 100 < active.size() + n)
+                    break;
+            }
+        };
+
+    std::vector<uint8_t> fmark(N), bmark(N);
+    std::vector<size_t> freached, breached;
+
+    trim();
+
+    if (!active.empty())
+    {
+        size_t pivot = active[0];
+        size_t d_max = 0;
+        for (auto v : active)
+        {
+            size_t d = (out_degree(vertex(v, g), g) + 1) *
+                (in_degreeS()(vertex(v, g), g) + 1);
+            if (d > d_max)
+            {
+                d_max = d;
+                pivot = v;
+            }
+        }
+
+        reach(g, {pivot}, fmark, out,
+              [&](auto, auto v) { return !is_set(v); }, freached);
+        reach(g, {pivot}, bmark, in,
+              [&](auto, auto v) { return fmark[v] && !is_set(v); }, breached);
+
+        for (auto v : breached)
+        {
+            comp[v] = pivot;
+            bmark[v] = false;
+        }
+        for (auto v : freached)
+            fmark[v] = false;
+        freached.clear();
+        breached.clear();
+
+        compact(active, is_set);
+        trim();
+    }
+
+    // the remaining vertices are given to Tarjan's algorithm, through
+    // boost::strong_components() on the subgraph they induce
+    auto finish = [&]()
+        {
+            std::vector<size_t> idx(N);
+            for (size_t i = 0; i < active.size(); ++i)
+                idx[active[i]] = i;
+            boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS>
+                sg(active.size());
+            for (size_t i = 0; i < active.size(); ++i)
+            {
+                for (auto u : out_neighbors_range(vertex(active[i], g), g))
+                {
+                    if (!is_set(u))
+                        add_edge(i, idx[u], sg);
+                }
+            }
+            std::vector<size_t> sg_comp(active.size());
+            size_t n_comp =
+                boost::strong_components(sg, make_iterator_property_map
+                                             (sg_comp.begin(),
+                                              get(boost::vertex_index, sg)));
+            std::vector<size_t> rep(n_comp, unset);
+            for (size_t i = 0; i < active.size(); ++i)
+            {
+                auto& r = rep[sg_comp[i]];
+                if (r == unset)
+                    r = active[i];
+                comp[active[i]] = r;
+            }
+            active.clear();
+        };
+
+    // Coloring needs as many sweeps as the longest path through increasing
+    // colors, and may settle only a few components per round, as happens
+    // for a chain of components. Like [slota-bfs-2014], we switch to the
+    // serial search once a round settles less than 1% of the remaining
+    // vertices, once these are too few for a parallel region, or once the
+    // sweeps have visited more vertices and edges than all threads could
+    // have visited in one serial search each, which bounds the total work by
+    // O(T (V + E)) for T threads.
+    size_t budget = 0;
+    #pragma omp parallel for schedule(runtime) reduction(+:budget) \
+        if (is_parallel_worth(active.size()))
+    for (size_t i = 0; i < active.size(); ++i)
+        budget += out_degree(vertex(active[i], g), g) + 1;
+#ifdef _OPENMP
+    budget *= omp_get_max_threads();
+#endif
+    std::vector<size_t> color(N);
+    std::vector<size_t> roots;
+    while (!active.empty())
+    {
+        bool parallel = is_parallel_worth(active.size() *
+                                          components_kernel.get_cost());
+        if (!parallel)
+        {
+            finish();
+            break;
+        }
+
+        #pragma omp parallel for schedule(runtime)
+        for (size_t i = 0; i < active.size(); ++i)
+            color[active[i]] = active[i];
+
+        bool changed = true;
+        while (changed && budget > 0)
+        {
+            changed = false;
+            size_t work = 0;
+            #pragma omp parallel for schedule(runtime) \
+                reduction(||:changed) reduction(+:work)
+            for (size_t i = 0; i < active.size(); ++i)
+            {
+                auto v = vertex(active[i], g);
+                work += out_degree(v, g) + 1;
+                size_t c = load(color[v]);
+                for (auto u : out_neighbors_range(v, g))
+                {
+                    if (is_set(u))
+                        continue;
+                    size_t c_u = load(color[u]);
+                    while (c_u < c)
+                    {
+                        if (compare_exchange(color[u], c_u, c))
+                        {
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            budget -= std::min(work, budget);
+        }
+
+        if (changed)
+        {
+            finish();
+            break;
+        }
+
+        roots.clear();
+        for (auto v : active)
+        {
+            if (color[v] == v)
+                roots.push_back(v);
+        }
+
+        reach(g, roots, bmark, in,
+              [&](auto u, auto v)
+              { return !is_set(v) && color[v] == color[u]; }, breached);
+
+        #pragma omp parallel for schedule(runtime) \
+            if (is_parallel_worth(breached.size()))
+        for (size_t i = 0; i < breached.size(); ++i)
+        {
+            size_t v = breached[i];
+            comp[v] = color[v];
+            bmark[v] = false;
+        }
+        size_t n = breached.size();
+        breached.clear();
+
+        compact(active, is_set);
+        if (n * 100 < active.size() + n)
+        {
+            finish();
+            break;
+        }
+        trim();
+    }
+}
+
+// Puts in comp_map the label of the component of every vertex, given the
+// representatives, numbered from zero in the order of the smallest vertex of
+// each component.
+template <class Graph, class CompMap>
+void put_component_labels(const Graph& g, const std::vector<size_t>& comp,
+                          CompMap comp_map)
+{
+    constexpr size_t unset = std::numeric_limits<size_t>::max();
+    std::vector<size_t> label(comp.size(), unset);
+    size_t c = 0;
+    for (auto v : vertices_range(g))
+    {
+        auto& l = label[comp[v]];
+        if (l == unset)
+            l = c++;
+        put(comp_map, v, l);
+    }
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_COMPONENTS_PARALLEL_HH
@@ -132,6 +132,34 @@ boost::any GraphInterface::get_graph_view() const
     return graph;
 }
 
+// this will return the proper view of the frozen graph, encapsulated
+template <class Graph>
+boost::any
+check_frozen(const Graph& g, GraphInterface& gi, bool reverse, bool directed)
+{
+    if (!directed)
+    {
+        undirected_adaptor<Graph> ug(g);
+        return std::ref(*retrieve_graph_view(gi, ug));
+    }
+    if (reverse)
+    {
+        reversed_graph<Graph> rg(g);
+        return std::ref(*retrieve_graph_view(gi, rg));
+    }
+    return std::ref(const_cast<Graph&>(g));
+}
+
+// gets the frozen graph view at run time, or the regular one if the graph is
+// not frozen, or is filtered
+boost::any GraphInterface::get_frozen_graph_view() const
+{
+    if (!is_frozen() || _edge_filter_active || _vertex_filter_active)
+        return get_graph_view();
+    return check_frozen(*_frozen, const_cast<GraphInterface&>(*this),
+                        _reversed, _directed);
+}
+
 // these test whether or not the vertex and edge filters are active
 bool GraphInterface::is_vertex_filter_active() const
 { return _vertex_filter_active; }
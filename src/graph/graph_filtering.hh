@@ -42,6 +42,8 @@
 #include <boost/mpl/quote.hpp>
 #include <boost/mpl/range_c.hpp>
 #include <boost/mpl/print.hpp>
+#include <boost/mpl/contains.hpp>
+#include <boost/mpl/copy.hpp>
 
 #include "graph_adaptor.hh"
 #include "graph_filtered.hh"
@@ -72,6 +74,12 @@ namespace graph_tool
 //
 // The total number of graph views is then: 1 + 1 + 2 + 2 = 6
 //
+// Additionally, if the graph has been frozen (see GraphInterface::freeze()),
+// algorithms may opt to run on the unfiltered views of the read-only snapshot
+// instead, i.e. the frozen graph itself, and its reversed and undirected
+// versions. This is done by dispatching with all_graph_views_frozen below,
+// instead of all_graph_views.
+//
 // The specific specialization can be called at run time (and generated at
 // compile time) with the run_action() function, which takes as arguments the
 // GraphInterface worked on, and the template functor to be specialized, which
@@ -271,12 +279,13 @@ struct get_all_graph_views
               class NeverDirected = boost::mpl::bool_<false>,
               class AlwaysReversed = boost::mpl::bool_<false>,
               class NeverReversed = boost::mpl::bool_<false>,
-              class NeverFiltered = boost::mpl::bool_<false> >
+              class NeverFiltered = boost::mpl::bool_<false>,
+              class BaseGraph = GraphInterface::multigraph_t>
     struct apply
     {
 
         struct base_graphs:
-            boost::mpl::vector1<GraphInterface::multigraph_t> {};
+            boost::mpl::vector1<BaseGraph> {};
 
         // reversed graphs
         struct reversed_graphs:
@@ -365,9 +374,23 @@ struct never_filtered_never_reversed:
                                boost::mpl::bool_<false>,boost::mpl::bool_<false>,
                                boost::mpl::bool_<true>,boost::mpl::bool_<true> >::type {};
 
+// views of the frozen snapshot, which are never filtered
+struct frozen_graph_views:
+    get_all_graph_views::apply<filt_scalar_type,boost::mpl::bool_<false>,
+                               boost::mpl::bool_<false>,boost::mpl::bool_<false>,
+                               boost::mpl::bool_<false>,boost::mpl::bool_<true>,
+                               GraphInterface::frozen_graph_t>::type {};
+
+// all graph views, followed by the frozen ones
+struct all_graph_views_frozen:
+    boost::mpl::copy<frozen_graph_views,
+                     boost::mpl::back_inserter<all_graph_views>>::type {};
+
 // sanity check
 typedef boost::mpl::size<all_graph_views>::type n_views;
 BOOST_MPL_ASSERT_RELATION(n_views::value, == , boost::mpl::int_<6>::value);
+typedef boost::mpl::size<all_graph_views_frozen>::type n_views_frozen;
+BOOST_MPL_ASSERT_RELATION(n_views_frozen::value, == , boost::mpl::int_<9>::value);
 
 // run_action() and gt_dispatch() implementation
 // =============================================
@@ -408,8 +431,8 @@ struct action_wrap
     auto& deference(Type* a) const
     {
         typedef typename std::remove_const<Type>::type type_t;
-        typedef typename boost::mpl::find<detail::all_graph_views, type_t>::type iter_t;
-        typedef typename boost::mpl::end<detail::all_graph_views>::type end_t;
+        typedef typename boost::mpl::find<detail::all_graph_views_frozen, type_t>::type iter_t;
+        typedef typename boost::mpl::end<detail::all_graph_views_frozen>::type end_t;
         return deference_dispatch(a, typename std::is_same<iter_t, end_t>::type());
     }
 
@@ -472,8 +495,15 @@ struct run_action
     template <class Action, class... TRS>
     auto operator()(GraphInterface& gi, Action a, TRS...)
     {
+        typedef typename boost::mpl::contains<GraphViews,
+                                              GraphInterface::frozen_graph_t>::type
+            use_frozen;
         auto dispatch = detail::action_dispatch<Action,Wrap,GraphViews,TRS...>(a);
-        auto wrap = [dispatch, &gi](auto&&... args) { dispatch(gi.get_graph_view(), args...); };
+        auto wrap = [dispatch, &gi](auto&&... args)
+            {
+                dispatch(use_frozen::value ? gi.get_frozen_graph_view() :
+                         gi.get_graph_view(), args...);
+            };
         return wrap;
     }
 };
@@ -489,6 +519,7 @@ struct gt_dispatch
 };
 
 typedef detail::all_graph_views all_graph_views;
+typedef detail::all_graph_views_frozen all_graph_views_frozen;
 typedef detail::always_directed always_directed;
 typedef detail::never_directed never_directed;
 typedef detail::always_reversed always_reversed;
@@ -520,7 +551,7 @@ typename std::shared_ptr<Graph>
 retrieve_graph_view(GraphInterface& gi, Graph& init)
 {
     typedef typename std::remove_const<Graph>::type g_t;
-    size_t index = boost::mpl::find<detail::all_graph_views,g_t>::type::pos::value;
+    size_t index = boost::mpl::find<detail::all_graph_views_frozen,g_t>::type::pos::value;
     auto& graph_views = gi.get_graph_views();
     if (index >= graph_views.size())
         graph_views.resize(index + 1);
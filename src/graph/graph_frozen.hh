@@ -0,0 +1,498 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_FROZEN_HH
+#define GRAPH_FROZEN_HH
+
+#include "graph_adjacency.hh"
+
+namespace boost
+{
+
+// ========================================================================
+// frozen_adj_list<Vertex>
+// ========================================================================
+//
+// frozen_adj_list is an immutable snapshot of an adj_list, stored in
+// compressed sparse row form: the out- and in-lists of all vertices are kept
+// in a single contiguous array, in vertex order, and are delimited by an array
+// of offsets. The entries of each list, and their order, are exactly the same
+// as in the original adj_list, so that algorithms yield identical results on
+// both. The edge descriptors, iterators and index maps are shared with
+// adj_list<Vertex>, and hence so are all edge and vertex property maps.
+//
+// The snapshot is not updated when the original graph is modified (which can be
+// detected with matches()), and it provides no manipulation functions.
+
+template <class Vertex = size_t>
+class frozen_adj_list
+{
+public:
+    struct graph_tag {};
+    typedef Vertex vertex_t;
+    typedef typename adj_list<Vertex>::index_t index_t;
+    typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
+    typedef typename adj_list<Vertex>::edge_list_t edge_list_t;
+
+    typedef typename adj_list<Vertex>::vertex_iterator vertex_iterator;
+    typedef typename adj_list<Vertex>::adjacency_iterator adjacency_iterator;
+    typedef typename adj_list<Vertex>::in_adjacency_iterator
+        in_adjacency_iterator;
+    typedef typename adj_list<Vertex>::out_edge_iterator out_edge_iterator;
+    typedef typename adj_list<Vertex>::in_edge_iterator in_edge_iterator;
+    typedef typename adj_list<Vertex>::all_edge_iterator all_edge_iterator;
+    typedef typename adj_list<Vertex>::all_edge_iterator_reversed
+        all_edge_iterator_reversed;
+
+    frozen_adj_list(): _n_edges(0), _edge_index_range(0), _n_mods(0),
+                       _id(0), _offsets(1, 0) {}
+
+    explicit frozen_adj_list(const adj_list<Vertex>& g)
+        : _n_edges(num_edges(g)),
+          _edge_index_range(g.get_edge_index_range()),
+          _n_mods(g.get_num_modifications()),
+          _id(g.get_instance_id())
+    {
+        size_t N = num_vertices(g);
+        _offsets.resize(N + 1);
+        _pos.resize(N);
+        _offsets[0] = 0;
+        for (size_t v = 0; v < N; ++v)
+            _offsets[v + 1] = _offsets[v] + degree(Vertex(v), g);
+        _edges.resize(_offsets[N]);
+
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            size_t i = _offsets[v];
+            typename adj_list<Vertex>::out_edge_iterator e, e_end;
+            for (std::tie(e, e_end) = out_edges(Vertex(v), g); e != e_end; ++e)
+                _edges[i++] = {e->t, e->idx};
+            _pos[v] = i;
+            typename adj_list<Vertex>::in_edge_iterator ie, ie_end;
+            for (std::tie(ie, ie_end) = in_edges(Vertex(v), g); ie != ie_end;
+                 ++ie)
+                _edges[i++] = {ie->s, ie->idx};
+        }
+    }
+
+    class edge_iterator:
+        public boost::iterator_facade<edge_iterator,
+                                      edge_descriptor,
+                                      boost::forward_traversal_tag,
+                                      edge_descriptor>
+    {
+    public:
+        edge_iterator() : _g(nullptr), _v(0), _i(0) {}
+        explicit edge_iterator(const frozen_adj_list& g, size_t v, size_t i)
+            : _g(&g), _v(v), _i(i)
+        {
+            // move position to first edge
+            skip();
+        }
+
+    private:
+        friend class boost::iterator_core_access;
+
+        void skip()
+        {
+            //skip vertices without remaining out-edges
+            size_t N = _g->_pos.size();
+            while (_v < N && _i == _g->_pos[_v])
+            {
+                ++_v;
+                if (_v < N)
+                    _i = _g->_offsets[_v];
+            }
+        }
+
+        void increment()
+        {
+            ++_i;
+            skip();
+        }
+
+        bool equal(edge_iterator const& other) const
+        {
+            if (_v != other._v)
+                return false;
+            return _g == nullptr || _v == _g->_pos.size() || _i == other._i;
+        }
+
+        edge_descriptor dereference() const
+        {
+            const auto& e = _g->_edges[_i];
+            return edge_descriptor(_v, e.first, e.second);
+        }
+
+        const frozen_adj_list* _g;
+        size_t _v;
+        size_t _i;
+    };
+
+    size_t get_edge_index_range() const { return _edge_index_range; }
+
+    static Vertex null_vertex() { return adj_list<Vertex>::null_vertex(); }
+
+    __attribute__((always_inline))
+    void reverse_edge(edge_descriptor& e) const
+    {
+        auto begin = _edges.begin() + _offsets[e.s];
+        auto end = _edges.begin() + _pos[e.s];
+        auto iter = std::find_if(begin, end,
+                                 [&](const auto& oe) -> bool
+                                 {return oe.second == e.idx;});
+        if (iter == end)
+            std::swap(e.s, e.t);
+    }
+
+    // returns true if g was not modified since the snapshot was taken
+    bool matches(const adj_list<Vertex>& g) const
+    {
+        return (_id == g.get_instance_id() &&
+                _n_mods == g.get_num_modifications());
+    }
+
+    typename edge_list_t::const_iterator out_begin(Vertex v) const
+    { return _edges.begin() + _offsets[v]; }
+    typename edge_list_t::const_iterator out_end(Vertex v) const
+    { return _edges.begin() + _pos[v]; }
+    typename edge_list_t::const_iterator in_begin(Vertex v) const
+    { return out_end(v); }
+    typename edge_list_t::const_iterator in_end(Vertex v) const
+    { return _edges.begin() + _offsets[v + 1]; }
+
+private:
+    size_t _n_edges;
+    size_t _edge_index_range;
+    size_t _n_mods;
+    size_t _id;                   // instance id of the original graph
+    edge_list_t _edges;           // out- and in-lists of all vertices
+    std::vector<size_t> _offsets; // beginning of the out-list of each vertex
+    std::vector<size_t> _pos;     // beginning of the in-list of each vertex
+
+    template <class V>
+    friend size_t num_vertices(const frozen_adj_list<V>& g);
+
+    template <class V>
+    friend size_t num_edges(const frozen_adj_list<V>& g);
+};
+
+//========================================================================
+// Graph traits and BGL scaffolding
+//========================================================================
+
+template <class Vertex>
+struct graph_traits<frozen_adj_list<Vertex>>
+{
+    typedef Vertex vertex_descriptor;
+    typedef typename frozen_adj_list<Vertex>::edge_descriptor edge_descriptor;
+    typedef typename frozen_adj_list<Vertex>::edge_iterator edge_iterator;
+    typedef typename frozen_adj_list<Vertex>::adjacency_iterator
+        adjacency_iterator;
+    typedef typename frozen_adj_list<Vertex>::in_adjacency_iterator
+        in_adjacency_iterator;
+
+    typedef typename frozen_adj_list<Vertex>::out_edge_iterator
+        out_edge_iterator;
+    typedef typename frozen_adj_list<Vertex>::in_edge_iterator
+        in_edge_iterator;
+
+    typedef typename frozen_adj_list<Vertex>::vertex_iterator vertex_iterator;
+
+    typedef bidirectional_tag directed_category;
+    typedef allow_parallel_edge_tag edge_parallel_category;
+    typedef adj_list_traversal_tag traversal_category;
+
+    typedef Vertex vertices_size_type;
+    typedef Vertex edges_size_type;
+    typedef size_t degree_size_type;
+
+    static Vertex null_vertex() { return frozen_adj_list<Vertex>::null_vertex(); }
+};
+
+template <class Vertex>
+struct graph_traits<const frozen_adj_list<Vertex>>
+    : public graph_traits<frozen_adj_list<Vertex>>
+{
+};
+
+template <class Vertex>
+struct edge_property_type<frozen_adj_list<Vertex>>
+{
+    typedef void type;
+};
+
+template <class Vertex>
+struct vertex_property_type<frozen_adj_list<Vertex>>
+{
+    typedef void type;
+};
+
+template <class Vertex>
+struct graph_property_type<frozen_adj_list<Vertex>>
+{
+    typedef void type;
+};
+
+//========================================================================
+// Graph access functions
+//========================================================================
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t num_vertices(const frozen_adj_list<Vertex>& g)
+{
+    return g._pos.size();
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t num_edges(const frozen_adj_list<Vertex>& g)
+{
+    return g._n_edges;
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::vertex_iterator,
+          typename frozen_adj_list<Vertex>::vertex_iterator>
+vertices(const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::vertex_iterator vi_t;
+    return {vi_t(0), vi_t(num_vertices(g))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::edge_iterator,
+          typename frozen_adj_list<Vertex>::edge_iterator>
+edges(const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::edge_iterator ei_t;
+    size_t N = num_vertices(g);
+    return {ei_t(g, 0, 0), ei_t(g, N, 0)};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+Vertex vertex(size_t i, const frozen_adj_list<Vertex>&)
+{
+    return i;
+}
+
+template <class Vertex>
+inline
+std::pair<typename frozen_adj_list<Vertex>::edge_descriptor, bool>
+edge(Vertex s, Vertex t, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::edge_descriptor edge_descriptor;
+    auto end = g.out_end(s);
+    auto iter = std::find_if(g.out_begin(s), end,
+                             [&](const auto& e) -> bool {return e.first == t;});
+    if (iter != end)
+        return {edge_descriptor(s, t, iter->second), true};
+    return {edge_descriptor(), false};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t out_degree(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    return g.out_end(v) - g.out_begin(v);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t in_degree(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    return g.in_end(v) - g.in_begin(v);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t degree(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    return g.in_end(v) - g.out_begin(v);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::out_edge_iterator,
+          typename frozen_adj_list<Vertex>::out_edge_iterator>
+out_edges(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::out_edge_iterator ei_t;
+    return {ei_t(v, g.out_begin(v)), ei_t(v, g.out_end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::in_edge_iterator,
+          typename frozen_adj_list<Vertex>::in_edge_iterator>
+in_edges(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::in_edge_iterator ei_t;
+    return {ei_t(v, g.in_begin(v)), ei_t(v, g.in_end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::out_edge_iterator,
+          typename frozen_adj_list<Vertex>::out_edge_iterator>
+_all_edges_out(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::out_edge_iterator ei_t;
+    return {ei_t(v, g.out_begin(v)), ei_t(v, g.in_end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::in_edge_iterator,
+          typename frozen_adj_list<Vertex>::in_edge_iterator>
+_all_edges_in(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::in_edge_iterator ei_t;
+    return {ei_t(v, g.out_begin(v)), ei_t(v, g.in_end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::all_edge_iterator,
+          typename frozen_adj_list<Vertex>::all_edge_iterator>
+all_edges(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::all_edge_iterator ei_t;
+    auto pos = g.out_end(v);
+    return {ei_t(v, g.out_begin(v), pos), ei_t(v, g.in_end(v), pos)};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::all_edge_iterator_reversed,
+          typename frozen_adj_list<Vertex>::all_edge_iterator_reversed>
+_all_edges_reversed(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::all_edge_iterator_reversed ei_t;
+    auto pos = g.out_end(v);
+    return {ei_t(v, g.out_begin(v), pos), ei_t(v, g.in_end(v), pos)};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::adjacency_iterator,
+          typename frozen_adj_list<Vertex>::adjacency_iterator>
+out_neighbors(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::adjacency_iterator ai_t;
+    return {ai_t(g.out_begin(v)), ai_t(g.out_end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::adjacency_iterator,
+          typename frozen_adj_list<Vertex>::adjacency_iterator>
+in_neighbors(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::adjacency_iterator ai_t;
+    return {ai_t(g.in_begin(v)), ai_t(g.in_end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::adjacency_iterator,
+          typename frozen_adj_list<Vertex>::adjacency_iterator>
+all_neighbors(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    typedef typename frozen_adj_list<Vertex>::adjacency_iterator ai_t;
+    return {ai_t(g.out_begin(v)), ai_t(g.in_end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename frozen_adj_list<Vertex>::adjacency_iterator,
+          typename frozen_adj_list<Vertex>::adjacency_iterator>
+adjacent_vertices(Vertex v, const frozen_adj_list<Vertex>& g)
+{
+    return out_neighbors(v, g);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+Vertex source(const typename frozen_adj_list<Vertex>::edge_descriptor& e,
+              const frozen_adj_list<Vertex>&)
+{
+    return e.s;
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+Vertex target(const typename frozen_adj_list<Vertex>::edge_descriptor& e,
+              const frozen_adj_list<Vertex>&)
+{
+    return e.t;
+}
+
+//========================================================================
+// Vertex and edge index property maps
+//========================================================================
+
+template <class Vertex>
+struct property_map<frozen_adj_list<Vertex>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+struct property_map<const frozen_adj_list<Vertex>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+inline identity_property_map
+get(vertex_index_t, frozen_adj_list<Vertex>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex>
+inline identity_property_map
+get(vertex_index_t, const frozen_adj_list<Vertex>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex>
+struct property_map<frozen_adj_list<Vertex>, edge_index_t>
+{
+    typedef adj_edge_index_property_map<Vertex> type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+inline adj_edge_index_property_map<Vertex>
+get(edge_index_t, const frozen_adj_list<Vertex>&)
+{
+    return adj_edge_index_property_map<Vertex>();
+}
+
+} // namespace boost
+
+#endif //GRAPH_FROZEN_HH
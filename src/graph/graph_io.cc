@@ -16,14 +16,20 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include <boost/python/extract.hpp>
+#include <boost/python/stl_iterator.hpp>
 
 #include <iostream>
+#include <sstream>
+#include <sys/stat.h>
 #include <boost/iostreams/categories.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
 #include <boost/graph/graphml.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/xpressive/xpressive.hpp>
@@ -34,6 +40,7 @@
 #include "graph_util.hh"
 
 #include "graph_python_interface.hh"
+#include "numpy_bind.hh"
 #include "str_repr.hh"
 
 #include "gml.hh"
@@ -92,6 +99,8 @@ std::ostringstream& operator<<(std::ostringstream& stream, const boost::python::
 #include <boost/graph/graphviz.hpp>
 
 #include "graph_io_binary.hh"
+#include "graph_io_gzip.hh"
+#include "graph_io_parallel.hh"
 
 // the following source & sink provide iostream access to python file-like
 // objects
@@ -308,13 +317,66 @@ void build_stream(boost::iostreams::filtering_stream<boost::iostreams::input>& s
     stream.exceptions(ios_base::badbit);
 }
 
+// maps a regular file into memory; if the file is something else (e.g. a pipe
+// or a terminal), or the mapping fails, false is returned, and the file should
+// be read from the stream instead
+bool map_file(boost::iostreams::mapped_file_source& mfile, const string& file)
+{
+    struct stat st;
+    if (stat(file.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    try
+    {
+        mfile.open(file);
+    }
+    catch (std::exception&)
+    {
+        return false;
+    }
+    return mfile.is_open();
+}
+
+// brings a regular file into memory: uncompressed files are mapped, and gzip
+// files are decompressed, in parallel if they are in blocked gzip format; if
+// the file cannot be mapped, false is returned, and it should be read from the
+// stream instead
+bool read_file_buffer(boost::iostreams::mapped_file_source& mfile,
+                      std::string& buf, const char*& data, size_t& size,
+                      const string& file,
+                      boost::iostreams::filtering_stream<boost::iostreams::input>& stream)
+{
+    if (boost::ends_with(file, ".bz2") || !map_file(mfile, file))
+        return false;
+    data = mfile.data();
+    size = mfile.size();
+    if (boost::ends_with(file, ".gz"))
+    {
+        if (is_block_gzip(data, size))
+        {
+            buf = block_gzip_decompress(data, size);
+        }
+        else
+        {
+            std::ostringstream out;
+            out << stream.rdbuf();
+            buf = out.str();
+        }
+        mfile.close();
+        data = buf.data();
+        size = buf.size();
+    }
+    stream.reset();
+    return true;
+}
+
 
 boost::python::tuple GraphInterface::read_from_file(string file,
                                                     boost::python::object pfile,
                                                     string format,
                                                     boost::python::list ignore_vp,
                                                     boost::python::list ignore_ep,
-                                                    boost::python::list ignore_gp)
+                                                    boost::python::list ignore_gp,
+                                                    bool lazy)
 {
     if (format != "gt" && format != "dot" && format != "xml" && format != "gml")
         throw ValueException("error reading from file '" + file +
@@ -337,31 +399,98 @@ boost::python::tuple GraphInterface::read_from_file(string file,
         create_dynamic_map<vertex_index_map_t,edge_index_map_t>
             map_creator(_vertex_index, _edge_index);
         dynamic_properties dp(map_creator);
+        unfreeze();
         *_mg = multigraph_t();
 
-        if (format == "dot")
-            _directed = read_graphviz(stream, *_mg, dp, "vertex_name", true,
-                                      ivp, iep, igp);
-        else if (format == "xml")
-            _directed = read_graphml(stream, *_mg, dp, true, true, true,
-                                     ivp, iep, igp);
-        else if (format == "gml")
-            _directed = read_gml(stream, *_mg, dp, ivp, iep, igp);
+        if (format == "dot" || format == "xml" || format == "gml")
+        {
+            // The whole input is brought into memory (regular files are
+            // mapped, anything else is read from the stream), and parsed in
+            // parallel. If it uses anything not supported by the parallel
+            // readers, the sequential ones are used on the same buffer.
+            boost::iostreams::mapped_file_source mfile;
+            std::string buf;
+            const char* data;
+            size_t size;
+            if (pfile != boost::python::object() || file == "-" ||
+                !read_file_buffer(mfile, buf, data, size, file, stream))
+            {
+                std::ostringstream out;
+                out << stream.rdbuf();
+                buf = out.str();
+                data = buf.data();
+                size = buf.size();
+            }
+            stream.reset();
+
+            if (!read_text_parallel(format, data, size, *_mg, dp,
+                                    _vertex_index, _edge_index, ivp, iep, igp,
+                                    _directed))
+            {
+                boost::iostreams::stream<boost::iostreams::array_source>
+                    istream(data, size);
+                if (format == "dot")
+                    _directed = read_graphviz(istream, *_mg, dp, "vertex_name",
+                                              true, ivp, iep, igp);
+                else if (format == "xml")
+                    _directed = read_graphml(istream, *_mg, dp, true, true,
+                                             true, ivp, iep, igp);
+                else
+                    _directed = read_gml(istream, *_mg, dp, ivp, iep, igp);
+            }
+        }
 
 
         boost::python::dict vprops, eprops, gprops;
+        boost::python::list lazy_props;
+        bool lazy_ok = false;
         if (format == "gt")
         {
             vector<pair<string, boost::any>> agprops, avprops, aeprops;
-            stream.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
-            _directed = read_graph(stream, *_mg, agprops, avprops, aeprops, igp,
-                                   ivp, iep);
+            vector<gt_section> deferred;
+            bool done = false;
+            // regular files are read from memory, in parallel, without going
+            // through a stream; uncompressed version 2 files are read from
+            // the mapped file, and only these can have their property maps
+            // deferred
+            boost::iostreams::mapped_file_source mfile;
+            std::string buf;
+            const char* data;
+            size_t size;
+            if (pfile == boost::python::object() && file != "-" &&
+                read_file_buffer(mfile, buf, data, size, file, stream))
+            {
+                if (mfile.is_open() && get_version(data, size) == _version_v2)
+                {
+                    lazy_ok = true;
+                    _directed = read_graph_v2(data, size, *_mg, agprops,
+                                              avprops, aeprops, igp, ivp, iep,
+                                              lazy ? &deferred : nullptr);
+                }
+                else
+                {
+                    _directed = read_graph(data, size, *_mg, agprops, avprops,
+                                           aeprops, igp, ivp, iep);
+                }
+                done = true;
+            }
+
+            if (!done)
+            {
+                stream.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
+                _directed = read_graph(stream, *_mg, agprops, avprops, aeprops,
+                                       igp, ivp, iep);
+            }
             for (auto& p : agprops)
                 gprops[p.first] = find_property_map(p.second, _graph_index);
             for (auto& p : avprops)
                 vprops[p.first] = find_property_map(p.second, _vertex_index);
             for (auto& p : aeprops)
                 eprops[p.first] = find_property_map(p.second, _edge_index);
+            for (auto& sec : deferred)
+                lazy_props.append(boost::python::make_tuple
+                                  ((sec.type == property_type::Vertex) ? "v" : "e",
+                                   sec.name));
         }
         else
         {
@@ -378,7 +507,8 @@ boost::python::tuple GraphInterface::read_from_file(string file,
                                                             _graph_index);
             }
         }
-        return boost::python::make_tuple(vprops, eprops, gprops);
+        return boost::python::make_tuple(vprops, eprops, gprops, lazy_props,
+                                         lazy_ok);
     }
     catch (ios_base::failure &e)
     {
@@ -394,6 +524,34 @@ boost::python::tuple GraphInterface::read_from_file(string file,
     }
 };
 
+// reads a single property map which was deferred by read_from_file()
+boost::python::object GraphInterface::read_property_from_file(string file,
+                                                              string key_type,
+                                                              string name)
+{
+    try
+    {
+        property_type type;
+        if (key_type == "v")
+            type = property_type::Vertex;
+        else if (key_type == "e")
+            type = property_type::Edge;
+        else
+            throw ValueException("invalid key type: " + key_type);
+
+        boost::iostreams::mapped_file_source mfile(file);
+        boost::any prop = read_property_v2_section(mfile.data(), mfile.size(),
+                                                   *_mg, type, name);
+        if (type == property_type::Vertex)
+            return find_property_map(prop, _vertex_index);
+        return find_property_map(prop, _edge_index);
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+}
+
 template <class IndexMap>
 string graphviz_insert_index(dynamic_properties& dp, IndexMap index_map,
                              bool insert = true)
@@ -442,9 +600,15 @@ struct do_write_to_binary_file
     void operator()(ostream& stream, Graph& g, IndexMap index_map, size_t N,
                     bool directed, vector<pair<string, boost::any >> & gprops,
                     vector<pair<string, boost::any >> & vprops,
-                    vector<pair<string, boost::any >> & eprops) const
+                    vector<pair<string, boost::any >> & eprops,
+                    int version) const
     {
-        write_graph(g, index_map, N, directed, gprops, vprops, eprops, stream);
+        if (version == _version_v2)
+            write_graph_v2(g, index_map, N, directed, gprops, vprops, eprops,
+                           stream);
+        else
+            write_graph(g, index_map, N, directed, gprops, vprops, eprops,
+                        stream);
     }
 };
 
@@ -461,11 +625,16 @@ struct generate_index
 };
 
 void GraphInterface::write_to_file(string file, boost::python::object pfile,
-                                   string format, boost::python::list props)
+                                   string format, boost::python::list props,
+                                   int gt_version)
 {
     if (format != "gt" && format != "xml" && format != "dot" && format != "gml")
         throw ValueException("error writing to file '" + file +
                              "': requested invalid format '" + format + "'");
+    if (format == "gt" && gt_version != _version && gt_version != _version_v2)
+        throw ValueException("error writing to file '" + file +
+                             "': invalid gt format version " +
+                             lexical_cast<string>(gt_version));
     try
     {
         boost::iostreams::filtering_stream<boost::iostreams::output> stream;
@@ -480,7 +649,14 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                  std::ios_base::binary);
                 file_stream.exceptions(ios_base::badbit | ios_base::failbit);
                 if (boost::ends_with(file,".gz"))
-                    stream.push(boost::iostreams::gzip_compressor());
+                {
+                    // gt files are written in blocks that can be
+                    // decompressed in parallel
+                    if (format == "gt")
+                        stream.push(block_gzip_compressor());
+                    else
+                        stream.push(boost::iostreams::gzip_compressor());
+                }
                 if (boost::ends_with(file,".bz2"))
                     stream.push(boost::iostreams::bzip2_compressor());
                 stream.push(file_stream);
@@ -530,7 +706,8 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                gt_version))();
             }
             else
             {
@@ -542,7 +719,8 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                gt_version))();
             }
 
             _directed = directed;
@@ -594,3 +772,140 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
         throw IOException("error writing to file '" + file + "':" + e.what());
     }
 }
+
+// Incremental writer
+// ==================
+
+template <class T>
+struct extract_value
+{
+    T operator()(boost::python::object o) const
+    {
+        return boost::python::extract<T>(o)();
+    }
+};
+
+template <class T>
+struct extract_value<std::vector<T>>
+{
+    std::vector<T> operator()(boost::python::object o) const
+    {
+        std::vector<T> v;
+        for (boost::python::stl_input_iterator<boost::python::object> iter(o), end;
+             iter != end; ++iter)
+            v.push_back(extract_value<T>()(*iter));
+        return v;
+    }
+};
+
+struct add_stream_values
+{
+    template <class ValueType>
+    void operator()(ValueType, gt_stream_writer& writer, property_type type,
+                    const string& name, const string& type_name,
+                    boost::python::object& values, bool& found) const
+    {
+        typedef typename mpl::find<value_types, ValueType>::type pos;
+        if (type_name != type_names[mpl::distance<typename mpl::begin<value_types>::type, pos>::type::value])
+            return;
+        found = true;
+        if constexpr (std::is_scalar<ValueType>::value)
+        {
+            auto a = get_array<ValueType, 1>(values);
+            writer.add_values<ValueType>(type, name, a.begin(), a.end());
+        }
+        else
+        {
+            std::vector<ValueType> vals;
+            for (boost::python::stl_input_iterator<boost::python::object> iter(values), end;
+                 iter != end; ++iter)
+                vals.push_back(extract_value<ValueType>()(*iter));
+            writer.add_values<ValueType>(type, name, vals.begin(), vals.end());
+        }
+    }
+};
+
+class GraphStreamWriter
+{
+public:
+    GraphStreamWriter(string file, bool directed)
+        : _writer(file, directed) {}
+
+    void add_vertices(size_t n) { _writer.add_vertices(n); }
+
+    void add_edge_list(boost::python::object aedges)
+    {
+        auto edges = get_array<int64_t, 2>(aedges);
+        if (edges.shape()[0] > 0 && edges.shape()[1] < 2)
+            throw ValueException("edge list must have at least two columns");
+        auto get_st = [&](size_t i)
+            {
+                int64_t s = edges[i][0];
+                int64_t t = edges[i][1];
+                if (s < 0 || t < 0)
+                    throw ValueException("invalid vertex index: " +
+                                         lexical_cast<string>(std::min(s, t)));
+                return std::make_pair(uint64_t(s), uint64_t(t));
+            };
+        _writer.add_edges(boost::make_transform_iterator(boost::counting_iterator<size_t>(0),
+                                                         get_st),
+                          boost::make_transform_iterator(boost::counting_iterator<size_t>(edges.shape()[0]),
+                                                         get_st));
+    }
+
+    void add_values(string key_type, string name, string type_name,
+                    boost::python::object values)
+    {
+        property_type type;
+        if (key_type == "g")
+            type = property_type::Graph;
+        else if (key_type == "v")
+            type = property_type::Vertex;
+        else if (key_type == "e")
+            type = property_type::Edge;
+        else
+            throw ValueException("invalid key type: " + key_type);
+
+        bool found = false;
+        mpl::for_each<value_types>(std::bind(add_stream_values(),
+                                             std::placeholders::_1,
+                                             std::ref(_writer), type,
+                                             std::cref(name),
+                                             std::cref(type_name),
+                                             std::ref(values),
+                                             std::ref(found)));
+        if (!found)
+            throw ValueException("invalid value type: " + type_name);
+    }
+
+    size_t get_num_vertices() { return _writer.get_num_vertices(); }
+    size_t get_num_edges() { return _writer.get_num_edges(); }
+
+    void close()
+    {
+        try
+        {
+            _writer.close();
+        }
+        catch (ios_base::failure &e)
+        {
+            throw IOException(string("error writing to file: ") + e.what());
+        }
+    }
+
+private:
+    gt_stream_writer _writer;
+};
+
+void export_stream_writer()
+{
+    using namespace boost::python;
+    class_<GraphStreamWriter, boost::noncopyable>
+        ("GraphStreamWriter", init<string, bool>())
+        .def("add_vertices", &GraphStreamWriter::add_vertices)
+        .def("add_edge_list", &GraphStreamWriter::add_edge_list)
+        .def("add_values", &GraphStreamWriter::add_values)
+        .def("get_num_vertices", &GraphStreamWriter::get_num_vertices)
+        .def("get_num_edges", &GraphStreamWriter::get_num_edges)
+        .def("close", &GraphStreamWriter::close);
+}
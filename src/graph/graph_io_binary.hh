@@ -23,6 +23,17 @@
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
 #include <unordered_set>
+#include <fstream>
+#include <memory>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/array.hpp>
 
 namespace graph_tool
 {
@@ -201,19 +212,20 @@ void write_adjacency(Graph& g, const VProp& vindex, uint64_t N,
 template <bool BE, class Vint, class Graph>
 void read_adjacency_dispatch(Graph& g, size_t N, std::istream& s)
 {
-    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-    for (vertex_t v = 0; v < N; ++v)
-    {
-        std::vector<Vint> us;
-        read<BE>(s, us);
-        for (vertex_t u : us)
-        {
-            if (u >= N)
-                throw IOException("error reading graph: vertex index not in range");
-            add_edge(v, u, g);
-        }
-    }
+    // the out-lists are inserted as they are read, without storing the whole
+    // edge list
+    std::vector<Vint> us;
+    add_out_edges(g,
+                  [&](auto) -> const std::vector<Vint>&
+                  {
+                      read<BE>(s, us);
+                      for (auto u : us)
+                      {
+                          if (u >= N)
+                              throw IOException("error reading graph: vertex index not in range");
+                      }
+                      return us;
+                  });
 }
 
 
@@ -438,25 +450,40 @@ read_property(Graph& g, const std::unordered_set<std::string>& ignore,
 }
 
 
-template <class Graph, class VProp>
-void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
-                 std::vector<std::pair<std::string, boost::any>>& gprops,
-                 std::vector<std::pair<std::string, boost::any>>& vprops,
-                 std::vector<std::pair<std::string, boost::any>>& eprops, std::ostream& s)
+inline std::string get_comment(size_t N, size_t E, bool directed,
+                               size_t n_gprops, size_t n_vprops,
+                               size_t n_eprops)
 {
-    s.write(_magic, _magic_length);
-    write(s, _version);
-    uint8_t big_end = is_bigendian();
-    write(s, big_end);
     string comment = "graph-tool binary file (http:://graph-tool.skewed.de)"
         " generated by version " VERSION " (commit " GIT_COMMIT ", " GIT_COMMIT_DATE ")";
     comment += " stats: " + lexical_cast<std::string>(N) + " vertices, " +
-        lexical_cast<std::string>(num_edges(g)) + " edges, " +
+        lexical_cast<std::string>(E) + " edges, " +
         std::string((directed) ? "directed, " : "undirected, ") +
-        lexical_cast<std::string>(gprops.size()) + " graph props, " +
-        lexical_cast<std::string>(vprops.size()) + " vertex props, " +
-        lexical_cast<std::string>(eprops.size()) + " edge props";
+        lexical_cast<std::string>(n_gprops) + " graph props, " +
+        lexical_cast<std::string>(n_vprops) + " vertex props, " +
+        lexical_cast<std::string>(n_eprops) + " edge props";
+    return comment;
+}
+
+inline void write_preamble(std::ostream& s, uint8_t version,
+                           const std::string& comment)
+{
+    s.write(_magic, _magic_length);
+    write(s, version);
+    uint8_t big_end = is_bigendian();
+    write(s, big_end);
     write(s, comment);
+}
+
+template <class Graph, class VProp>
+void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
+                 std::vector<std::pair<std::string, boost::any>>& gprops,
+                 std::vector<std::pair<std::string, boost::any>>& vprops,
+                 std::vector<std::pair<std::string, boost::any>>& eprops, std::ostream& s)
+{
+    write_preamble(s, _version, get_comment(N, num_edges(g), directed,
+                                            gprops.size(), vprops.size(),
+                                            eprops.size()));
 
     write_adjacency(g, vindex, N, directed, s);
     uint64_t nprops = gprops.size() + vprops.size() + eprops.size();
@@ -513,6 +540,1301 @@ bool read_graph_dispatch(Graph& g,
 }
 
 
+// Version 2 of the format
+// =======================
+//
+// The second version of the format stores the same information, but in
+// aligned sections which are located via an index at the end of the file, so
+// that it can be read from a memory-mapped file without a sequential pass: the
+// adjacency is stored either in CSR form (an array of N + 1 offsets, followed
+// by the E targets), or as an edge list (an array of E sources followed by the
+// E targets), and scalar property maps are stored as raw columns. Non-scalar
+// property maps use the same encoding as version 1. The index also allows
+// property maps to be skipped without touching their data.
+//
+// Since the graph and the property maps own their storage, the mapped data
+// are not used in place: the adjacency is checked in parallel and inserted
+// with add_edges(), and the columns are copied in bulk, also in parallel.
+
+const uint8_t _version_v2 = 2;
+const size_t _v2_align = 16;
+
+// returns the format version of the data, or zero if they are not in the gt
+// format
+inline uint8_t get_version(const char* data, size_t size)
+{
+    if (size < _magic_length + 1 || strncmp(data, _magic, _magic_length) != 0)
+        return 0;
+    return data[_magic_length];
+}
+
+enum class adjacency_type : uint8_t
+{
+    CSR,
+    EdgeList
+};
+
+struct gt_section
+{
+    property_type type;
+    uint8_t val;
+    std::string name;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Output stream buffer that keeps track of the absolute position in the file,
+// so that section offsets can be recorded even if the underlying stream is not
+// seekable (e.g. when it is compressed, or a python file object).
+class counting_streambuf : public std::streambuf
+{
+public:
+    counting_streambuf(std::ostream& s, size_t pos = 0)
+        : _s(s), _pos(pos) {}
+
+    size_t tell() const { return _pos; }
+
+protected:
+    std::streamsize xsputn(const char* c, std::streamsize n) override
+    {
+        _s.write(c, n);
+        _pos += n;
+        return n;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            char x = traits_type::to_char_type(c);
+            xsputn(&x, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+private:
+    std::ostream& _s;
+    size_t _pos;
+};
+
+inline void write_padding(std::ostream& s, const counting_streambuf& buf)
+{
+    static const char zeros[_v2_align] = {};
+    size_t r = buf.tell() % _v2_align;
+    if (r > 0)
+        s.write(zeros, _v2_align - r);
+}
+
+template <class T, class Range, class Get>
+void write_column(std::ostream& s, Range&& range, Get&& get)
+{
+    std::vector<T> col;
+    col.reserve(1 << 16);
+    for (auto x : range)
+    {
+        col.push_back(get(x));
+        if (col.size() == col.capacity())
+        {
+            s.write(reinterpret_cast<const char*>(col.data()),
+                    sizeof(T) * col.size());
+            col.clear();
+        }
+    }
+    s.write(reinterpret_cast<const char*>(col.data()), sizeof(T) * col.size());
+}
+
+template <class Vint, class Graph, class VProp>
+void write_adjacency_v2_dispatch(Graph& g, const VProp& vindex,
+                                 std::ostream& s)
+{
+    write_column<Vint>(s, edges_range(g),
+                       [&](auto e) { return Vint(vindex[target(e, g)]); });
+}
+
+template <class RangeTraits>
+struct write_property_v2_dispatch
+{
+    template <class T, class Graph>
+    void operator()(T, Graph& g, boost::any& aprop, uint8_t& val,
+                    std::ostream& s) const
+    {
+        typedef typename property_map_type::apply<T, typename RangeTraits::index_map_t>::type pmap_t;
+        if (aprop.type() != typeid(pmap_t))
+            return;
+        pmap_t prop = any_cast<pmap_t>(aprop);
+        typedef typename mpl::find<val_types, T>::type pos;
+        val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
+        if constexpr (std::is_scalar<T>::value)
+        {
+            write_column<T>(s, RangeTraits::get_range(g),
+                            [&](auto x) { return prop[x]; });
+        }
+        else
+        {
+            for (auto x : RangeTraits::get_range(g))
+                write(s, prop[x]);
+        }
+    }
+
+    template <class Graph>
+    void operator()(size_t, Graph& g, boost::any& aprop, uint8_t& val,
+                    std::ostream& s) const
+    {
+        typedef typename mpl::find<val_types, int64_t>::type pos;
+        if (aprop.type() == typeid(GraphInterface::vertex_index_map_t))
+        {
+            auto prop = any_cast<GraphInterface::vertex_index_map_t>(aprop);
+            val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
+            write_column<int64_t>(s, vertices_range(g),
+                                  [&](auto v) { return prop[v]; });
+        }
+        if (aprop.type() == typeid(GraphInterface::edge_index_map_t))
+        {
+            auto prop = any_cast<GraphInterface::edge_index_map_t>(aprop);
+            val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
+            write_column<int64_t>(s, edges_range(g),
+                                  [&](auto e) { return prop[e]; });
+        }
+    }
+};
+
+template <class RangeTraits, class Graph>
+void write_property_v2(Graph& g, std::string& name, boost::any& prop,
+                       std::ostream& s, counting_streambuf& buf,
+                       std::vector<gt_section>& sections)
+{
+    write_padding(s, buf);
+    gt_section sec;
+    sec.type = RangeTraits::get_property_id();
+    sec.val = std::numeric_limits<uint8_t>::max();
+    sec.name = name;
+    sec.offset = buf.tell();
+    mpl::for_each<val_types>(std::bind(write_property_v2_dispatch<RangeTraits>(),
+                                       std::placeholders::_1, std::ref(g),
+                                       std::ref(prop), std::ref(sec.val),
+                                       std::ref(s)));
+    if (sec.val == std::numeric_limits<uint8_t>::max())
+        throw GraphException("Error writing graph: unknown property map type (this is a bug)");
+    sec.size = buf.tell() - sec.offset;
+    sections.push_back(sec);
+}
+
+// Writes the index of the sections, followed by its position in the file,
+// which is always the last eight bytes.
+inline void write_index_v2(std::ostream& s, counting_streambuf& buf,
+                           bool directed, adjacency_type adj, uint64_t N,
+                           uint64_t E, uint64_t offsets_pos,
+                           uint64_t targets_pos,
+                           const std::vector<gt_section>& sections)
+{
+    write_padding(s, buf);
+    uint64_t index_pos = buf.tell();
+    uint8_t dir = directed;
+    write(s, dir);
+    write(s, adj);
+    write(s, N);
+    write(s, E);
+    write(s, offsets_pos);
+    write(s, targets_pos);
+    uint64_t nsecs = sections.size();
+    write(s, nsecs);
+    for (auto& sec : sections)
+    {
+        write(s, sec.type);
+        write(s, sec.val);
+        write(s, sec.name);
+        write(s, sec.offset);
+        write(s, sec.size);
+    }
+    write(s, index_pos);
+}
+
+template <class Graph, class VProp>
+void write_graph_v2(Graph& g, const VProp& vindex, size_t N, bool directed,
+                    std::vector<std::pair<std::string, boost::any>>& gprops,
+                    std::vector<std::pair<std::string, boost::any>>& vprops,
+                    std::vector<std::pair<std::string, boost::any>>& eprops,
+                    std::ostream& os)
+{
+    counting_streambuf buf(os);
+    std::ostream s(&buf);
+    s.exceptions(ios_base::badbit | ios_base::failbit);
+
+    uint64_t E = num_edges(g);
+    write_preamble(s, _version_v2, get_comment(N, E, directed, gprops.size(),
+                                               vprops.size(), eprops.size()));
+
+    // CSR adjacency; the edges are stored in the same order as they are
+    // iterated, which is also the order of the edge property values
+    write_padding(s, buf);
+    uint64_t offsets_pos = buf.tell();
+    uint64_t pos = 0;
+    write(s, pos);
+    write_column<uint64_t>(s, vertices_range(g),
+                           [&](auto v) { return pos += out_degree(v, g); });
+
+    write_padding(s, buf);
+    uint64_t targets_pos = buf.tell();
+    if (N <= numeric_limits<uint8_t>::max())
+        write_adjacency_v2_dispatch<uint8_t>(g, vindex, s);
+    else if (N <= numeric_limits<uint16_t>::max())
+        write_adjacency_v2_dispatch<uint16_t>(g, vindex, s);
+    else if (N <= numeric_limits<uint32_t>::max())
+        write_adjacency_v2_dispatch<uint32_t>(g, vindex, s);
+    else
+        write_adjacency_v2_dispatch<uint64_t>(g, vindex, s);
+
+    std::vector<gt_section> sections;
+    for (auto& p : gprops)
+        write_property_v2<graph_range_traits>(g, p.first, p.second, s, buf,
+                                              sections);
+    for (auto& p : vprops)
+        write_property_v2<vertex_range_traits>(g, p.first, p.second, s, buf,
+                                               sections);
+    for (auto& p : eprops)
+        write_property_v2<edge_range_traits>(g, p.first, p.second, s, buf,
+                                             sections);
+
+    write_index_v2(s, buf, directed, adjacency_type::CSR, N, E, offsets_pos,
+                   targets_pos, sections);
+    s.flush();
+}
+
+// Incremental writer
+// ------------------
+//
+// Writes a version 2 file without requiring the graph to be in memory. Edges
+// and property values are appended in batches, and every section is spilled
+// to a uniquely named temporary file next to the output, until the final
+// file is assembled by close(). The edges are stored as an edge list in the order they were
+// added, which determines their indexes. The number of vertices is the larger
+// of the number added explicitly and one plus the largest index seen in an
+// edge. Property values are appended in index order, and the values which are
+// missing at the end are filled with defaults.
+
+class gt_stream_writer
+{
+public:
+    gt_stream_writer(const std::string& file, bool directed)
+        : _file(file), _directed(directed)
+    {
+        _sources = open_spill(_sources_path);
+        _targets = open_spill(_targets_path);
+    }
+
+    ~gt_stream_writer()
+    {
+        if (!_closed)
+            remove_spills();
+    }
+
+    gt_stream_writer(const gt_stream_writer&) = delete;
+    gt_stream_writer& operator=(const gt_stream_writer&) = delete;
+
+    size_t get_num_vertices() const { return _N; }
+    size_t get_num_edges() const { return _E; }
+
+    void add_vertices(size_t n)
+    {
+        check_open();
+        _N += n;
+    }
+
+    // Appends the edges in the range, which must dereference to (source,
+    // target) pairs.
+    template <class Iter>
+    void add_edges(Iter begin, Iter end)
+    {
+        check_open();
+        std::vector<uint64_t> ss, ts;
+        size_t N = _N;
+        for (; begin != end; ++begin)
+        {
+            auto st = *begin;
+            uint64_t s = std::get<0>(st);
+            uint64_t t = std::get<1>(st);
+            ss.push_back(s);
+            ts.push_back(t);
+            N = std::max({N, size_t(s + 1), size_t(t + 1)});
+        }
+        _sources->write(reinterpret_cast<const char*>(ss.data()),
+                        ss.size() * sizeof(uint64_t));
+        _targets->write(reinterpret_cast<const char*>(ts.data()),
+                        ts.size() * sizeof(uint64_t));
+        _E += ss.size();
+        _N = N;
+    }
+
+    // Appends the values in the range to the given property map, which is
+    // created with the first call. For graph properties, only a single value
+    // may be given.
+    template <class T, class Iter>
+    void add_values(property_type type, const std::string& name, Iter begin,
+                    Iter end)
+    {
+        check_open();
+        typedef typename mpl::find<val_types, T>::type pos;
+        uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
+        auto& sp = get_spill(type, name, val);
+        if (sp.val != val)
+            throw ValueException("property map '" + name + "' was created "
+                                 "with a different value type");
+        std::vector<T> vals(begin, end);
+        if (type == property_type::Graph && sp.count + vals.size() > 1)
+            throw ValueException("graph property map '" + name +
+                                 "' can only have one value");
+        std::ostream& s = *sp.s;
+        if constexpr (std::is_scalar<T>::value)
+        {
+            s.write(reinterpret_cast<const char*>(vals.data()),
+                    sizeof(T) * vals.size());
+        }
+        else
+        {
+            for (auto& x : vals)
+                write(s, x);
+        }
+        sp.count += vals.size();
+    }
+
+    void close()
+    {
+        check_open();
+        _closed = true;
+        try
+        {
+            assemble();
+        }
+        catch (...)
+        {
+            remove_spills();
+            throw;
+        }
+        remove_spills();
+    }
+
+private:
+    struct spill
+    {
+        property_type type;
+        uint8_t val;
+        std::string name;
+        std::string path;
+        std::unique_ptr<std::ofstream> s;
+        size_t count = 0;
+        size_t bytes = 0;
+    };
+
+    void check_open() const
+    {
+        if (_closed)
+            throw ValueException("writer for '" + _file + "' is closed");
+    }
+
+    std::unique_ptr<std::ofstream> open_spill(std::string& path)
+    {
+        std::string name = _file + ".tmp.XXXXXX";
+        int fd = mkstemp(&name[0]);
+        if (fd < 0)
+            throw IOException("error writing graph: cannot create temporary "
+                              "file '" + name + "'");
+        ::close(fd);
+        path = name;
+        std::unique_ptr<std::ofstream> s(new std::ofstream());
+        s->exceptions(ios_base::badbit | ios_base::failbit);
+        s->open(path.c_str(), std::ios_base::out | std::ios_base::binary |
+                std::ios_base::trunc);
+        return s;
+    }
+
+    spill& get_spill(property_type type, const std::string& name, uint8_t val)
+    {
+        for (auto& sp : _spills)
+            if (sp.type == type && sp.name == name)
+                return sp;
+        _spills.emplace_back();
+        auto& sp = _spills.back();
+        sp.type = type;
+        sp.val = val;
+        sp.name = name;
+        sp.s = open_spill(sp.path);
+        return sp;
+    }
+
+    void remove_spills()
+    {
+        _sources.reset();
+        _targets.reset();
+        std::remove(_sources_path.c_str());
+        std::remove(_targets_path.c_str());
+        for (auto& sp : _spills)
+        {
+            sp.s.reset();
+            std::remove(sp.path.c_str());
+        }
+    }
+
+    static std::ifstream open_input(const std::string& path)
+    {
+        std::ifstream in(path.c_str(),
+                         std::ios_base::in | std::ios_base::binary);
+        if (!in.is_open())
+            throw IOException("error writing graph: cannot open temporary "
+                              "file '" + path + "'");
+        return in;
+    }
+
+    static void check_size(const std::string& path, size_t size,
+                           size_t expected)
+    {
+        if (size != expected)
+            throw IOException("error writing graph: temporary file '" + path +
+                              "' has " + lexical_cast<std::string>(size) +
+                              " bytes, but " +
+                              lexical_cast<std::string>(expected) +
+                              " were written");
+    }
+
+    // copies the spilled data, converting them from uint64_t to Vint
+    template <class Vint>
+    static void copy_edges(const std::string& path, size_t E, std::ostream& s)
+    {
+        auto in = open_input(path);
+        std::vector<uint64_t> buf(1 << 16);
+        std::vector<Vint> out;
+        size_t size = 0;
+        while (in)
+        {
+            in.read(reinterpret_cast<char*>(buf.data()),
+                    buf.size() * sizeof(uint64_t));
+            size += in.gcount();
+            size_t n = in.gcount() / sizeof(uint64_t);
+            out.assign(buf.begin(), buf.begin() + n);
+            s.write(reinterpret_cast<const char*>(out.data()),
+                    n * sizeof(Vint));
+        }
+        check_size(path, size, E * sizeof(uint64_t));
+    }
+
+    static void copy_file(const std::string& path, size_t bytes,
+                          std::ostream& s)
+    {
+        auto in = open_input(path);
+        std::vector<char> buf(1 << 20);
+        size_t size = 0;
+        while (in)
+        {
+            in.read(buf.data(), buf.size());
+            size += in.gcount();
+            s.write(buf.data(), in.gcount());
+        }
+        check_size(path, size, bytes);
+    }
+
+    size_t get_num_values(const spill& sp) const
+    {
+        if (sp.type == property_type::Vertex)
+            return _N;
+        else if (sp.type == property_type::Edge)
+            return _E;
+        return 1;
+    }
+
+    struct write_defaults
+    {
+        template <class T>
+        void operator()(T, uint8_t val, size_t n, std::ostream& s) const
+        {
+            typedef typename mpl::find<val_types, T>::type pos;
+            if (mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value != val)
+                return;
+            T x = T();
+            for (size_t i = 0; i < n; ++i)
+                write(s, x);
+        }
+    };
+
+    void assemble()
+    {
+        _sources->close();
+        _targets->close();
+        for (auto& sp : _spills)
+        {
+            sp.bytes = sp.s->tellp();
+            sp.s->close();
+        }
+
+        // everything is validated before the output is truncated
+        for (auto& sp : _spills)
+        {
+            size_t n = get_num_values(sp);
+            if (sp.count > n)
+                throw ValueException("property map '" + sp.name + "' has " +
+                                     lexical_cast<std::string>(sp.count) +
+                                     " values, but only " +
+                                     lexical_cast<std::string>(n) +
+                                     " are needed");
+        }
+
+        std::ofstream file;
+        file.exceptions(ios_base::badbit | ios_base::failbit);
+        file.open(_file.c_str(), std::ios_base::out | std::ios_base::binary |
+                  std::ios_base::trunc);
+        counting_streambuf buf(file);
+        std::ostream s(&buf);
+        s.exceptions(ios_base::badbit | ios_base::failbit);
+
+        size_t n_props[3] = {0, 0, 0};
+        for (auto& sp : _spills)
+            n_props[size_t(sp.type)]++;
+        write_preamble(s, _version_v2, get_comment(_N, _E, _directed,
+                                                   n_props[0], n_props[1],
+                                                   n_props[2]));
+
+        uint64_t pos[2];
+        std::string* paths[2] = {&_sources_path, &_targets_path};
+        for (size_t i = 0; i < 2; ++i)
+        {
+            write_padding(s, buf);
+            pos[i] = buf.tell();
+            if (_N <= numeric_limits<uint8_t>::max())
+                copy_edges<uint8_t>(*paths[i], _E, s);
+            else if (_N <= numeric_limits<uint16_t>::max())
+                copy_edges<uint16_t>(*paths[i], _E, s);
+            else if (_N <= numeric_limits<uint32_t>::max())
+                copy_edges<uint32_t>(*paths[i], _E, s);
+            else
+                copy_edges<uint64_t>(*paths[i], _E, s);
+        }
+
+        std::vector<gt_section> sections;
+        for (auto& sp : _spills)
+        {
+            size_t n = get_num_values(sp);
+            write_padding(s, buf);
+            gt_section sec;
+            sec.type = sp.type;
+            sec.val = sp.val;
+            sec.name = sp.name;
+            sec.offset = buf.tell();
+            copy_file(sp.path, sp.bytes, s);
+            mpl::for_each<value_types>(std::bind(write_defaults(),
+                                                 std::placeholders::_1, sp.val,
+                                                 n - sp.count, std::ref(s)));
+            sec.size = buf.tell() - sec.offset;
+            sections.push_back(sec);
+        }
+
+        write_index_v2(s, buf, _directed, adjacency_type::EdgeList, _N, _E,
+                       pos[0], pos[1], sections);
+        s.flush();
+        file.close();
+    }
+
+    std::string _file;
+    bool _directed;
+    bool _closed = false;
+    size_t _N = 0;
+    size_t _E = 0;
+    std::string _sources_path;
+    std::string _targets_path;
+    std::unique_ptr<std::ofstream> _sources;
+    std::unique_ptr<std::ofstream> _targets;
+    std::vector<spill> _spills;
+};
+
+// Reading is done from a contiguous buffer (typically a memory-mapped file)
+
+template <bool BE, class T>
+T load(const char* p)
+{
+    T v;
+    memcpy(&v, p, sizeof(T));
+    byte_swap<BE>(v);
+    return v;
+}
+
+class buffer_reader
+{
+public:
+    buffer_reader(const char* data, size_t size, size_t pos = 0)
+        : _data(data), _size(size), _pos(pos) {}
+
+    template <bool BE, class T>
+    void read(T& v)
+    {
+        v = load<BE, T>(get(sizeof(T)));
+    }
+
+    template <bool BE>
+    void read(std::string& v)
+    {
+        uint64_t size = 0;
+        read<BE>(size);
+        v.assign(get(size), size);
+    }
+
+    const char* get(size_t n)
+    {
+        check(_pos, n);
+        const char* p = _data + _pos;
+        _pos += n;
+        return p;
+    }
+
+    void check(size_t pos, size_t n) const
+    {
+        if (pos > _size || n > _size - pos)
+            throw IOException("Error reading graph: offset out of range "
+                              "(truncated file?)");
+    }
+
+    // Checks that an array of `count` elements of size `elem_size` starting at
+    // `pos` fits in the buffer, without overflowing the product.
+    void check_array(size_t pos, size_t count, size_t elem_size) const
+    {
+        if (count > std::numeric_limits<size_t>::max() / elem_size)
+            throw IOException("Error reading graph: array size out of range "
+                              "(corrupted file?)");
+        check(pos, count * elem_size);
+    }
+
+    const char* get_array(size_t count, size_t elem_size)
+    {
+        check_array(_pos, count, elem_size);
+        return get(count * elem_size);
+    }
+
+    const char* data() const { return _data; }
+    size_t pos() const { return _pos; }
+    size_t size() const { return _size; }
+
+private:
+    const char* _data;
+    size_t _size;
+    size_t _pos;
+};
+
+// Copies a raw column from the buffer, in parallel for large columns, so that
+// the page faults of a memory-mapped file are also serviced in parallel.
+template <bool BE, class T>
+void read_column(const char* src, T* dst, size_t n)
+{
+    constexpr size_t chunk = (1 << 20) / sizeof(T) + 1;
+    #pragma omp parallel for schedule(static) if (n > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < n; i += chunk)
+    {
+        size_t m = std::min(chunk, n - i);
+        if (BE == is_bigendian())
+        {
+            memcpy(dst + i, src + i * sizeof(T), m * sizeof(T));
+        }
+        else
+        {
+            for (size_t j = i; j < i + m; ++j)
+                dst[j] = load<BE, T>(src + j * sizeof(T));
+        }
+    }
+}
+
+// Iterates through the (source, target) pairs of a CSR adjacency stored in the
+// buffer.
+template <bool BE, class Vint>
+class csr_edge_iterator
+    : public boost::iterator_facade<csr_edge_iterator<BE, Vint>,
+                                    std::pair<size_t, size_t>,
+                                    boost::forward_traversal_tag,
+                                    std::pair<size_t, size_t>>
+{
+public:
+    csr_edge_iterator() {}
+    csr_edge_iterator(const char* offsets, const char* targets, size_t N,
+                      size_t k)
+        : _offsets(offsets), _targets(targets), _N(N), _v(0), _k(k)
+    {
+        skip_empty();
+    }
+
+private:
+    friend class boost::iterator_core_access;
+
+    void skip_empty()
+    {
+        while (_v < _N &&
+               _k >= load<BE, uint64_t>(_offsets + (_v + 1) * sizeof(uint64_t)))
+            ++_v;
+    }
+
+    void increment()
+    {
+        ++_k;
+        skip_empty();
+    }
+
+    bool equal(const csr_edge_iterator& other) const
+    {
+        return _k == other._k;
+    }
+
+    std::pair<size_t, size_t> dereference() const
+    {
+        return {_v, load<BE, Vint>(_targets + _k * sizeof(Vint))};
+    }
+
+    const char* _offsets = nullptr;
+    const char* _targets = nullptr;
+    size_t _N = 0;
+    size_t _v = 0;
+    size_t _k = 0;
+};
+
+template <bool BE, class Vint>
+bool check_targets(const char* targets, size_t N, size_t E)
+{
+    bool valid = true;
+    #pragma omp parallel for schedule(static) if (E > OPENMP_MIN_THRESH) \
+        reduction(&&:valid)
+    for (size_t k = 0; k < E; ++k)
+        valid = valid && (load<BE, Vint>(targets + k * sizeof(Vint)) < N);
+    return valid;
+}
+
+template <bool BE, class Vint, class Graph>
+void read_edge_list_v2_dispatch(Graph& g, size_t N, size_t E,
+                                buffer_reader& buf, uint64_t sources_pos,
+                                uint64_t targets_pos)
+{
+    buf.check_array(sources_pos, E, sizeof(Vint));
+    buf.check_array(targets_pos, E, sizeof(Vint));
+    const char* sources = buf.data() + sources_pos;
+    const char* targets = buf.data() + targets_pos;
+
+    if (!check_targets<BE, Vint>(sources, N, E) ||
+        !check_targets<BE, Vint>(targets, N, E))
+        throw IOException("error reading graph: vertex index not in range");
+
+    for (size_t i = 0; i < N; ++i)
+        add_vertex(g);
+
+    auto get_st = [=](size_t k)
+        {
+            return std::make_pair(size_t(load<BE, Vint>(sources + k * sizeof(Vint))),
+                                  size_t(load<BE, Vint>(targets + k * sizeof(Vint))));
+        };
+    add_edges(boost::make_transform_iterator(boost::counting_iterator<size_t>(0),
+                                             get_st),
+              boost::make_transform_iterator(boost::counting_iterator<size_t>(E),
+                                             get_st),
+              g);
+}
+
+template <bool BE, class Vint, class Graph>
+void read_adjacency_v2_dispatch(Graph& g, size_t N, size_t E,
+                                buffer_reader& buf, adjacency_type adj,
+                                uint64_t offsets_pos, uint64_t targets_pos)
+{
+    if (adj == adjacency_type::EdgeList)
+    {
+        read_edge_list_v2_dispatch<BE, Vint>(g, N, E, buf, offsets_pos,
+                                             targets_pos);
+        return;
+    }
+    if (adj != adjacency_type::CSR)
+        throw IOException("error reading graph: invalid adjacency type " +
+                          boost::lexical_cast<std::string>(int(adj)));
+
+    buf.check_array(offsets_pos, N, sizeof(uint64_t));
+    buf.check(offsets_pos + N * sizeof(uint64_t), sizeof(uint64_t));
+    buf.check_array(targets_pos, E, sizeof(Vint));
+    const char* offsets = buf.data() + offsets_pos;
+    const char* targets = buf.data() + targets_pos;
+
+    bool valid = (load<BE, uint64_t>(offsets) == 0 &&
+                  load<BE, uint64_t>(offsets + N * sizeof(uint64_t)) == E);
+    #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH) \
+        reduction(&&:valid)
+    for (size_t v = 0; v < N; ++v)
+        valid = valid &&
+            (load<BE, uint64_t>(offsets + v * sizeof(uint64_t)) <=
+             load<BE, uint64_t>(offsets + (v + 1) * sizeof(uint64_t)));
+    if (!valid)
+        throw IOException("error reading graph: invalid adjacency offsets");
+
+    if (!check_targets<BE, Vint>(targets, N, E))
+        throw IOException("error reading graph: vertex index not in range");
+
+    for (size_t i = 0; i < N; ++i)
+        add_vertex(g);
+
+    add_edges(csr_edge_iterator<BE, Vint>(offsets, targets, N, 0),
+              csr_edge_iterator<BE, Vint>(offsets, targets, N, E), g);
+}
+
+template <bool BE, class RangeTraits>
+struct read_property_v2_dispatch
+{
+    template <class T, class Graph>
+    void operator()(T, Graph& g, boost::any& aprop, const gt_section& sec,
+                    size_t n, buffer_reader& buf) const
+    {
+        typedef typename mpl::find<val_types, T>::type pos;
+        if (mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value != sec.val)
+            return;
+
+        typedef typename property_map_type::apply<T, typename RangeTraits::index_map_t>::type pmap_t;
+        pmap_t prop(RangeTraits::get_index_map(g));
+        buf.check(sec.offset, sec.size);
+        const char* data = buf.data() + sec.offset;
+        if constexpr (std::is_scalar<T>::value)
+        {
+            if (sec.size % sizeof(T) != 0 || sec.size / sizeof(T) != n)
+                throw IOException("Error reading graph: invalid size of property map section '"
+                                  + sec.name + "'");
+            auto& store = prop.get_storage();
+            store.resize(n);
+            read_column<BE>(data, store.data(), n);
+        }
+        else
+        {
+            boost::iostreams::stream<boost::iostreams::array_source>
+                s(data, sec.size);
+            s.exceptions(ios_base::badbit | ios_base::failbit |
+                         ios_base::eofbit);
+            // values are stored in index order, which for edges coincides
+            // with the iteration order only for CSR adjacency
+            auto& store = prop.get_storage();
+            store.resize(n);
+            for (auto& x : store)
+                read<BE>(s, x);
+        }
+        aprop = prop;
+    }
+};
+
+template <bool BE, class RangeTraits, class Graph>
+boost::any read_property_v2(Graph& g, const gt_section& sec, size_t n,
+                            buffer_reader& buf)
+{
+    boost::any prop;
+    mpl::for_each<val_types>(std::bind(read_property_v2_dispatch<BE, RangeTraits>(),
+                                       std::placeholders::_1, std::ref(g),
+                                       std::ref(prop), std::cref(sec), n,
+                                       std::ref(buf)));
+    if (prop.empty())
+        throw IOException("Error reading graph: invalid property value type index "
+                          + boost::lexical_cast<std::string>(int(sec.val)));
+    return prop;
+}
+
+struct gt_index
+{
+    bool directed;
+    adjacency_type adjacency;
+    uint64_t N;
+    uint64_t E;
+    uint64_t offsets_pos;   // for edge lists, this is the array of sources
+    uint64_t targets_pos;
+    std::vector<gt_section> sections;
+};
+
+template <bool BE>
+gt_index read_index_v2(const char* data, size_t size)
+{
+    if (size < sizeof(uint64_t))
+        throw IOException("Error reading graph: truncated file");
+    uint64_t index_pos = load<BE, uint64_t>(data + size - sizeof(uint64_t));
+    buffer_reader buf(data, size - sizeof(uint64_t), index_pos);
+    buf.check(index_pos, 0);
+
+    gt_index idx;
+    uint8_t dir = 0;
+    buf.read<BE>(dir);
+    idx.directed = dir;
+    buf.read<BE>(idx.adjacency);
+    buf.read<BE>(idx.N);
+    buf.read<BE>(idx.E);
+    buf.read<BE>(idx.offsets_pos);
+    buf.read<BE>(idx.targets_pos);
+    uint64_t nsecs = 0;
+    buf.read<BE>(nsecs);
+    for (size_t i = 0; i < nsecs; ++i)
+    {
+        gt_section sec;
+        buf.read<BE>(sec.type);
+        buf.read<BE>(sec.val);
+        buf.read<BE>(sec.name);
+        buf.read<BE>(sec.offset);
+        buf.read<BE>(sec.size);
+        idx.sections.push_back(sec);
+    }
+    return idx;
+}
+
+// If deferred is given, the vertex and edge property maps which are not
+// ignored are not read, and their sections are returned instead, so that they
+// can be read later with read_property_v2_section().
+template <bool BE, class Graph>
+bool read_graph_v2_dispatch(const char* data, size_t size, Graph& g,
+                            std::vector<std::pair<std::string, boost::any>>& gprops,
+                            std::vector<std::pair<std::string, boost::any>>& vprops,
+                            std::vector<std::pair<std::string, boost::any>>& eprops,
+                            const std::unordered_set<std::string>& ignore_gp,
+                            const std::unordered_set<std::string>& ignore_vp,
+                            const std::unordered_set<std::string>& ignore_ep,
+                            std::vector<gt_section>* deferred)
+{
+    auto idx = read_index_v2<BE>(data, size);
+    size_t N = idx.N, E = idx.E;
+    buffer_reader buf(data, size - sizeof(uint64_t));
+
+    if (N <= numeric_limits<uint8_t>::max())
+        read_adjacency_v2_dispatch<BE, uint8_t>(g, N, E, buf, idx.adjacency,
+                                                idx.offsets_pos,
+                                                idx.targets_pos);
+    else if (N <= numeric_limits<uint16_t>::max())
+        read_adjacency_v2_dispatch<BE, uint16_t>(g, N, E, buf, idx.adjacency,
+                                                 idx.offsets_pos,
+                                                 idx.targets_pos);
+    else if (N <= numeric_limits<uint32_t>::max())
+        read_adjacency_v2_dispatch<BE, uint32_t>(g, N, E, buf, idx.adjacency,
+                                                 idx.offsets_pos,
+                                                 idx.targets_pos);
+    else
+        read_adjacency_v2_dispatch<BE, uint64_t>(g, N, E, buf, idx.adjacency,
+                                                 idx.offsets_pos,
+                                                 idx.targets_pos);
+
+    for (auto& sec : idx.sections)
+    {
+        switch (sec.type)
+        {
+        case property_type::Graph:
+            if (ignore_gp.find(sec.name) == ignore_gp.end())
+                gprops.emplace_back(sec.name,
+                                    read_property_v2<BE, graph_range_traits>
+                                        (g, sec, 1, buf));
+            break;
+        case property_type::Vertex:
+            if (ignore_vp.find(sec.name) != ignore_vp.end())
+                break;
+            if (deferred != nullptr)
+                deferred->push_back(sec);
+            else
+                vprops.emplace_back(sec.name,
+                                    read_property_v2<BE, vertex_range_traits>
+                                        (g, sec, N, buf));
+            break;
+        case property_type::Edge:
+            if (ignore_ep.find(sec.name) != ignore_ep.end())
+                break;
+            if (deferred != nullptr)
+                deferred->push_back(sec);
+            else
+                eprops.emplace_back(sec.name,
+                                    read_property_v2<BE, edge_range_traits>
+                                        (g, sec, E, buf));
+            break;
+        default:
+            throw IOException("Error reading graph: invalid property type " +
+                              boost::lexical_cast<std::string>(int(sec.type)));
+        }
+    }
+    return idx.directed;
+}
+
+// checks the header, and returns whether the data are big-endian
+inline bool check_header_v2(const char* data, size_t size)
+{
+    uint8_t version = get_version(data, size);
+    if (version == 0 || size < _magic_length + 2)
+        throw IOException("Error reading graph: Invalid magic number");
+    if (version != _version_v2)
+        throw IOException("Error reading graph: Invalid format version " +
+                          boost::lexical_cast<std::string>(int(version)));
+    return data[_magic_length + 1];
+}
+
+template <class Graph>
+bool read_graph_v2(const char* data, size_t size, Graph& g,
+                   std::vector<std::pair<std::string, boost::any>>& gprops,
+                   std::vector<std::pair<std::string, boost::any>>& vprops,
+                   std::vector<std::pair<std::string, boost::any>>& eprops,
+                   const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>(),
+                   const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
+                   const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>(),
+                   std::vector<gt_section>* deferred = nullptr)
+{
+    if (check_header_v2(data, size))
+        return read_graph_v2_dispatch<true>(data, size, g, gprops, vprops,
+                                            eprops, ignore_gp, ignore_vp,
+                                            ignore_ep, deferred);
+    else
+        return read_graph_v2_dispatch<false>(data, size, g, gprops, vprops,
+                                             eprops, ignore_gp, ignore_vp,
+                                             ignore_ep, deferred);
+}
+
+template <bool BE, class Graph>
+boost::any read_property_v2_section_dispatch(const char* data, size_t size,
+                                             Graph& g, property_type type,
+                                             const std::string& name)
+{
+    auto idx = read_index_v2<BE>(data, size);
+
+    // the edges must be indexed contiguously by their position in the file,
+    // as they are right after reading
+    if (idx.N != num_vertices(g) || idx.E != num_edges(g) ||
+        idx.E != g.get_edge_index_range())
+        throw IOException("Error reading property map '" + name + "': the "
+                          "graph does not match the one stored in the file");
+
+    buffer_reader buf(data, size - sizeof(uint64_t));
+    for (auto& sec : idx.sections)
+    {
+        if (sec.type != type || sec.name != name)
+            continue;
+        switch (type)
+        {
+        case property_type::Graph:
+            return read_property_v2<BE, graph_range_traits>(g, sec, 1, buf);
+        case property_type::Vertex:
+            return read_property_v2<BE, vertex_range_traits>(g, sec, idx.N, buf);
+        case property_type::Edge:
+            return read_property_v2<BE, edge_range_traits>(g, sec, idx.E, buf);
+        }
+    }
+    throw IOException("Error reading property map '" + name + "': not found "
+                      "in file");
+}
+
+// Reads a single property map from a version 2 file, for a graph that has been
+// previously read from it, and not modified since.
+template <class Graph>
+boost::any read_property_v2_section(const char* data, size_t size, Graph& g,
+                                    property_type type, const std::string& name)
+{
+    if (check_header_v2(data, size))
+        return read_property_v2_section_dispatch<true>(data, size, g, type,
+                                                       name);
+    else
+        return read_property_v2_section_dispatch<false>(data, size, g, type,
+                                                        name);
+}
+
+// Version 1 from a buffer
+// -----------------------
+//
+// The out-neighbors of every vertex are preceded by their number, hence the
+// lists are located by a serial pass over these numbers only, after which the
+// targets are checked in parallel and the out-edges are inserted in bulk.
+// Scalar property maps are raw columns, as in version 2, and are copied in
+// the same way; the other ones are read sequentially.
+
+template <bool BE, class Vint, class Graph>
+void read_adjacency_v1_dispatch(Graph& g, size_t N, buffer_reader& buf)
+{
+    std::vector<const char*> targets(N);
+    std::vector<uint64_t> k(N);
+    for (size_t v = 0; v < N; ++v)
+    {
+        buf.read<BE>(k[v]);
+        targets[v] = buf.get_array(k[v], sizeof(Vint));
+    }
+
+    bool valid = true;
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH) \
+        reduction(&&:valid)
+    for (size_t v = 0; v < N; ++v)
+    {
+        for (size_t j = 0; j < k[v]; ++j)
+            valid = valid &&
+                (load<BE, Vint>(targets[v] + j * sizeof(Vint)) < N);
+    }
+    if (!valid)
+        throw IOException("error reading graph: vertex index not in range");
+
+    add_out_edges(g,
+                  [&](auto v)
+                  {
+                      auto get_u = [p = targets[v]](size_t j)
+                          { return size_t(load<BE, Vint>(p + j * sizeof(Vint))); };
+                      return mk_range
+                          (std::make_pair
+                               (boost::make_transform_iterator
+                                    (boost::counting_iterator<size_t>(0), get_u),
+                                boost::make_transform_iterator
+                                    (boost::counting_iterator<size_t>(k[v]),
+                                     get_u)));
+                  });
+}
+
+template <bool BE, class RangeTraits>
+struct read_property_v1_dispatch
+{
+    template <class T, class Graph>
+    void operator()(T, Graph& g, boost::any& aprop, uint8_t val, bool ignore,
+                    size_t n, bool& found, buffer_reader& buf) const
+    {
+        typedef typename mpl::find<val_types, T>::type pos;
+        if (mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value != val)
+            return;
+        found = true;
+
+        // the values are stored in iteration order, which is the same as the
+        // index order for a graph which has just been read
+        typedef typename property_map_type::apply<T, typename RangeTraits::index_map_t>::type pmap_t;
+        pmap_t prop(RangeTraits::get_index_map(g));
+        auto& store = prop.get_storage();
+        if constexpr (std::is_scalar<T>::value)
+        {
+            const char* data = buf.get_array(n, sizeof(T));
+            if (ignore)
+                return;
+            store.resize(n);
+            read_column<BE>(data, store.data(), n);
+        }
+        else
+        {
+            boost::iostreams::stream<boost::iostreams::array_source>
+                s(buf.data() + buf.pos(), buf.size() - buf.pos());
+            s.exceptions(ios_base::badbit | ios_base::failbit |
+                         ios_base::eofbit);
+            if (ignore)
+            {
+                T y;
+                for (size_t i = 0; i < n; ++i)
+                    skip<BE>(s, y);
+            }
+            else
+            {
+                store.resize(n);
+                for (auto& x : store)
+                    read<BE>(s, x);
+            }
+            buf.get(s.tellg());
+            if (ignore)
+                return;
+        }
+        aprop = prop;
+    }
+};
+
+template <bool BE, class RangeTraits, class Graph>
+std::pair<std::string, boost::any>
+read_property_v1(Graph& g, const std::unordered_set<std::string>& ignore,
+                 size_t n, buffer_reader& buf)
+{
+    boost::any prop;
+    bool found = false;
+    std::string name;
+    buf.read<BE>(name);
+    bool skip = ignore.find(name) != ignore.end();
+    uint8_t val = 0;
+    buf.read<BE>(val);
+    mpl::for_each<val_types>(std::bind(read_property_v1_dispatch<BE, RangeTraits>(),
+                                       std::placeholders::_1, std::ref(g),
+                                       std::ref(prop), val, skip, n,
+                                       std::ref(found), std::ref(buf)));
+    if (!found)
+        throw IOException("Error reading graph: invalid property value type index "
+                          + boost::lexical_cast<std::string>(int(val)));
+    return make_pair(name, prop);
+}
+
+template <bool BE, class Graph>
+bool read_graph_v1_dispatch(buffer_reader& buf, Graph& g,
+                            std::vector<std::pair<std::string, boost::any>>& gprops,
+                            std::vector<std::pair<std::string, boost::any>>& vprops,
+                            std::vector<std::pair<std::string, boost::any>>& eprops,
+                            const std::unordered_set<std::string>& ignore_gp,
+                            const std::unordered_set<std::string>& ignore_vp,
+                            const std::unordered_set<std::string>& ignore_ep)
+{
+    uint8_t directed = false;
+    buf.read<BE>(directed);
+    uint64_t N = 0;
+    buf.read<BE>(N);
+
+    // every vertex takes at least the number of its out-neighbors
+    buf.check_array(buf.pos(), N, sizeof(uint64_t));
+
+    for (size_t i = 0; i < N; ++i)
+        add_vertex(g);
+
+    if (N <= numeric_limits<uint8_t>::max())
+        read_adjacency_v1_dispatch<BE, uint8_t>(g, N, buf);
+    else if (N <= numeric_limits<uint16_t>::max())
+        read_adjacency_v1_dispatch<BE, uint16_t>(g, N, buf);
+    else if (N <= numeric_limits<uint32_t>::max())
+        read_adjacency_v1_dispatch<BE, uint32_t>(g, N, buf);
+    else
+        read_adjacency_v1_dispatch<BE, uint64_t>(g, N, buf);
+
+    uint64_t nprops = 0;
+    buf.read<BE>(nprops);
+    for (size_t i = 0; i < nprops; ++i)
+    {
+        property_type pt;
+        buf.read<BE>(pt);
+        std::pair<std::string, boost::any> p;
+        switch (pt)
+        {
+        case property_type::Graph:
+            p = read_property_v1<BE, graph_range_traits>(g, ignore_gp, 1, buf);
+            if (!p.second.empty())
+                gprops.push_back(p);
+            break;
+        case property_type::Vertex:
+            p = read_property_v1<BE, vertex_range_traits>(g, ignore_vp, N,
+                                                          buf);
+            if (!p.second.empty())
+                vprops.push_back(p);
+            break;
+        case property_type::Edge:
+            p = read_property_v1<BE, edge_range_traits>(g, ignore_ep,
+                                                        num_edges(g), buf);
+            if (!p.second.empty())
+                eprops.push_back(p);
+            break;
+        default:
+            throw IOException("Error reading graph: invalid property type " +
+                              boost::lexical_cast<std::string>(uint8_t(pt)));
+        }
+    }
+    return directed;
+}
+
+template <class Graph>
+bool read_graph_v1(const char* data, size_t size, Graph& g,
+                   std::vector<std::pair<std::string, boost::any>>& gprops,
+                   std::vector<std::pair<std::string, boost::any>>& vprops,
+                   std::vector<std::pair<std::string, boost::any>>& eprops,
+                   const std::unordered_set<std::string>& ignore_gp,
+                   const std::unordered_set<std::string>& ignore_vp,
+                   const std::unordered_set<std::string>& ignore_ep)
+{
+    buffer_reader buf(data, size);
+    if (size < _magic_length ||
+        strncmp(buf.get(_magic_length), _magic, _magic_length) != 0)
+        throw IOException("Error reading graph: Invalid magic number");
+    uint8_t version = 0;
+    buf.read<false>(version);
+    if (version != _version)
+        throw IOException("Error reading graph: Invalid format version " +
+                          boost::lexical_cast<std::string>(version));
+    uint8_t big_end = 0;
+    buf.read<false>(big_end);
+    string comment;
+    buf.read<false>(comment);
+
+    if (big_end)
+        return read_graph_v1_dispatch<true>(buf, g, gprops, vprops, eprops,
+                                            ignore_gp, ignore_vp, ignore_ep);
+    else
+        return read_graph_v1_dispatch<false>(buf, g, gprops, vprops, eprops,
+                                             ignore_gp, ignore_vp, ignore_ep);
+}
+
 template <class Graph>
 bool read_graph(std::istream& s, Graph& g,
                 std::vector<std::pair<std::string, boost::any>>& gprops,
@@ -528,6 +1850,17 @@ bool read_graph(std::istream& s, Graph& g,
         throw IOException("Error reading graph: Invalid magic number");
     uint8_t version = 0;
     read<false>(s, version);
+    if (version == _version_v2)
+    {
+        // the sections are located by their absolute offsets, hence the whole
+        // file needs to be in memory if it cannot be mapped
+        std::string buf(magic, _magic_length);
+        buf.push_back(char(version));
+        buf.append(std::istreambuf_iterator<char>(s),
+                   std::istreambuf_iterator<char>());
+        return read_graph_v2(buf.data(), buf.size(), g, gprops, vprops, eprops,
+                             ignore_gp, ignore_vp, ignore_ep);
+    }
     if (version != _version)
         throw IOException("Error reading graph: Invalid format version " +
                           boost::lexical_cast<std::string>(version));
@@ -544,6 +1877,23 @@ bool read_graph(std::istream& s, Graph& g,
                                           ignore_vp, ignore_ep, s);
 }
 
+// reads from a contiguous buffer, in either version of the format
+template <class Graph>
+bool read_graph(const char* data, size_t size, Graph& g,
+                std::vector<std::pair<std::string, boost::any>>& gprops,
+                std::vector<std::pair<std::string, boost::any>>& vprops,
+                std::vector<std::pair<std::string, boost::any>>& eprops,
+                const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>(),
+                const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
+                const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>())
+{
+    if (get_version(data, size) == _version_v2)
+        return read_graph_v2(data, size, g, gprops, vprops, eprops, ignore_gp,
+                             ignore_vp, ignore_ep);
+    return read_graph_v1(data, size, g, gprops, vprops, eprops, ignore_gp,
+                         ignore_vp, ignore_ep);
+}
+
 } // namespace graph_tool
 
 #endif // GRAPH_IO_BINARY_HH
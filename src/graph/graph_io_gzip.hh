@@ -0,0 +1,274 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_IO_GZIP_HH
+#define GRAPH_IO_GZIP_HH
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include <boost/crc.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/operations.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include "graph_exceptions.hh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+// Blocked gzip files
+// ==================
+//
+// A blocked gzip file is a sequence of independently compressed gzip members,
+// each holding at most _gzip_block_size bytes of uncompressed data. Since
+// concatenated members are valid gzip, these files can be read by any gzip
+// implementation. Additionally, the header of every member has an extra field
+// (with subfield id "GT") which contains the total compressed size of the
+// member, so that all blocks can be located without decompressing them, and
+// then be compressed or decompressed in parallel. This is the same idea as
+// the BGZF format used in bioinformatics, but with larger blocks.
+
+constexpr size_t _gzip_block_size = 1 << 20;
+constexpr size_t _gzip_header_size = 20;
+constexpr size_t _gzip_footer_size = 8;
+
+inline void put_le32(char* p, uint32_t x)
+{
+    for (size_t i = 0; i < 4; ++i)
+        p[i] = char((x >> (8 * i)) & 0xff);
+}
+
+inline uint32_t get_le32(const char* p)
+{
+    uint32_t x = 0;
+    for (size_t i = 0; i < 4; ++i)
+        x |= uint32_t(uint8_t(p[i])) << (8 * i);
+    return x;
+}
+
+inline uint16_t get_le16(const char* p)
+{
+    return uint16_t(uint8_t(p[0])) | (uint16_t(uint8_t(p[1])) << 8);
+}
+
+// Compresses a single block into a complete gzip member.
+inline std::string gzip_compress_block(const char* data, size_t size,
+                                       int level)
+{
+    namespace io = boost::iostreams;
+
+    std::string out(_gzip_header_size, '\0');
+    const char header[] = {'\x1f', '\x8b', 8, 4, 0, 0, 0, 0, 0, '\xff',
+                           8, 0, 'G', 'T', 4, 0};
+    memcpy(&out[0], header, sizeof(header));
+
+    {
+        io::filtering_ostream os;
+        os.push(io::zlib_compressor(io::zlib_params(level, io::zlib::deflated,
+                                                    io::zlib::default_window_bits,
+                                                    io::zlib::default_mem_level,
+                                                    io::zlib::default_strategy,
+                                                    true)));
+        os.push(io::back_inserter(out));
+        os.write(data, size);
+    }
+
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    char footer[_gzip_footer_size];
+    put_le32(footer, crc.checksum());
+    put_le32(footer + 4, uint32_t(size));
+    out.append(footer, _gzip_footer_size);
+    put_le32(&out[_gzip_header_size - 4], uint32_t(out.size()));
+    return out;
+}
+
+// Output filter that produces a blocked gzip stream. Incoming data are
+// buffered until there is a block for every thread, and then they are all
+// compressed in parallel.
+class block_gzip_compressor
+{
+public:
+    typedef char char_type;
+    struct category
+        : boost::iostreams::output_filter_tag,
+          boost::iostreams::multichar_tag,
+          boost::iostreams::closable_tag
+    {};
+
+    block_gzip_compressor(int level = boost::iostreams::zlib::default_compression)
+        : _level(level) {}
+
+    template <class Sink>
+    std::streamsize write(Sink& sink, const char* s, std::streamsize n)
+    {
+        std::streamsize written = 0;
+        while (written < n)
+        {
+            size_t m = std::min(size_t(n - written),
+                                get_capacity() - _buf.size());
+            _buf.append(s + written, m);
+            written += m;
+            if (_buf.size() == get_capacity())
+                flush_blocks(sink);
+        }
+        return n;
+    }
+
+    template <class Sink>
+    void close(Sink& sink)
+    {
+        flush_blocks(sink);
+    }
+
+private:
+    static size_t get_capacity()
+    {
+#ifdef _OPENMP
+        return _gzip_block_size * omp_get_max_threads();
+#else
+        return _gzip_block_size;
+#endif
+    }
+
+    template <class Sink>
+    void flush_blocks(Sink& sink)
+    {
+        size_t nblocks = (_buf.size() + _gzip_block_size - 1) / _gzip_block_size;
+        std::vector<std::string> blocks(nblocks);
+        std::string err;
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < nblocks; ++i)
+        {
+            size_t pos = i * _gzip_block_size;
+            try
+            {
+                blocks[i] = gzip_compress_block(_buf.data() + pos,
+                                                std::min(_gzip_block_size,
+                                                         _buf.size() - pos),
+                                                _level);
+            }
+            catch (std::exception& e)
+            {
+                #pragma omp critical (block_gzip_compressor)
+                err = e.what();
+            }
+        }
+        if (!err.empty())
+            throw IOException("error compressing data: " + err);
+        for (auto& block : blocks)
+            boost::iostreams::write(sink, block.data(), block.size());
+        _buf.clear();
+    }
+
+    int _level;
+    std::string _buf;
+};
+
+// Returns the total size of the gzip member starting at the given position,
+// if it is a block of a blocked gzip file, or zero otherwise.
+inline size_t get_gzip_block_size(const char* data, size_t size)
+{
+    if (size < _gzip_header_size + _gzip_footer_size ||
+        uint8_t(data[0]) != 0x1f || uint8_t(data[1]) != 0x8b ||
+        data[2] != 8 || data[3] != 4 || get_le16(data + 10) != 8 ||
+        data[12] != 'G' || data[13] != 'T' || get_le16(data + 14) != 4)
+        return 0;
+    size_t bsize = get_le32(data + 16);
+    if (bsize < _gzip_header_size + _gzip_footer_size || bsize > size)
+        return 0;
+    return bsize;
+}
+
+inline bool is_block_gzip(const char* data, size_t size)
+{
+    return get_gzip_block_size(data, size) > 0;
+}
+
+// Decompresses a whole blocked gzip file, in parallel.
+inline std::string block_gzip_decompress(const char* data, size_t size)
+{
+    namespace io = boost::iostreams;
+
+    // locate the blocks
+    std::vector<size_t> offsets, out_offsets = {0};
+    size_t pos = 0;
+    while (pos < size)
+    {
+        size_t bsize = get_gzip_block_size(data + pos, size - pos);
+        if (bsize == 0)
+            throw IOException("error reading blocked gzip data: invalid block "
+                              "at offset " + std::to_string(pos));
+        offsets.push_back(pos);
+        pos += bsize;
+        out_offsets.push_back(out_offsets.back() +
+                              get_le32(data + pos - 4));
+    }
+    offsets.push_back(size);
+
+    std::string out(out_offsets.back(), '\0');
+    std::string err;
+    size_t nblocks = offsets.size() - 1;
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < nblocks; ++i)
+    {
+        const char* block = data + offsets[i];
+        size_t bsize = offsets[i + 1] - offsets[i];
+        size_t usize = out_offsets[i + 1] - out_offsets[i];
+        char* dst = &out[0] + out_offsets[i];
+        try
+        {
+            io::filtering_istream is;
+            is.push(io::zlib_decompressor(io::zlib_params(io::zlib::default_compression,
+                                                          io::zlib::deflated,
+                                                          io::zlib::default_window_bits,
+                                                          io::zlib::default_mem_level,
+                                                          io::zlib::default_strategy,
+                                                          true)));
+            is.push(io::array_source(block + _gzip_header_size,
+                                     bsize - _gzip_header_size - _gzip_footer_size));
+            is.read(dst, usize);
+            if (size_t(is.gcount()) != usize)
+                throw IOException("truncated block");
+            boost::crc_32_type crc;
+            crc.process_bytes(dst, usize);
+            if (crc.checksum() != get_le32(block + bsize - _gzip_footer_size))
+                throw IOException("checksum mismatch");
+        }
+        catch (std::exception& e)
+        {
+            #pragma omp critical (block_gzip_decompress)
+            err = e.what();
+        }
+    }
+    if (!err.empty())
+        throw IOException("error reading blocked gzip data: " + err);
+    return out;
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_IO_GZIP_HH
@@ -0,0 +1,2200 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_IO_PARALLEL_HH
+#define GRAPH_IO_PARALLEL_HH
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/property_map/dynamic_property_map.hpp>
+#include <boost/spirit/include/qi.hpp>
+#include <boost/graph/graphml.hpp>
+
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_util.hh"
+#include "base64.hh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+// Parallel readers of text formats
+// ================================
+//
+// GraphML, GML and DOT files are split into chunks at positions where a node
+// or edge record begins, which are then tokenized by all threads at once.
+// Each chunk yields its vertex references, edges and raw property values in
+// file order. These are then resolved into vertex indexes, converted into
+// typed property maps in parallel, and finally inserted in the graph in bulk.
+//
+// Only the commonly used subset of each format is handled. Whenever anything
+// else is found (including malformed input), the reader gives up and the
+// sequential parser is used instead, so that the semantics and the error
+// messages are always the same as those of the latter. The split positions
+// are only guesses, but they are validated: every chunk must be parsed until
+// its end, finishing in a state where a new record can begin. Since the first
+// chunk starts at a known position, by induction all splits are correct.
+//
+// Nothing is inserted in the graph or in the dynamic properties before the
+// whole input has been parsed and converted.
+
+constexpr size_t _text_chunk_size = 1 << 20;
+
+// thrown when the input cannot be handled by the parallel readers
+struct text_fallback {};
+
+// Splits [begin, end) into chunks, where find_next(p, end) returns the first
+// possible record boundary at or after p (or end).
+template <class Find>
+std::vector<const char*> split_text(const char* begin, const char* end,
+                                    Find&& find_next)
+{
+    size_t nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    size_t chunk = std::max(_text_chunk_size,
+                            size_t(end - begin) / (8 * nthreads));
+    std::vector<const char*> pos = {begin};
+    while (size_t(end - pos.back()) > chunk)
+    {
+        const char* p = find_next(pos.back() + chunk, end);
+        if (p == end)
+            break;
+        pos.push_back(p);
+    }
+    pos.push_back(end);
+    return pos;
+}
+
+// Runs f(i) for i in [0, n), in parallel. If any of the calls gives up, with
+// text_fallback or with a value which cannot be converted, text_fallback is
+// thrown after all of them are done. Any other exception (e.g. bad_alloc) is
+// passed on to the caller instead.
+template <class F>
+void parallel_text_loop(size_t n, F&& f, bool parallel = true)
+{
+    bool fallback = false;
+    std::exception_ptr error;
+    #pragma omp parallel for schedule(dynamic) if (parallel && n > 1)
+    for (size_t i = 0; i < n; ++i)
+    {
+        try
+        {
+            f(i);
+        }
+        catch (text_fallback&)
+        {
+            #pragma omp atomic write
+            fallback = true;
+        }
+        catch (boost::bad_lexical_cast&)
+        {
+            #pragma omp atomic write
+            fallback = true;
+        }
+        catch (...)
+        {
+            #pragma omp critical (parallel_text_loop)
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+    if (fallback)
+        throw text_fallback();
+}
+
+// Property values of a chunk, as (position, value) pairs in file order. The
+// position refers either to a vertex reference or to an edge of the chunk.
+template <class V>
+using text_column = std::vector<std::pair<size_t, V>>;
+
+// Converts the values of the given columns (one per chunk, possibly null),
+// and stores them at the positions given by get_index(c, pos). Later values
+// override earlier ones. If disjoint == true, no index appears in more than
+// one chunk, and the values are stored in parallel.
+template <class T, class V, class Convert, class GetIndex>
+void fill_text_column(std::vector<T>& store,
+                      const std::vector<const text_column<V>*>& cols,
+                      Convert&& convert, GetIndex&& get_index, bool disjoint)
+{
+    // python objects can only be created by the thread holding the GIL
+    constexpr bool parallel = !std::is_same<T, boost::python::object>::value;
+    if (disjoint && parallel)
+    {
+        parallel_text_loop(cols.size(),
+                           [&](size_t c)
+                           {
+                               if (cols[c] == nullptr)
+                                   return;
+                               for (auto& x : *cols[c])
+                                   store[get_index(c, x.first)] = convert(x.second);
+                           });
+        return;
+    }
+
+    std::vector<std::vector<T>> vals(cols.size());
+    parallel_text_loop(cols.size(),
+                       [&](size_t c)
+                       {
+                           if (cols[c] == nullptr)
+                               return;
+                           vals[c].reserve(cols[c]->size());
+                           for (auto& x : *cols[c])
+                               vals[c].push_back(convert(x.second));
+                       }, parallel);
+    for (size_t c = 0; c < cols.size(); ++c)
+    {
+        if (cols[c] == nullptr)
+            continue;
+        auto& col = *cols[c];
+        for (size_t i = 0; i < col.size(); ++i)
+            store[get_index(c, col[i].first)] = std::move(vals[c][i]);
+    }
+}
+
+template <class T, class IndexMap>
+typename property_map_type::apply<T, IndexMap>::type
+new_text_property(IndexMap index, size_t n)
+{
+    typename property_map_type::apply<T, IndexMap>::type pmap(index);
+    pmap.get_storage().resize(n);
+    return pmap;
+}
+
+// Assigns vertex indexes to the references of all chunks, in order of first
+// appearance. Afterwards, vmap[c][pos] is the vertex of each reference, and
+// keys[v] the key of each vertex.
+template <class Key>
+void resolve_text_vertices(const std::vector<const std::vector<Key>*>& refs,
+                           std::vector<std::vector<size_t>>& vmap,
+                           std::vector<Key>& keys)
+{
+    typedef typename std::conditional<std::is_same<Key, std::string>::value,
+                                      std::string_view, Key>::type hkey_t;
+    size_t n = refs.size();
+    std::vector<std::vector<size_t>> first(n);
+    vmap.resize(n);
+    parallel_text_loop(n,
+                       [&](size_t c)
+                       {
+                           std::unordered_map<hkey_t, size_t> local;
+                           auto& r = *refs[c];
+                           auto& m = vmap[c];
+                           m.resize(r.size());
+                           for (size_t i = 0; i < r.size(); ++i)
+                           {
+                               auto iter = local.find(hkey_t(r[i]));
+                               if (iter == local.end())
+                               {
+                                   iter = local.emplace(hkey_t(r[i]),
+                                                        first[c].size()).first;
+                                   first[c].push_back(i);
+                               }
+                               m[i] = iter->second;
+                           }
+                       });
+
+    std::unordered_map<hkey_t, size_t> global;
+    std::vector<std::vector<size_t>> gid(n);
+    for (size_t c = 0; c < n; ++c)
+    {
+        auto& r = *refs[c];
+        for (auto pos : first[c])
+        {
+            auto ret = global.emplace(hkey_t(r[pos]), keys.size());
+            if (ret.second)
+                keys.push_back(r[pos]);
+            gid[c].push_back(ret.first->second);
+        }
+    }
+
+    parallel_text_loop(n,
+                       [&](size_t c)
+                       {
+                           for (auto& v : vmap[c])
+                               v = gid[c][v];
+                       });
+}
+
+// Collects the edges of all chunks, given as the position of the reference
+// to their source (the target being the next one), into a single list.
+// Afterwards eoffset[c] contains the index of the first edge of each chunk.
+inline std::vector<std::pair<size_t, size_t>>
+collect_text_edges(const std::vector<const std::vector<size_t>*>& edges,
+                   const std::vector<std::vector<size_t>>& vmap,
+                   std::vector<size_t>& eoffset)
+{
+    eoffset.assign(edges.size() + 1, 0);
+    for (size_t c = 0; c < edges.size(); ++c)
+        eoffset[c + 1] = eoffset[c] + edges[c]->size();
+    std::vector<std::pair<size_t, size_t>> elist(eoffset.back());
+    parallel_text_loop(edges.size(),
+                       [&](size_t c)
+                       {
+                           auto& es = *edges[c];
+                           for (size_t i = 0; i < es.size(); ++i)
+                               elist[eoffset[c] + i] =
+                                   {vmap[c][es[i]], vmap[c][es[i] + 1]};
+                       });
+    return elist;
+}
+
+template <class Graph>
+void add_text_graph(Graph& g, size_t N,
+                    std::vector<std::pair<size_t, size_t>>& elist)
+{
+    for (size_t i = 0; i < N; ++i)
+        add_vertex(g);
+    add_edges(elist.begin(), elist.end(), g);
+}
+
+// Iterates over the chunk columns with the given key, creating an empty
+// entry for the chunks which do not have it.
+template <class Chunk, class Columns, class Key>
+auto get_text_columns(std::vector<Chunk>& chunks, Columns Chunk::* cols,
+                      const Key& key)
+{
+    std::vector<const typename Columns::mapped_type*> ret;
+    for (auto& chunk : chunks)
+    {
+        auto iter = (chunk.*cols).find(key);
+        ret.push_back((iter == (chunk.*cols).end()) ? nullptr : &iter->second);
+    }
+    return ret;
+}
+
+// GraphML
+// -------
+
+// Minimal XML scanner, which handles elements, attributes, character data,
+// entity and character references, comments, processing instructions and
+// CDATA sections. Tokens must finish before the end of the range.
+
+struct xml_token
+{
+    enum kind_t
+    {
+        Start,
+        End,
+        Text,
+        Eof
+    };
+
+    kind_t kind;
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> attrs;
+    bool empty;       // empty element tag, i.e. <name ... />
+    std::string_view text;
+    bool cdata;
+
+    const std::string* get_attr(const char* key) const
+    {
+        for (auto& a : attrs)
+            if (a.first == key)
+                return &a.second;
+        return nullptr;
+    }
+};
+
+inline bool is_xml_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline void append_utf8(std::string& out, uint32_t c)
+{
+    if (c < 0x80)
+    {
+        out += char(c);
+    }
+    else if (c < 0x800)
+    {
+        out += char(0xc0 | (c >> 6));
+        out += char(0x80 | (c & 0x3f));
+    }
+    else if (c < 0x10000)
+    {
+        out += char(0xe0 | (c >> 12));
+        out += char(0x80 | ((c >> 6) & 0x3f));
+        out += char(0x80 | (c & 0x3f));
+    }
+    else
+    {
+        out += char(0xf0 | (c >> 18));
+        out += char(0x80 | ((c >> 12) & 0x3f));
+        out += char(0x80 | ((c >> 6) & 0x3f));
+        out += char(0x80 | (c & 0x3f));
+    }
+}
+
+// Appends the decoded text to out, expanding references and normalizing line
+// ends, as well as white space if attr == true.
+inline void xml_decode(std::string_view s, std::string& out, bool attr)
+{
+    size_t i = 0;
+    while (i < s.size())
+    {
+        char c = s[i];
+        if (c == '&')
+        {
+            size_t j = s.find(';', i);
+            if (j == std::string_view::npos)
+                throw text_fallback();
+            std::string_view ref = s.substr(i + 1, j - i - 1);
+            if (ref == "lt")
+                out += '<';
+            else if (ref == "gt")
+                out += '>';
+            else if (ref == "amp")
+                out += '&';
+            else if (ref == "quot")
+                out += '"';
+            else if (ref == "apos")
+                out += '\'';
+            else if (ref.size() > 1 && ref[0] == '#')
+            {
+                bool hex = (ref[1] == 'x');
+                std::string_view num = ref.substr(hex ? 2 : 1);
+                if (num.empty() || num.size() > 8)
+                    throw text_fallback();
+                uint32_t x = 0;
+                for (char d : num)
+                {
+                    uint32_t k;
+                    if (d >= '0' && d <= '9')
+                        k = d - '0';
+                    else if (hex && d >= 'a' && d <= 'f')
+                        k = d - 'a' + 10;
+                    else if (hex && d >= 'A' && d <= 'F')
+                        k = d - 'A' + 10;
+                    else
+                        throw text_fallback();
+                    x = x * (hex ? 16 : 10) + k;
+                }
+                if (x == 0 || x > 0x10ffff || (x >= 0xd800 && x < 0xe000))
+                    throw text_fallback();
+                append_utf8(out, x);
+            }
+            else
+            {
+                throw text_fallback();
+            }
+            i = j + 1;
+            continue;
+        }
+        if (c == '\r')
+        {
+            out += attr ? ' ' : '\n';
+            if (i + 1 < s.size() && s[i + 1] == '\n')
+                ++i;
+        }
+        else if (attr && (c == '\n' || c == '\t'))
+        {
+            out += ' ';
+        }
+        else
+        {
+            out += c;
+        }
+        ++i;
+    }
+}
+
+class xml_scanner
+{
+public:
+    xml_scanner(const char* begin, const char* end)
+        : _p(begin), _end(end) {}
+
+    const char* pos() const { return _p; }
+
+    void next(xml_token& t)
+    {
+        while (true)
+        {
+            if (_p == _end)
+            {
+                t.kind = xml_token::Eof;
+                return;
+            }
+
+            if (*_p != '<')
+            {
+                const char* q = static_cast<const char*>(memchr(_p, '<', _end - _p));
+                if (q == nullptr)
+                    q = _end;
+                t.kind = xml_token::Text;
+                t.text = std::string_view(_p, q - _p);
+                t.cdata = false;
+                _p = q;
+                return;
+            }
+
+            std::string_view rest(_p, _end - _p);
+            if (rest.substr(0, 4) == "<!--")
+            {
+                _p = find(rest, "-->", 4);
+                continue;
+            }
+            if (rest.substr(0, 9) == "<![CDATA[")
+            {
+                const char* q = find(rest, "]]>", 9);
+                t.kind = xml_token::Text;
+                t.text = std::string_view(_p + 9, q - 3 - (_p + 9));
+                t.cdata = true;
+                _p = q;
+                return;
+            }
+            if (rest.substr(0, 2) == "<?")
+            {
+                const char* q = find(rest, "?>", 2);
+                check_declaration(std::string_view(_p, q - _p));
+                _p = q;
+                continue;
+            }
+            if (rest.substr(0, 2) == "<!")  // document type declarations
+                throw text_fallback();
+
+            if (rest.substr(0, 2) == "</")
+            {
+                _p += 2;
+                read_name(t.name);
+                skip_space();
+                if (_p == _end || *_p != '>')
+                    throw text_fallback();
+                ++_p;
+                t.kind = xml_token::End;
+                return;
+            }
+
+            ++_p;
+            read_name(t.name);
+            read_attrs(t);
+            t.kind = xml_token::Start;
+            return;
+        }
+    }
+
+private:
+    const char* find(std::string_view rest, const char* delim, size_t start)
+    {
+        size_t i = rest.find(delim, start);
+        if (i == std::string_view::npos)
+            throw text_fallback();
+        return _p + i + strlen(delim);
+    }
+
+    // only UTF-8 (or ASCII) input is handled
+    void check_declaration(std::string_view decl)
+    {
+        if (decl.substr(0, 5) != "<?xml")
+            return;
+        size_t i = decl.find("encoding");
+        if (i == std::string_view::npos)
+            return;
+        i = decl.find_first_of("\"'", i);
+        if (i == std::string_view::npos)
+            throw text_fallback();
+        size_t j = decl.find(decl[i], i + 1);
+        if (j == std::string_view::npos)
+            throw text_fallback();
+        std::string enc(decl.substr(i + 1, j - i - 1));
+        boost::algorithm::to_lower(enc);
+        if (enc != "utf-8" && enc != "us-ascii")
+            throw text_fallback();
+    }
+
+    void skip_space()
+    {
+        while (_p != _end && is_xml_space(*_p))
+            ++_p;
+    }
+
+    void read_name(std::string& name)
+    {
+        const char* q = _p;
+        while (q != _end && !is_xml_space(*q) && *q != '/' && *q != '>' &&
+               *q != '=' && *q != '<' && *q != '"' && *q != '\'')
+            ++q;
+        if (q == _p || q == _end)
+            throw text_fallback();
+        name.assign(_p, q);
+        _p = q;
+    }
+
+    void read_attrs(xml_token& t)
+    {
+        t.attrs.clear();
+        while (true)
+        {
+            skip_space();
+            if (_p == _end)
+                throw text_fallback();
+            if (*_p == '>')
+            {
+                ++_p;
+                t.empty = false;
+                return;
+            }
+            if (*_p == '/')
+            {
+                if (_p + 1 == _end || _p[1] != '>')
+                    throw text_fallback();
+                _p += 2;
+                t.empty = true;
+                return;
+            }
+
+            std::string name;
+            read_name(name);
+            skip_space();
+            if (_p == _end || *_p != '=')
+                throw text_fallback();
+            ++_p;
+            skip_space();
+            if (_p == _end || (*_p != '"' && *_p != '\''))
+                throw text_fallback();
+            const char* q = static_cast<const char*>(memchr(_p + 1, *_p,
+                                                            _end - _p - 1));
+            if (q == nullptr)
+                throw text_fallback();
+            std::string_view raw(_p + 1, q - _p - 1);
+            if (raw.find('<') != std::string_view::npos)
+                throw text_fallback();
+            _p = q + 1;
+
+            for (auto& a : t.attrs)
+                if (a.first == name)
+                    throw text_fallback();
+            t.attrs.emplace_back(std::move(name), std::string());
+            xml_decode(raw, t.attrs.back().second, true);
+
+            // elements in any namespace other than GraphML's are ignored by
+            // the sequential reader
+            if (t.attrs.back().first == "xmlns" &&
+                t.attrs.back().second != "http://graphml.graphdrawing.org/xmlns")
+                throw text_fallback();
+        }
+    }
+
+    const char* _p;
+    const char* _end;
+};
+
+inline void append_xml_text(const xml_token& t, std::string& out)
+{
+    if (t.cdata)
+        out.append(t.text.data(), t.text.size());
+    else
+        xml_decode(t.text, out, false);
+}
+
+struct graphml_key
+{
+    enum kind_t
+    {
+        graph_key,
+        node_key,
+        edge_key,
+        hyperedge_key,
+        port_key,
+        endpoint_key,
+        all_key
+    };
+
+    std::string name;
+    std::string type;
+    kind_t kind = all_key;
+    bool has_default = false;
+    std::string default_value;
+};
+
+struct graphml_header
+{
+    std::map<std::string, graphml_key> keys;
+    std::vector<std::pair<std::string, std::string>> gvals; // (key, value)
+    bool directed = false;
+    bool canonical_vertices = false;
+    bool canonical_edges = false;
+    const char* body = nullptr;
+};
+
+// Skips the content of an element which may only contain text.
+inline void skip_xml_element(xml_scanner& s, xml_token& t)
+{
+    std::string name = t.name;
+    if (t.empty)
+        return;
+    while (true)
+    {
+        s.next(t);
+        if (t.kind == xml_token::Text)
+            continue;
+        if (t.kind == xml_token::End && t.name == name)
+            return;
+        throw text_fallback();
+    }
+}
+
+// Reads the text content of an element, which may not contain children.
+inline void read_xml_text(xml_scanner& s, xml_token& t, std::string& text)
+{
+    std::string name = t.name;
+    text.clear();
+    if (t.empty)
+        return;
+    while (true)
+    {
+        s.next(t);
+        if (t.kind == xml_token::Text)
+        {
+            append_xml_text(t, text);
+            continue;
+        }
+        if (t.kind == xml_token::End && t.name == name)
+            return;
+        throw text_fallback();
+    }
+}
+
+// Reads everything up to the first node or edge.
+inline graphml_header read_graphml_header(const char* begin, const char* end)
+{
+    graphml_header h;
+    if (end - begin >= 2 && (uint8_t(begin[0]) == 0xfe ||
+                             uint8_t(begin[0]) == 0xff))  // UTF-16
+        throw text_fallback();
+    if (end - begin >= 3 && memcmp(begin, "\xef\xbb\xbf", 3) == 0)
+        begin += 3;
+
+    xml_scanner s(begin, end);
+    xml_token t;
+    bool in_graphml = false, in_graph = false;
+    graphml_key* key = nullptr;
+    std::string text;
+    while (true)
+    {
+        const char* pos = s.pos();
+        s.next(t);
+        switch (t.kind)
+        {
+        case xml_token::Eof:
+            throw text_fallback();
+        case xml_token::Text:
+            continue;
+        case xml_token::End:
+            if (t.name == "key" && key != nullptr)
+            {
+                key = nullptr;
+                continue;
+            }
+            throw text_fallback();
+        case xml_token::Start:
+            break;
+        }
+
+        if (t.name == "graphml" && !in_graphml)
+        {
+            in_graphml = true;
+            if (t.empty)
+                throw text_fallback();
+        }
+        else if (t.name == "desc")
+        {
+            skip_xml_element(s, t);
+        }
+        else if (t.name == "key" && in_graphml && key == nullptr)
+        {
+            auto id = t.get_attr("id");
+            if (id == nullptr || h.keys.find(*id) != h.keys.end())
+                throw text_fallback();
+            graphml_key& k = h.keys[*id];
+            if (auto name = t.get_attr("attr.name"))
+                k.name = *name;
+            if (auto type = t.get_attr("attr.type"))
+                k.type = *type;
+            if (auto kind = t.get_attr("for"))
+            {
+                static const char* kinds[] = {"graph", "node", "edge",
+                                              "hyperedge", "port", "endpoint",
+                                              "all"};
+                auto iter = std::find(kinds, kinds + 7, *kind);
+                if (iter == kinds + 7)
+                    throw text_fallback();
+                k.kind = graphml_key::kind_t(iter - kinds);
+            }
+            if (!t.empty)
+                key = &k;
+        }
+        else if (t.name == "default" && key != nullptr)
+        {
+            read_xml_text(s, t, key->default_value);
+            key->has_default = true;
+        }
+        else if (t.name == "graph" && in_graphml && !in_graph && key == nullptr)
+        {
+            in_graph = true;
+            if (t.empty)
+                throw text_fallback();
+            if (auto val = t.get_attr("edgedefault"))
+                h.directed = (*val == "directed");
+            if (auto val = t.get_attr("parse.nodeids"))
+                h.canonical_vertices = (*val == "canonical");
+            if (auto val = t.get_attr("parse.edgeids"))
+                h.canonical_edges = (*val == "canonical");
+        }
+        else if (t.name == "data" && in_graph && key == nullptr)
+        {
+            auto k = t.get_attr("key");
+            if (k == nullptr)
+                throw text_fallback();
+            std::string id = *k;
+            read_xml_text(s, t, text);
+            h.gvals.emplace_back(id, text);
+        }
+        else if ((t.name == "node" || t.name == "edge") && in_graph &&
+                 key == nullptr)
+        {
+            h.body = pos;
+            return h;
+        }
+        else
+        {
+            throw text_fallback();
+        }
+    }
+}
+
+inline const char* find_graphml_record(const char* p, const char* end)
+{
+    while (true)
+    {
+        p = static_cast<const char*>(memchr(p, '<', end - p));
+        if (p == nullptr || end - p < 6)
+            return end;
+        if ((memcmp(p + 1, "node", 4) == 0 || memcmp(p + 1, "edge", 4) == 0) &&
+            (is_xml_space(p[5]) || p[5] == '/' || p[5] == '>'))
+            return p;
+        ++p;
+    }
+}
+
+struct graphml_chunk
+{
+    std::vector<std::string> vrefs;    // vertex ids, in order of reference
+    std::vector<size_t> edges;         // position of the source in vrefs
+    std::vector<std::string> eids;
+    std::map<std::string, text_column<std::string>> vvals, evals; // by key id
+    bool directed = false;
+};
+
+// Parses a sequence of nodes and edges. If last == true, the chunk must
+// contain the end of the graph.
+inline void parse_graphml_chunk(const char* begin, const char* end, bool last,
+                                graphml_chunk& chunk)
+{
+    xml_scanner s(begin, end);
+    xml_token t;
+    std::string text;
+    bool done = false;
+    while (true)
+    {
+        s.next(t);
+        if (t.kind == xml_token::Eof)
+            break;
+        if (t.kind == xml_token::Text)
+        {
+            if (done && t.text.find_first_not_of(" \t\r\n") != std::string_view::npos)
+                throw text_fallback();
+            continue;
+        }
+        if (t.kind == xml_token::End)
+        {
+            if (!last || done || t.name != "graph")
+                throw text_fallback();
+            // the remainder may only close the document
+            s.next(t);
+            while (t.kind == xml_token::Text &&
+                   t.text.find_first_not_of(" \t\r\n") == std::string_view::npos)
+                s.next(t);
+            if (t.kind != xml_token::End || t.name != "graphml")
+                throw text_fallback();
+            done = true;
+            continue;
+        }
+        if (done)
+            throw text_fallback();
+
+        std::map<std::string, text_column<std::string>>* vals;
+        size_t pos;
+        if (t.name == "node")
+        {
+            auto id = t.get_attr("id");
+            chunk.vrefs.push_back((id == nullptr) ? std::string() : *id);
+            vals = &chunk.vvals;
+            pos = chunk.vrefs.size() - 1;
+        }
+        else if (t.name == "edge")
+        {
+            auto id = t.get_attr("id");
+            auto source = t.get_attr("source");
+            auto target = t.get_attr("target");
+            if (source == nullptr || target == nullptr)
+                throw text_fallback();
+            if (auto directed = t.get_attr("directed"))
+                chunk.directed = chunk.directed || (*directed == "directed");
+            chunk.edges.push_back(chunk.vrefs.size());
+            chunk.vrefs.push_back(*source);
+            chunk.vrefs.push_back(*target);
+            chunk.eids.push_back((id == nullptr) ? std::string() : *id);
+            vals = &chunk.evals;
+            pos = chunk.edges.size() - 1;
+        }
+        else if (t.name == "desc")
+        {
+            skip_xml_element(s, t);
+            continue;
+        }
+        else
+        {
+            throw text_fallback();
+        }
+
+        if (t.empty)
+            continue;
+        std::string name = t.name;
+        while (true)
+        {
+            s.next(t);
+            if (t.kind == xml_token::Text)
+                continue;
+            if (t.kind == xml_token::End && t.name == name)
+                break;
+            if (t.kind != xml_token::Start)
+                throw text_fallback();
+            if (t.name == "desc")
+            {
+                skip_xml_element(s, t);
+                continue;
+            }
+            if (t.name != "data")
+                throw text_fallback();
+            auto k = t.get_attr("key");
+            if (k == nullptr)
+                throw text_fallback();
+            auto& col = (*vals)[*k];
+            read_xml_text(s, t, text);
+            col.emplace_back(pos, text);
+        }
+    }
+    if (last && !done)
+        throw text_fallback();
+}
+
+// Converts a value in the same way as the sequential reader.
+template <class Value>
+Value graphml_value(const std::string& value, bool boolean)
+{
+    if constexpr (std::is_same<Value, uint8_t>::value)
+    {
+        if (boolean)
+        {
+            if (value == "true" || value == "True")
+                return 1;
+            if (value == "false" || value == "False")
+                return 0;
+        }
+        return uint8_t(boost::lexical_cast<int>(value));
+    }
+    else if constexpr (std::is_same<Value, boost::python::object>::value)
+    {
+        return boost::lexical_cast<Value>(base64_decode(value));
+    }
+    else
+    {
+        return boost::lexical_cast<Value>(value);
+    }
+}
+
+// Calls f(Value()) for the value type with the given GraphML name.
+template <class F>
+void dispatch_graphml_type(const std::string& type, F&& f)
+{
+    bool found = false;
+    mpl::for_each<prop_value_types>
+        ([&](auto x)
+         {
+             typedef decltype(x) Value;
+             if (type == prop_type_names[mpl::find<prop_value_types,
+                                                   Value>::type::pos::value])
+             {
+                 found = true;
+                 f(x);
+             }
+         });
+    if (!found)
+        throw text_fallback();
+}
+
+template <class Graph, class VertexIndex, class EdgeIndex>
+bool read_graphml_parallel(const char* data, size_t size, Graph& g,
+                           dynamic_properties& dp, VertexIndex vindex,
+                           EdgeIndex eindex,
+                           const std::unordered_set<std::string>& ignore_vp,
+                           const std::unordered_set<std::string>& ignore_ep,
+                           const std::unordered_set<std::string>& ignore_gp)
+{
+    graphml_header h = read_graphml_header(data, data + size);
+
+    auto bounds = split_text(h.body, data + size, find_graphml_record);
+    size_t nchunks = bounds.size() - 1;
+    std::vector<graphml_chunk> chunks(nchunks);
+    parallel_text_loop(nchunks,
+                       [&](size_t c)
+                       {
+                           parse_graphml_chunk(bounds[c], bounds[c + 1],
+                                               c == nchunks - 1, chunks[c]);
+                       });
+
+    bool directed = h.directed;
+    for (auto& chunk : chunks)
+        directed = directed || chunk.directed;
+
+    // vertices
+    std::vector<std::vector<size_t>> vmap(nchunks);
+    std::vector<std::string> vnames;
+    std::vector<uint8_t> vdefault;   // whether defaults were applied
+    size_t N;
+    if (h.canonical_vertices)
+    {
+        // the vertex index follows the first character of the id, and the
+        // defaults are only applied to the vertices which extend the range
+        std::vector<size_t> vmax(nchunks, 0);
+        parallel_text_loop(nchunks,
+                           [&](size_t c)
+                           {
+                               auto& r = chunks[c].vrefs;
+                               auto& m = vmap[c];
+                               m.resize(r.size());
+                               for (size_t i = 0; i < r.size(); ++i)
+                               {
+                                   auto& id = r[i];
+                                   if (id.size() < 2 || id.size() > 19)
+                                       throw text_fallback();
+                                   size_t v = 0;
+                                   for (size_t j = 1; j < id.size(); ++j)
+                                   {
+                                       if (id[j] < '0' || id[j] > '9')
+                                           throw text_fallback();
+                                       v = v * 10 + (id[j] - '0');
+                                   }
+                                   m[i] = v;
+                                   vmax[c] = std::max(vmax[c], v + 1);
+                               }
+                           });
+        std::vector<size_t> vprev(nchunks, 0);
+        for (size_t c = 1; c < nchunks; ++c)
+            vprev[c] = std::max(vprev[c - 1], vmax[c - 1]);
+        N = std::max(vprev.back(), vmax.back());
+        vdefault.resize(N, false);
+        parallel_text_loop(nchunks,
+                           [&](size_t c)
+                           {
+                               size_t n = vprev[c];
+                               for (auto v : vmap[c])
+                               {
+                                   if (v >= n)
+                                   {
+                                       vdefault[v] = true;
+                                       n = v + 1;
+                                   }
+                               }
+                           });
+    }
+    else
+    {
+        std::vector<const std::vector<std::string>*> refs;
+        for (auto& chunk : chunks)
+            refs.push_back(&chunk.vrefs);
+        resolve_text_vertices(refs, vmap, vnames);
+        N = vnames.size();
+        vdefault.resize(N, true);
+    }
+
+    std::vector<const std::vector<size_t>*> cedges;
+    for (auto& chunk : chunks)
+        cedges.push_back(&chunk.edges);
+    std::vector<size_t> eoffset;
+    auto elist = collect_text_edges(cedges, vmap, eoffset);
+    size_t E = elist.size();
+
+    // property maps, which are only inserted at the very end
+    std::vector<std::function<void()>> vprops, eprops;
+    std::map<std::string, std::function<void()>> gprops;
+
+    std::set<std::string> vkeys, ekeys;
+    for (auto& chunk : chunks)
+    {
+        for (auto& kv : chunk.vvals)
+            vkeys.insert(kv.first);
+        for (auto& kv : chunk.evals)
+            ekeys.insert(kv.first);
+    }
+    for (auto& kv : h.keys)
+    {
+        if (kv.second.has_default && kv.second.kind == graphml_key::node_key &&
+            N > 0)
+            vkeys.insert(kv.first);
+        if (kv.second.has_default && kv.second.kind == graphml_key::edge_key &&
+            E > 0)
+            ekeys.insert(kv.first);
+    }
+
+    std::unordered_set<std::string> vnames_used = {"_graphml_vertex_id"};
+    for (auto& id : vkeys)
+    {
+        auto iter = h.keys.find(id);
+        if (iter == h.keys.end())
+            throw text_fallback();
+        auto& key = iter->second;
+        if (ignore_vp.find(key.name) != ignore_vp.end())
+            continue;
+        if (!vnames_used.insert(key.name).second)
+            throw text_fallback();
+        dispatch_graphml_type
+            (key.type,
+             [&](auto x)
+             {
+                 typedef decltype(x) Value;
+                 bool boolean = (key.type == "boolean");
+                 auto pmap = new_text_property<Value>(vindex, N);
+                 auto& store = pmap.get_storage();
+                 if (key.has_default && key.kind == graphml_key::node_key)
+                 {
+                     Value val;
+                     try
+                     {
+                         val = graphml_value<Value>(key.default_value, boolean);
+                     }
+                     catch (boost::bad_lexical_cast&)
+                     {
+                         throw text_fallback();
+                     }
+                     for (size_t v = 0; v < N; ++v)
+                         if (vdefault[v])
+                             store[v] = val;
+                 }
+                 fill_text_column(store,
+                                  get_text_columns(chunks, &graphml_chunk::vvals, id),
+                                  [&](auto& s) { return graphml_value<Value>(s, boolean); },
+                                  [&](size_t c, size_t pos) { return vmap[c][pos]; },
+                                  false);
+                 vprops.push_back([&dp, name = key.name, pmap]
+                                  { dp.property(name, pmap); });
+             });
+    }
+
+    std::unordered_set<std::string> enames_used = {"_graphml_edge_id"};
+    for (auto& id : ekeys)
+    {
+        auto iter = h.keys.find(id);
+        if (iter == h.keys.end())
+            throw text_fallback();
+        auto& key = iter->second;
+        if (ignore_ep.find(key.name) != ignore_ep.end())
+            continue;
+        if (!enames_used.insert(key.name).second)
+            throw text_fallback();
+        dispatch_graphml_type
+            (key.type,
+             [&](auto x)
+             {
+                 typedef decltype(x) Value;
+                 bool boolean = (key.type == "boolean");
+                 auto pmap = new_text_property<Value>(eindex, E);
+                 auto& store = pmap.get_storage();
+                 if (key.has_default && key.kind == graphml_key::edge_key)
+                 {
+                     Value val;
+                     try
+                     {
+                         val = graphml_value<Value>(key.default_value, boolean);
+                     }
+                     catch (boost::bad_lexical_cast&)
+                     {
+                         throw text_fallback();
+                     }
+                     std::fill(store.begin(), store.end(), val);
+                 }
+                 fill_text_column(store,
+                                  get_text_columns(chunks, &graphml_chunk::evals, id),
+                                  [&](auto& s) { return graphml_value<Value>(s, boolean); },
+                                  [&](size_t c, size_t pos) { return eoffset[c] + pos; },
+                                  true);
+                 eprops.push_back([&dp, name = key.name, pmap]
+                                  { dp.property(name, pmap); });
+             });
+    }
+
+    if (!h.canonical_vertices && N > 0 &&
+        ignore_vp.find("_graphml_vertex_id") == ignore_vp.end())
+    {
+        auto pmap = new_text_property<std::string>(vindex, N);
+        pmap.get_storage() = std::move(vnames);
+        vprops.push_back([&dp, pmap]
+                         { dp.property("_graphml_vertex_id", pmap); });
+    }
+
+    if (!h.canonical_edges && E > 0 &&
+        ignore_ep.find("_graphml_edge_id") == ignore_ep.end())
+    {
+        auto pmap = new_text_property<std::string>(eindex, E);
+        auto& store = pmap.get_storage();
+        parallel_text_loop(nchunks,
+                           [&](size_t c)
+                           {
+                               auto& eids = chunks[c].eids;
+                               for (size_t i = 0; i < eids.size(); ++i)
+                                   store[eoffset[c] + i] = std::move(eids[i]);
+                           });
+        eprops.push_back([&dp, pmap]
+                         { dp.property("_graphml_edge_id", pmap); });
+    }
+
+    ConstantPropertyMap<size_t, graph_property_tag> gindex(0);
+    std::map<std::string, std::string> gtypes;
+    for (auto& kv : h.gvals)
+    {
+        auto iter = h.keys.find(kv.first);
+        if (iter == h.keys.end())
+            throw text_fallback();
+        auto& key = iter->second;
+        if (ignore_gp.find(key.name) != ignore_gp.end())
+            continue;
+        auto titer = gtypes.find(key.name);
+        if (titer != gtypes.end() && titer->second != key.type)
+            throw text_fallback();
+        gtypes[key.name] = key.type;
+        dispatch_graphml_type
+            (key.type,
+             [&](auto x)
+             {
+                 typedef decltype(x) Value;
+                 auto pmap = new_text_property<Value>(gindex, 1);
+                 try
+                 {
+                     pmap.get_storage()[0] =
+                         graphml_value<Value>(kv.second, key.type == "boolean");
+                 }
+                 catch (boost::bad_lexical_cast&)
+                 {
+                     throw text_fallback();
+                 }
+                 gprops[key.name] = [&dp, name = key.name, pmap]
+                                    { dp.property(name, pmap); };
+             });
+    }
+
+    // everything went fine; now the graph can be built
+    add_text_graph(g, N, elist);
+    for (auto& f : vprops)
+        f();
+    for (auto& f : eprops)
+        f();
+    for (auto& p : gprops)
+        p.second();
+    return directed;
+}
+
+// GML
+// ---
+
+struct gml_value
+{
+    bool is_string = false;
+    double number = 0;
+    std::string str;
+};
+
+inline bool is_gml_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+        c == '\f';
+}
+
+// Tokenizer for GML, which mirrors the grammar in gml.hh. Anything which it
+// cannot parse unambiguously results in text_fallback.
+class gml_scanner
+{
+public:
+    gml_scanner(const char* begin, const char* end)
+        : _p(begin), _end(end) {}
+
+    const char* pos() const { return _p; }
+
+    // skips white space and comments, and returns false at the end
+    bool skip()
+    {
+        while (_p != _end)
+        {
+            if (is_gml_space(*_p))
+            {
+                ++_p;
+            }
+            else if (*_p == '#')
+            {
+                // comments must be terminated by a line end
+                while (_p != _end && *_p != '\n' && *_p != '\r')
+                {
+                    if (uint8_t(*_p) >= 0x80)
+                        throw text_fallback();
+                    ++_p;
+                }
+                if (_p == _end)
+                    throw text_fallback();
+            }
+            else
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool peek(char c)
+    {
+        return skip() && *_p == c;
+    }
+
+    void expect(char c)
+    {
+        if (!peek(c))
+            throw text_fallback();
+        ++_p;
+    }
+
+    void read_key(std::string& key)
+    {
+        if (!skip())
+            throw text_fallback();
+        const char* q = _p;
+        while (q != _end && (isalnum(uint8_t(*q)) || *q == '_' || *q == '-'))
+            ++q;
+        if (q == _p)
+            throw text_fallback();
+        key.assign(_p, q);
+        _p = q;
+    }
+
+    // reads a value, or returns false if a list follows
+    bool read_value(gml_value& val)
+    {
+        if (!skip())
+            throw text_fallback();
+        if (*_p == '[')
+        {
+            ++_p;
+            return false;
+        }
+        if (*_p == '"')
+        {
+            val.is_string = true;
+            val.str.clear();
+            ++_p;
+            while (true)
+            {
+                if (_p == _end)
+                    throw text_fallback();
+                char c = *_p;
+                if (c == '"')
+                    break;
+                if (uint8_t(c) >= 0x80 || (!isgraph(uint8_t(c)) &&
+                                           !is_gml_space(c)))
+                    throw text_fallback();
+                if (c == '\\' && _p + 1 != _end)
+                {
+                    const char* esc = strchr("abfnrtv\\'\"", _p[1]);
+                    if (_p[1] != '\0' && esc != nullptr)
+                    {
+                        static const char vals[] = "\a\b\f\n\r\t\v\\'\"";
+                        val.str += vals[esc - "abfnrtv\\'\""];
+                        _p += 2;
+                        continue;
+                    }
+                }
+                val.str += c;
+                ++_p;
+            }
+            ++_p;
+            return true;
+        }
+        val.is_string = false;
+        const char* q = _p;
+        if (!boost::spirit::qi::parse(q, _end, boost::spirit::qi::double_,
+                                      val.number))
+            throw text_fallback();
+        if (q != _end && !is_gml_space(*q) && *q != '[' && *q != ']' &&
+            *q != '"' && *q != '#')
+            throw text_fallback();
+        _p = q;
+        return true;
+    }
+
+private:
+    const char* _p;
+    const char* _end;
+};
+
+// Reads the top-level entries up to the opening of the graph list.
+inline const char* read_gml_header(const char* begin, const char* end)
+{
+    gml_scanner s(begin, end);
+    std::string key;
+    gml_value val;
+    while (true)
+    {
+        s.read_key(key);
+        if (!s.read_value(val))
+        {
+            if (key != "graph")
+                throw text_fallback();
+            return s.pos();
+        }
+    }
+}
+
+inline const char* find_gml_record(const char* p, const char* end)
+{
+    while (true)
+    {
+        p = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (p == nullptr)
+            return end;
+        ++p;
+        const char* q = p;
+        while (q != end && (*q == ' ' || *q == '\t'))
+            ++q;
+        if (end - q > 4 &&
+            (memcmp(q, "node", 4) == 0 || memcmp(q, "edge", 4) == 0) &&
+            (is_gml_space(q[4]) || q[4] == '['))
+            return q;
+    }
+}
+
+struct gml_chunk
+{
+    std::vector<int> vrefs;
+    std::vector<size_t> edges;
+    std::map<std::string, text_column<double>> vnums, enums;
+    std::map<std::string, text_column<std::string>> vstrs, estrs;
+    std::vector<std::pair<std::string, gml_value>> gvals;
+};
+
+inline int gml_vertex_id(const gml_value& val)
+{
+    if (val.is_string || !(val.number >= std::numeric_limits<int>::min() &&
+                           val.number < double(std::numeric_limits<int>::max()) + 1))
+        throw text_fallback();
+    return int(val.number);
+}
+
+// Parses the entries of the graph list. If last == true, the chunk must
+// contain its end.
+inline void parse_gml_chunk(const char* begin, const char* end, bool last,
+                            gml_chunk& chunk)
+{
+    gml_scanner s(begin, end);
+    std::string key;
+    gml_value val;
+    std::vector<std::pair<std::string, gml_value>> record;
+    while (s.skip())
+    {
+        if (s.peek(']'))
+        {
+            if (!last)
+                throw text_fallback();
+            s.expect(']');
+            // only top-level entries may follow
+            while (s.skip())
+            {
+                s.read_key(key);
+                if (!s.read_value(val))
+                    throw text_fallback();
+            }
+            return;
+        }
+
+        s.read_key(key);
+        if (s.read_value(val))
+        {
+            chunk.gvals.emplace_back(key, val);
+            continue;
+        }
+        if (key != "node" && key != "edge")
+            throw text_fallback();
+
+        record.clear();
+        while (!s.peek(']'))
+        {
+            record.emplace_back();
+            s.read_key(record.back().first);
+            if (!s.read_value(record.back().second))
+                throw text_fallback();
+        }
+        s.expect(']');
+
+        // the last value of a repeated key prevails
+        auto find = [&](const char* k) -> const gml_value*
+            {
+                for (auto iter = record.rbegin(); iter != record.rend(); ++iter)
+                    if (iter->first == k)
+                        return &iter->second;
+                return nullptr;
+            };
+
+        size_t pos;
+        if (key == "node")
+        {
+            auto id = find("id");
+            if (id == nullptr)
+                throw text_fallback();
+            pos = chunk.vrefs.size();
+            chunk.vrefs.push_back(gml_vertex_id(*id));
+        }
+        else
+        {
+            auto source = find("source");
+            auto target = find("target");
+            if (source == nullptr || target == nullptr)
+                throw text_fallback();
+            chunk.edges.push_back(chunk.vrefs.size());
+            chunk.vrefs.push_back(gml_vertex_id(*source));
+            chunk.vrefs.push_back(gml_vertex_id(*target));
+            pos = chunk.edges.size() - 1;
+        }
+
+        for (size_t i = 0; i < record.size(); ++i)
+        {
+            auto& k = record[i].first;
+            if (k == "id" || (key == "edge" && (k == "source" || k == "target")))
+                continue;
+            if (find(k.c_str()) != &record[i].second)
+                continue;
+            auto& v = record[i].second;
+            if (key == "node")
+            {
+                if (v.is_string)
+                    chunk.vstrs[k].emplace_back(pos, std::move(v.str));
+                else
+                    chunk.vnums[k].emplace_back(pos, v.number);
+            }
+            else
+            {
+                if (v.is_string)
+                    chunk.estrs[k].emplace_back(pos, std::move(v.str));
+                else
+                    chunk.enums[k].emplace_back(pos, v.number);
+            }
+        }
+    }
+    if (last)
+        throw text_fallback();
+}
+
+template <class Graph, class VertexIndex, class EdgeIndex>
+bool read_gml_parallel(const char* data, size_t size, Graph& g,
+                       dynamic_properties& dp, VertexIndex vindex,
+                       EdgeIndex eindex,
+                       const std::unordered_set<std::string>& ignore_vp,
+                       const std::unordered_set<std::string>& ignore_ep,
+                       const std::unordered_set<std::string>& ignore_gp)
+{
+    const char* body = read_gml_header(data, data + size);
+
+    auto bounds = split_text(body, data + size, find_gml_record);
+    size_t nchunks = bounds.size() - 1;
+    std::vector<gml_chunk> chunks(nchunks);
+    parallel_text_loop(nchunks,
+                       [&](size_t c)
+                       {
+                           parse_gml_chunk(bounds[c], bounds[c + 1],
+                                           c == nchunks - 1, chunks[c]);
+                       });
+
+    std::vector<const std::vector<int>*> refs;
+    std::vector<const std::vector<size_t>*> cedges;
+    for (auto& chunk : chunks)
+    {
+        refs.push_back(&chunk.vrefs);
+        cedges.push_back(&chunk.edges);
+    }
+    std::vector<std::vector<size_t>> vmap;
+    std::vector<int> ids;
+    resolve_text_vertices(refs, vmap, ids);
+    size_t N = ids.size();
+    std::vector<size_t> eoffset;
+    auto elist = collect_text_edges(cedges, vmap, eoffset);
+    size_t E = elist.size();
+
+    // property maps, which are only inserted at the very end
+    std::vector<std::function<void()>> props;
+    auto identity = [](auto& x) { return x; };
+
+    auto add_props = [&](auto nums, auto strs, auto index, size_t n,
+                         const std::unordered_set<std::string>& ignore,
+                         auto&& get_index, bool disjoint)
+        {
+            std::set<std::string> knum, kstr;
+            for (auto& chunk : chunks)
+            {
+                for (auto& kv : chunk.*nums)
+                    knum.insert(kv.first);
+                for (auto& kv : chunk.*strs)
+                    kstr.insert(kv.first);
+            }
+            for (auto& k : knum)
+            {
+                if (ignore.find(k) != ignore.end())
+                    continue;
+                if (kstr.find(k) != kstr.end())
+                    throw text_fallback();
+                auto pmap = new_text_property<double>(index, n);
+                fill_text_column(pmap.get_storage(),
+                                 get_text_columns(chunks, nums, k), identity,
+                                 get_index, disjoint);
+                props.push_back([&dp, k, pmap] { dp.property(k, pmap); });
+            }
+            for (auto& k : kstr)
+            {
+                if (ignore.find(k) != ignore.end())
+                    continue;
+                auto pmap = new_text_property<std::string>(index, n);
+                fill_text_column(pmap.get_storage(),
+                                 get_text_columns(chunks, strs, k), identity,
+                                 get_index, disjoint);
+                props.push_back([&dp, k, pmap] { dp.property(k, pmap); });
+            }
+        };
+
+    add_props(&gml_chunk::vnums, &gml_chunk::vstrs, vindex, N, ignore_vp,
+              [&](size_t c, size_t pos) { return vmap[c][pos]; }, false);
+    add_props(&gml_chunk::enums, &gml_chunk::estrs, eindex, E, ignore_ep,
+              [&](size_t c, size_t pos) { return eoffset[c] + pos; }, true);
+
+    std::map<std::string, const gml_value*> gvals;
+    for (auto& chunk : chunks)
+        for (auto& kv : chunk.gvals)
+            gvals[kv.first] = &kv.second;
+
+    bool directed = false;
+    ConstantPropertyMap<size_t, graph_property_tag> gindex(0);
+    for (auto& kv : gvals)
+    {
+        auto& k = kv.first;
+        auto& val = *kv.second;
+        if (k == "directed")
+        {
+            if (val.is_string)
+                throw text_fallback();
+            directed = val.number;
+        }
+        if (ignore_gp.find(k) != ignore_gp.end())
+            continue;
+        if (val.is_string)
+        {
+            auto pmap = new_text_property<std::string>(gindex, 1);
+            pmap.get_storage()[0] = val.str;
+            props.push_back([&dp, k, pmap] { dp.property(k, pmap); });
+        }
+        else
+        {
+            auto pmap = new_text_property<double>(gindex, 1);
+            pmap.get_storage()[0] = val.number;
+            props.push_back([&dp, k, pmap] { dp.property(k, pmap); });
+        }
+    }
+
+    // everything went fine; now the graph can be built
+    add_text_graph(g, N, elist);
+    for (auto& f : props)
+        f();
+    return directed;
+}
+
+// DOT
+// ---
+
+// Only flat graphs are handled, i.e. node and edge statements, graph
+// attributes, and attribute lists. Subgraphs, default attribute statements,
+// ports, string concatenation, HTML strings and comments are left to the
+// sequential parser.
+
+struct dot_token
+{
+    enum kind_t
+    {
+        Id,
+        Keyword,
+        Punct,
+        Edge,   // "->" or "--"
+        Eof
+    };
+
+    kind_t kind;
+    char punct;  // punctuation character, or '>' and '-' for edge operators
+    std::string value;
+};
+
+class dot_scanner
+{
+public:
+    dot_scanner(const char* begin, const char* end)
+        : _p(begin), _end(end) {}
+
+    const char* pos() const { return _p; }
+
+    const dot_token& peek()
+    {
+        if (!_has_peek)
+        {
+            read(_peek);
+            _has_peek = true;
+        }
+        return _peek;
+    }
+
+    void next(dot_token& t)
+    {
+        peek();
+        std::swap(t, _peek);
+        _has_peek = false;
+    }
+
+    // returns true if the next token is the given punctuation
+    bool peek(char c)
+    {
+        auto& t = peek();
+        return t.kind == dot_token::Punct && t.punct == c;
+    }
+
+    void expect(char c)
+    {
+        if (!peek(c))
+            throw text_fallback();
+        _has_peek = false;
+    }
+
+private:
+    static bool is_word(char c)
+    {
+        return isalnum(uint8_t(c)) || c == '_';
+    }
+
+    void read(dot_token& t)
+    {
+        while (_p != _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' ||
+                              *_p == '\r' || *_p == '\v' || *_p == '\f'))
+            ++_p;
+        if (_p == _end)
+        {
+            t.kind = dot_token::Eof;
+            return;
+        }
+
+        char c = *_p;
+        if (isalpha(uint8_t(c)) || c == '_')
+        {
+            const char* q = _p;
+            while (q != _end && is_word(*q))
+                ++q;
+            t.value.assign(_p, q);
+            _p = q;
+            std::string lower = boost::algorithm::to_lower_copy(t.value);
+            t.kind = (lower == "strict" || lower == "graph" ||
+                      lower == "digraph" || lower == "node" ||
+                      lower == "edge" || lower == "subgraph") ?
+                dot_token::Keyword : dot_token::Id;
+            if (t.kind == dot_token::Keyword)
+                t.value = lower;
+            return;
+        }
+
+        if (strchr("[]{};=,:()@", c) != nullptr && c != '\0')
+        {
+            t.kind = dot_token::Punct;
+            t.punct = c;
+            ++_p;
+            return;
+        }
+
+        if (c == '-' && _p + 1 != _end && (_p[1] == '>' || _p[1] == '-'))
+        {
+            t.kind = dot_token::Edge;
+            t.punct = _p[1];
+            _p += 2;
+            return;
+        }
+
+        if (c == '-' || c == '.' || isdigit(uint8_t(c)))
+        {
+            const char* q = _p;
+            if (*q == '-')
+                ++q;
+            const char* digits = q;
+            while (q != _end && isdigit(uint8_t(*q)))
+                ++q;
+            bool int_part = (q != digits);
+            if (q != _end && *q == '.')
+            {
+                ++q;
+                const char* frac = q;
+                while (q != _end && isdigit(uint8_t(*q)))
+                    ++q;
+                if (!int_part && q == frac)
+                    throw text_fallback();
+            }
+            else if (!int_part)
+            {
+                throw text_fallback();
+            }
+            // numbers must be delimited, since otherwise they are split in
+            // more than one token
+            if (q != _end && (is_word(*q) || *q == '.'))
+                throw text_fallback();
+            t.kind = dot_token::Id;
+            t.value.assign(_p, q);
+            _p = q;
+            return;
+        }
+
+        if (c == '"')
+        {
+            const char* q = _p + 1;
+            while (q != _end && *q != '"')
+            {
+                if (*q == '\\')
+                {
+                    ++q;
+                    if (q == _end)
+                        break;
+                }
+                ++q;
+            }
+            if (q == _end)
+                throw text_fallback();
+            t.kind = dot_token::Id;
+            t.value.clear();
+            for (const char* r = _p + 1; r != q; ++r)
+            {
+                if (*r == '\\' && r + 1 != q && r[1] == '"')
+                    continue;
+                if (*r == '\\' && r + 1 != q && r[1] == '\n')
+                {
+                    ++r;
+                    continue;
+                }
+                t.value += *r;
+            }
+            _p = q + 1;
+            return;
+        }
+
+        // comments, string concatenation, HTML strings and invalid input
+        throw text_fallback();
+    }
+
+    const char* _p;
+    const char* _end;
+    dot_token _peek;
+    bool _has_peek = false;
+};
+
+// Reads the graph header, and returns whether the graph is directed, and the
+// position of the body.
+inline std::pair<bool, const char*>
+read_dot_header(const char* begin, const char* end)
+{
+    dot_scanner s(begin, end);
+    dot_token t;
+    s.next(t);
+    if (t.kind != dot_token::Keyword ||
+        (t.value != "graph" && t.value != "digraph"))
+        throw text_fallback();
+    bool directed = (t.value == "digraph");
+    if (s.peek().kind == dot_token::Id)
+        s.next(t);
+    s.expect('{');
+    return {directed, s.pos()};
+}
+
+inline const char* find_dot_record(const char* p, const char* end)
+{
+    while (true)
+    {
+        p = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (p == nullptr)
+            return end;
+        ++p;
+        while (p != end && (*p == ' ' || *p == '\t'))
+            ++p;
+        if (p != end && (isalnum(uint8_t(*p)) || *p == '_' || *p == '"'))
+            return p;
+    }
+}
+
+struct dot_chunk
+{
+    std::vector<std::string> vrefs;
+    std::vector<size_t> edges;
+    std::map<std::string, text_column<std::string>> vvals, evals;
+    bool has_gprops = false;
+};
+
+inline void parse_dot_attrs(dot_scanner& s,
+                            std::vector<std::pair<std::string, std::string>>& attrs)
+{
+    attrs.clear();
+    dot_token t;
+    while (s.peek('['))
+    {
+        s.expect('[');
+        while (!s.peek(']'))
+        {
+            s.next(t);
+            if (t.kind != dot_token::Id)
+                throw text_fallback();
+            std::string name = std::move(t.value);
+            std::string value = "true";
+            if (s.peek('='))
+            {
+                s.expect('=');
+                s.next(t);
+                if (t.kind != dot_token::Id)
+                    throw text_fallback();
+                value = std::move(t.value);
+            }
+            attrs.emplace_back(std::move(name), std::move(value));
+            if (!s.peek(','))
+                break;
+            s.expect(',');
+        }
+        s.expect(']');
+    }
+}
+
+// Parses a sequence of statements. If last == true, the chunk must contain
+// the end of the graph.
+inline void parse_dot_chunk(const char* begin, const char* end, bool last,
+                            bool directed, dot_chunk& chunk)
+{
+    dot_scanner s(begin, end);
+    dot_token t;
+    std::vector<std::pair<std::string, std::string>> attrs;
+    while (true)
+    {
+        auto& next = s.peek();
+        if (next.kind == dot_token::Eof)
+        {
+            if (last)
+                throw text_fallback();
+            return;
+        }
+        if (next.kind == dot_token::Punct && next.punct == '}')
+        {
+            if (!last)
+                throw text_fallback();
+            s.expect('}');
+            if (s.peek().kind != dot_token::Eof)
+                throw text_fallback();
+            return;
+        }
+        if (next.kind == dot_token::Keyword)
+        {
+            if (next.value != "graph")
+                throw text_fallback();
+            s.next(t);
+            parse_dot_attrs(s, attrs);
+            chunk.has_gprops = chunk.has_gprops || !attrs.empty();
+        }
+        else if (next.kind == dot_token::Id)
+        {
+            s.next(t);
+            if (s.peek('='))
+            {
+                s.expect('=');
+                if (s.peek().kind != dot_token::Id)
+                    throw text_fallback();
+                s.next(t);
+                chunk.has_gprops = true;
+            }
+            else
+            {
+                size_t pos = chunk.vrefs.size();
+                chunk.vrefs.push_back(std::move(t.value));
+                size_t nedges = 0;
+                while (s.peek().kind == dot_token::Edge)
+                {
+                    s.next(t);
+                    if ((t.punct == '>') != directed)
+                        throw text_fallback();
+                    s.next(t);
+                    if (t.kind != dot_token::Id)
+                        throw text_fallback();
+                    chunk.edges.push_back(chunk.vrefs.size() - 1);
+                    chunk.vrefs.push_back(std::move(t.value));
+                    ++nedges;
+                }
+                parse_dot_attrs(s, attrs);
+                if (nedges == 0)
+                {
+                    for (auto& a : attrs)
+                        chunk.vvals[a.first].emplace_back(pos, a.second);
+                }
+                else
+                {
+                    // the last value of a repeated attribute prevails
+                    std::map<std::string, std::string> eattrs;
+                    for (auto& a : attrs)
+                        eattrs[a.first] = a.second;
+                    for (auto& a : eattrs)
+                    {
+                        auto& col = chunk.evals[a.first];
+                        for (size_t i = chunk.edges.size() - nedges;
+                             i < chunk.edges.size(); ++i)
+                            col.emplace_back(i, a.second);
+                    }
+                }
+            }
+        }
+        else
+        {
+            throw text_fallback();
+        }
+        if (s.peek(';'))
+            s.expect(';');
+    }
+}
+
+// Merges sorted lists of unique names, in parallel.
+inline std::vector<std::string>
+merge_text_names(std::vector<std::vector<std::string>> lists)
+{
+    if (lists.empty())
+        return {};
+    while (lists.size() > 1)
+    {
+        size_t n = lists.size() / 2;
+        std::vector<std::vector<std::string>> merged(n);
+        parallel_text_loop(n,
+                           [&](size_t i)
+                           {
+                               auto& a = lists[2 * i];
+                               auto& b = lists[2 * i + 1];
+                               auto& m = merged[i];
+                               m.reserve(a.size() + b.size());
+                               std::merge(std::make_move_iterator(a.begin()),
+                                          std::make_move_iterator(a.end()),
+                                          std::make_move_iterator(b.begin()),
+                                          std::make_move_iterator(b.end()),
+                                          std::back_inserter(m));
+                               m.erase(std::unique(m.begin(), m.end()),
+                                       m.end());
+                               std::vector<std::string>().swap(a);
+                               std::vector<std::string>().swap(b);
+                           });
+        if (lists.size() % 2 == 1)
+            merged.push_back(std::move(lists.back()));
+        lists.swap(merged);
+    }
+    return std::move(lists[0]);
+}
+
+template <class Graph, class VertexIndex, class EdgeIndex>
+bool read_dot_parallel(const char* data, size_t size, Graph& g,
+                       dynamic_properties& dp, const std::string& vertex_name,
+                       VertexIndex vindex, EdgeIndex eindex,
+                       const std::unordered_set<std::string>& ignore_vp,
+                       const std::unordered_set<std::string>& ignore_ep)
+{
+    bool directed;
+    const char* body;
+    std::tie(directed, body) = read_dot_header(data, data + size);
+
+    auto bounds = split_text(body, data + size, find_dot_record);
+    size_t nchunks = bounds.size() - 1;
+    std::vector<dot_chunk> chunks(nchunks);
+    parallel_text_loop(nchunks,
+                       [&](size_t c)
+                       {
+                           parse_dot_chunk(bounds[c], bounds[c + 1],
+                                           c == nchunks - 1, directed,
+                                           chunks[c]);
+                       });
+
+    // Graph attributes cannot be stored by the graph-tool property map
+    // generator, which results in an error in the sequential parser. Since
+    // the vertex names are stored as a property, the node attributes must
+    // also not clash with them.
+    for (auto& chunk : chunks)
+    {
+        if (chunk.has_gprops)
+            throw text_fallback();
+        if (chunk.vvals.find(vertex_name) != chunk.vvals.end())
+            throw text_fallback();
+    }
+
+    // the vertices are ordered by name
+    std::vector<std::vector<std::string>> lists(nchunks);
+    parallel_text_loop(nchunks,
+                       [&](size_t c)
+                       {
+                           auto& l = lists[c];
+                           l = chunks[c].vrefs;
+                           std::sort(l.begin(), l.end());
+                           l.erase(std::unique(l.begin(), l.end()), l.end());
+                       });
+    std::vector<std::string> names = merge_text_names(std::move(lists));
+    size_t N = names.size();
+
+    std::vector<std::vector<size_t>> vmap(nchunks);
+    parallel_text_loop(nchunks,
+                       [&](size_t c)
+                       {
+                           auto& r = chunks[c].vrefs;
+                           auto& m = vmap[c];
+                           m.resize(r.size());
+                           for (size_t i = 0; i < r.size(); ++i)
+                               m[i] = std::lower_bound(names.begin(),
+                                                       names.end(),
+                                                       r[i]) - names.begin();
+                       });
+
+    std::vector<const std::vector<size_t>*> cedges;
+    for (auto& chunk : chunks)
+        cedges.push_back(&chunk.edges);
+    std::vector<size_t> eoffset;
+    auto elist = collect_text_edges(cedges, vmap, eoffset);
+    size_t E = elist.size();
+
+    // property maps, which are only inserted at the very end
+    std::vector<std::function<void()>> props;
+    auto identity = [](auto& x) { return x; };
+
+    std::set<std::string> vkeys, ekeys;
+    for (auto& chunk : chunks)
+    {
+        for (auto& kv : chunk.vvals)
+            vkeys.insert(kv.first);
+        for (auto& kv : chunk.evals)
+            ekeys.insert(kv.first);
+    }
+    for (auto& k : vkeys)
+    {
+        if (ignore_vp.find(k) != ignore_vp.end())
+            continue;
+        auto pmap = new_text_property<std::string>(vindex, N);
+        fill_text_column(pmap.get_storage(),
+                         get_text_columns(chunks, &dot_chunk::vvals, k),
+                         identity,
+                         [&](size_t c, size_t pos) { return vmap[c][pos]; },
+                         false);
+        props.push_back([&dp, k, pmap] { dp.property(k, pmap); });
+    }
+    for (auto& k : ekeys)
+    {
+        if (ignore_ep.find(k) != ignore_ep.end())
+            continue;
+        auto pmap = new_text_property<std::string>(eindex, E);
+        fill_text_column(pmap.get_storage(),
+                         get_text_columns(chunks, &dot_chunk::evals, k),
+                         identity,
+                         [&](size_t c, size_t pos) { return eoffset[c] + pos; },
+                         true);
+        props.push_back([&dp, k, pmap] { dp.property(k, pmap); });
+    }
+
+    if (N > 0)
+    {
+        auto pmap = new_text_property<std::string>(vindex, N);
+        pmap.get_storage() = std::move(names);
+        props.push_back([&dp, vertex_name, pmap]
+                        { dp.property(vertex_name, pmap); });
+    }
+
+    // everything went fine; now the graph can be built
+    add_text_graph(g, N, elist);
+    for (auto& f : props)
+        f();
+    return directed;
+}
+
+// Reads a graph in one of the text formats ("xml", "gml" or "dot") from
+// memory, in parallel. Returns false if the input cannot be handled, in
+// which case nothing has been modified, and the sequential parser should be
+// used instead.
+template <class Graph, class VertexIndex, class EdgeIndex>
+bool read_text_parallel(const std::string& format, const char* data,
+                        size_t size, Graph& g, dynamic_properties& dp,
+                        VertexIndex vindex, EdgeIndex eindex,
+                        const std::unordered_set<std::string>& ignore_vp,
+                        const std::unordered_set<std::string>& ignore_ep,
+                        const std::unordered_set<std::string>& ignore_gp,
+                        bool& directed)
+{
+    try
+    {
+        if (format == "xml")
+            directed = read_graphml_parallel(data, size, g, dp, vindex, eindex,
+                                             ignore_vp, ignore_ep, ignore_gp);
+        else if (format == "gml")
+            directed = read_gml_parallel(data, size, g, dp, vindex, eindex,
+                                         ignore_vp, ignore_ep, ignore_gp);
+        else if (format == "dot")
+            directed = read_dot_parallel(data, size, g, dp, "vertex_name",
+                                         vindex, eindex, ignore_vp, ignore_ep);
+        else
+            return false;
+        return true;
+    }
+    catch (text_fallback&)
+    {
+        return false;
+    }
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_IO_PARALLEL_HH
@@ -0,0 +1,425 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_LANDMARK_LABELING_HH
+#define GRAPH_LANDMARK_LABELING_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "graph.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Pruned landmark labeling
+// ========================
+//
+// Every vertex v stores a list of "hubs" h, together with the distances
+// d(v, h) (the out-label) and d(h, v) (the in-label, which is the same as the
+// out-label if the graph is undirected), such that for every pair s, t with
+// t reachable from s, some vertex in a shortest path between them is a hub of
+// both [akiba-fast-2013]. The distance d(s, t) is then the minimum of
+// d(s, h) + d(h, t) over the common hubs, which is found by merging the two
+// labels, sorted by hub.
+//
+// The labels are built by a BFS from every vertex h, in order of decreasing
+// importance, which adds h to the in-labels of the vertices it reaches (and a
+// BFS through the in-edges, which adds it to the out-labels), but does not
+// continue past the vertices whose distance from h is already given by the
+// labels built so far. If the first hubs are central, e.g. of high degree,
+// most searches are pruned after very few steps, and the labels remain small.
+//
+// The searches run in parallel, in batches whose size doubles from one up to
+// the number of threads. The searches of the same batch are pruned only by
+// the labels of the previous ones, which can make the labels larger, but not
+// incorrect. The new entries are written to thread-local buffers, one per
+// destination thread, and appended by the owners of the vertices after each
+// batch.
+//
+// [akiba-fast-2013] T. Akiba, Y. Iwata, Y. Yoshida, "Fast exact
+//    shortest-path distance queries on large networks by pruned landmark
+//    labeling", SIGMOD '13, pp. 349-360, 2013, DOI: 10.1145/2463676.2465315
+
+inline const openmp_kernel pll_kernel("pruned_landmark_labeling", 10);
+inline const openmp_kernel pll_query_kernel("pruned_landmark_labeling_query",
+                                            100);
+
+class PrunedLandmarkLabeling
+{
+public:
+    typedef uint32_t dist_t;
+    static constexpr dist_t inf = std::numeric_limits<dist_t>::max();
+
+    struct label_t
+    {
+        uint32_t hub;  // rank of the hub
+        dist_t d;
+    };
+
+    PrunedLandmarkLabeling() : _N(0), _directed(false)
+    {
+        for (auto& pos : _pos)
+            pos.assign(1, 0);
+    }
+
+    // The vertices become hubs in order of decreasing priority.
+    template <class Graph, class PrioMap>
+    void build(const Graph& g, PrioMap prio);
+
+    size_t get_num_vertices() const { return _N; }
+    size_t get_num_labels() const
+    {
+        return _labels[0].size() + _labels[1].size();
+    }
+    bool is_directed() const { return _directed; }
+
+    // Distance from s to t, or inf if t is not reachable. The vertices are
+    // not checked.
+    dist_t query(size_t s, size_t t) const
+    {
+        auto& ls = _labels[0];
+        auto& lt = _labels[in_label()];
+        size_t i = _pos[0][s], i_end = _pos[0][s + 1];
+        size_t j = _pos[in_label()][t], j_end = _pos[in_label()][t + 1];
+        dist_t d = inf;
+        while (i < i_end && j < j_end)
+        {
+            auto& a = ls[i];
+            auto& b = lt[j];
+            if (a.hub < b.hub)
+            {
+                ++i;
+            }
+            else if (a.hub > b.hub)
+            {
+                ++j;
+            }
+            else
+            {
+                d = std::min(d, dist_t(a.d + b.d));
+                ++i;
+                ++j;
+            }
+        }
+        return d;
+    }
+
+    // Distance from s to t, or infinity if t is not reachable.
+    double distance(size_t s, size_t t) const
+    {
+        check_vertex(s);
+        check_vertex(t);
+        auto d = query(s, t);
+        if (d == inf)
+            return std::numeric_limits<double>::infinity();
+        return d;
+    }
+
+    // Distances between the pairs (sources[i], targets[i]), in parallel.
+    template <class Array, class DArray>
+    void distances(Array& sources, Array& targets, DArray& dist) const
+    {
+        size_t M = sources.shape()[0];
+        if (targets.shape()[0] != M || dist.shape()[0] != M)
+            throw ValueException("sources and targets must have the same size");
+        for (size_t i = 0; i < M; ++i)
+        {
+            check_vertex(sources[i]);
+            check_vertex(targets[i]);
+        }
+
+        #pragma omp parallel for schedule(runtime) \
+            if (is_parallel_worth(M * pll_query_kernel.get_cost()))
+        for (size_t i = 0; i < M; ++i)
+        {
+            auto d = query(sources[i], targets[i]);
+            dist[i] = (d == inf) ? std::numeric_limits<double>::infinity() : d;
+        }
+    }
+
+    // Flat representation of the index, for serialization: whether the graph
+    // is directed, and for the out- and in-labels the offsets of every
+    // vertex, the hub ranks and the distances. The in-labels are empty for
+    // undirected graphs.
+    typedef std::tuple<bool,
+                       std::vector<int64_t>, std::vector<int64_t>,
+                       std::vector<int64_t>,
+                       std::vector<int64_t>, std::vector<int64_t>,
+                       std::vector<int64_t>> state_t;
+
+    state_t get_state() const
+    {
+        state_t state;
+        std::get<0>(state) = _directed;
+        pack(0, std::get<1>(state), std::get<2>(state), std::get<3>(state));
+        pack(1, std::get<4>(state), std::get<5>(state), std::get<6>(state));
+        return state;
+    }
+
+    // The state is validated completely before it replaces the index, which
+    // is left untouched if the state is invalid.
+    template <class IArray>
+    void set_state(bool directed, IArray& out_pos, IArray& out_hub,
+                   IArray& out_d, IArray& in_pos, IArray& in_hub,
+                   IArray& in_d)
+    {
+        if (out_pos.shape()[0] == 0 || out_pos.shape()[0] - 1 >= inf / 2)
+            throw ValueException("invalid distance labeling state");
+        size_t N = out_pos.shape()[0] - 1;
+
+        std::vector<size_t> pos[2];
+        std::vector<label_t> labels[2];
+        unpack(N, out_pos, out_hub, out_d, pos[0], labels[0]);
+        if (directed)
+        {
+            unpack(N, in_pos, in_hub, in_d, pos[1], labels[1]);
+        }
+        else
+        {
+            if (in_pos.shape()[0] > 1 || in_hub.shape()[0] > 0 ||
+                in_d.shape()[0] > 0)
+                throw ValueException("invalid distance labeling state");
+            pos[1].assign(1, 0);
+        }
+
+        _N = N;
+        _directed = directed;
+        for (size_t k = 0; k < 2; ++k)
+        {
+            _pos[k].swap(pos[k]);
+            _labels[k].swap(labels[k]);
+        }
+    }
+
+private:
+    size_t in_label() const { return _directed ? 1 : 0; }
+
+    void check_vertex(int64_t v) const
+    {
+        if (v < 0 || size_t(v) >= _N)
+            throw ValueException("invalid vertex: " + std::to_string(v));
+    }
+
+    void pack(size_t k, std::vector<int64_t>& pos, std::vector<int64_t>& hub,
+              std::vector<int64_t>& d) const
+    {
+        pos.assign(_pos[k].begin(), _pos[k].end());
+        for (auto& l : _labels[k])
+        {
+            hub.push_back(l.hub);
+            d.push_back(l.d);
+        }
+    }
+
+    // Converts the flat labels of N vertices, checking that the offsets are
+    // monotonic, and that every label is sorted by hub, with hub ranks and
+    // distances smaller than N, as the queries require.
+    template <class IArray>
+    static void unpack(size_t N, IArray& ipos, IArray& hub, IArray& d,
+                       std::vector<size_t>& pos, std::vector<label_t>& labels)
+    {
+        size_t M = hub.shape()[0];
+        if (ipos.shape()[0] != N + 1 || d.shape()[0] != M || ipos[0] != 0 ||
+            size_t(ipos[N]) != M)
+            throw ValueException("invalid distance labeling state");
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (ipos[v + 1] < ipos[v])
+                throw ValueException("invalid distance labeling state");
+        }
+
+        pos.assign(ipos.begin(), ipos.end());
+        labels.resize(M);
+        for (size_t v = 0; v < N; ++v)
+        {
+            for (size_t i = pos[v]; i < pos[v + 1]; ++i)
+            {
+                if (hub[i] < 0 || size_t(hub[i]) >= N ||
+                    (i > pos[v] && hub[i] <= hub[i - 1]) ||
+                    d[i] < 0 || size_t(d[i]) >= N)
+                    throw ValueException("invalid distance labeling state");
+                labels[i] = {uint32_t(hub[i]), dist_t(d[i])};
+            }
+        }
+    }
+
+    size_t _N;
+    bool _directed;
+
+    // index 0 holds the out-labels, and 1 the in-labels, which are only used
+    // if the graph is directed
+    std::vector<size_t> _pos[2];
+    std::vector<label_t> _labels[2];
+};
+
+template <class Graph, class PrioMap>
+void PrunedLandmarkLabeling::build(const Graph& g, PrioMap prio)
+{
+    typedef std::pair<size_t, label_t> entry_t;
+
+    _N = num_vertices(g);
+    _directed = graph_tool::is_directed(g);
+    if (_N >= inf / 2)
+        throw ValueException("graph is too large for a distance labeling");
+
+    std::vector<size_t> order;
+    for (auto v : vertices_range(g))
+        order.push_back(v);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](auto u, auto v) { return get(prio, u) > get(prio, v); });
+
+    size_t K = _directed ? 2 : 1;
+    std::vector<std::vector<label_t>> labels[2];
+    for (size_t k = 0; k < K; ++k)
+        labels[k].resize(_N);
+
+    // buffers[(k * P + q) * P + p] are the entries of labels[k] found by
+    // thread q for the vertices owned by thread p
+    std::vector<std::vector<entry_t>> buffers;
+    size_t P = 1;
+
+    #pragma omp parallel if (is_parallel_worth(g, pll_kernel))
+    {
+        size_t p = 0;
+#ifdef _OPENMP
+        p = omp_get_thread_num();
+        #pragma omp single
+        P = omp_get_num_threads();
+#endif
+        #pragma omp single
+        buffers.resize(K * P * P);
+
+        auto owner = [&](size_t v) { return (v * P) / _N; };
+
+        std::vector<dist_t> dist(_N, inf);
+        std::vector<dist_t> hub_dist(_N, inf); // indexed by rank
+        std::vector<size_t> queue;
+
+        // Pruned BFS from the hub of rank r, which adds it to labels[k] of
+        // the vertices reached through neighbors(), pruning with
+        // labels[k_hub] of the hub itself.
+        auto search = [&](size_t r, size_t k, size_t k_hub, auto&& neighbors)
+            {
+                size_t h = order[r];
+                for (auto& l : labels[k_hub][h])
+                    hub_dist[l.hub] = l.d;
+
+                queue.clear();
+                queue.push_back(h);
+                dist[h] = 0;
+                for (size_t i = 0; i < queue.size(); ++i)
+                {
+                    size_t v = queue[i];
+                    dist_t d = dist[v];
+
+                    bool pruned = false;
+                    for (auto& l : labels[k][v])
+                    {
+                        if (hub_dist[l.hub] != inf &&
+                            hub_dist[l.hub] + l.d <= d)
+                        {
+                            pruned = true;
+                            break;
+                        }
+                    }
+                    if (pruned)
+                        continue;
+
+                    buffers[(k * P + p) * P + owner(v)]
+                        .emplace_back(v, label_t{uint32_t(r), d});
+
+                    for (auto u : neighbors(v))
+                    {
+                        if (dist[u] != inf)
+                            continue;
+                        dist[u] = d + 1;
+                        queue.push_back(u);
+                    }
+                }
+
+                for (auto v : queue)
+                    dist[v] = inf;
+                for (auto& l : labels[k_hub][h])
+                    hub_dist[l.hub] = inf;
+            };
+
+        size_t batch = 1;
+        for (size_t start = 0; start < order.size();
+             start += batch, batch = std::min(2 * batch, P))
+        {
+            size_t end = std::min(start + batch, order.size());
+
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t r = start; r < end; ++r)
+            {
+                // forward search: d(h, v), pruned with the out-label of h
+                search(r, K - 1, 0,
+                       [&](auto v) { return out_neighbors_range(v, g); });
+                // backward search: d(v, h), pruned with the in-label of h
+                if (K > 1)
+                    search(r, 0, 1,
+                           [&](auto v)
+                           { return in_or_out_neighbors_range(v, g); });
+            }
+
+            for (size_t k = 0; k < K; ++k)
+            {
+                for (size_t q = 0; q < P; ++q)
+                {
+                    auto& buf = buffers[(k * P + q) * P + p];
+                    for (auto& [v, l] : buf)
+                        labels[k][v].push_back(l);
+                    buf.clear();
+                }
+            }
+            #pragma omp barrier
+        }
+    }
+
+    for (size_t k = 0; k < 2; ++k)
+    {
+        parallel_loop(labels[k],
+                      [&](size_t, auto& l)
+                      {
+                          std::sort(l.begin(), l.end(),
+                                    [](auto& a, auto& b)
+                                    { return a.hub < b.hub; });
+                      });
+
+        _pos[k].assign(1, 0);
+        _labels[k].clear();
+        if (labels[k].empty())
+            continue;
+        for (auto& l : labels[k])
+            _pos[k].push_back(_pos[k].back() + l.size());
+        _labels[k].reserve(_pos[k].back());
+        for (auto& l : labels[k])
+        {
+            _labels[k].insert(_labels[k].end(), l.begin(), l.end());
+            std::vector<label_t>().swap(l);
+        }
+    }
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_LANDMARK_LABELING_HH
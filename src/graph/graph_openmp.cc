@@ -16,9 +16,15 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "graph.hh"
+#include "graph_util.hh"
 
 #include <boost/python.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <unordered_map>
+
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
@@ -106,6 +112,150 @@ void openmp_set_schedule(string skind, int chunk)
 #endif
 }
 
+namespace graph_tool
+{
+// these are read inside parallel regions, and may be changed concurrently
+static std::atomic<loop_balance> _loop_balance(loop_balance::vertex);
+
+loop_balance get_loop_balance()
+{
+    return _loop_balance;
+}
+
+void set_loop_balance(loop_balance balance)
+{
+    _loop_balance = balance;
+}
+}
+
+namespace graph_tool
+{
+static std::atomic<size_t> _openmp_min_work(OPENMP_MIN_THRESH);
+
+size_t get_openmp_min_work()
+{
+    return _openmp_min_work;
+}
+
+void set_openmp_min_work(size_t work)
+{
+    _openmp_min_work = work;
+}
+
+static unordered_map<string, std::atomic<double>>& get_openmp_kernel_costs()
+{
+    static unordered_map<string, std::atomic<double>> costs;
+    return costs;
+}
+
+// Returns a reference to the cost of the given kernel, which is registered
+// with the given default cost if it is not known yet.
+std::atomic<double>& get_openmp_kernel_cost(const string& kernel, double cost)
+{
+    return get_openmp_kernel_costs().emplace(kernel, cost).first->second;
+}
+}
+
+python::dict openmp_get_kernel_costs()
+{
+    python::dict costs;
+    for (auto& kc : get_openmp_kernel_costs())
+        costs[kc.first] = kc.second.load();
+    return costs;
+}
+
+void openmp_set_kernel_cost(string kernel, double cost)
+{
+    auto& costs = get_openmp_kernel_costs();
+    auto iter = costs.find(kernel);
+    if (iter == costs.end())
+        throw GraphException("Unknown kernel: " + kernel);
+    iter->second = cost;
+}
+
+// Measures the fork/join overhead of a parallel region with the current number
+// of threads, and the time taken by an elementary operation (a load and an
+// addition), and sets the minimum amount of work of a parallel region
+// accordingly. With p threads, a parallel region with work W takes a time
+// W/p + overhead, so that it is only advantageous if W > overhead * p/(p-1).
+python::tuple openmp_calibrate(size_t repeats)
+{
+#ifdef _OPENMP
+    typedef std::chrono::steady_clock clock_t;
+    auto elapsed = [](auto start)
+        {
+            return std::chrono::duration<double, std::nano>(clock_t::now() -
+                                                             start).count();
+        };
+
+    size_t nthreads = omp_get_max_threads();
+    repeats = std::max(repeats, size_t(1));
+
+    // start the thread pool before measuring
+    size_t count = 0;
+    #pragma omp parallel reduction(+:count)
+    count++;
+
+    auto start = clock_t::now();
+    for (size_t i = 0; i < repeats; ++i)
+    {
+        #pragma omp parallel reduction(+:count)
+        {
+            #pragma omp for schedule(runtime)
+            for (size_t j = 0; j < nthreads; ++j)
+                count++;
+        }
+    }
+    double overhead = elapsed(start) / repeats;
+
+    vector<size_t> x(1 << 16);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = i;
+    start = clock_t::now();
+    for (size_t i = 0; i < repeats; ++i)
+    {
+        for (size_t j = 0; j < x.size(); ++j)
+            count += x[j];
+        x[count % x.size()]++;
+    }
+    double op_time = elapsed(start) / (repeats * x.size());
+
+    // a single thread never benefits from a parallel region
+    size_t work = numeric_limits<size_t>::max();
+    if (nthreads > 1)
+        work = std::min(overhead / op_time * nthreads / (nthreads - 1), 1e18);
+    set_openmp_min_work(work);
+    return python::make_tuple(overhead, op_time, get_openmp_min_work());
+#else
+    throw GraphException("OpenMP was not enabled during compilation");
+#endif
+}
+
+string openmp_get_loop_balance()
+{
+    switch (get_loop_balance())
+    {
+    case loop_balance::vertex:
+        return "vertex";
+    case loop_balance::degree:
+        return "degree";
+    case loop_balance::split:
+        return "split";
+    }
+    throw GraphException("Unknown loop balance");
+}
+
+void openmp_set_loop_balance(string balance)
+{
+    if (balance == "vertex")
+        set_loop_balance(loop_balance::vertex);
+    else if (balance == "degree")
+        set_loop_balance(loop_balance::degree);
+    else if (balance == "split")
+        set_loop_balance(loop_balance::split);
+    else
+        throw GraphException("Unknown loop balance: " + balance);
+}
 
 void export_openmp()
 {
@@ -116,4 +266,11 @@ void export_openmp()
     def("openmp_set_num_threads", &openmp_set_num_threads);
     def("openmp_get_schedule", &openmp_get_schedule);
     def("openmp_set_schedule", &openmp_set_schedule);
+    def("openmp_get_min_work", &get_openmp_min_work);
+    def("openmp_set_min_work", &set_openmp_min_work);
+    def("openmp_get_kernel_costs", &openmp_get_kernel_costs);
+    def("openmp_set_kernel_cost", &openmp_set_kernel_cost);
+    def("openmp_calibrate", &openmp_calibrate);
+    def("openmp_get_loop_balance", &openmp_get_loop_balance);
+    def("openmp_set_loop_balance", &openmp_set_loop_balance);
 };
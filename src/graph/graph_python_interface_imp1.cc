@@ -22,6 +22,7 @@
 
 #include <boost/python.hpp>
 #include <boost/python/stl_iterator.hpp>
+#include <boost/iterator/transform_iterator.hpp>
 #include <set>
 
 
@@ -69,26 +70,37 @@ struct add_edge_list
 
                 size_t n_props = std::min(eprops.size(), edge_list.shape()[1] - 2);
 
+                size_t N = 0;
                 for (const auto& e : edge_list)
                 {
                     size_t s = e[0];
                     size_t t = e[1];
-                    while (s >= num_vertices(g) || t >= num_vertices(g))
-                        add_vertex(g);
-                    auto ne = add_edge(vertex(s, g), vertex(t, g), g).first;
-                    for (size_t i = 0; i < n_props; ++i)
-                    {
-                        try
-                        {
-                            put(eprops[i], ne, e[i + 2]);
-                        }
-                        catch(bad_lexical_cast&)
-                        {
-                            throw ValueException("Invalid edge property value: " +
-                                                 lexical_cast<string>(e[i + 2]));
-                        }
-                    }
+                    N = std::max({N, s + 1, t + 1});
                 }
+                while (num_vertices(g) < N)
+                    add_vertex(g);
+
+                auto get_st = [](const auto& e)
+                    { return std::make_pair(size_t(e[0]), size_t(e[1])); };
+                add_edges(boost::make_transform_iterator(edge_list.begin(), get_st),
+                          boost::make_transform_iterator(edge_list.end(), get_st),
+                          g,
+                          [&](size_t j, const edge_t& ne)
+                          {
+                              const auto& e = edge_list[j];
+                              for (size_t i = 0; i < n_props; ++i)
+                              {
+                                  try
+                                  {
+                                      put(eprops[i], ne, e[i + 2]);
+                                  }
+                                  catch(bad_lexical_cast&)
+                                  {
+                                      throw ValueException("Invalid edge property value: " +
+                                                           lexical_cast<string>(e[i + 2]));
+                                  }
+                              }
+                          });
                 found = true;
             }
             catch (InvalidNumpyConversion& e) {}
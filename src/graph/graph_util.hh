@@ -20,6 +20,7 @@
 
 // allow boost::python to bind to std::functions
 #include <boost/mpl/vector.hpp>
+#include <atomic>
 #include <functional>
 namespace boost { namespace python { namespace detail {
     template <class R_, class... PS_, class T=void>
@@ -44,6 +45,14 @@ namespace boost { namespace python { namespace detail {
 
 #include <functional>
 #include <random>
+#include <memory>
+#include <vector>
+
+#include <boost/iterator/iterator_categories.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "graph_selectors.hh"
 #include "graph_reverse.hh"
@@ -179,13 +188,264 @@ void graph_copy(const GraphOrig& g, GraphTarget& gt)
 }
 
 
+// Inserts the edges in the range [begin, end), given as (source, target)
+// pairs, calling f(i, e) for the i-th inserted edge e. Graph types which are
+// able to insert the whole range at once overload this function.
+template <class Iter, class Graph, class F>
+void add_edges(Iter begin, Iter end, Graph& g, F&& f)
+{
+    size_t i = 0;
+    for (; begin != end; ++begin)
+    {
+        auto e = add_edge(vertex(std::get<0>(*begin), g),
+                          vertex(std::get<1>(*begin), g), g).first;
+        f(i++, e);
+    }
+}
+
+// Inserts, for every vertex v in turn, the out-edges to the vertices in the
+// range returned by get_targets(v). Graph types which can do this without
+// inserting the edges one by one overload this function.
+template <class Graph, class F>
+void add_out_edges(Graph& g, F&& get_targets)
+{
+    size_t N = num_vertices(g);
+    for (size_t v = 0; v < N; ++v)
+    {
+        for (auto u : get_targets(v))
+            add_edge(vertex(v, g), vertex(u, g), g);
+    }
+}
+
+//
+// Parallelism threshold
+// =====================
+//
+// A parallel region is only worth spawning if the amount of work it contains
+// exceeds the fork/join overhead. The work is estimated as the number of
+// vertices and edges of the graph times a per-kernel cost, measured in
+// elementary operations, and is compared with get_openmp_min_work(), which
+// defaults to OPENMP_MIN_THRESH but can be set at runtime, or measured on the
+// host with openmp_calibrate(). The costs of the individual kernels are
+// registered by name, so that they can be tuned at runtime as well.
+
+// These are implemented in graph_openmp.cc.
+size_t get_openmp_min_work();
+void set_openmp_min_work(size_t work);
+std::atomic<double>& get_openmp_kernel_cost(const std::string& kernel,
+                                            double cost);
+
+class openmp_kernel
+{
+public:
+    openmp_kernel(const std::string& name, double cost)
+        : _cost(&get_openmp_kernel_cost(name, cost)) {}
+
+    double get_cost() const { return *_cost; }
+
+private:
+    std::atomic<double>* _cost;
+};
+
+inline bool is_parallel_worth(double work)
+{
+    return work > get_openmp_min_work();
+}
+
+template <class Graph>
+bool is_parallel_worth(const Graph& g, const openmp_kernel& kernel)
+{
+    return is_parallel_worth((num_vertices(g) + num_edges(g)) *
+                             kernel.get_cost());
+}
+
 //
 // Parallel loops
 // ==============
+//
+// By default, the vertex and edge loops below split the range of vertex
+// indices between the threads according to the OpenMP runtime schedule. For
+// graphs with very skewed degree distributions this can leave a single thread
+// with most of the work, so that alternatively the loops can be balanced by
+// degree (see set_loop_balance()): the vertices are grouped in contiguous
+// ranges with approximately the same number of out-edges, which are then
+// handed out dynamically to the threads as they become idle. In the "split"
+// mode, edge loops additionally break the out-edge lists of hub vertices into
+// pieces, so that a single vertex can be processed by several threads.
+
+enum class loop_balance { vertex, degree, split };
+
+// These are implemented in graph_openmp.cc.
+loop_balance get_loop_balance();
+void set_loop_balance(loop_balance balance);
+
+// A range of vertices [v_begin, v_end), or, if e_end > e_begin, the out-edges
+// [e_begin, e_end) of vertex v_begin.
+struct loop_range
+{
+    size_t v_begin;
+    size_t v_end;
+    size_t e_begin;
+    size_t e_end;
+};
+
+// Estimated cost of visiting a vertex. For filtered graphs the degree in the
+// underlying graph is used, since the filtered degree is O(k).
+template <class Graph, class Vertex>
+size_t get_loop_weight(Vertex v, const Graph& g)
+{
+    return out_degree(v, g) + 1;
+}
+
+template <class Graph, class EPred, class VPred, class Vertex>
+size_t get_loop_weight(Vertex v, const boost::filt_graph<Graph, EPred, VPred>& g)
+{
+    return get_loop_weight(v, g._g);
+}
+
+// Partitions the vertices in contiguous ranges of approximately the same
+// weight. If split == true, vertices which are heavier than a single range are
+// further split into pieces of their out-edge lists. This needs to be called
+// by all threads of a team, and they all receive the same ranges.
+//
+// The ranges are computed in parallel: every thread takes a contiguous block
+// of vertices, and the ranges end where the prefix sum of the weights crosses
+// a multiple of the target weight, or at the end of a block. Only the block
+// sums and the final list of ranges are handled by a single thread.
+template <class Graph>
+std::shared_ptr<std::vector<loop_range>>
+get_balanced_ranges_no_spawn(const Graph& g, bool split)
+{
+    size_t N = num_vertices(g);
+    size_t nthreads = 1;
+    size_t tid = 0;
+#ifdef _OPENMP
+    nthreads = omp_get_num_threads();
+    tid = omp_get_thread_num();
+#endif
+    size_t begin = (N * tid) / nthreads;
+    size_t end = (N * (tid + 1)) / nthreads;
+
+    struct blocks_t
+    {
+        std::vector<size_t> weight;
+        std::vector<std::vector<loop_range>> ranges;
+    };
+    std::shared_ptr<blocks_t> blocks;
+    #pragma omp single copyprivate(blocks)
+    {
+        blocks = std::make_shared<blocks_t>();
+        blocks->weight.resize(nthreads);
+        blocks->ranges.resize(nthreads);
+    }
+
+    size_t weight = 0;
+    for (size_t i = begin; i < end; ++i)
+        weight += get_loop_weight(vertex(i, g), g);
+    blocks->weight[tid] = weight;
+
+    #pragma omp barrier
+
+    size_t total = 0;
+    size_t acc = 0;   // weight before the current vertex
+    for (size_t t = 0; t < nthreads; ++t)
+    {
+        if (t == tid)
+            acc = total;
+        total += blocks->weight[t];
+    }
+    size_t target = std::max(total / (nthreads * 16), size_t(1));
+
+    auto& ranges = blocks->ranges[tid];
+    size_t rbegin = begin;
+    for (size_t i = begin; i < end; ++i)
+    {
+        size_t w = get_loop_weight(vertex(i, g), g);
+        if (split && w > target)
+        {
+            if (rbegin < i)
+                ranges.push_back({rbegin, i, 0, 0});
+            size_t k = w - 1;
+            for (size_t pos = 0; pos < k; pos += target)
+                ranges.push_back({i, i + 1, pos, std::min(pos + target, k)});
+            if (k == 0)
+                ranges.push_back({i, i + 1, 0, 0});
+            rbegin = i + 1;
+            acc += w;
+            continue;
+        }
+        if ((acc + w) / target > acc / target)
+        {
+            ranges.push_back({rbegin, i + 1, 0, 0});
+            rbegin = i + 1;
+        }
+        acc += w;
+    }
+    if (rbegin < end)
+        ranges.push_back({rbegin, end, 0, 0});
+
+    #pragma omp barrier
+
+    std::shared_ptr<std::vector<loop_range>> all;
+    #pragma omp single copyprivate(all)
+    {
+        all = std::make_shared<std::vector<loop_range>>();
+        for (auto& r : blocks->ranges)
+            all->insert(all->end(), r.begin(), r.end());
+    }
+    return all;
+}
+
+// Iterates over the balanced ranges, calling f(v) for every valid vertex v in
+// a vertex range, and fe(v, begin, end) for every out-edge piece.
+template <class Graph, class F, class FE>
+void balanced_vertex_loop_no_spawn(const Graph& g, F&& f, FE&& fe, bool split)
+{
+    auto ranges = get_balanced_ranges_no_spawn(g, split);
+    size_t M = ranges->size();
+    #pragma omp for schedule(dynamic, 1)
+    for (size_t j = 0; j < M; ++j)
+    {
+        const auto& r = (*ranges)[j];
+        if (r.e_end > r.e_begin)
+        {
+            auto v = vertex(r.v_begin, g);
+            if (is_valid_vertex(v, g))
+                fe(v, r.e_begin, r.e_end);
+            continue;
+        }
+        for (size_t i = r.v_begin; i < r.v_end; ++i)
+        {
+            auto v = vertex(i, g);
+            if (!is_valid_vertex(v, g))
+                continue;
+            f(v);
+        }
+    }
+}
+
+// Returns true if the loops in the current thread team should be balanced by
+// degree.
+inline bool use_balanced_loop()
+{
+#ifdef _OPENMP
+    return (get_loop_balance() != loop_balance::vertex &&
+            omp_get_num_threads() > 1);
+#else
+    return false;
+#endif
+}
 
 template <class Graph, class F>
 void parallel_vertex_loop_no_spawn(const Graph& g, F&& f)
 {
+    if (use_balanced_loop())
+    {
+        balanced_vertex_loop_no_spawn(g, f, [](auto, size_t, size_t) {},
+                                      false);
+        return;
+    }
+
     size_t N = num_vertices(g);
     #pragma omp for schedule(runtime)
     for (size_t i = 0; i < N; ++i)
@@ -197,10 +457,19 @@ void parallel_vertex_loop_no_spawn(const Graph& g, F&& f)
     }
 }
 
-template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
+template <class Graph, class F>
 void parallel_vertex_loop(const Graph& g, F&& f)
 {
-    #pragma omp parallel if (num_vertices(g) > thres)
+    #pragma omp parallel if (is_parallel_worth(num_vertices(g)))
+    {
+        parallel_vertex_loop_no_spawn<Graph, F>(g, std::forward<F>(f));
+    }
+}
+
+template <class Graph, class F>
+void parallel_vertex_loop(const Graph& g, F&& f, const openmp_kernel& kernel)
+{
+    #pragma omp parallel if (is_parallel_worth(g, kernel))
     {
         parallel_vertex_loop_no_spawn<Graph, F>(g, std::forward<F>(f));
     }
@@ -239,14 +508,50 @@ void parallel_edge_loop_no_spawn(const Graph& g, F&& f)
              for (auto e : out_edges_range(v, u))
                  f(e);
         };
+
+    if (use_balanced_loop())
+    {
+        // hub vertices can only be split if their out-edges can be accessed
+        // randomly
+        typedef typename boost::graph_traits<graph_t>::out_edge_iterator
+            eiter_t;
+        constexpr bool random_access =
+            std::is_convertible<typename boost::iterator_traversal<eiter_t>::type,
+                                boost::random_access_traversal_tag>::value;
+        auto dispatch_range =
+            [&](auto v, size_t begin, size_t end)
+            {
+                if constexpr (random_access)
+                {
+                    auto e = out_edges(v, u).first;
+                    auto e_end = e + end;
+                    for (e += begin; e != e_end; ++e)
+                        f(*e);
+                }
+            };
+        balanced_vertex_loop_no_spawn(u, dispatch, dispatch_range,
+                                      (random_access &&
+                                       get_loop_balance() == loop_balance::split));
+        return;
+    }
+
     typedef decltype(dispatch) dispatch_t;
     parallel_vertex_loop_no_spawn<graph_t, dispatch_t&>(u, dispatch);
 }
 
-template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
+template <class Graph, class F>
 void parallel_edge_loop(const Graph& g, F&& f)
 {
-    #pragma omp parallel if (num_vertices(g) > thres)
+    #pragma omp parallel if (is_parallel_worth(num_vertices(g)))
+    {
+        parallel_edge_loop_no_spawn<Graph, F>(g, std::forward<F>(f));
+    }
+}
+
+template <class Graph, class F>
+void parallel_edge_loop(const Graph& g, F&& f, const openmp_kernel& kernel)
+{
+    #pragma omp parallel if (is_parallel_worth(g, kernel))
     {
         parallel_edge_loop_no_spawn<Graph, F>(g, std::forward<F>(f));
     }
@@ -261,10 +566,10 @@ void parallel_loop_no_spawn(Container&& v, F&& f)
         f(i, v[i]);
 }
 
-template <class Container, class F, size_t thres = OPENMP_MIN_THRESH>
+template <class Container, class F>
 void parallel_loop(Container&& v, F&& f)
 {
-    #pragma omp parallel if (v.size() > thres)
+    #pragma omp parallel if (is_parallel_worth(v.size()))
     {
         parallel_loop_no_spawn<Container, F>(std::forward<Container>(v),
                                              std::forward<F>(f));
@@ -27,83 +27,96 @@
 
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_search_visitor.hh"
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
-class BFSVisitorWrapper
+class BFSVisitorWrapper: public SearchVisitorWrapper
 {
 public:
-    BFSVisitorWrapper(GraphInterface& gi, python::object vis)
-        : _gi(gi), _vis(vis) {}
+    enum event_t
+    {
+        INITIALIZE_VERTEX, DISCOVER_VERTEX, EXAMINE_VERTEX, EXAMINE_EDGE,
+        TREE_EDGE, NON_TREE_EDGE, GRAY_TARGET, BLACK_TARGET, FINISH_VERTEX,
+        DIST
+    };
+
+    static std::vector<std::string> get_events()
+    {
+        return {"initialize_vertex", "discover_vertex", "examine_vertex",
+                "examine_edge", "tree_edge", "non_tree_edge", "gray_target",
+                "black_target", "finish_vertex", "dist"};
+    }
+
+    using SearchVisitorWrapper::SearchVisitorWrapper;
 
     template <class Vertex, class Graph>
     void initialize_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("initialize_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(INITIALIZE_VERTEX, u, g);
     }
 
     template <class Vertex, class Graph>
     void discover_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("discover_vertex")(PythonVertex<Graph>(gp, u));
+        // the roots are discovered without a tree edge
+        if (_rec.is_recorded(DIST))
+        {
+            auto& dist = _rec.get_values(num_vertices(g));
+            if (dist[u] == numeric_limits<int32_t>::max())
+                dist[u] = 0;
+        }
+        vertex_event(DISCOVER_VERTEX, u, g);
     }
 
     template <class Vertex, class Graph>
     void examine_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("examine_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(EXAMINE_VERTEX, u, g);
     }
 
     template <class Edge, class Graph>
     void examine_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("examine_edge")(PythonEdge<Graph>(gp, e));
+        edge_event(EXAMINE_EDGE, e, g);
     }
 
     template <class Edge, class Graph>
     void tree_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("tree_edge")(PythonEdge<Graph>(gp, e));
+        if (_rec.is_recorded(DIST))
+        {
+            auto& dist = _rec.get_values(num_vertices(g));
+            dist[target(e, g)] = dist[source(e, g)] + 1;
+        }
+        edge_event(TREE_EDGE, e, g);
     }
 
     template <class Edge, class Graph>
     void non_tree_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("non_tree_edge")(PythonEdge<Graph>(gp, e));
+        edge_event(NON_TREE_EDGE, e, g);
     }
 
     template <class Edge, class Graph>
     void gray_target(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("gray_target")(PythonEdge<Graph>(gp, e));
+        edge_event(GRAY_TARGET, e, g);
     }
 
     template <class Edge, class Graph>
     void black_target(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("black_target")(PythonEdge<Graph>(gp, e));
+        edge_event(BLACK_TARGET, e, g);
     }
 
     template <class Vertex, class Graph>
     void finish_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("finish_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(FINISH_VERTEX, u, g);
     }
-
-private:
-    GraphInterface& _gi;
-    boost::python::object _vis;
 };
 
 template <class Graph, class Visitor>
@@ -128,10 +141,17 @@ void do_bfs(Graph& g, size_t s, Visitor&& vis)
     }
 }
 
-void bfs_search(GraphInterface& gi, size_t s, python::object vis)
+void bfs_search(GraphInterface& gi, size_t s, python::object vis,
+                python::object calls, python::object record,
+                python::dict events)
 {
-    run_action<graph_tool::all_graph_views,mpl::true_>()
-        (gi, [&](auto &g){ do_bfs(g, s, BFSVisitorWrapper(gi, vis)); })();
+    SearchRecord rec(BFSVisitorWrapper::get_events(), calls, record);
+    rec.run([&]()
+            {
+                run_action<graph_tool::all_graph_views,mpl::true_>()
+                    (gi, [&](auto &g)
+                     { do_bfs(g, s, BFSVisitorWrapper(gi, vis, rec)); })();
+            }, events);
 }
 
 #ifdef HAVE_BOOST_COROUTINE
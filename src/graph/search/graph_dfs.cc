@@ -18,76 +18,78 @@
 
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_search_visitor.hh"
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
 
-class DFSVisitorWrapper
+class DFSVisitorWrapper: public SearchVisitorWrapper
 {
 public:
-    DFSVisitorWrapper(GraphInterface& gi, python::object vis)
-        : _gi(gi), _vis(vis) {}
+    enum event_t
+    {
+        INITIALIZE_VERTEX, START_VERTEX, DISCOVER_VERTEX, EXAMINE_EDGE,
+        TREE_EDGE, BACK_EDGE, FORWARD_OR_CROSS_EDGE, FINISH_VERTEX
+    };
 
+    static std::vector<std::string> get_events()
+    {
+        return {"initialize_vertex", "start_vertex", "discover_vertex",
+                "examine_edge", "tree_edge", "back_edge",
+                "forward_or_cross_edge", "finish_vertex"};
+    }
+
+    using SearchVisitorWrapper::SearchVisitorWrapper;
 
     template <class Vertex, class Graph>
     void initialize_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("initialize_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(INITIALIZE_VERTEX, u, g);
     }
+
     template <class Vertex, class Graph>
     void start_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("start_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(START_VERTEX, u, g);
     }
+
     template <class Vertex, class Graph>
     void discover_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("discover_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(DISCOVER_VERTEX, u, g);
     }
 
     template <class Edge, class Graph>
     void examine_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("examine_edge")(PythonEdge<Graph>(gp, e));
+        edge_event(EXAMINE_EDGE, e, g);
     }
 
     template <class Edge, class Graph>
     void tree_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("tree_edge")(PythonEdge<Graph>(gp, e));
+        edge_event(TREE_EDGE, e, g);
     }
 
     template <class Edge, class Graph>
     void back_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("back_edge")(PythonEdge<Graph>(gp, e));
+        edge_event(BACK_EDGE, e, g);
     }
 
     template <class Edge, class Graph>
     void forward_or_cross_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("forward_or_cross_edge")(PythonEdge<Graph>(gp, e));
+        edge_event(FORWARD_OR_CROSS_EDGE, e, g);
     }
 
     template <class Vertex, class Graph>
     void finish_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("finish_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(FINISH_VERTEX, u, g);
     }
-
-private:
-    GraphInterface& _gi;
-    python::object _vis;
 };
 
 template <class Graph, class Visitor>
@@ -102,10 +104,17 @@ void do_dfs(Graph& g, size_t s, Visitor&& vis)
         depth_first_visit(g, v, vis, color);
 }
 
-void dfs_search(GraphInterface& gi, size_t s, python::object vis)
+void dfs_search(GraphInterface& gi, size_t s, python::object vis,
+                python::object calls, python::object record,
+                python::dict events)
 {
-    run_action<graph_tool::all_graph_views, mpl::true_>()
-        (gi, [&](auto &g) { do_dfs(g, s, DFSVisitorWrapper(gi, vis));})();
+    SearchRecord rec(DFSVisitorWrapper::get_events(), calls, record);
+    rec.run([&]()
+            {
+                run_action<graph_tool::all_graph_views, mpl::true_>()
+                    (gi, [&](auto &g)
+                     { do_dfs(g, s, DFSVisitorWrapper(gi, vis, rec));})();
+            }, events);
 }
 
 #ifdef HAVE_BOOST_COROUTINE
@@ -27,70 +27,72 @@
 
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_search_visitor.hh"
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
 
-class DJKVisitorWrapper
+class DJKVisitorWrapper: public SearchVisitorWrapper
 {
 public:
-    DJKVisitorWrapper(GraphInterface& gi, python::object vis)
-        : _gi(gi), _vis(vis) {}
+    enum event_t
+    {
+        INITIALIZE_VERTEX, DISCOVER_VERTEX, EXAMINE_VERTEX, EXAMINE_EDGE,
+        EDGE_RELAXED, EDGE_NOT_RELAXED, FINISH_VERTEX
+    };
+
+    static std::vector<std::string> get_events()
+    {
+        return {"initialize_vertex", "discover_vertex", "examine_vertex",
+                "examine_edge", "edge_relaxed", "edge_not_relaxed",
+                "finish_vertex"};
+    }
+
+    using SearchVisitorWrapper::SearchVisitorWrapper;
 
     template <class Vertex, class Graph>
     void initialize_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("initialize_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(INITIALIZE_VERTEX, u, g);
     }
 
     template <class Vertex, class Graph>
     void discover_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("discover_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(DISCOVER_VERTEX, u, g);
     }
 
     template <class Vertex, class Graph>
     void examine_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("examine_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(EXAMINE_VERTEX, u, g);
     }
 
     template <class Edge, class Graph>
     void examine_edge(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("examine_edge")(PythonEdge<Graph>(gp, e));
+        edge_event(EXAMINE_EDGE, e, g);
     }
 
     template <class Edge, class Graph>
     void edge_relaxed(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("edge_relaxed")(PythonEdge<Graph>(gp, e));
+        edge_event(EDGE_RELAXED, e, g);
     }
 
     template <class Edge, class Graph>
     void edge_not_relaxed(Edge e, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("edge_not_relaxed")(PythonEdge<Graph>(gp, e));
+        edge_event(EDGE_NOT_RELAXED, e, g);
     }
 
     template <class Vertex, class Graph>
     void finish_vertex(Vertex u, Graph& g)
     {
-        auto gp = retrieve_graph_view<Graph>(_gi, g);
-        _vis.attr("finish_vertex")(PythonVertex<Graph>(gp, u));
+        vertex_event(FINISH_VERTEX, u, g);
     }
-
-private:
-    GraphInterface& _gi;
-    boost::python::object _vis;
 };
 
 
@@ -212,17 +214,23 @@ struct do_djk_search_fast
 void dijkstra_search(GraphInterface& g, size_t source, boost::any dist_map,
                      boost::any pred_map, boost::any weight, python::object vis,
                      python::object cmp, python::object cmb,
-                     python::object zero, python::object inf)
+                     python::object zero, python::object inf,
+                     python::object calls, python::object record,
+                     python::dict events)
 {
     typedef typename property_map_type::
         apply<int64_t, GraphInterface::vertex_index_map_t>::type pred_t;
     pred_t pred = any_cast<pred_t>(pred_map);
-    run_action<graph_tool::all_graph_views, mpl::true_>()
-        (g, std::bind(do_djk_search(), std::placeholders::_1, source,
-                      std::placeholders::_2, pred, weight,
-                      DJKVisitorWrapper(g, vis), DJKCmp(cmp), DJKCmb(cmb),
-                      make_pair(zero, inf)),
-         writable_vertex_properties())(dist_map);
+    SearchRecord rec(DJKVisitorWrapper::get_events(), calls, record);
+    rec.run([&]()
+            {
+                run_action<graph_tool::all_graph_views, mpl::true_>()
+                    (g, std::bind(do_djk_search(), std::placeholders::_1,
+                                  source, std::placeholders::_2, pred, weight,
+                                  DJKVisitorWrapper(g, vis, rec), DJKCmp(cmp),
+                                  DJKCmb(cmb), make_pair(zero, inf)),
+                     writable_vertex_properties())(dist_map);
+            }, events);
 }
 
 #ifdef HAVE_BOOST_COROUTINE
@@ -0,0 +1,194 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SEARCH_VISITOR_HH
+#define GRAPH_SEARCH_VISITOR_HH
+
+#include "graph_filtering.hh"
+#include "graph_python_interface.hh"
+#include "numpy_bind.hh"
+
+#include <boost/python.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace graph_tool
+{
+
+// The events of a search, identified by their position in a list of names.
+// An event is forwarded to the Python visitor only if it overrides the
+// corresponding method (as determined on the Python side), since building
+// the vertex and edge objects and calling into Python dominates the running
+// time otherwise. The vertices or edges of the events requested are recorded
+// into arrays, without involving Python at all. The record is owned by the
+// caller, since the visitors are copied by the search algorithms.
+
+class SearchRecord
+{
+public:
+    SearchRecord(std::vector<std::string> names, boost::python::object calls,
+                 boost::python::object record)
+        : _names(std::move(names)), _call(_names.size()),
+          _record(_names.size()), _vertices(_names.size()),
+          _edges(_names.size())
+    {
+        set_events(calls, _call, false);
+        set_events(record, _record, true);
+    }
+
+    const char* get_name(size_t ev) const { return _names[ev].c_str(); }
+    bool is_called(size_t ev) const { return _call[ev]; }
+    bool is_recorded(size_t ev) const { return _record[ev]; }
+
+    void put_vertex(size_t ev, size_t v)
+    {
+        if (_record[ev])
+            _vertices[ev].push_back(v);
+    }
+
+    void put_edge(size_t ev, size_t s, size_t t)
+    {
+        if (_record[ev])
+            _edges[ev].push_back({{s, t}});
+    }
+
+    // Per-vertex values recorded by specific searches under the event name
+    // "dist", such as the BFS distances.
+    std::vector<int32_t>& get_values(size_t N)
+    {
+        if (_values.size() < N)
+            _values.resize(N, std::numeric_limits<int32_t>::max());
+        return _values;
+    }
+
+    // Runs the search, and stores in the dictionary an array for every event
+    // recorded: the vertices of the vertex events, and the source and target
+    // of the edge events, in the order in which they occurred, and the
+    // per-vertex values. This is done also if the search is interrupted by an
+    // exception raised by the visitor, such as StopSearch.
+    template <class Search>
+    void run(Search&& search, boost::python::dict arrays)
+    {
+        try
+        {
+            search();
+        }
+        catch (boost::python::error_already_set&)
+        {
+            PyObject *type, *value, *traceback;
+            PyErr_Fetch(&type, &value, &traceback);
+            put_arrays(arrays);
+            PyErr_Restore(type, value, traceback);
+            throw;
+        }
+        put_arrays(arrays);
+    }
+
+private:
+    void put_arrays(boost::python::dict arrays)
+    {
+        for (size_t ev = 0; ev < _names.size(); ++ev)
+        {
+            if (!_record[ev])
+                continue;
+            if (_names[ev] == "dist")
+                arrays[_names[ev]] = wrap_vector_owned(_values);
+            else if (is_vertex_event(ev))
+                arrays[_names[ev]] = wrap_vector_owned(_vertices[ev]);
+            else
+                arrays[_names[ev]] = wrap_vector_owned<size_t,2>(_edges[ev]);
+        }
+    }
+
+    bool is_vertex_event(size_t ev) const
+    {
+        const std::string suffix = "_vertex";
+        auto& name = _names[ev];
+        return (name.size() >= suffix.size() &&
+                name.compare(name.size() - suffix.size(), suffix.size(),
+                             suffix) == 0);
+    }
+
+    void set_events(boost::python::object events, std::vector<uint8_t>& flags,
+                    bool check)
+    {
+        if (events.is_none())
+            return;
+        for (int i = 0; i < boost::python::len(events); ++i)
+        {
+            std::string name = boost::python::extract<std::string>(events[i]);
+            auto iter = std::find(_names.begin(), _names.end(), name);
+            if (iter == _names.end())
+            {
+                if (check)
+                    throw ValueException("invalid search event: " + name);
+                continue;
+            }
+            flags[iter - _names.begin()] = true;
+        }
+    }
+
+    std::vector<std::string> _names;
+    std::vector<uint8_t> _call, _record;
+    std::vector<std::vector<size_t>> _vertices;
+    std::vector<std::vector<std::array<size_t, 2>>> _edges;
+    std::vector<int32_t> _values;
+};
+
+// Base of the visitor wrappers, which dispatches the events through the
+// record.
+
+class SearchVisitorWrapper
+{
+public:
+    SearchVisitorWrapper(GraphInterface& gi, boost::python::object vis,
+                         SearchRecord& rec)
+        : _gi(gi), _vis(vis), _rec(rec) {}
+
+protected:
+    template <class Vertex, class Graph>
+    void vertex_event(size_t ev, Vertex u, Graph& g)
+    {
+        _rec.put_vertex(ev, u);
+        if (!_rec.is_called(ev))
+            return;
+        auto gp = retrieve_graph_view<Graph>(_gi, g);
+        _vis.attr(_rec.get_name(ev))(PythonVertex<Graph>(gp, u));
+    }
+
+    template <class Edge, class Graph>
+    void edge_event(size_t ev, const Edge& e, Graph& g)
+    {
+        _rec.put_edge(ev, source(e, g), target(e, g));
+        if (!_rec.is_called(ev))
+            return;
+        auto gp = retrieve_graph_view<Graph>(_gi, g);
+        _vis.attr(_rec.get_name(ev))(PythonEdge<Graph>(gp, e));
+    }
+
+    GraphInterface& _gi;
+    boost::python::object _vis;
+    SearchRecord& _rec;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_SEARCH_VISITOR_HH
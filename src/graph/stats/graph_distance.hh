@@ -28,6 +28,7 @@
 #include "histogram.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "graph_bfs.hh"
 
 namespace graph_tool
 {
@@ -58,11 +59,6 @@ struct get_distance_histogram
                     const vector<long double>& obins, python::object& phist)
         const
     {
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
         typedef Histogram<val_type, size_t, 1> hist_t;
@@ -75,34 +71,65 @@ struct get_distance_histogram
         hist_t hist(bins);
         SharedHistogram<hist_t> s_hist(hist);
 
-        typename hist_t::point_t point;
-        get_vertex_dists_t get_vertex_dists;
+        if constexpr (std::is_same<WeightMap, no_weightS>::value)
+        {
+            // unweighted version: multi-source BFS, from 64 sources at a time
+            vector<size_t> sources;
+            for (auto v : vertices_range(g))
+                sources.push_back(v);
+
+            multi_source_bfs<Graph> bfs(g);
+
+            #pragma omp parallel if (is_parallel_worth(g, bfs_kernel)) \
+                firstprivate(s_hist)
+            {
+                auto visit = [&](auto, uint64_t mask, size_t d)
+                    {
+                        if (d == 0)
+                            return;
+                        typename hist_t::point_t point;
+                        point[0] = d;
+                        s_hist.put_value(point, __builtin_popcountll(mask));
+                    };
+
+                for (size_t i = 0; i < sources.size(); i += bfs.max_sources)
+                {
+                    size_t n = std::min(bfs.max_sources, sources.size() - i);
+                    bfs.run_no_spawn(sources.data() + i, n, visit);
+                }
+            }
+        }
+        else
+        {
+            get_dists_djk get_vertex_dists;
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(s_hist)
-        parallel_vertex_loop_no_spawn
-            (g,
-             [&](auto v)
-             {
-                 unchecked_vector_property_map<val_type,VertexIndex>
-                     dist_map(vertex_index, num_vertices(g));
+            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+                firstprivate(s_hist)
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
+                 {
+                     unchecked_vector_property_map<val_type,VertexIndex>
+                         dist_map(vertex_index, num_vertices(g));
 
-                 for (auto u : vertices_range(g))
-                     dist_map[u] = numeric_limits<val_type>::max();
+                     for (auto u : vertices_range(g))
+                         dist_map[u] = numeric_limits<val_type>::max();
 
-                 dist_map[v] = 0;
-                 get_vertex_dists(g, v, vertex_index, dist_map, weights);
+                     dist_map[v] = 0;
+                     get_vertex_dists(g, v, vertex_index, dist_map, weights);
 
-                 for (auto v2 : vertices_range(g))
-                 {
-                     if (v2 != v &&
-                         dist_map[v2] != numeric_limits<val_type>::max())
+                     typename hist_t::point_t point;
+                     for (auto v2 : vertices_range(g))
                      {
-                         point[0] = dist_map[v2];
-                         s_hist.put_value(point);
+                         if (v2 != v &&
+                             dist_map[v2] != numeric_limits<val_type>::max())
+                         {
+                             point[0] = dist_map[v2];
+                             s_hist.put_value(point);
+                         }
                      }
-                 }
-             });
+                 });
+        }
         s_hist.gather();
 
         python::list ret;
@@ -123,29 +150,6 @@ struct get_distance_histogram
                                     weight_map(weights).distance_map(dist_map));
         }
     };
-
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
-        {
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef gt_hash_map<vertex_t,default_color_type,
-                                DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
-        }
-    };
 };
 
 } // boost namespace
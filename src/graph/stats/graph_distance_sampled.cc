@@ -59,7 +59,26 @@ python::object sampled_distance_histogram(GraphInterface& gi, boost::any weight,
     return ret;
 }
 
+python::object labeling_distance_histogram(GraphInterface& gi,
+                                           PrunedLandmarkLabeling& pll,
+                                           const vector<long double>& bins,
+                                           size_t n_samples, rng_t& rng)
+{
+    if (pll.get_num_vertices() != gi.get_num_vertices(false))
+        throw ValueException("distance labeling does not match the graph");
+
+    python::object ret;
+    run_action<>()(gi,
+                   [&](auto& g)
+                   {
+                       get_labeling_distance_histogram()
+                           (g, pll, n_samples, bins, ret, rng);
+                   })();
+    return ret;
+}
+
 void export_sampled_distance()
 {
     python::def("sampled_distance_histogram", &sampled_distance_histogram);
+    python::def("labeling_distance_histogram", &labeling_distance_histogram);
 }
@@ -28,6 +28,10 @@
 #include "histogram.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "random.hh"
+#include "parallel_rng.hh"
+#include "graph_bfs.hh"
+#include "graph_landmark_labeling.hh"
 
 namespace graph_tool
 {
@@ -58,14 +62,6 @@ struct get_sampled_distance_histogram
                     size_t n_samples, const vector<long double>& obins,
                     python::object& phist, RNG& rng) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
         typedef Histogram<val_type, size_t, 1> hist_t;
@@ -78,48 +74,75 @@ struct get_sampled_distance_histogram
         hist_t hist(bins);
         SharedHistogram<hist_t> s_hist(hist);
 
-        vector<vertex_t> sources;
+        // the sources are sampled without replacement beforehand, so that
+        // the searches need no synchronization
+        vector<size_t> sources;
         sources.reserve(num_vertices(g));
         for (auto v : vertices_range(g))
             sources.push_back(v);
         n_samples = min(n_samples, sources.size());
-
-        typename hist_t::point_t point;
-        get_vertex_dists_t get_vertex_dists;
-
-        #pragma omp parallel for default(shared) private(point) \
-            firstprivate(s_hist) schedule(runtime) \
-            if (num_vertices(g) * n_samples > OPENMP_MIN_THRESH)
         for (size_t i = 0; i < n_samples; ++i)
         {
-            vertex_t v;
-            #pragma omp critical
-            {
-                uniform_int_distribution<size_t> randint(0, sources.size()-1);
-                size_t j = randint(rng);
-                v = sources[j];
-                swap(sources[j], sources.back());
-                sources.pop_back();
-            }
-
-            unchecked_vector_property_map<val_type,VertexIndex>
-                dist_map(vertex_index, num_vertices(g));
-
-            for (auto u : vertices_range(g))
-                dist_map[u] = numeric_limits<val_type>::max();
+            uniform_int_distribution<size_t> randint(i, sources.size() - 1);
+            swap(sources[i], sources[randint(rng)]);
+        }
+        sources.resize(n_samples);
 
-            dist_map[v] = 0;
-            get_vertex_dists(g, v, vertex_index, dist_map, weights);
+        if constexpr (std::is_same<WeightMap, no_weightS>::value)
+        {
+            // unweighted version: multi-source BFS, from 64 sources at a time
+            multi_source_bfs<Graph> bfs(g);
 
-            for (auto v2 : vertices_range(g))
+            #pragma omp parallel if (is_parallel_worth(g, bfs_kernel)) \
+                firstprivate(s_hist)
             {
-                if (v2 != v && dist_map[v2] != numeric_limits<val_type>::max())
+                auto visit = [&](auto, uint64_t mask, size_t d)
+                    {
+                        if (d == 0)
+                            return;
+                        typename hist_t::point_t point;
+                        point[0] = d;
+                        s_hist.put_value(point, __builtin_popcountll(mask));
+                    };
+
+                for (size_t i = 0; i < sources.size(); i += bfs.max_sources)
                 {
-                    point[0] = dist_map[v2];
-                    s_hist.put_value(point);
+                    size_t n = std::min(bfs.max_sources, sources.size() - i);
+                    bfs.run_no_spawn(sources.data() + i, n, visit);
                 }
             }
         }
+        else
+        {
+            get_dists_djk get_vertex_dists;
+
+            #pragma omp parallel if (num_vertices(g) * n_samples > OPENMP_MIN_THRESH) \
+                firstprivate(s_hist)
+            parallel_loop_no_spawn
+                (sources,
+                 [&](size_t, auto v)
+                 {
+                     unchecked_vector_property_map<val_type,VertexIndex>
+                         dist_map(vertex_index, num_vertices(g));
+
+                     for (auto u : vertices_range(g))
+                         dist_map[u] = numeric_limits<val_type>::max();
+
+                     dist_map[v] = 0;
+                     get_vertex_dists(g, v, vertex_index, dist_map, weights);
+
+                     typename hist_t::point_t point;
+                     for (auto v2 : vertices_range(g))
+                     {
+                         if (v2 != v &&
+                             dist_map[v2] != numeric_limits<val_type>::max())
+                         {
+                             point[0] = dist_map[v2];
+                             s_hist.put_value(point);
+                         }
+                     }
+                 });
+        }
         s_hist.gather();
 
         python::list ret;
@@ -140,30 +163,89 @@ struct get_sampled_distance_histogram
                                     weight_map(weights).distance_map(dist_map));
         }
     };
+};
+
+// Histogram of the distances between randomly sampled pairs of distinct
+// vertices, or all of them if n_samples == 0, obtained from a distance
+// labeling of the graph.
 
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
+struct get_labeling_distance_histogram
+{
+    template <class Graph, class RNG>
+    void operator()(const Graph& g, const PrunedLandmarkLabeling& pll,
+                    size_t n_samples, const vector<long double>& obins,
+                    python::object& phist, RNG& rng) const
     {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
+        typedef Histogram<size_t, size_t, 1> hist_t;
+
+        std::array<vector<size_t>,1> bins;
+        bins[0].resize(obins.size());
+        for (size_t i = 0; i < obins.size(); ++i)
+            bins[0][i] = obins[i];
+
+        hist_t hist(bins);
+        SharedHistogram<hist_t> s_hist(hist);
+
+        vector<size_t> vs;
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+
+        auto put = [&](auto& s_hist, size_t s, size_t t)
+            {
+                auto d = pll.query(s, t);
+                if (d == PrunedLandmarkLabeling::inf)
+                    return;
+                typename hist_t::point_t point;
+                point[0] = d;
+                s_hist.put_value(point);
+            };
+
+        if (n_samples == 0)
         {
-            typedef typename vprop_map_t<default_color_type>::type::unchecked_t vmap_t;
-            vmap_t color_map(vertex_index, num_vertices(g));
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
+            #pragma omp parallel if (is_parallel_worth(vs.size() * vs.size() * \
+                                                       pll_query_kernel.get_cost())) \
+                firstprivate(s_hist)
+            parallel_loop_no_spawn
+                (vs,
+                 [&](size_t, auto s)
                  {
-                     color_map[v] = color_traits<default_color_type>::white();
+                     for (auto t : vs)
+                     {
+                         if (t != s)
+                             put(s_hist, s, t);
+                     }
                  });
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
         }
-    };
+        else if (vs.size() > 1)
+        {
+            parallel_rng<RNG>::init(rng);
+
+            #pragma omp parallel if (is_parallel_worth(n_samples * \
+                                                       pll_query_kernel.get_cost())) \
+                firstprivate(s_hist)
+            {
+                auto& rng_ = parallel_rng<RNG>::get(rng);
+                uniform_int_distribution<size_t> sample(0, vs.size() - 1);
+                uniform_int_distribution<size_t> sample_t(0, vs.size() - 2);
+
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < n_samples; ++i)
+                {
+                    size_t j = sample(rng_);
+                    size_t k = sample_t(rng_);
+                    if (k >= j)
+                        ++k;
+                    put(s_hist, vs[j], vs[k]);
+                }
+            }
+        }
+        s_hist.gather();
+
+        python::list ret;
+        ret.append(wrap_multi_array_owned<size_t,1>(hist.get_array()));
+        ret.append(wrap_vector_owned<size_t>(hist.get_bins()[0]));
+        phist = ret;
+    }
 };
 
 } // boost namespace
@@ -19,6 +19,7 @@
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "graph_bfs.hh"
 
 #include <boost/python.hpp>
 
@@ -63,67 +64,45 @@ struct do_all_pairs_search
     }
 };
 
+// The unweighted distances are obtained with multi-source BFS, from 64 sources
+// at a time.
+
 struct do_all_pairs_search_unweighted
 {
-    template <class DistMap, class PredMap>
-    class bfs_visitor: public boost::bfs_visitor<null_visitor>
+    template <class Graph, class DistMap>
+    void operator()(const Graph& g, DistMap dist_map) const
     {
-    public:
-        bfs_visitor(DistMap& dist_map, PredMap& pred, size_t source)
-        : _dist_map(dist_map), _pred(pred), _source(source) {}
+        typedef typename property_traits<DistMap>::value_type::value_type
+            dist_t;
+        constexpr dist_t inf = std::is_floating_point<dist_t>::value ?
+            numeric_limits<dist_t>::infinity() :
+            numeric_limits<dist_t>::max();
 
-        template <class Graph>
-        void initialize_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                               Graph&)
-        {
-            typedef typename DistMap::value_type dist_t;
-            dist_t inf = std::is_floating_point<dist_t>::value ?
-                numeric_limits<dist_t>::infinity() :
-                numeric_limits<dist_t>::max();
-            _dist_map[v] = (v == _source) ? 0 : inf;
-            _pred[v] = v;
-        }
+        size_t N = num_vertices(g);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 dist_map[v].clear();
+                 dist_map[v].resize(N, inf);
+             });
 
-        template <class Graph>
-        void tree_edge(const typename graph_traits<Graph>::edge_descriptor& e,
-                       Graph& g)
-        {
-            _pred[target(e,g)] = source(e,g);
-        }
+        vector<size_t> sources;
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
 
-        template <class Graph>
-        void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                             Graph&)
+        multi_source_bfs<Graph> bfs(g);
+        for (size_t i = 0; i < sources.size(); i += bfs.max_sources)
         {
-            if (size_t(_pred[v]) == v)
-                return;
-            _dist_map[v] = _dist_map[_pred[v]] + 1;
+            const size_t* s = sources.data() + i;
+            size_t n = std::min(bfs.max_sources, sources.size() - i);
+            bfs.run(s, n,
+                    [&](auto v, uint64_t mask, size_t d)
+                    {
+                        for (; mask != 0; mask &= mask - 1)
+                            dist_map[s[__builtin_ctzll(mask)]][v] = d;
+                    });
         }
-
-    private:
-        DistMap& _dist_map;
-        PredMap& _pred;
-        size_t _source;
-    };
-
-    template <class Graph, class DistMap>
-    void operator()(const Graph& g, DistMap dist_map) const
-    {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-        typedef typename property_traits<DistMap>::value_type dist_t;
-
-        vector<vertex_t> pred_map(num_vertices(g));
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(pred_map)
-        parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     dist_map[v].resize(num_vertices(g), 0);
-                     bfs_visitor<dist_t,vector<size_t>>
-                         vis(dist_map[v], pred_map, v);
-                     breadth_first_search(g, v, visitor(vis));
-                 });
     }
 };
 
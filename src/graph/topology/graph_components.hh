@@ -22,6 +22,9 @@
 #include <boost/graph/strong_components.hpp>
 #include <boost/graph/biconnected_components.hpp>
 
+#include "graph_bfs.hh"
+#include "graph_components_parallel.hh"
+
 namespace graph_tool
 {
 template <class PropertyMap>
@@ -99,6 +102,13 @@ void put(HistogramPropertyMap<PropertyMap> pmap,
 // this will label the components of a graph to a given vertex property, from
 // [0, number of components - 1], and keep an histogram. If the graph is
 // directed the strong components are used.
+//
+// The components are found in parallel (see graph_components_parallel.hh),
+// and labeled in the order of their smallest vertex, which is also the order
+// of boost::connected_components(). The strong components of graphs too small
+// for a parallel search are found with boost::strong_components() instead,
+// and relabeled in the same order, so that the labels do not depend on which
+// search was used.
 struct label_components
 {
     template <class Graph, class CompMap>
@@ -117,14 +127,28 @@ struct label_components
     void get_components(Graph& g, CompMap comp_map,
                         std::true_type) const
     {
-        boost::strong_components(g, comp_map);
+        vector<size_t> comp;
+        if (is_parallel_worth(g, components_kernel))
+        {
+            parallel_strong_components(g, comp);
+        }
+        else
+        {
+            comp.resize(num_vertices(g));
+            boost::strong_components(g, make_iterator_property_map
+                                         (comp.begin(),
+                                          get(vertex_index_t(), g)));
+        }
+        put_component_labels(g, comp, comp_map);
     }
 
     template <class Graph, class CompMap>
     void get_components(Graph& g, CompMap comp_map,
                         std::false_type) const
     {
-        boost::connected_components(g, comp_map);
+        vector<size_t> comp;
+        parallel_connected_components(g, comp);
+        put_component_labels(g, comp, comp_map);
     }
 };
 
@@ -164,27 +188,13 @@ struct label_biconnected_components
 
 struct label_out_component
 {
-    template <class CompMap>
-    class marker_visitor: public bfs_visitor<>
-    {
-    public:
-        marker_visitor() { }
-        marker_visitor(CompMap comp) : _comp(comp) { }
-
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex u, const Graph&)
-        {
-            _comp[u] = true;
-        }
-    private:
-        CompMap _comp;
-    };
-
     template <class Graph, class CompMap>
     void operator()(Graph& g, CompMap comp_map, size_t root) const
     {
-        marker_visitor<CompMap> marker(comp_map);
-        breadth_first_search(g, vertex(root, g), visitor(marker));
+        auto comp = comp_map.get_unchecked(num_vertices(g));
+        comp[root] = true;
+        parallel_bfs(g, root, numeric_limits<size_t>::max(),
+                     [&](auto v, auto, auto) { comp[v] = true; });
     }
 };
 
@@ -0,0 +1,106 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "numpy_bind.hh"
+
+#include "graph_contraction_hierarchy.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+ContractionHierarchy build_contraction_hierarchy(GraphInterface& gi,
+                                                 boost::any weight,
+                                                 size_t max_settled)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (weight.empty())
+        weight = weight_map_t();
+
+    ContractionHierarchy ch;
+    run_action<all_graph_views_frozen>()
+        (gi, [&](auto& g, auto w) { ch.build(g, w, max_settled); },
+         weight_props_t())(weight);
+    return ch;
+}
+
+void export_contraction_hierarchy()
+{
+    using namespace boost::python;
+
+    def("build_contraction_hierarchy", &build_contraction_hierarchy);
+
+    class_<ContractionHierarchy>("ContractionHierarchy")
+        .def("distance", &ContractionHierarchy::distance)
+        .def("path",
+             +[](ContractionHierarchy& ch, size_t s, size_t t)
+              {
+                  return wrap_vector_owned<size_t>(ch.path(s, t));
+              })
+        .def("distances",
+             +[](ContractionHierarchy& ch, object osources, object otargets,
+                 object odist)
+              {
+                  auto sources = get_array<int64_t, 1>(osources);
+                  auto targets = get_array<int64_t, 1>(otargets);
+                  auto dist = get_array<double, 1>(odist);
+                  ch.distances(sources, targets, dist);
+              })
+        .def("get_num_vertices", &ContractionHierarchy::get_num_vertices)
+        .def("get_num_arcs", &ContractionHierarchy::get_num_arcs)
+        .def("get_state",
+             +[](ContractionHierarchy& ch)
+              {
+                  auto state = ch.get_state();
+                  return boost::python::make_tuple
+                      (wrap_vector_owned(std::get<0>(state)),
+                       wrap_vector_owned(std::get<1>(state)),
+                       wrap_vector_owned(std::get<2>(state)),
+                       wrap_vector_owned(std::get<3>(state)),
+                       wrap_vector_owned(std::get<4>(state)),
+                       wrap_vector_owned(std::get<5>(state)),
+                       wrap_vector_owned(std::get<6>(state)),
+                       wrap_vector_owned(std::get<7>(state)),
+                       wrap_vector_owned(std::get<8>(state)));
+              })
+        .def("set_state",
+             +[](ContractionHierarchy& ch, object orank, object oup_pos,
+                 object oup_v, object oup_w, object oup_mid, object odown_pos,
+                 object odown_v, object odown_w, object odown_mid)
+              {
+                  auto rank = get_array<int64_t, 1>(orank);
+                  auto up_pos = get_array<int64_t, 1>(oup_pos);
+                  auto up_v = get_array<int64_t, 1>(oup_v);
+                  auto up_w = get_array<double, 1>(oup_w);
+                  auto up_mid = get_array<int64_t, 1>(oup_mid);
+                  auto down_pos = get_array<int64_t, 1>(odown_pos);
+                  auto down_v = get_array<int64_t, 1>(odown_v);
+                  auto down_w = get_array<double, 1>(odown_w);
+                  auto down_mid = get_array<int64_t, 1>(odown_mid);
+                  ch.set_state(rank, up_pos, up_v, up_w, up_mid, down_pos,
+                               down_v, down_w, down_mid);
+              });
+}
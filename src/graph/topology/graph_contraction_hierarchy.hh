@@ -0,0 +1,625 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CONTRACTION_HIERARCHY_HH
+#define GRAPH_CONTRACTION_HIERARCHY_HH
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include "graph.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Contraction hierarchies
+// =======================
+//
+// The vertices are contracted one by one, in order of increasing importance
+// [geisberger-contraction-2008]. Contracting a vertex v removes it from the
+// graph, and adds a shortcut u -> x of length w(u, v) + w(v, x) for every pair
+// of remaining neighbors for which the path u -> v -> x is the only shortest
+// one, as determined by a bounded "witness" search from u that avoids v. The
+// order is given by the edge difference (the number of shortcuts minus the
+// number of removed edges) plus the number of neighbors already contracted,
+// which is updated lazily.
+//
+// Every edge and shortcut is stored at its lower-ranked endpoint: the upward
+// lists contain the arcs v -> x, and the downward lists the arcs u -> v, with
+// rank(u), rank(x) > rank(v). The shortest path between s and t can then be
+// found with a bidirectional search, forward from s through the upward arcs
+// and backward from t through the downward arcs, both of which only ever move
+// to higher ranks, and so settle very few vertices. Shortcuts remember the
+// vertex they bypass, so that the paths can be unpacked.
+//
+// [geisberger-contraction-2008] R. Geisberger, P. Sanders, D. Schultes,
+//    D. Delling, "Contraction Hierarchies: Faster and Simpler Hierarchical
+//    Routing in Road Networks", WEA 2008, LNCS 5038, pp. 319-333,
+//    DOI: 10.1007/978-3-540-68552-4_24
+
+inline const openmp_kernel ch_query_kernel("contraction_hierarchy_query",
+                                            1000);
+
+class ContractionHierarchy
+{
+public:
+    static constexpr size_t null = numeric_limits<size_t>::max();
+
+    struct arc_t
+    {
+        size_t v;
+        double w;
+        size_t mid;   // bypassed vertex, or null if this is an original edge
+    };
+
+    ContractionHierarchy() : _N(0), _up_pos(1, 0), _down_pos(1, 0) {}
+
+    template <class Graph, class WeightMap>
+    void build(const Graph& g, WeightMap weight, size_t max_settled);
+
+    size_t get_num_vertices() const { return _N; }
+    size_t get_num_arcs() const { return _up.size() + _down.size(); }
+
+    // Distance from s to t, or infinity if t is not reachable.
+    double distance(size_t s, size_t t)
+    {
+        return query(s, t, _ws).first;
+    }
+
+    // Vertices in the shortest path from s to t, which is empty if t is not
+    // reachable.
+    vector<size_t> path(size_t s, size_t t)
+    {
+        vector<size_t> p;
+        auto m = query(s, t, _ws).second;
+        if (m == null)
+            return p;
+
+        vector<size_t> stack;
+        for (size_t v = m; v != s; v = _ws.parent[0][v])
+            stack.push_back(_ws.parent_arc[0][v]);
+        p.push_back(s);
+        for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter)
+        {
+            auto k = *iter;
+            unpack(p.back(), _up[k].v, _up[k].mid, p);
+        }
+        for (size_t v = m; v != t; v = _ws.parent[1][v])
+        {
+            auto& a = _down[_ws.parent_arc[1][v]];
+            unpack(v, _ws.parent[1][v], a.mid, p);
+        }
+        return p;
+    }
+
+    // Distances between the pairs (sources[i], targets[i]), in parallel.
+    template <class Array, class DArray>
+    void distances(Array& sources, Array& targets, DArray& dist)
+    {
+        size_t M = sources.shape()[0];
+        if (targets.shape()[0] != M || dist.shape()[0] != M)
+            throw ValueException("sources and targets must have the same size");
+        for (size_t i = 0; i < M; ++i)
+        {
+            if (size_t(sources[i]) >= _N || size_t(targets[i]) >= _N)
+                throw ValueException("invalid vertex");
+        }
+
+        #pragma omp parallel if (is_parallel_worth(M * ch_query_kernel.get_cost()))
+        {
+            workspace ws;
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < M; ++i)
+                dist[i] = query(sources[i], targets[i], ws).first;
+        }
+    }
+
+    // Flat representation of the index, for serialization: the ranks of the
+    // vertices (-1 for those filtered out), and for the upward and downward
+    // arcs the offsets of every vertex, the endpoints, the lengths and the
+    // bypassed vertices (-1 for original edges).
+    typedef std::tuple<vector<int64_t>,
+                       vector<int64_t>, vector<int64_t>, vector<double>,
+                       vector<int64_t>,
+                       vector<int64_t>, vector<int64_t>, vector<double>,
+                       vector<int64_t>> state_t;
+
+    state_t get_state() const
+    {
+        state_t state;
+        for (auto r : _rank)
+            std::get<0>(state).push_back((r == null) ? -1 : int64_t(r));
+        pack(_up_pos, _up, std::get<1>(state), std::get<2>(state),
+             std::get<3>(state), std::get<4>(state));
+        pack(_down_pos, _down, std::get<5>(state), std::get<6>(state),
+             std::get<7>(state), std::get<8>(state));
+        return state;
+    }
+
+    // The state is validated completely before it replaces the index, which
+    // is left untouched if the state is invalid. The vertices which were
+    // filtered out when the index was built have a negative rank.
+    template <class IArray, class DArray>
+    void set_state(IArray& rank, IArray& up_pos, IArray& up_v, DArray& up_w,
+                   IArray& up_mid, IArray& down_pos, IArray& down_v,
+                   DArray& down_w, IArray& down_mid)
+    {
+        size_t N = rank.shape()[0];
+        vector<size_t> nrank(N, null);
+        vector<uint8_t> taken(N, false);
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (rank[v] < 0)
+                continue;
+            if (size_t(rank[v]) >= N || taken[rank[v]])
+                throw ValueException("invalid contraction hierarchy state");
+            nrank[v] = rank[v];
+            taken[rank[v]] = true;
+        }
+
+        vector<size_t> nup_pos, ndown_pos;
+        vector<arc_t> nup, ndown;
+        unpack_arcs(nrank, up_pos, up_v, up_w, up_mid, nup_pos, nup);
+        unpack_arcs(nrank, down_pos, down_v, down_w, down_mid, ndown_pos,
+                    ndown);
+
+        _N = N;
+        _rank.swap(nrank);
+        _up_pos.swap(nup_pos);
+        _up.swap(nup);
+        _down_pos.swap(ndown_pos);
+        _down.swap(ndown);
+        _ws = workspace();
+    }
+
+private:
+    struct workspace
+    {
+        // index 0 is the forward search, and 1 the backward search
+        vector<double> dist[2];
+        vector<size_t> parent[2];
+        vector<size_t> parent_arc[2];
+        vector<size_t> touched[2];
+    };
+
+    typedef pair<double, size_t> item_t;
+    typedef priority_queue<item_t, vector<item_t>, std::greater<item_t>>
+        queue_t;
+
+    pair<double, size_t> query(size_t s, size_t t, workspace& ws)
+    {
+        constexpr double inf = numeric_limits<double>::infinity();
+
+        if (s >= _N || t >= _N)
+            throw ValueException("invalid vertex");
+
+        for (size_t d = 0; d < 2; ++d)
+        {
+            if (ws.dist[d].size() < _N)
+            {
+                ws.dist[d].resize(_N, inf);
+                ws.parent[d].resize(_N, null);
+                ws.parent_arc[d].resize(_N, null);
+            }
+            for (auto v : ws.touched[d])
+                ws.dist[d][v] = inf;
+            ws.touched[d].clear();
+        }
+
+        queue_t queue[2];
+        ws.dist[0][s] = 0;
+        ws.parent[0][s] = s;
+        ws.touched[0].push_back(s);
+        queue[0].emplace(0, s);
+        ws.dist[1][t] = 0;
+        ws.parent[1][t] = t;
+        ws.touched[1].push_back(t);
+        queue[1].emplace(0, t);
+
+        double best = (s == t) ? 0 : inf;
+        size_t meet = (s == t) ? s : null;
+
+        const vector<size_t>* pos[2] = {&_up_pos, &_down_pos};
+        const vector<arc_t>* arcs[2] = {&_up, &_down};
+
+        size_t d = 0;
+        while (!queue[0].empty() || !queue[1].empty())
+        {
+            // alternate the directions, skipping exhausted ones
+            if (queue[d].empty())
+                d = 1 - d;
+            auto& q = queue[d];
+
+            auto [du, u] = q.top();
+            q.pop();
+            if (du > ws.dist[d][u])
+                continue;
+
+            // each search can stop once it cannot improve the best path
+            if (du >= best)
+            {
+                while (!q.empty())
+                    q.pop();
+                d = 1 - d;
+                continue;
+            }
+
+            double dm = du + ws.dist[1 - d][u];
+            if (dm < best)
+            {
+                best = dm;
+                meet = u;
+            }
+
+            for (size_t k = (*pos[d])[u]; k < (*pos[d])[u + 1]; ++k)
+            {
+                auto& a = (*arcs[d])[k];
+                double dv = du + a.w;
+                if (dv >= ws.dist[d][a.v])
+                    continue;
+                if (ws.dist[d][a.v] == inf)
+                    ws.touched[d].push_back(a.v);
+                ws.dist[d][a.v] = dv;
+                ws.parent[d][a.v] = u;
+                ws.parent_arc[d][a.v] = k;
+                q.emplace(dv, a.v);
+            }
+            d = 1 - d;
+        }
+        return {best, meet};
+    }
+
+    // appends the original path from u to v (excluding u) given an arc with
+    // bypassed vertex mid
+    void unpack(size_t u, size_t v, size_t mid, vector<size_t>& p) const
+    {
+        if (mid == null)
+        {
+            p.push_back(v);
+            return;
+        }
+        // u -> mid is stored downward at mid, and mid -> v upward at mid
+        unpack(u, mid, find_arc(_down_pos, _down, mid, u).mid, p);
+        unpack(mid, v, find_arc(_up_pos, _up, mid, v).mid, p);
+    }
+
+    const arc_t& find_arc(const vector<size_t>& pos, const vector<arc_t>& arcs,
+                          size_t v, size_t u) const
+    {
+        for (size_t k = pos[v]; k < pos[v + 1]; ++k)
+        {
+            if (arcs[k].v == u)
+                return arcs[k];
+        }
+        throw GraphException("inconsistent contraction hierarchy");
+    }
+
+    static void pack(const vector<size_t>& pos, const vector<arc_t>& arcs,
+                     vector<int64_t>& opos, vector<int64_t>& ov,
+                     vector<double>& ow, vector<int64_t>& omid)
+    {
+        opos.assign(pos.begin(), pos.end());
+        for (auto& a : arcs)
+        {
+            ov.push_back(a.v);
+            ow.push_back(a.w);
+            omid.push_back((a.mid == null) ? -1 : int64_t(a.mid));
+        }
+    }
+
+    // Converts the flat arcs, checking the invariants of the hierarchy: the
+    // offsets are monotonic, every arc leads to a vertex of higher rank than
+    // the one it is stored at, and bypasses a vertex of lower rank. The latter
+    // guarantee that the searches and the path unpacking terminate. Vertices
+    // without rank (i.e. filtered out) have no arcs.
+    template <class IArray, class DArray>
+    static void unpack_arcs(const vector<size_t>& rank, IArray& ipos,
+                            IArray& iv, DArray& iw, IArray& imid,
+                            vector<size_t>& pos, vector<arc_t>& arcs)
+    {
+        size_t N = rank.size();
+        size_t M = iv.shape()[0];
+        if (ipos.shape()[0] != N + 1 || iw.shape()[0] != M ||
+            imid.shape()[0] != M || ipos[0] != 0 || size_t(ipos[N]) != M)
+            throw ValueException("invalid contraction hierarchy state");
+        for (size_t u = 0; u < N; ++u)
+        {
+            if (ipos[u + 1] < ipos[u] ||
+                (rank[u] == null && ipos[u + 1] != ipos[u]))
+                throw ValueException("invalid contraction hierarchy state");
+        }
+
+        pos.assign(ipos.begin(), ipos.end());
+        arcs.resize(M);
+        for (size_t u = 0; u < N; ++u)
+        {
+            for (size_t k = pos[u]; k < pos[u + 1]; ++k)
+            {
+                auto v = iv[k];
+                auto mid = imid[k];
+                if (v < 0 || size_t(v) >= N || rank[v] <= rank[u] ||
+                    rank[v] == null ||
+                    iw[k] < 0 ||
+                    (mid >= 0 && (size_t(mid) >= N || rank[mid] >= rank[u])))
+                    throw ValueException("invalid contraction hierarchy state");
+                arcs[k].v = v;
+                arcs[k].w = iw[k];
+                arcs[k].mid = (mid < 0) ? null : size_t(mid);
+            }
+        }
+    }
+
+    static void flatten(vector<vector<arc_t>>& lists, vector<size_t>& pos,
+                        vector<arc_t>& arcs)
+    {
+        pos.resize(lists.size() + 1);
+        pos[0] = 0;
+        for (size_t v = 0; v < lists.size(); ++v)
+            pos[v + 1] = pos[v] + lists[v].size();
+        arcs.clear();
+        arcs.reserve(pos.back());
+        for (auto& l : lists)
+        {
+            arcs.insert(arcs.end(), l.begin(), l.end());
+            vector<arc_t>().swap(l);
+        }
+    }
+
+    class contraction;
+
+    size_t _N;
+    vector<size_t> _rank;
+    vector<size_t> _up_pos, _down_pos;
+    vector<arc_t> _up, _down;
+    workspace _ws;
+};
+
+// Contraction state: the arcs between the vertices not yet contracted.
+
+class ContractionHierarchy::contraction
+{
+public:
+    struct search_t
+    {
+        vector<double> dist;
+        vector<size_t> touched;
+    };
+
+    template <class Graph, class WeightMap>
+    contraction(const Graph& g, WeightMap weight, size_t max_settled)
+        : _N(num_vertices(g)), _out(_N), _in(_N), _deleted(_N, 0),
+          _max_settled(max_settled)
+    {
+        for (auto u : vertices_range(g))
+        {
+            for (const auto& e : out_edges_range(u, g))
+            {
+                size_t v = target(e, g);
+                double w = get(weight, e);
+                if (w < 0)
+                    throw ValueException("the weights must be non-negative");
+                if (v == size_t(u))
+                    continue;
+                add_arc(u, v, w, null);
+            }
+        }
+    }
+
+    // shortcuts needed to contract v, as (u, x, w)
+    template <class F>
+    void get_shortcuts(size_t v, search_t& s, F&& f)
+    {
+        double max_out = 0;
+        for (auto& a : _out[v])
+            max_out = std::max(max_out, a.w);
+        for (auto& a : _in[v])
+        {
+            size_t u = a.v;
+            witness_search(u, v, a.w + max_out, s);
+            for (auto& b : _out[v])
+            {
+                size_t x = b.v;
+                if (x == u)
+                    continue;
+                double w = a.w + b.w;
+                if (s.dist[x] > w)
+                    f(u, x, w);
+            }
+        }
+    }
+
+    search_t get_search() const
+    {
+        return {vector<double>(_N, numeric_limits<double>::infinity()), {}};
+    }
+
+    int64_t priority(size_t v, search_t& s)
+    {
+        int64_t n_shortcuts = 0;
+        get_shortcuts(v, s, [&](auto, auto, auto) { ++n_shortcuts; });
+        return n_shortcuts - int64_t(_out[v].size() + _in[v].size()) +
+            _deleted[v];
+    }
+
+    // contracts v, and returns its upward and downward arcs
+    void contract(size_t v, search_t& s, vector<arc_t>& up,
+                  vector<arc_t>& down)
+    {
+        vector<std::tuple<size_t, size_t, double>> shortcuts;
+        get_shortcuts(v, s,
+                      [&](auto u, auto x, auto w)
+                      { shortcuts.emplace_back(u, x, w); });
+        for (auto& sc : shortcuts)
+            add_arc(get<0>(sc), get<1>(sc), get<2>(sc), v);
+
+        for (auto& a : _out[v])
+        {
+            remove_arc(_in[a.v], v);
+            ++_deleted[a.v];
+        }
+        for (auto& a : _in[v])
+        {
+            remove_arc(_out[a.v], v);
+            ++_deleted[a.v];
+        }
+        up.swap(_out[v]);
+        down.swap(_in[v]);
+        vector<arc_t>().swap(_out[v]);
+        vector<arc_t>().swap(_in[v]);
+    }
+
+private:
+    void add_arc(size_t u, size_t v, double w, size_t mid)
+    {
+        for (auto& a : _out[u])
+        {
+            if (a.v != v)
+                continue;
+            if (w < a.w)
+            {
+                a.w = w;
+                a.mid = mid;
+                for (auto& b : _in[v])
+                {
+                    if (b.v == u)
+                    {
+                        b.w = w;
+                        b.mid = mid;
+                    }
+                }
+            }
+            return;
+        }
+        _out[u].push_back({v, w, mid});
+        _in[v].push_back({u, w, mid});
+    }
+
+    static void remove_arc(vector<arc_t>& arcs, size_t v)
+    {
+        for (size_t i = 0; i < arcs.size(); ++i)
+        {
+            if (arcs[i].v != v)
+                continue;
+            arcs[i] = arcs.back();
+            arcs.pop_back();
+            return;
+        }
+    }
+
+    // bounded Dijkstra search from u, avoiding v, in the remaining graph
+    void witness_search(size_t u, size_t v, double max_dist, search_t& s)
+    {
+        constexpr double inf = numeric_limits<double>::infinity();
+        for (auto x : s.touched)
+            s.dist[x] = inf;
+        s.touched.clear();
+
+        queue_t queue;
+        s.dist[u] = 0;
+        s.touched.push_back(u);
+        queue.emplace(0, u);
+        size_t n_settled = 0;
+        while (!queue.empty() && n_settled < _max_settled)
+        {
+            auto [dx, x] = queue.top();
+            queue.pop();
+            if (dx > s.dist[x])
+                continue;
+            if (dx > max_dist)
+                break;
+            ++n_settled;
+            for (auto& a : _out[x])
+            {
+                if (a.v == v)
+                    continue;
+                double dy = dx + a.w;
+                if (dy >= s.dist[a.v])
+                    continue;
+                if (s.dist[a.v] == inf)
+                    s.touched.push_back(a.v);
+                s.dist[a.v] = dy;
+                queue.emplace(dy, a.v);
+            }
+        }
+    }
+
+    size_t _N;
+    vector<vector<arc_t>> _out, _in;
+    vector<int64_t> _deleted;
+    size_t _max_settled;
+};
+
+template <class Graph, class WeightMap>
+void ContractionHierarchy::build(const Graph& g, WeightMap weight,
+                                 size_t max_settled)
+{
+    _N = num_vertices(g);
+    contraction c(g, weight, max_settled);
+
+    // the initial priorities are independent, and computed in parallel
+    vector<int64_t> prio(_N);
+    #pragma omp parallel if (is_parallel_worth(_N + num_edges(g)))
+    {
+        auto s = c.get_search();
+        parallel_vertex_loop_no_spawn
+            (g, [&](auto v) { prio[v] = c.priority(v, s); });
+    }
+
+    typedef pair<int64_t, size_t> pitem_t;
+    priority_queue<pitem_t, vector<pitem_t>, std::greater<pitem_t>> queue;
+    for (auto v : vertices_range(g))
+        queue.emplace(prio[v], v);
+
+    vector<vector<arc_t>> up(_N), down(_N);
+    _rank.clear();
+    _rank.resize(_N, null);
+    size_t r = 0;
+    auto s = c.get_search();
+    while (!queue.empty())
+    {
+        auto [p, v] = queue.top();
+        queue.pop();
+        if (p != prio[v] || _rank[v] != null)
+            continue;
+
+        // lazy update: the vertex is only contracted if its current priority
+        // is still the smallest
+        prio[v] = c.priority(v, s);
+        if (!queue.empty() && prio[v] > queue.top().first)
+        {
+            queue.emplace(prio[v], v);
+            continue;
+        }
+
+        c.contract(v, s, up[v], down[v]);
+        _rank[v] = r++;
+    }
+
+    flatten(up, _up_pos, _up);
+    flatten(down, _down_pos, _down);
+    _ws = workspace();
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_CONTRACTION_HIERARCHY_HH
@@ -0,0 +1,446 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_DELTA_STEPPING_HH
+#define GRAPH_DELTA_STEPPING_HH
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "graph.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Parallel delta-stepping single-source shortest paths
+// ====================================================
+//
+// The tentative distances are kept in buckets of width delta
+// [meyer-delta-stepping-2003], which are settled in increasing order. The
+// vertices in the current bucket are expanded in parallel through their light
+// edges (weight <= delta) repeatedly, until the bucket remains empty, and only
+// then once through their heavy edges, which cannot lead back into it.
+//
+// The vertices are split in contiguous blocks, one per thread, and only the
+// owner of a vertex modifies its distance, predecessor and bucket. The
+// relaxations are written to thread-local buffers, one per destination
+// thread, which are processed by their owners after a barrier, so that no
+// atomic operations are needed.
+//
+// [meyer-delta-stepping-2003] U. Meyer, P. Sanders, "Delta-stepping: a
+//    parallelizable shortest path algorithm", Journal of Algorithms 49 (1),
+//    pp. 114-152, 2003, DOI: 10.1016/S0196-6774(03)00076-2
+
+inline const openmp_kernel delta_stepping_kernel("delta_stepping", 4);
+
+// Choose delta as the maximum weight divided by the average degree, as
+// suggested in [meyer-delta-stepping-2003] for random weights.
+template <class Graph, class WeightMap>
+double get_delta_stepping_width(const Graph& g, WeightMap weight)
+{
+    double max_w = 0;
+    double min_w = 0;
+    size_t E = 0;
+    size_t N = 0;
+    #pragma omp parallel if (is_parallel_worth(num_vertices(g) + num_edges(g))) \
+        reduction(max:max_w) reduction(min:min_w) reduction(+:E, N)
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto v)
+         {
+             ++N;
+             for (const auto& e : out_edges_range(v, g))
+             {
+                 double w = get(weight, e);
+                 max_w = std::max(max_w, w);
+                 min_w = std::min(min_w, w);
+                 ++E;
+             }
+         });
+
+    if (min_w < 0)
+        throw ValueException("the weights must be non-negative");
+
+    double delta = (E > 0) ? max_w / (double(E) / N) : 1;
+    return (delta > 0) ? delta : 1;
+}
+
+// The distances of the vertices not yet reached must be initialized to inf,
+// and that of the source to zero. The search stops once the current bucket
+// starts above max_dist, or when stop(d) returns true, where d is the
+// distance below which all vertices have been settled.
+
+template <class Graph, class DistMap, class PredMap, class WeightMap,
+          class Stop>
+void delta_stepping(const Graph& g, size_t s, DistMap dist, PredMap pred,
+                    WeightMap weight, double delta,
+                    typename property_traits<DistMap>::value_type max_dist,
+                    Stop&& stop)
+{
+    typedef typename property_traits<DistMap>::value_type dist_t;
+    typedef std::tuple<size_t, dist_t, size_t> request_t;
+    constexpr size_t null = numeric_limits<size_t>::max();
+
+    size_t N = num_vertices(g);
+    dist_t inf = std::is_floating_point<dist_t>::value ?
+        numeric_limits<dist_t>::infinity() :
+        numeric_limits<dist_t>::max();
+
+    auto get_bucket = [&](dist_t d) { return size_t(d / delta); };
+
+    // per-vertex distance at which it was last expanded, and whether it
+    // belongs to the set of vertices to be expanded by heavy edges
+    vector<dist_t> expanded(N, inf);
+    vector<uint8_t> in_heavy(N, false);
+
+    vector<vector<vector<size_t>>> buckets;
+    vector<vector<request_t>> requests;
+    vector<size_t> next;
+    vector<uint8_t> active;
+    size_t P = 1;
+
+    #pragma omp parallel if (is_parallel_worth(g, delta_stepping_kernel))
+    {
+        size_t p = 0;
+#ifdef _OPENMP
+        p = omp_get_thread_num();
+        #pragma omp single
+        P = omp_get_num_threads();
+#endif
+        #pragma omp single
+        {
+            buckets.resize(P);
+            requests.resize(P * P);
+            next.resize(P);
+            active.resize(P);
+        }
+
+        auto owner = [&](size_t v) { return (v * P) / N; };
+        auto& my_buckets = buckets[p];
+        vector<size_t> heavy;
+
+        auto insert = [&](size_t v, size_t b)
+            {
+                if (b >= my_buckets.size())
+                    my_buckets.resize(b + 1);
+                my_buckets[b].push_back(v);
+            };
+
+        // requests[q * P + p] are the relaxations sent from thread q to p
+        auto relax = [&](size_t u, bool light)
+            {
+                dist_t du = dist[u];
+                for (const auto& e : out_edges_range(vertex(u, g), g))
+                {
+                    auto w = get(weight, e);
+                    if ((w <= delta) != light)
+                        continue;
+                    size_t v = target(e, g);
+                    dist_t dv = du + w;
+                    if (dv < dist[v])
+                        requests[p * P + owner(v)].emplace_back(v, dv, u);
+                }
+            };
+
+        auto apply = [&](size_t i)
+            {
+                for (size_t q = 0; q < P; ++q)
+                {
+                    auto& req = requests[q * P + p];
+                    for (auto& r : req)
+                    {
+                        size_t v = get<0>(r);
+                        dist_t d = get<1>(r);
+                        if (d >= dist[v])
+                            continue;
+                        dist[v] = d;
+                        pred[v] = get<2>(r);
+                        insert(v, std::max(get_bucket(d), i));
+                    }
+                    req.clear();
+                }
+            };
+
+        if (owner(s) == p)
+            insert(s, get_bucket(dist[s]));
+        #pragma omp barrier
+
+        size_t i = 0;
+        while (true)
+        {
+            while (i < my_buckets.size() && my_buckets[i].empty())
+                ++i;
+            next[p] = (i < my_buckets.size()) ? i : null;
+            #pragma omp barrier
+            i = *std::min_element(next.begin(), next.end());
+            if (i == null || i * delta > max_dist || stop(i * delta))
+                break;
+
+            // light edges, until the bucket remains empty
+            while (true)
+            {
+                vector<size_t> cur;
+                if (i < my_buckets.size())
+                    cur.swap(my_buckets[i]);
+                for (auto u : cur)
+                {
+                    if (expanded[u] == dist[u])
+                        continue;
+                    expanded[u] = dist[u];
+                    if (!in_heavy[u])
+                    {
+                        in_heavy[u] = true;
+                        heavy.push_back(u);
+                    }
+                    relax(u, true);
+                }
+                #pragma omp barrier
+                apply(i);
+                active[p] = (i < my_buckets.size() && !my_buckets[i].empty());
+                #pragma omp barrier
+                if (std::find(active.begin(), active.end(), true) ==
+                    active.end())
+                    break;
+            }
+
+            // heavy edges, once
+            for (auto u : heavy)
+            {
+                in_heavy[u] = false;
+                relax(u, false);
+            }
+            heavy.clear();
+            #pragma omp barrier
+            apply(i + 1);
+            ++i;
+        }
+    }
+
+    // vertices beyond max_dist are not considered reached
+    if (max_dist < inf)
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 if (dist[v] > max_dist)
+                     dist[v] = inf;
+             });
+    }
+}
+
+// Sorts the vector in parallel blocks, which are then merged pairwise.
+template <class Vec, class Cmp>
+void parallel_sort(Vec& x, Cmp&& cmp)
+{
+    size_t P = 1;
+#ifdef _OPENMP
+    if (is_parallel_worth(x.size()))
+        P = omp_get_max_threads();
+#endif
+    vector<size_t> bounds(P + 1);
+    for (size_t i = 0; i <= P; ++i)
+        bounds[i] = (x.size() * i) / P;
+    auto b = x.begin();
+
+    #pragma omp parallel for schedule(static, 1) if (P > 1)
+    for (size_t i = 0; i < P; ++i)
+        std::sort(b + bounds[i], b + bounds[i + 1], cmp);
+
+    for (size_t width = 1; width < P; width *= 2)
+    {
+        #pragma omp parallel for schedule(static, 1) if (P > 2 * width)
+        for (size_t i = 0; i < P; i += 2 * width)
+        {
+            if (i + width < P)
+                std::inplace_merge(b + bounds[i], b + bounds[i + width],
+                                   b + bounds[std::min(i + 2 * width, P)],
+                                   cmp);
+        }
+    }
+}
+
+// Given the distances found by delta_stepping() from s, this emulates the
+// sequential Dijkstra search, with the ties between equal distances broken by
+// vertex index: the vertices are examined in order of distance, up to
+// max_dist, and, if all the targets are reached, up to the last of them, whose
+// edges are not relaxed. For every vertex v != s discovered by the search,
+// discover(v, u, d0, d) is called, in the order of discovery, with u its
+// predecessor, d0 the distance with which it was discovered, and d its final
+// distance, which for the vertices not examined is the tentative one. This is
+// the same as the sequential search if the distances are all different. The
+// order is found in parallel, but discover() is called by a single thread.
+
+template <class Graph, class DistMap, class WeightMap, class Targets,
+          class Discover>
+void dijkstra_discovery_order(const Graph& g, size_t s, DistMap dist,
+                              WeightMap weight,
+                              typename property_traits<DistMap>::value_type max_dist,
+                              const Targets& targets, Discover&& discover)
+{
+    typedef typename property_traits<DistMap>::value_type dist_t;
+    constexpr size_t null = numeric_limits<size_t>::max();
+    constexpr size_t done = null - 1;
+
+    size_t N = num_vertices(g);
+    dist_t inf = std::is_floating_point<dist_t>::value ?
+        numeric_limits<dist_t>::infinity() :
+        numeric_limits<dist_t>::max();
+
+    // the settled vertices, in order of examination
+    vector<size_t> order;
+    #pragma omp parallel if (is_parallel_worth(N))
+    {
+        vector<size_t> lorder;
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 if (dist[v] < inf && dist[v] <= max_dist)
+                     lorder.push_back(v);
+             });
+        #pragma omp critical (dijkstra_discovery_order)
+        order.insert(order.end(), lorder.begin(), lorder.end());
+    }
+    parallel_sort(order,
+                  [&](size_t u, size_t v)
+                  {
+                      return (std::make_tuple(u != s, dist[u], u) <
+                              std::make_tuple(v != s, dist[v], v));
+                  });
+
+    vector<size_t> pos(N, null);
+    #pragma omp parallel for schedule(runtime) \
+        if (is_parallel_worth(order.size()))
+    for (size_t i = 0; i < order.size(); ++i)
+        pos[order[i]] = i;
+
+    // the search stops when the last target is examined
+    size_t n_exam = order.size();
+    size_t n_relax = order.size();
+    if (!targets.empty())
+    {
+        size_t last = 0;
+        bool all = true;
+        for (size_t t : targets)
+        {
+            if (t >= N || pos[t] == null)
+                all = false;
+            else
+                last = std::max(last, pos[t]);
+        }
+        if (all)
+        {
+            n_exam = last + 1;
+            n_relax = last;
+        }
+    }
+
+    // position of the first relaxed vertex with an edge to v
+    vector<size_t> first(N, null);
+    vector<vector<std::pair<size_t, dist_t>>> found;
+    size_t nthreads = 1;
+    #pragma omp parallel if (is_parallel_worth(g, delta_stepping_kernel))
+    {
+        size_t tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+        #pragma omp single
+        nthreads = omp_get_num_threads();
+#endif
+        #pragma omp single
+        found.resize(nthreads);
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < n_relax; ++i)
+        {
+            for (auto v : out_neighbors_range(vertex(order[i], g), g))
+            {
+                size_t j = v;
+                if (j == s)
+                    continue;
+                size_t old = first[j];
+                while (i < old &&
+                       !__atomic_compare_exchange_n(&first[j], &old, i, false,
+                                                    __ATOMIC_RELAXED,
+                                                    __ATOMIC_RELAXED));
+            }
+        }
+
+        // with a static schedule, every thread gets a contiguous block of
+        // the order
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < n_relax; ++i)
+        {
+            dist_t du = dist[order[i]];
+            for (const auto& e : out_edges_range(vertex(order[i], g), g))
+            {
+                size_t j = target(e, g);
+                if (j == s || first[j] != i)
+                    continue;
+                first[j] = done;
+                dist_t dv = du + get(weight, e);
+                found[tid].emplace_back(j, dv);
+            }
+        }
+    }
+
+    vector<std::pair<size_t, dist_t>> discovered;
+    for (auto& lfound : found)
+        discovered.insert(discovered.end(), lfound.begin(), lfound.end());
+
+    // the predecessor is the first relaxed vertex which gives the smallest
+    // distance
+    vector<std::pair<size_t, dist_t>> pred(discovered.size());
+    #pragma omp parallel for schedule(runtime) \
+        if (is_parallel_worth(g, delta_stepping_kernel))
+    for (size_t k = 0; k < discovered.size(); ++k)
+    {
+        size_t v = discovered[k].first;
+        dist_t best = inf;
+        size_t best_pos = null;
+        for (const auto& e : in_or_out_edges_range(vertex(v, g), g))
+        {
+            size_t u = source(e, g);
+            if (u == v)
+                u = target(e, g);
+            size_t i = pos[u];
+            if (i >= n_relax)
+                continue;
+            dist_t d = dist[u] + get(weight, e);
+            if (d < best || (d == best && i < best_pos))
+            {
+                best = d;
+                best_pos = i;
+            }
+        }
+        pred[k] = {order[best_pos], (pos[v] < n_exam) ? dist[v] : best};
+    }
+
+    for (size_t k = 0; k < discovered.size(); ++k)
+        discover(vertex(discovered[k].first, g), vertex(pred[k].first, g),
+                 discovered[k].second, pred[k].second);
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_DELTA_STEPPING_HH
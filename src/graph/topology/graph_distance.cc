@@ -24,6 +24,8 @@
 #include "hash_map_wrap.hh"
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_bfs.hh"
+#include "graph_delta_stepping.hh"
 
 #include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
@@ -148,7 +150,7 @@ public:
         if (size_t(p) == v)
             return;
         _dist_map[v] = _dist_map[p] + 1;
-
+        _reached.push_back(v);
         if (_dist_map[v] > _max_dist)
             _unreached.push_back(v);
 
@@ -297,6 +299,60 @@ struct do_bfs_search
 
         dist_map[source] = 0;
 
+        // large graphs are searched in parallel, one level at a time; the
+        // reached vertices and their predecessors are then listed as in the
+        // sequential search below
+        if (is_parallel_worth(g, bfs_kernel))
+        {
+            // the vertices one level beyond max_dist are also reached, and
+            // the source is never counted as a reached target
+            size_t N = num_vertices(g);
+            size_t max_level = (max_dist > 0 && max_d < N) ?
+                size_t(max_d) + 1 : numeric_limits<size_t>::max();
+            size_t n_tgt = tgt.size() - tgt.count(source);
+            parallel_bfs(g, source, max_level,
+                         [&](auto v, auto, size_t d) { dist_map[v] = d; },
+                         [&]()
+                         {
+                             if (n_tgt == 0)
+                                 return false;
+                             for (auto t : tgt)
+                             {
+                                 if (t != source && dist_map[t] == inf)
+                                     return false;
+                             }
+                             return true;
+                         });
+
+            vector<uint8_t> listed(N, false);
+            listed[source] = true;
+            bfs_discovery_order
+                (g, source, max_level,
+                 [&](auto v)
+                 {
+                     return (dist_map[v] == inf) ?
+                         numeric_limits<size_t>::max() : size_t(dist_map[v]);
+                 },
+                 [&](auto v, auto u)
+                 {
+                     pred_map[v] = u;
+                     reached.push_back(v);
+                     listed[v] = true;
+                     if (tgt.find(v) != tgt.end() && --n_tgt == 0)
+                         return false;
+                     return true;
+                 });
+
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     if (!listed[v] || dist_map[v] > max_d)
+                         dist_map[v] = inf;
+                 });
+            return;
+        }
+
         unchecked_vector_property_map<boost::default_color_type, VertexIndexMap>
         color_map(vertex_index, num_vertices(g));
         try
@@ -353,6 +409,53 @@ struct do_djk_search
 
         dist_map[source] = 0;
 
+        // large graphs are searched in parallel, with delta-stepping; the
+        // reached vertices and their predecessors are then listed as in the
+        // sequential search below
+        if (!dag && is_parallel_worth(g, delta_stepping_kernel))
+        {
+            size_t N = num_vertices(g);
+            vector<size_t> dpred(N);
+            double delta = get_delta_stepping_width(g, weight);
+            delta_stepping(g, source, dist_map, dpred.data(), weight, delta,
+                           max_d,
+                           [&](double d)
+                           {
+                               if (tgt.empty())
+                                   return false;
+                               for (auto t : tgt)
+                               {
+                                   if (!(dist_map[t] < d))
+                                       return false;
+                               }
+                               return true;
+                           });
+
+            vector<uint8_t> listed(N, false);
+            listed[source] = true;
+            reached.push_back(source);
+            dijkstra_discovery_order
+                (g, source, dist_map, weight, max_d, tgt,
+                 [&](auto v, auto u, dist_t d0, dist_t d)
+                 {
+                     pred_map[v] = u;
+                     reached.push_back(v);
+                     listed[v] = true;
+                     // as in djk_max_visitor, the vertices discovered beyond
+                     // max_dist are not reached
+                     dist_map[v] = (d0 > max_d) ? inf : d;
+                 });
+
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     if (!listed[v])
+                         dist_map[v] = inf;
+                 });
+            return;
+        }
+
         try
         {
             if (tgt.size() <= 1)
@@ -455,7 +558,7 @@ void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
 
     if (weight.empty())
     {
-        run_action<>()
+        run_action<all_graph_views_frozen>()
             (gi, std::bind(do_bfs_search(), std::placeholders::_1, source, tgt, gi.get_vertex_index(),
                            std::placeholders::_2, pmap.get_unchecked(num_vertices(gi.get_graph())),
                            max_dist, std::ref(reached)),
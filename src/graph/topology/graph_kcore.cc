@@ -19,6 +19,7 @@
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 
 #include "graph_kcore.hh"
 
@@ -39,7 +40,28 @@ void do_kcore_decomposition(GraphInterface& gi, boost::any prop)
         (gi.get_graph_view(), prop);
 }
 
+void do_kcore_update(GraphInterface& gi, boost::any prop,
+                     python::object oadded, python::object oremoved)
+{
+    auto added = get_array<int64_t, 2>(oadded);
+    auto removed = get_array<int64_t, 2>(oremoved);
+    run_action<>()
+        (gi,
+         [&](auto& g, auto core)
+         {
+             KCoreMaintainer<std::remove_reference_t<decltype(g)>,
+                             decltype(core)> m(g, core);
+             for (size_t i = 0; i < added.shape()[0]; ++i)
+                 m.insert(added[i][0], added[i][1]);
+             for (size_t i = 0; i < removed.shape()[0]; ++i)
+                 m.remove(removed[i][0], removed[i][1]);
+             m.finish();
+         },
+         writable_vertex_scalar_properties())(prop);
+}
+
 void export_kcore()
 {
     python::def("kcore_decomposition", &do_kcore_decomposition);
+    python::def("kcore_update", &do_kcore_update);
 };
@@ -18,67 +18,367 @@
 #ifndef GRAPH_KCORE_HH
 #define GRAPH_KCORE_HH
 
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "graph_util.hh"
+#include "idx_map.hh"
+
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The k-core decomposition is obtained by peeling [batagelj-algorithm]: the
+// vertices of smallest remaining degree k are removed, decreasing the degree
+// of their neighbors, until none remains with degree k or smaller, after which
+// k is increased. Here, all the vertices of the current level are removed
+// concurrently, and the remaining degrees of their neighbors are decreased
+// atomically, but never below k [dasari-park-2014]. A vertex is added to the
+// next level exactly when its degree drops to k.
+//
+// [dasari-park-2014] N. S. Dasari, R. Desh, M. Zubair, "ParK: An efficient
+//    algorithm for k-core decomposition on multicore processors", IEEE
+//    International Conference on Big Data, 2014,
+//    DOI: 10.1109/BigData.2014.7004366
+
+inline const openmp_kernel kcore_kernel("kcore_decomposition", 1);
+
 template <class Graph, class CoreMap>
-void kcore_decomposition(Graph& g, CoreMap core_map)
+void kcore_decomposition(Graph& g, CoreMap core)
 {
-    auto vertex_index = get(vertex_index_t(), g);
+    size_t N = num_vertices(g);
 
-    typedef typename vprop_map_t<size_t>::type::unchecked_t vmap_t;
+    vector<size_t> deg(N);    // Remaining degree
+    vector<size_t> active;    // Vertices not yet removed
+    for (auto v : vertices_range(g))
+    {
+        deg[v] = degree(v, g);
+        active.push_back(v);
+    }
 
-    vmap_t deg(vertex_index, num_vertices(g));  // Remaining degree
-    vmap_t pos(vertex_index, num_vertices(g));  // Position in bin (core)
+    // Puts in out the vertices of in for which f(v) is true
+    auto filter = [&](vector<size_t>& in, vector<size_t>& out, auto&& f)
+        {
+            out.clear();
+            #pragma omp parallel if (is_parallel_worth(in.size()))
+            {
+                vector<size_t> lout;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < in.size(); ++i)
+                {
+                    if (f(in[i]))
+                        lout.push_back(in[i]);
+                }
+                #pragma omp critical (kcore_decomposition)
+                out.insert(out.end(), lout.begin(), lout.end());
+            }
+        };
 
-    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    vector<size_t> frontier, next, remaining;
+    size_t k = 0;
+    while (!active.empty())
+    {
+        // Skip directly to the smallest remaining degree
+        size_t k_min = numeric_limits<size_t>::max();
+        #pragma omp parallel for schedule(runtime) \
+            if (is_parallel_worth(active.size())) reduction(min:k_min)
+        for (size_t i = 0; i < active.size(); ++i)
+            k_min = std::min(k_min, deg[active[i]]);
+        k = std::max(k, k_min);
 
-    vector<vector<vertex_t>> bins; // Each bin stores the set of vertices of
-                                   // a core
+        filter(active, frontier, [&](auto v) { return deg[v] <= k; });
+        while (!frontier.empty())
+        {
+            next.clear();
+            #pragma omp parallel if (is_parallel_worth(frontier.size() * \
+                                                       kcore_kernel.get_cost()))
+            {
+                vector<size_t> lnext;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    auto v = vertex(frontier[i], g);
+                    core[v] = k;
+                    for (auto u : all_neighbors_range(v, g))
+                    {
+                        size_t& du = deg[u];
+                        size_t d;
+                        #pragma omp atomic read
+                        d = du;
+                        while (d > k)
+                        {
+                            if (__atomic_compare_exchange_n(&du, &d, d - 1,
+                                                            false,
+                                                            __ATOMIC_RELAXED,
+                                                            __ATOMIC_RELAXED))
+                            {
+                                if (d - 1 == k)
+                                    lnext.push_back(u);
+                                break;
+                            }
+                        }
+                    }
+                }
+                #pragma omp critical (kcore_decomposition)
+                next.insert(next.end(), lnext.begin(), lnext.end());
+            }
+            frontier.swap(next);
+        }
 
-    // Put each vertex to the bin corresponding to its degree
-    for (auto v : vertices_range(g))
+        filter(active, remaining, [&](auto v) { return deg[v] > k; });
+        active.swap(remaining);
+    }
+}
+
+// Incremental maintenance of the k-core decomposition under edge insertions
+// and removals [sariyuce-streaming-2013]. If an edge (u, v) is inserted or
+// removed, with r = min(core[u], core[v]), only the vertices with core r
+// connected to the endpoints of core r through vertices of core r can change,
+// and only by one. The affected vertices are found by traversals which start
+// at these endpoints, and evict the vertices with too few neighbors
+// repeatedly, as in the decomposition itself, keeping the current degrees
+// only for the vertices visited:
+//
+// - After a removal, the degree counts the neighbors of core r or larger, and
+//   the vertices are evicted if it is smaller than r, after which their core
+//   is decreased. The traversal only continues from the evicted vertices.
+//
+// - After an insertion, the degree counts the neighbors that may belong to the
+//   (r + 1)-core, i.e. those of core larger than r, or of core r with at least
+//   r + 1 neighbors of core r or larger. The vertices are evicted if it does
+//   not exceed r, and the traversal only continues from the vertices which are
+//   not. The ones visited and not evicted have their core increased.
+//
+// Self-loops, which change the degree by two, are handled by repeating the
+// update while it changes the core of the endpoint.
+//
+// The traversals are local in most networks, but can cover a whole shell if
+// it is large and homogeneous, as in random graphs. The neighbors scanned by
+// all the traversals of a batch of updates are counted, and if they exceed the
+// number of vertices and edges, i.e. about the work of one decomposition, the
+// maintainer gives up, only modifies the graph in the remaining updates, and
+// recomputes the decomposition once in finish(). Hence a batch of updates
+// costs at most about two decompositions.
+//
+// [sariyuce-streaming-2013] A. E. Sarıyüce, B. Gedik, G. Jacques-Silva,
+//    K.-L. Wu, Ü. V. Çatalyürek, "Streaming algorithms for k-core
+//    decomposition", Proceedings of the VLDB Endowment 6 (6), 2013,
+//    DOI: 10.14778/2536336.2536344
+
+template <class Graph, class CoreMap>
+class KCoreMaintainer
+{
+public:
+    KCoreMaintainer(Graph& g, CoreMap core)
+        : _g(g), _core(core),
+          _work(0), _max_work(num_vertices(g) + num_edges(g)),
+          _stale(false) {}
+
+    void insert(size_t u, size_t v)
+    {
+        check_vertex(u);
+        check_vertex(v);
+        add_edge(vertex(u, _g), vertex(v, _g), _g);
+        while (!_stale && update(u, v, true) && u == v);
+    }
+
+    void remove(size_t u, size_t v)
+    {
+        check_vertex(u);
+        check_vertex(v);
+        auto e = edge(vertex(u, _g), vertex(v, _g), _g);
+        if (!e.second)
+            throw ValueException("edge (" + lexical_cast<string>(u) + ", " +
+                                 lexical_cast<string>(v) + ") not found");
+        remove_edge(e.first, _g);
+        while (!_stale && update(u, v, false) && u == v);
+    }
+
+    // Must be called after the last update.
+    void finish()
+    {
+        if (_stale)
+            kcore_decomposition(_g, _core);
+        _stale = false;
+    }
+
+private:
+    static constexpr size_t evicted = numeric_limits<size_t>::max();
+
+    void check_vertex(size_t v)
+    {
+        if (v >= num_vertices(_g) || !is_valid_vertex(vertex(v, _g), _g))
+            throw ValueException("invalid vertex: " + lexical_cast<string>(v));
+    }
+
+    bool is_over_budget()
+    {
+        if (_work > _max_work)
+            _stale = true;
+        return _stale;
+    }
+
+    // Accounts for a scan of the neighbors of v.
+    void add_work(typename graph_traits<Graph>::vertex_descriptor v)
+    {
+        _work += degree(v, _g) + 1;
+    }
+
+    bool is_evicted(size_t w)
     {
-        size_t k = degree(v, g);
-        deg[v] = k;
-        if (k >= bins.size())
-            bins.resize(k + 1);
-        bins[k].push_back(v);
-        pos[v] = bins[k].size() - 1;
+        auto iter = _cd.find(w);
+        return iter != _cd.end() && iter->second == evicted;
     }
 
-    // Proceed from smallest bin to largest. For each vertex in bin, check
-    // the neighbors; if any of them have a larger remaining degree, reduce
-    // it by one, and put it in the correct bin.
-    for (size_t k = 0; k < bins.size(); ++k)
+    // Number of neighbors of w with core r or larger, or, if pure is true,
+    // which may belong to the (r + 1)-core. The self-loops are counted as in
+    // the degree.
+    size_t get_degree(size_t w, size_t r, bool pure)
     {
-        auto& bins_k = bins[k];
-        while (!bins_k.empty())
+        auto v = vertex(w, _g);
+        size_t d = degree(v, _g);
+        add_work(v);
+        for (auto x : all_neighbors_range(v, _g))
         {
-            auto v = bins_k.back();
-            bins_k.pop_back();
-            core_map[v] = k;
-            for (auto u : all_neighbors_range(v, g))
+            if (x == v)
+                continue;
+            size_t k_x = _core[x];
+            if (k_x < r ||
+                (pure && k_x == r && (is_evicted(x) || get_mcd(x, r) <= r)))
+                --d;
+        }
+        return d;
+    }
+
+    size_t get_mcd(size_t w, size_t r)
+    {
+        auto iter = _mcd.find(w);
+        if (iter != _mcd.end())
+            return iter->second;
+        size_t d = get_degree(w, r, false);
+        _mcd[w] = d;
+        return d;
+    }
+
+    // Evicts w, and then every visited neighbor whose degree becomes too
+    // small. After a removal, the neighbors of core r are visited here.
+    void evict(size_t w, size_t r, bool insert)
+    {
+        _cd[w] = evicted;
+        _queue.clear();
+        _queue.push_back(w);
+        for (size_t i = 0; i < _queue.size() && !is_over_budget(); ++i)
+        {
+            auto y = vertex(_queue[i], _g);
+            add_work(y);
+            for (auto x : all_neighbors_range(y, _g))
             {
-                auto& ku = deg[u];
-                if (ku > deg[v])
+                if (x == y)
+                    continue;
+                auto iter = _cd.find(x);
+                if (iter == _cd.end())
                 {
-                    auto& bins_ku = bins[ku];
-                    auto w = bins_ku.back();
-                    auto pos_w = pos[w] = pos[u];
-                    bins_ku[pos_w] = w;
-                    bins_ku.pop_back();
-                    --ku;
-                    auto& bins_ku_m = bins[ku];
-                    bins_ku_m.push_back(u);
-                    pos[u] = bins_ku_m.size() - 1;
+                    if (insert || size_t(_core[x]) != r)
+                        continue;
+                    _cd[x] = get_degree(x, r, false);
+                    iter = _cd.find(x);
+                }
+                if (iter->second == evicted)
+                    continue;
+                size_t d = --iter->second;
+                if (insert ? d <= r : d < r)
+                {
+                    iter->second = evicted;
+                    _queue.push_back(x);
                 }
             }
         }
     }
-}
+
+    // Returns true if any core number changed.
+    bool update(size_t u, size_t v, bool insert)
+    {
+        size_t r = std::min(size_t(_core[u]), size_t(_core[v]));
+        if (!insert && r == 0)
+            return false;
+
+        _cd.clear();
+        _mcd.clear();
+        _stack.clear();
+        for (auto w : {u, v})
+        {
+            if (size_t(_core[w]) != r || _cd.find(w) != _cd.end())
+                continue;
+            _cd[w] = get_degree(w, r, insert);
+            _stack.push_back(w);
+        }
+
+        while (!_stack.empty() && !is_over_budget())
+        {
+            size_t w = _stack.back();
+            _stack.pop_back();
+            size_t d = _cd[w];
+            if (d == evicted)
+                continue;
+
+            if (!insert)
+            {
+                if (d < r)
+                    evict(w, r, false);
+                continue;
+            }
+
+            if (d <= r)
+            {
+                evict(w, r, true);
+                continue;
+            }
+
+            auto y = vertex(w, _g);
+            add_work(y);
+            for (auto x : all_neighbors_range(y, _g))
+            {
+                if (x == y || size_t(_core[x]) != r ||
+                    _cd.find(x) != _cd.end() || get_mcd(x, r) <= r)
+                    continue;
+                _cd[x] = get_degree(x, r, true);
+                _stack.push_back(x);
+            }
+        }
+
+        if (_stale)
+            return false;
+
+        bool changed = false;
+        for (auto& [w, d] : _cd)
+        {
+            if (insert && d != evicted)
+            {
+                _core[w] = r + 1;
+                changed = true;
+            }
+            else if (!insert && d == evicted)
+            {
+                _core[w] = r - 1;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    Graph& _g;
+    CoreMap _core;
+    idx_map<size_t, size_t> _cd;   // current degrees of the visited vertices
+    idx_map<size_t, size_t> _mcd;  // neighbors with core r or larger
+    vector<size_t> _stack;
+    vector<size_t> _queue;
+    size_t _work;      // neighbors scanned in this batch
+    size_t _max_work;
+    bool _stale;
+};
 
 } // graph_tool namespace
 
@@ -0,0 +1,89 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "numpy_bind.hh"
+
+#include "graph_landmark_labeling.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+PrunedLandmarkLabeling build_landmark_labeling(GraphInterface& gi,
+                                               boost::any prio)
+{
+    PrunedLandmarkLabeling pll;
+    run_action<all_graph_views_frozen>()
+        (gi, [&](auto& g, auto p) { pll.build(g, p); },
+         vertex_scalar_properties())(prio);
+    return pll;
+}
+
+void export_landmark_labeling()
+{
+    using namespace boost::python;
+
+    def("build_landmark_labeling", &build_landmark_labeling);
+
+    class_<PrunedLandmarkLabeling>("PrunedLandmarkLabeling")
+        .def("distance", &PrunedLandmarkLabeling::distance)
+        .def("distances",
+             +[](PrunedLandmarkLabeling& pll, object osources,
+                 object otargets, object odist)
+              {
+                  auto sources = get_array<int64_t, 1>(osources);
+                  auto targets = get_array<int64_t, 1>(otargets);
+                  auto dist = get_array<double, 1>(odist);
+                  pll.distances(sources, targets, dist);
+              })
+        .def("get_num_vertices", &PrunedLandmarkLabeling::get_num_vertices)
+        .def("get_num_labels", &PrunedLandmarkLabeling::get_num_labels)
+        .def("is_directed", &PrunedLandmarkLabeling::is_directed)
+        .def("get_state",
+             +[](PrunedLandmarkLabeling& pll)
+              {
+                  auto state = pll.get_state();
+                  return boost::python::make_tuple
+                      (std::get<0>(state),
+                       wrap_vector_owned(std::get<1>(state)),
+                       wrap_vector_owned(std::get<2>(state)),
+                       wrap_vector_owned(std::get<3>(state)),
+                       wrap_vector_owned(std::get<4>(state)),
+                       wrap_vector_owned(std::get<5>(state)),
+                       wrap_vector_owned(std::get<6>(state)));
+              })
+        .def("set_state",
+             +[](PrunedLandmarkLabeling& pll, bool directed, object oout_pos,
+                 object oout_hub, object oout_d, object oin_pos,
+                 object oin_hub, object oin_d)
+              {
+                  auto out_pos = get_array<int64_t, 1>(oout_pos);
+                  auto out_hub = get_array<int64_t, 1>(oout_hub);
+                  auto out_d = get_array<int64_t, 1>(oout_d);
+                  auto in_pos = get_array<int64_t, 1>(oin_pos);
+                  auto in_hub = get_array<int64_t, 1>(oin_hub);
+                  auto in_d = get_array<int64_t, 1>(oin_d);
+                  pll.set_state(directed, out_pos, out_hub, out_d, in_pos,
+                                in_hub, in_d);
+              });
+}
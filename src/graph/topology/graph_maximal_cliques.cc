@@ -25,7 +25,7 @@
 using namespace std;
 using namespace graph_tool;
 
-boost::python::object get_max_cliques(GraphInterface& gi)
+boost::python::object get_max_cliques(GraphInterface& gi, size_t batch)
 {
 #ifdef HAVE_BOOST_COROUTINE
     auto dispatch = [&](auto& yield)
@@ -34,11 +34,12 @@ boost::python::object get_max_cliques(GraphInterface& gi)
                 (gi,
                  [&](auto& g)
                  {
-                     max_cliques(g,
-                                 [&](auto& s)
+                     max_cliques(g, batch,
+                                 [&](auto& cliques, auto& pos)
                                  {
-                                     std::vector<size_t> v(s.begin(), s.end());
-                                     yield(wrap_vector_owned(v));
+                                     yield(boost::python::make_tuple
+                                           (wrap_vector_owned(cliques),
+                                            wrap_vector_owned(pos)));
                                  });
                  })();
         };
@@ -18,122 +18,405 @@
 #ifndef GRAPH_MAXIMAL_CLIQUES_HH
 #define GRAPH_MAXIMAL_CLIQUES_HH
 
-#include <array>
-#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "graph_util.hh"
 
 namespace graph_tool
 {
 
 using namespace boost;
 
-template <class Graph, class Visitor>
-void max_cliques(Graph& g, Visitor&& vis)
+// The maximal cliques are enumerated with the Bron-Kerbosch algorithm with
+// pivoting [tomita_worst-case_2006], split into one subproblem per vertex v,
+// following a degeneracy ordering [eppstein_listing_2010]: the subproblem of v
+// finds the maximal cliques whose first vertex in the order is v, so that the
+// candidates P are the later neighbors of v, of which there are at most as
+// many as the degeneracy of the graph, and the excluded vertices X are the
+// earlier neighbors. The subproblems are independent, and are solved in
+// parallel, in chunks of consecutive vertices in the order. The cliques found
+// in each chunk are passed to the visitor in batches, in a deterministic
+// order, so that they never need to be all kept in memory.
+//
+// If P ∪ X is small, the sets are bitsets over it, and the adjacency matrix of
+// its induced subgraph is built, so that the set operations are word-parallel.
+// Otherwise, they are sorted vectors of vertex positions in the order.
+//
+// [eppstein_listing_2010] D. Eppstein, M. Löffler, D. Strash, "Listing all
+//    maximal cliques in sparse graphs in near-optimal time", ISAAC 2010,
+//    DOI: 10.1007/978-3-642-17517-6_36
+
+inline const openmp_kernel max_cliques_kernel("max_cliques", 10);
+
+class MaxCliqueSolver
 {
-    typedef gt_hash_set<size_t> vset_t;
-    //typedef std::set<size_t> vset_t;
+public:
+    // The neighborhoods are given as sorted lists of positions in the order,
+    // without repetitions or self-loops.
+    MaxCliqueSolver(const std::vector<size_t>& pos,
+                    const std::vector<size_t>& adj,
+                    const std::vector<size_t>& order)
+        : _pos(pos), _adj(adj), _order(order), _loc(order.size(), _null) {}
+
+    // Appends to cliques the maximal cliques with first vertex i, and their
+    // sizes to sizes.
+    void solve(size_t i, std::vector<int64_t>& cliques,
+               std::vector<int64_t>& sizes)
+    {
+        auto begin = _adj.begin() + _pos[i];
+        auto end = _adj.begin() + _pos[i + 1];
+        auto mid = std::upper_bound(begin, end, i);
+        if (mid == end)
+            return;  // either isolated, or not maximal
+
+        _cliques = &cliques;
+        _sizes = &sizes;
+        _R.assign(1, i);
+
+        size_t n = end - begin;
+        if (n <= _max_bitset)
+            solve_bitset(begin, mid, end);
+        else
+            solve_vector(std::vector<size_t>(mid, end),
+                         std::vector<size_t>(begin, mid));
+    }
+
+private:
+    typedef uint64_t word_t;
+    static constexpr size_t _null = std::numeric_limits<size_t>::max();
+    static constexpr size_t _max_bitset = 1024;
+
+    template <class Iter>
+    void solve_bitset(Iter begin, Iter mid, Iter end)
+    {
+        size_t n = end - begin;
+        _W = (n + 63) / 64;
+        _local.assign(begin, end);
+        for (size_t j = 0; j < n; ++j)
+            _loc[_local[j]] = j;
+
+        _M.assign(n * _W, 0);
+        for (size_t j = 0; j < n; ++j)
+        {
+            auto row = &_M[j * _W];
+            auto u = _local[j];
+            for (size_t k = _pos[u]; k < _pos[u + 1]; ++k)
+            {
+                auto l = _loc[_adj[k]];
+                if (l != _null)
+                    row[l / 64] |= word_t(1) << (l % 64);
+            }
+        }
+
+        for (auto u : _local)
+            _loc[u] = _null;
+
+        // P, X and the vertices to be branched on, for every depth
+        _sets.assign(3 * (n + 2) * _W, 0);
+        word_t* P = &_sets[0];
+        word_t* X = &_sets[_W];
+        for (size_t j = 0; j < n; ++j)
+        {
+            auto& S = (j < size_t(mid - begin)) ? X : P;
+            S[j / 64] |= word_t(1) << (j % 64);
+        }
+        expand_bitset(0);
+    }
 
-    auto get_pivot_adj = [&](const auto& P, const auto& X, auto& u_adj)
+    void expand_bitset(size_t depth)
     {
-        auto u = graph_traits<Graph>::null_vertex();
-        size_t ku = 0;
-        std::array<const vset_t*, 2> Ss({&P, &X});
-        for (auto S : Ss)
+        word_t* P = &_sets[3 * depth * _W];
+        word_t* X = P + _W;
+        word_t* B = X + _W;
+
+        bool P_empty = std::all_of(P, P + _W, [](auto w) { return w == 0; });
+        if (P_empty)
         {
-            for (auto v : *S)
+            if (std::all_of(X, X + _W, [](auto w) { return w == 0; }))
             {
+                _cliques->push_back(_order[_R[0]]);
+                for (size_t j = 1; j < _R.size(); ++j)
+                    _cliques->push_back(_order[_local[_R[j]]]);
+                _sizes->push_back(_R.size());
+            }
+            return;
+        }
+
+        // pivot: the vertex of P ∪ X with most neighbors in P
+        size_t u = 0, ku = 0;
+        for (size_t w = 0; w < _W; ++w)
+        {
+            for (word_t bits = P[w] | X[w]; bits != 0; bits &= bits - 1)
+            {
+                size_t j = w * 64 + __builtin_ctzll(bits);
+                auto row = &_M[j * _W];
                 size_t k = 0;
-                for (auto w : out_neighbors_range(v, g))
-                {
-                    if (w == v)
-                        continue;
-                    if (P.find(w) != P.end())
-                        ++k;
-                }
+                for (size_t l = 0; l < _W; ++l)
+                    k += __builtin_popcountll(P[l] & row[l]);
                 if (k >= ku)
                 {
-                    u = v;
+                    u = j;
                     ku = k;
                 }
             }
         }
 
-        for (auto w : out_neighbors_range(u, g))
+        auto row_u = &_M[u * _W];
+        for (size_t w = 0; w < _W; ++w)
+            B[w] = P[w] & ~row_u[w];
+
+        word_t* nP = B + _W;
+        word_t* nX = nP + _W;
+        for (size_t w = 0; w < _W; ++w)
         {
-            if (w == u)
-                continue;
-            u_adj.insert(w);
+            for (word_t bits = B[w]; bits != 0; bits &= bits - 1)
+            {
+                size_t j = w * 64 + __builtin_ctzll(bits);
+                auto row = &_M[j * _W];
+                for (size_t l = 0; l < _W; ++l)
+                {
+                    nP[l] = P[l] & row[l];
+                    nX[l] = X[l] & row[l];
+                }
+                _R.push_back(j);
+                expand_bitset(depth + 1);
+                _R.pop_back();
+                P[w] &= ~(word_t(1) << (j % 64));
+                X[w] |= word_t(1) << (j % 64);
+            }
         }
-    };
-
-    std::deque<std::tuple<vset_t, vset_t, vset_t, vset_t, vset_t::iterator>>
-        stack;
-    stack.emplace_back();
-    auto& P_ = get<1>(stack.back());
-    for (auto v : vertices_range(g))
-        P_.insert(v);
-    get_pivot_adj(get<1>(stack.back()),
-                  get<2>(stack.back()),
-                  get<3>(stack.back()));
-    get<4>(stack.back()) = P_.begin();
+    }
 
-    while (!stack.empty())
+    template <class Set>
+    size_t count_common(const Set& S, size_t u)
     {
-        auto& top = stack.back();
-        vset_t& R = get<0>(top);
-        vset_t& P = get<1>(top);
-        vset_t& X = get<2>(top);
-        vset_t& u_adj = get<3>(top);
-        auto& viter = get<4>(top);
+        size_t k = 0;
+        auto a = S.begin();
+        auto b = _adj.begin() + _pos[u];
+        auto b_end = _adj.begin() + _pos[u + 1];
+        while (a != S.end() && b != b_end)
+        {
+            if (*a < *b)
+            {
+                ++a;
+            }
+            else if (*b < *a)
+            {
+                ++b;
+            }
+            else
+            {
+                ++k;
+                ++a;
+                ++b;
+            }
+        }
+        return k;
+    }
 
+    void solve_vector(std::vector<size_t> P, std::vector<size_t> X)
+    {
         if (P.empty())
         {
-            if (X.empty() && R.size() > 1)
-                vis(R);
+            if (X.empty())
+            {
+                for (auto v : _R)
+                    _cliques->push_back(_order[v]);
+                _sizes->push_back(_R.size());
+            }
+            return;
+        }
 
-            stack.pop_back();
-            continue;
+        size_t u = P[0], ku = 0;
+        for (auto S : {&P, &X})
+        {
+            for (auto w : *S)
+            {
+                size_t k = count_common(P, w);
+                if (k >= ku)
+                {
+                    u = w;
+                    ku = k;
+                }
+            }
         }
 
-        while (viter != P.end() && u_adj.find(*viter) != u_adj.end())
-            ++viter;
+        std::vector<size_t> B;
+        std::set_difference(P.begin(), P.end(), _adj.begin() + _pos[u],
+                            _adj.begin() + _pos[u + 1], std::back_inserter(B));
 
-        if (viter == P.end())
+        std::vector<size_t> nP, nX;
+        for (auto v : B)
         {
-            stack.pop_back();
-            continue;
+            auto begin = _adj.begin() + _pos[v];
+            auto end = _adj.begin() + _pos[v + 1];
+            nP.clear();
+            nX.clear();
+            std::set_intersection(P.begin(), P.end(), begin, end,
+                                  std::back_inserter(nP));
+            std::set_intersection(X.begin(), X.end(), begin, end,
+                                  std::back_inserter(nX));
+            _R.push_back(v);
+            solve_vector(nP, nX);
+            _R.pop_back();
+            P.erase(std::lower_bound(P.begin(), P.end(), v));
+            X.insert(std::upper_bound(X.begin(), X.end(), v), v);
         }
+    }
+
+    const std::vector<size_t>& _pos;
+    const std::vector<size_t>& _adj;
+    const std::vector<size_t>& _order;
 
-        auto v = *viter;
+    std::vector<size_t> _loc;     // position in P ∪ X, for the bitsets
+    std::vector<size_t> _local;   // P ∪ X
+    std::vector<word_t> _M;       // adjacency matrix of P ∪ X
+    std::vector<word_t> _sets;    // P, X and branches for every depth
+    size_t _W = 0;                // words per bitset
 
-        stack.emplace_back();
-        auto& ntop = stack.back();
-        auto& nR = get<0>(ntop);
-        auto& nP = get<1>(ntop);
-        auto& nX = get<2>(ntop);
-        auto& nu_adj = get<3>(ntop);
-        auto& nviter = get<4>(ntop);
+    std::vector<size_t> _R;
+    std::vector<int64_t>* _cliques = nullptr;
+    std::vector<int64_t>* _sizes = nullptr;
+};
 
-        if (!R.empty())
-            nR.insert(R.begin(), R.end());
-        nR.insert(v);
-        for (auto w : out_neighbors_range(v, g))
+// Calls vis(cliques, pos) with batches of at least batch maximal cliques
+// (except the last one), of size larger than one, where the vertices of
+// clique i are cliques[pos[i]:pos[i+1]].
+template <class Graph, class Visitor>
+void max_cliques(Graph& g, size_t batch, Visitor&& vis)
+{
+    size_t N = num_vertices(g);
+
+    std::vector<std::vector<size_t>> ns(N);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto& n = ns[v];
+             for (auto u : out_neighbors_range(v, g))
+             {
+                 if (u != v)
+                     n.push_back(u);
+             }
+             std::sort(n.begin(), n.end());
+             n.erase(std::unique(n.begin(), n.end()), n.end());
+         });
+
+    // degeneracy ordering, by repeatedly removing a vertex of smallest
+    // remaining degree
+    std::vector<size_t> order, rank(N), deg(N);
+    std::vector<std::vector<size_t>> bins;
+    size_t M = 0;
+    for (auto v : vertices_range(g))
+    {
+        deg[v] = ns[v].size();
+        if (deg[v] >= bins.size())
+            bins.resize(deg[v] + 1);
+        bins[deg[v]].push_back(v);
+        ++M;
+    }
+    std::vector<uint8_t> removed(N, false);
+    size_t k = 0;
+    while (order.size() < M)
+    {
+        while (bins[k].empty())
+            ++k;
+        auto v = bins[k].back();
+        bins[k].pop_back();
+        if (removed[v] || deg[v] != k)
+            continue;  // stale entry
+        removed[v] = true;
+        rank[v] = order.size();
+        order.push_back(v);
+        for (auto u : ns[v])
         {
-            if (w == v)
+            if (removed[u])
                 continue;
-            if (P.find(w) != P.end())
-                nP.insert(w);
-            if (X.find(w) != X.end())
-                nX.insert(w);
+            bins[--deg[u]].push_back(u);
+            k = std::min(k, deg[u]);
         }
+    }
 
-        if (!(nP.empty() && nX.empty()))
-            get_pivot_adj(nP, nX, nu_adj);
+    std::vector<size_t> pos(M + 1, 0), adj;
+    for (size_t i = 0; i < M; ++i)
+        pos[i + 1] = pos[i] + ns[order[i]].size();
+    adj.resize(pos[M]);
+    parallel_loop(order,
+                  [&](size_t i, auto v)
+                  {
+                      auto& n = ns[v];
+                      auto a = adj.begin() + pos[i];
+                      for (size_t j = 0; j < n.size(); ++j)
+                          a[j] = rank[n[j]];
+                      std::sort(a, a + n.size());
+                      std::vector<size_t>().swap(n);
+                  });
 
-        nviter = nP.begin();
+    // the solvers hold vertex-sized buffers, so each thread creates its own
+    // only once, and keeps it for all chunks
+    size_t nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    std::vector<std::unique_ptr<MaxCliqueSolver>> solvers(nthreads);
+
+    std::vector<int64_t> cliques, cpos(1, 0);
+    std::vector<std::vector<int64_t>> ccliques, csizes;
+    size_t chunk = 64;
+    for (size_t start = 0; start < M;)
+    {
+        size_t end = std::min(start + chunk, M);
+        ccliques.resize(end - start);
+        csizes.resize(end - start);
 
-        X.insert(v);
-        P.erase(viter++);
+        #pragma omp parallel if (is_parallel_worth((pos[end] - pos[start]) * \
+                                                   max_cliques_kernel.get_cost()))
+        {
+            size_t tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            auto& solver = solvers[tid];
+            if (!solver)
+                solver = std::make_unique<MaxCliqueSolver>(pos, adj, order);
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t i = start; i < end; ++i)
+                solver->solve(i, ccliques[i - start], csizes[i - start]);
+        }
+
+        size_t nc = 0;
+        for (size_t j = 0; j < end - start; ++j)
+        {
+            auto& cs = ccliques[j];
+            cliques.insert(cliques.end(), cs.begin(), cs.end());
+            for (auto s : csizes[j])
+                cpos.push_back(cpos.back() + s);
+            nc += csizes[j].size();
+            cs.clear();
+            csizes[j].clear();
+        }
+
+        if (cpos.size() > batch)
+        {
+            vis(cliques, cpos);
+            cliques.clear();
+            cpos.assign(1, 0);
+        }
+
+        // adapt the chunks to produce about one batch each
+        if (nc > batch)
+            chunk = std::max(chunk / 2, size_t(1));
+        else if (2 * nc < batch)
+            chunk *= 2;
+        start = end;
     }
+
+    if (cpos.size() > 1)
+        vis(cliques, cpos);
 }
 
 } // graph_tool namespace
@@ -19,6 +19,7 @@
 #include "graph_filtering.hh"
 #include "random.hh"
 #include "coroutine.hh"
+#include "graph_subgraph_isomorphism.hh"
 
 #include <boost/graph/vf2_sub_graph_iso.hpp>
 #include <graph_python_interface.hh>
@@ -29,6 +30,9 @@ using namespace std;
 
 struct ListMatch
 {
+    // the matches can be collected in parallel, and passed later
+    static constexpr bool streaming = false;
+
     template <class Graph1, class Graph2, class VertexMap>
     struct GetMatch
     {
@@ -81,6 +85,10 @@ struct GenMatch
 {
     GenMatch(coro_t::push_type& yield): _yield(yield) {}
 
+    // every match is yielded as soon as it is found, by the thread that
+    // runs the coroutine, while the search continues in parallel
+    static constexpr bool streaming = true;
+
     template <class Graph1, class Graph2, class VertexMap>
     struct GetMatch
     {
@@ -141,34 +149,26 @@ struct get_subgraphs
 
         auto matcher = m.get_match(sub, g, vmaps,max_n);
 
-        typedef typename graph_traits<Graph1>::vertex_descriptor vertex_t;
-        vector<vertex_t> vorder;
-        std::copy(vertices(sub).first, vertices(sub).second, std::back_inserter(vorder));
-        auto cmp = [&](vertex_t u, vertex_t v) -> bool
-            {return make_pair(in_degree(u, sub), out_degree(u, sub)) <
-                    make_pair(in_degree(v, sub), out_degree(v, sub));};
-        std::sort(vorder.begin(), vorder.end(), cmp);
-
         if (iso)
         {
+            typedef typename graph_traits<Graph1>::vertex_descriptor vertex_t;
+            vector<vertex_t> vorder;
+            std::copy(vertices(sub).first, vertices(sub).second, std::back_inserter(vorder));
+            auto cmp = [&](vertex_t u, vertex_t v) -> bool
+                {return make_pair(in_degree(u, sub), out_degree(u, sub)) <
+                        make_pair(in_degree(v, sub), out_degree(v, sub));};
+            std::sort(vorder.begin(), vorder.end(), cmp);
+
             vf2_graph_iso(sub, g, matcher, vorder,
                           edges_equivalent(make_property_map_equivalent(edge_label1, edge_label2)).
                           vertices_equivalent(make_property_map_equivalent(vertex_label1, vertex_label2)));
         }
         else
         {
-            if (induced)
-            {
-                vf2_subgraph_iso(sub, g, matcher, vorder,
-                                 edges_equivalent(make_property_map_equivalent(edge_label1, edge_label2)).
-                                 vertices_equivalent(make_property_map_equivalent(vertex_label1, vertex_label2)));
-            }
-            else
-            {
-                vf2_subgraph_mono(sub, g, matcher, vorder,
-                                  edges_equivalent(make_property_map_equivalent(edge_label1, edge_label2)).
-                                  vertices_equivalent(make_property_map_equivalent(vertex_label1, vertex_label2)));
-            }
+            SubgraphMatcher<Graph1, Graph2, VertexLabel, EdgeLabel>
+                sm(sub, g, vertex_label1, vertex_label2, edge_label1,
+                   edge_label2, induced);
+            sm.run(max_n, Matcher::streaming, matcher);
         }
     }
 
@@ -250,8 +250,8 @@ subgraph_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
                 run_action<>()
                     (gi1, std::bind(get_subgraphs(), std::placeholders::_1, std::placeholders::_2,
                                     std::placeholders::_3, vertex_label2, std::placeholders::_4,
-                                    edge_label2, std::ref(vmaps), max_n, induced, iso,
-                                    GenMatch(yield)),
+                                    edge_label2, std::ref(vmaps), size_t(0), induced,
+                                    iso, GenMatch(yield)),
                      all_graph_views(), vertex_props_t(),
                      edge_props_t())(gi2.get_graph_view(),
                                      vertex_label1, edge_label1);
@@ -0,0 +1,855 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2019 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SUBGRAPH_ISOMORPHISM_HH
+#define GRAPH_SUBGRAPH_ISOMORPHISM_HH
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "graph_util.hh"
+#include "hash_map_wrap.hh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Subgraph matching
+// =================
+//
+// The matches of a pattern graph ("sub") in a target graph ("g") are found by
+// backtracking, as in VF2 [cordella-subgraph-2004], but with the pattern
+// vertices matched in a static order, in which every vertex is, if possible,
+// adjacent to an earlier one [bonnici-subgraph-2013], so that its candidates
+// are only the neighbors of the image of that earlier vertex. The order starts
+// with the pattern vertex with fewest candidates, and proceeds with the
+// vertices with most neighbors already in the order.
+//
+// The candidates are filtered with an index of the target graph, computed
+// once, with the label and degrees of every vertex, the largest degree of its
+// neighbors, and a 64-bit signature with one bit set for the labels of every
+// neighbor and of the edge leading to it. A pattern vertex can only be matched
+// to a target vertex with the same label, no smaller degrees or largest
+// neighbor degree, and a signature containing its own.
+//
+// The search trees of the candidates of the first pattern vertex are
+// independent, and are explored in parallel, in chunks of consecutive
+// candidates, after each of which the matches are passed to the caller in
+// order, outside of the parallel region. If the matches must be passed as soon
+// as they are found, e.g. to a generator, the search is run by a separate
+// thread instead, which puts the matches in a bounded queue, from which they
+// are passed to the caller by the calling thread; the search threads wait
+// while the queue is full, so that the memory used does not depend on the
+// number of matches. The state of every search is proportional to the size of
+// the pattern only.
+//
+// For graphs with parallel edges, the edges between two matched pattern
+// vertices must correspond to distinct edges with the same labels between
+// their images, as in boost::vf2_subgraph_mono(), and for induced subgraphs
+// the labels of the edges between the images must also not be more than those
+// in the pattern, as in boost::vf2_subgraph_iso().
+//
+// [cordella-subgraph-2004] L. P. Cordella, P. Foggia, C. Sansone, M. Vento,
+//    "A (sub)graph isomorphism algorithm for matching large graphs", IEEE
+//    Trans. Pattern Anal. Mach. Intell. 26 (10), 2004,
+//    DOI: 10.1109/TPAMI.2004.75
+// [bonnici-subgraph-2013] V. Bonnici, R. Giugno, A. Pulvirenti, D. Shasha,
+//    A. Ferro, "A subgraph isomorphism algorithm and its application to
+//    biochemical data", BMC Bioinformatics 14 (Suppl 7), 2013,
+//    DOI: 10.1186/1471-2105-14-S7-S13
+
+inline const openmp_kernel subgraph_matching_kernel("subgraph_matching", 10);
+
+template <class Graph1, class Graph2, class VertexLabel, class EdgeLabel>
+class SubgraphMatcher
+{
+public:
+    typedef typename property_traits<EdgeLabel>::value_type elabel_t;
+    static constexpr size_t null = numeric_limits<size_t>::max();
+
+    SubgraphMatcher(const Graph1& sub, const Graph2& g,
+                    VertexLabel vertex_label1, VertexLabel vertex_label2,
+                    EdgeLabel edge_label1, EdgeLabel edge_label2, bool induced)
+        : _sub(sub), _g(g), _vlabel1(vertex_label1), _vlabel2(vertex_label2),
+          _elabel1(edge_label1), _elabel2(edge_label2), _induced(induced),
+          _directed(graph_tool::is_directed(g))
+    {
+        build_index(_sub, _vlabel1, _elabel1, _index1);
+        build_index(_g, _vlabel2, _elabel2, _index2);
+        build_order();
+        build_back_edges();
+    }
+
+    // Calls f(match, match) for every match, where match[v] is the target
+    // vertex of pattern vertex v, until it returns false. If max_n > 0, the
+    // search stops after max_n matches are passed. If streaming is true, every
+    // match is passed as soon as it is found, and at most a bounded number of
+    // them are kept.
+    template <class F>
+    void run(size_t max_n, bool streaming, F&& f)
+    {
+        if (_order.empty())
+            return;
+
+        size_t N = num_vertices(_sub);
+        auto& roots = _cands[_order[0]];
+
+        _found = 0;
+        _limit = max_n;
+        _stop = false;
+        if (streaming && is_parallel_worth(g_work(0, roots.size())))
+        {
+            run_queued(max_n, f);
+            return;
+        }
+        if (streaming)
+        {
+            State state(N);
+            auto emit = [&](State& s)
+                {
+                    ++_found;
+                    if (!f(s.f, s.f))
+                        _stop = true;
+                };
+            for (auto w : roots)
+            {
+                if (is_done())
+                    break;
+                if (!is_feasible(state, 0, _order[0], w))
+                    continue;
+                assign(state, _order[0], w);
+                extend(state, 1, emit);
+                unassign(state, _order[0], w);
+            }
+            return;
+        }
+
+        size_t nthreads = 1;
+#ifdef _OPENMP
+        nthreads = omp_get_max_threads();
+#endif
+        vector<std::shared_ptr<State>> states(nthreads);
+        vector<vector<size_t>> matches;
+
+        size_t delivered = 0;
+        size_t chunk = 16 * nthreads;
+        for (size_t start = 0; start < roots.size();)
+        {
+            size_t end = std::min(start + chunk, roots.size());
+            matches.resize(end - start);
+            _found = 0;
+            _limit = (max_n > 0) ? max_n - delivered : 0;
+
+            #pragma omp parallel if (is_parallel_worth(g_work(start, end)))
+            {
+                size_t tid = 0;
+#ifdef _OPENMP
+                tid = omp_get_thread_num();
+#endif
+                if (states[tid] == nullptr)
+                    states[tid] = std::make_shared<State>(N);
+                auto& state = *states[tid];
+
+                #pragma omp for schedule(dynamic, 1)
+                for (size_t i = start; i < end; ++i)
+                {
+                    if (is_done())
+                        continue;
+                    auto& out = matches[i - start];
+                    out.clear();
+                    auto w = roots[i];
+                    if (!is_feasible(state, 0, _order[0], w))
+                        continue;
+                    auto emit = [&](State& s)
+                        {
+                            out.insert(out.end(), s.f.begin(), s.f.end());
+                            #pragma omp atomic
+                            ++_found;
+                        };
+                    assign(state, _order[0], w);
+                    extend(state, 1, emit);
+                    unassign(state, _order[0], w);
+                }
+            }
+
+            size_t nm = 0;
+            for (size_t j = 0; j < end - start; ++j)
+            {
+                auto& out = matches[j];
+                for (size_t k = 0; k < out.size(); k += N)
+                {
+                    vector<size_t> match(out.begin() + k, out.begin() + k + N);
+                    ++nm;
+                    if (!f(match, match) || (max_n > 0 && ++delivered >= max_n))
+                        return;
+                }
+                out.clear();
+            }
+
+            // adapt the chunks to produce a moderate number of matches
+            if (nm > (1 << 16))
+                chunk = std::max(chunk / 2, size_t(1));
+            else if (nm < (1 << 12))
+                chunk *= 2;
+            start = end;
+        }
+    }
+
+private:
+    // The search of run() for streaming, by a separate thread which puts the
+    // matches in a bounded queue, while the calling thread passes them to f.
+    // Both sides move the matches in small batches, so that the queue is not
+    // locked for every match.
+    template <class F>
+    void run_queued(size_t max_n, F& f)
+    {
+        size_t N = num_vertices(_sub);
+        auto& roots = _cands[_order[0]];
+
+        size_t nthreads = 1;
+#ifdef _OPENMP
+        nthreads = omp_get_max_threads();
+#endif
+        constexpr size_t batch_size = 16;   // in matches
+        size_t capacity = 256 * nthreads;   // in matches
+
+        std::mutex mutex;
+        std::condition_variable not_empty, not_full;
+        vector<size_t> queue;               // the matches, one after another
+        bool finished = false;
+        std::exception_ptr error;
+
+        auto search = [&]()
+            {
+                try
+                {
+                    vector<std::shared_ptr<State>> states(nthreads);
+                    #pragma omp parallel
+                    {
+                        size_t tid = 0;
+#ifdef _OPENMP
+                        tid = omp_get_thread_num();
+#endif
+                        states[tid] = std::make_shared<State>(N);
+                        auto& state = *states[tid];
+
+                        // the matches found before the limit was reached
+                        // are passed, unless the caller has stopped
+                        vector<size_t> batch;
+                        auto push = [&]()
+                            {
+                                std::unique_lock<std::mutex> lock(mutex);
+                                not_full.wait(lock, [&]
+                                    { return queue.size() < capacity * N ||
+                                             _stop; });
+                                if (!_stop)
+                                {
+                                    queue.insert(queue.end(), batch.begin(),
+                                                 batch.end());
+                                    not_empty.notify_one();
+                                }
+                                batch.clear();
+                            };
+                        auto emit = [&](State& s)
+                            {
+                                batch.insert(batch.end(), s.f.begin(),
+                                             s.f.end());
+                                #pragma omp atomic
+                                ++_found;
+                                if (batch.size() >= batch_size * N)
+                                    push();
+                            };
+
+                        #pragma omp for schedule(dynamic, 1)
+                        for (size_t i = 0; i < roots.size(); ++i)
+                        {
+                            if (is_done())
+                                continue;
+                            auto w = roots[i];
+                            if (!is_feasible(state, 0, _order[0], w))
+                                continue;
+                            assign(state, _order[0], w);
+                            extend(state, 1, emit);
+                            unassign(state, _order[0], w);
+                            if (!batch.empty())
+                                push();
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = true;
+                not_empty.notify_one();
+            };
+
+        std::thread searcher(search);
+
+        // stops the search, and waits for it to finish
+        auto join = [&]()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    #pragma omp atomic write
+                    _stop = true;
+                }
+                not_full.notify_all();
+                searcher.join();
+            };
+
+        vector<size_t> matches, match(N);
+        size_t delivered = 0;
+        try
+        {
+            bool done = false;
+            while (!done)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    not_empty.wait(lock, [&]
+                        { return !queue.empty() || finished; });
+                    if (queue.empty())
+                        break;
+                    matches.swap(queue);
+                    queue.clear();
+                }
+                not_full.notify_all();
+                for (size_t k = 0; k < matches.size(); k += N)
+                {
+                    std::copy(matches.begin() + k, matches.begin() + k + N,
+                              match.begin());
+                    if (!f(match, match) ||
+                        (max_n > 0 && ++delivered >= max_n))
+                    {
+                        done = true;
+                        break;
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            // e.g. if the generator is destroyed before it is exhausted
+            join();
+            throw;
+        }
+
+        join();
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    struct index_t
+    {
+        vector<size_t> kout, kin, maxnd;
+        vector<uint64_t> sig;
+    };
+
+    struct back_t
+    {
+        size_t u;
+        vector<elabel_t> out, in;
+    };
+
+    struct State
+    {
+        State(size_t N1) : f(N1, null), cands(N1) {}
+        vector<size_t> f;                   // current partial mapping
+        gt_hash_map<size_t, size_t> inv;    // and its inverse
+        vector<vector<size_t>> cands;       // candidates at every depth
+        vector<elabel_t> labels;
+        vector<pair<size_t, elabel_t>> scan;
+    };
+
+    template <class Graph, class VLabel, class ELabel>
+    void build_index(const Graph& g, VLabel& vlabel, ELabel& elabel,
+                     index_t& idx)
+    {
+        size_t N = num_vertices(g);
+        idx.kout.resize(N);
+        idx.kin.resize(N);
+        idx.maxnd.resize(N);
+        idx.sig.resize(N);
+
+        auto bit = [](auto vl, auto el, size_t dir)
+            {
+                uint64_t h = (uint64_t(vl) * 0x9e3779b97f4a7c15 +
+                              uint64_t(el)) * 0xbf58476d1ce4e5b9 + dir;
+                h *= 0x94d049bb133111eb;
+                return uint64_t(1) << (h >> 58);
+            };
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 uint64_t sig = 0;
+                 size_t kout = 0, kin = 0;
+                 for (auto e : out_edges_range(v, g))
+                 {
+                     sig |= bit(vlabel[target(e, g)], elabel[e], 0);
+                     ++kout;
+                 }
+                 if (_directed)
+                 {
+                     for (auto e : in_or_out_edges_range(v, g))
+                     {
+                         sig |= bit(vlabel[source(e, g)], elabel[e], 1);
+                         ++kin;
+                     }
+                 }
+                 idx.kout[v] = kout;
+                 idx.kin[v] = kin;
+                 idx.sig[v] = sig;
+             });
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t k = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                     k = std::max(k, idx.kout[u] + idx.kin[u]);
+                 if (_directed)
+                 {
+                     for (auto u : in_or_out_neighbors_range(v, g))
+                         k = std::max(k, idx.kout[u] + idx.kin[u]);
+                 }
+                 idx.maxnd[v] = k;
+             });
+    }
+
+    bool is_candidate(size_t v, size_t w) const
+    {
+        return (_vlabel1[vertex(v, _sub)] == _vlabel2[vertex(w, _g)] &&
+                _index1.kout[v] <= _index2.kout[w] &&
+                _index1.kin[v] <= _index2.kin[w] &&
+                _index1.maxnd[v] <= _index2.maxnd[w] &&
+                (_index1.sig[v] & ~_index2.sig[w]) == 0);
+    }
+
+    double g_work(size_t start, size_t end) const
+    {
+        return (end - start) * num_vertices(_sub) *
+            subgraph_matching_kernel.get_cost();
+    }
+
+    bool is_adjacent(size_t v, size_t u) const
+    {
+        for (auto t : out_neighbors_range(vertex(v, _sub), _sub))
+        {
+            if (size_t(t) == u)
+                return true;
+        }
+        return false;
+    }
+
+    void build_order()
+    {
+        size_t N = num_vertices(_sub);
+        vector<size_t> vs;
+        for (auto v : vertices_range(_sub))
+            vs.push_back(v);
+
+        // number of candidates of every pattern vertex
+        vector<size_t> count(N, 0);
+        #pragma omp parallel if (is_parallel_worth(num_vertices(_g) * vs.size()))
+        {
+            vector<size_t> lcount(N, 0);
+            parallel_vertex_loop_no_spawn
+                (_g,
+                 [&](auto w)
+                 {
+                     for (auto v : vs)
+                         lcount[v] += is_candidate(v, w);
+                 });
+            #pragma omp critical (subgraph_matching)
+            for (auto v : vs)
+                count[v] += lcount[v];
+        }
+
+        vector<uint8_t> ordered(N, false);
+        vector<size_t> nordered(N, 0);   // neighbors already in the order
+        _pos.assign(N, null);
+        while (_order.size() < vs.size())
+        {
+            // the vertex with most neighbors in the order, or with fewest
+            // candidates if there are none
+            auto better = [&](size_t u, size_t x)
+                {
+                    if (nordered[u] != nordered[x])
+                        return nordered[u] > nordered[x];
+                    if (nordered[u] == 0 && count[u] != count[x])
+                        return count[u] < count[x];
+                    size_t ku = _index1.kout[u] + _index1.kin[u];
+                    size_t kx = _index1.kout[x] + _index1.kin[x];
+                    if (ku != kx)
+                        return ku > kx;
+                    return count[u] < count[x];
+                };
+            size_t v = null;
+            for (auto u : vs)
+            {
+                if (!ordered[u] && (v == null || better(u, v)))
+                    v = u;
+            }
+
+            // the parent is the earliest neighbor in the order
+            size_t parent = null;
+            bool out = true;
+            for (auto u : _order)
+            {
+                if (is_adjacent(u, v))
+                {
+                    parent = u;
+                    out = true;
+                    break;
+                }
+                if (is_adjacent(v, u))
+                {
+                    parent = u;
+                    out = false;
+                    break;
+                }
+            }
+
+            _pos[v] = _order.size();
+            _order.push_back(v);
+            _parent.push_back(parent);
+            _parent_out.push_back(out);
+            ordered[v] = true;
+
+            auto inc = [&](auto u)
+                {
+                    if (!ordered[u] && size_t(u) != v)
+                        ++nordered[u];
+                };
+            for (auto u : out_neighbors_range(vertex(v, _sub), _sub))
+                inc(u);
+            if (_directed)
+            {
+                for (auto u : in_or_out_neighbors_range(vertex(v, _sub), _sub))
+                    inc(u);
+            }
+        }
+
+        // the vertices without a parent are matched to all their candidates
+        _cands.resize(N);
+        for (size_t i = 0; i < _order.size(); ++i)
+        {
+            if (_parent[i] != null)
+                continue;
+            auto v = _order[i];
+            auto& cands = _cands[v];
+            #pragma omp parallel if (is_parallel_worth(num_vertices(_g)))
+            {
+                vector<size_t> lcands;
+                parallel_vertex_loop_no_spawn
+                    (_g,
+                     [&](auto w)
+                     {
+                         if (is_candidate(v, w))
+                             lcands.push_back(w);
+                     });
+                #pragma omp critical (subgraph_matching)
+                cands.insert(cands.end(), lcands.begin(), lcands.end());
+            }
+            std::sort(cands.begin(), cands.end());
+        }
+    }
+
+    // The edges between every pattern vertex and those before it in the
+    // order, including itself, with their labels, sorted.
+    void build_back_edges()
+    {
+        _back.resize(_order.size());
+        _nback_out.resize(_order.size());
+        _nback_in.resize(_order.size());
+        for (size_t i = 0; i < _order.size(); ++i)
+        {
+            auto v = vertex(_order[i], _sub);
+            auto get_back = [&](size_t u) -> back_t&
+                {
+                    auto& back = _back[i];
+                    for (auto& b : back)
+                    {
+                        if (b.u == u)
+                            return b;
+                    }
+                    back.push_back({u, {}, {}});
+                    return back.back();
+                };
+            for (auto e : out_edges_range(v, _sub))
+            {
+                auto u = target(e, _sub);
+                if (_pos[u] <= i)
+                    get_back(u).out.push_back(_elabel1[e]);
+            }
+            if (_directed)
+            {
+                for (auto e : in_or_out_edges_range(v, _sub))
+                {
+                    auto u = source(e, _sub);
+                    if (_pos[u] <= i)
+                        get_back(u).in.push_back(_elabel1[e]);
+                }
+            }
+            auto& back = _back[i];
+            for (auto& b : back)
+            {
+                std::sort(b.out.begin(), b.out.end());
+                std::sort(b.in.begin(), b.in.end());
+                _nback_out[i] += !b.out.empty();
+                _nback_in[i] += !b.in.empty();
+            }
+            std::sort(back.begin(), back.end(),
+                      [](auto& a, auto& b) { return a.u < b.u; });
+        }
+    }
+
+    void assign(State& state, size_t v, size_t w)
+    {
+        state.f[v] = w;
+        state.inv[w] = v;
+    }
+
+    void unassign(State& state, size_t v, size_t w)
+    {
+        state.f[v] = null;
+        state.inv.erase(w);
+    }
+
+    // The pattern vertex matched to w, or null.
+    size_t get_inv(State& state, size_t w) const
+    {
+        auto iter = state.inv.find(w);
+        if (iter == state.inv.end())
+            return null;
+        return iter->second;
+    }
+
+    bool is_done()
+    {
+        bool stop;
+        #pragma omp atomic read
+        stop = _stop;
+        if (stop)
+            return true;
+        if (_limit == 0)
+            return false;
+        size_t found;
+        #pragma omp atomic read
+        found = _found;
+        return found >= _limit;
+    }
+
+    // Labels of the edges s -> t of the target graph, sorted.
+    void get_labels(size_t s, size_t t, vector<elabel_t>& labels)
+    {
+        labels.clear();
+        if (_directed && _index2.kin[t] < _index2.kout[s])
+        {
+            for (auto e : in_or_out_edges_range(vertex(t, _g), _g))
+            {
+                if (size_t(source(e, _g)) == s)
+                    labels.push_back(_elabel2[e]);
+            }
+        }
+        else
+        {
+            if (!_directed && _index2.kout[t] < _index2.kout[s])
+                std::swap(s, t);
+            for (auto e : out_edges_range(vertex(s, _g), _g))
+            {
+                if (size_t(target(e, _g)) == t)
+                    labels.push_back(_elabel2[e]);
+            }
+        }
+        std::sort(labels.begin(), labels.end());
+    }
+
+    // Whether the edges of w to the matched vertices of the target graph are
+    // the same as the back edges of v, for induced subgraphs, with the edges
+    // out of w (in == false) or into it.
+    template <class Edges>
+    bool is_induced_feasible(State& state, size_t i, size_t v, size_t w,
+                             Edges&& edges, bool in)
+    {
+        auto& scan = state.scan;
+        scan.clear();
+        for (auto e : edges)
+        {
+            size_t t = in ? source(e, _g) : target(e, _g);
+            if (t == w || get_inv(state, t) != null)
+                scan.emplace_back(t, _elabel2[e]);
+        }
+        std::sort(scan.begin(), scan.end());
+
+        auto& back = _back[i];
+        auto& labels = state.labels;
+        size_t groups = 0;
+        for (size_t j = 0; j < scan.size();)
+        {
+            size_t t = scan[j].first;
+            labels.clear();
+            for (; j < scan.size() && scan[j].first == t; ++j)
+                labels.push_back(scan[j].second);
+            size_t u = (t == w) ? v : get_inv(state, t);
+            auto iter = std::lower_bound(back.begin(), back.end(), u,
+                                         [](auto& b, size_t x)
+                                         { return b.u < x; });
+            if (iter == back.end() || iter->u != u ||
+                labels != (in ? iter->in : iter->out))
+                return false;
+            ++groups;
+        }
+        return groups == (in ? _nback_in[i] : _nback_out[i]);
+    }
+
+    bool is_feasible(State& state, size_t i, size_t v, size_t w)
+    {
+        if (_induced)
+        {
+            if (!is_induced_feasible(state, i, v, w,
+                                     out_edges_range(vertex(w, _g), _g),
+                                     false))
+                return false;
+            if (_directed &&
+                !is_induced_feasible(state, i, v, w,
+                                     in_or_out_edges_range(vertex(w, _g), _g),
+                                     true))
+                return false;
+            return true;
+        }
+
+        auto& labels = state.labels;
+        for (auto& b : _back[i])
+        {
+            size_t x = (b.u == v) ? w : state.f[b.u];
+            if (!b.out.empty())
+            {
+                get_labels(w, x, labels);
+                if (!std::includes(labels.begin(), labels.end(),
+                                   b.out.begin(), b.out.end()))
+                    return false;
+            }
+            if (!b.in.empty())
+            {
+                get_labels(x, w, labels);
+                if (!std::includes(labels.begin(), labels.end(),
+                                   b.in.begin(), b.in.end()))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Extends the partial match up to position i of the order, and calls
+    // emit(state) for every complete match.
+    template <class Emit>
+    void extend(State& state, size_t i, Emit& emit)
+    {
+        if (i == _order.size())
+        {
+            emit(state);
+            return;
+        }
+
+        size_t v = _order[i];
+        auto try_match = [&](size_t w)
+            {
+                if (get_inv(state, w) != null || !is_candidate(v, w) ||
+                    !is_feasible(state, i, v, w))
+                    return;
+                assign(state, v, w);
+                extend(state, i + 1, emit);
+                unassign(state, v, w);
+            };
+
+        if (_parent[i] == null)
+        {
+            for (auto w : _cands[v])
+            {
+                try_match(w);
+                if (is_done())
+                    return;
+            }
+            return;
+        }
+
+        // the candidates are the neighbors of the image of the parent, each
+        // collected once even if there are parallel edges
+        auto p = vertex(state.f[_parent[i]], _g);
+        auto& cands = state.cands[i];
+        cands.clear();
+        if (_parent_out[i])
+        {
+            for (auto w : out_neighbors_range(p, _g))
+                cands.push_back(w);
+        }
+        else
+        {
+            for (auto w : in_or_out_neighbors_range(p, _g))
+                cands.push_back(w);
+        }
+        std::sort(cands.begin(), cands.end());
+        cands.erase(std::unique(cands.begin(), cands.end()), cands.end());
+
+        for (auto w : cands)
+        {
+            try_match(w);
+            if (is_done())
+                return;
+        }
+    }
+
+    const Graph1& _sub;
+    const Graph2& _g;
+    VertexLabel _vlabel1, _vlabel2;
+    EdgeLabel _elabel1, _elabel2;
+    bool _induced;
+    bool _directed;
+
+    index_t _index1, _index2;
+    vector<size_t> _order, _pos, _parent;
+    vector<uint8_t> _parent_out;
+    vector<vector<size_t>> _cands;
+    vector<vector<back_t>> _back;
+    vector<size_t> _nback_out, _nback_in;
+
+    size_t _found = 0;
+    size_t _limit = 0;
+    bool _stop = false;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_SUBGRAPH_ISOMORPHISM_HH
@@ -59,6 +59,8 @@ void export_percolation();
 void export_similarity();
 void export_dists();
 void export_all_dists();
+void export_contraction_hierarchy();
+void export_landmark_labeling();
 void export_all_circuits();
 void export_diam();
 void export_random_matching();
@@ -90,6 +92,8 @@ BOOST_PYTHON_MODULE(libgraph_tool_topology)
     export_similarity();
     export_dists();
     export_all_dists();
+    export_contraction_hierarchy();
+    export_landmark_labeling();
     export_all_circuits();
     export_diam();
     export_random_matching();
@@ -20,6 +20,7 @@
 #include "graph_tool.hh"
 #include "graph_vertex_similarity.hh"
 #include "numpy_bind.hh"
+#include "random.hh"
 
 using namespace std;
 using namespace boost;
@@ -367,6 +368,63 @@ void get_leicht_holme_newman_similarity_pairs(GraphInterface& gi,
         (gi.get_graph_view(), weight);
 }
 
+python::object get_similarity_top_k(GraphInterface& gi, string sim_type,
+                                    size_t k, double threshold,
+                                    boost::any weight)
+{
+    static const vector<pair<string, similarity_t>> names =
+        {{"dice", similarity_t::dice},
+         {"salton", similarity_t::salton},
+         {"hub-promoted", similarity_t::hub_promoted},
+         {"hub-suppressed", similarity_t::hub_suppressed},
+         {"jaccard", similarity_t::jaccard},
+         {"inv-log-weight", similarity_t::inv_log_weight},
+         {"resource-allocation", similarity_t::r_allocation},
+         {"leicht-holme-newman", similarity_t::leicht_holme_newman}};
+    auto iter = std::find_if(names.begin(), names.end(),
+                             [&](auto& x) { return x.first == sim_type; });
+    if (iter == names.end())
+        throw ValueException("invalid similarity type: " + sim_type);
+    auto sim = iter->second;
+
+    if (weight.empty())
+        weight = ecmap_t();
+
+    vector<int64_t> rows, cols;
+    vector<double> vals;
+    gt_dispatch<>()
+        ([&](auto& g, auto w)
+         {
+             top_k_similarity(g, sim, w, k, threshold, rows, cols, vals);
+         },
+         all_graph_views(), weight_props_t())
+        (gi.get_graph_view(), weight);
+    return python::make_tuple(wrap_vector_owned(rows), wrap_vector_owned(cols),
+                              wrap_vector_owned(vals));
+}
+
+python::object get_minhash_similarity_top_k(GraphInterface& gi, size_t bands,
+                                            size_t band_size, size_t k,
+                                            double threshold, rng_t& rng)
+{
+    vector<uint64_t> seeds(bands * band_size);
+    std::uniform_int_distribution<uint64_t> random;
+    for (auto& seed : seeds)
+        seed = random(rng);
+
+    vector<int64_t> rows, cols;
+    vector<double> vals;
+    run_action<>()
+        (gi,
+         [&](auto& g)
+         {
+             top_k_minhash_similarity(g, seeds, band_size, k, threshold, rows,
+                                      cols, vals);
+         })();
+    return python::make_tuple(wrap_vector_owned(rows), wrap_vector_owned(cols),
+                              wrap_vector_owned(vals));
+}
+
 void export_vertex_similarity()
 {
     python::def("dice_similarity", &get_dice_similarity);
@@ -388,4 +446,6 @@ void export_vertex_similarity()
     python::def("leicht_holme_newman_similarity", &get_leicht_holme_newman_similarity);
     python::def("leicht_holme_newman_similarity_pairs",
                 &get_leicht_holme_newman_similarity_pairs);
+    python::def("similarity_top_k", &get_similarity_top_k);
+    python::def("minhash_similarity_top_k", &get_minhash_similarity_top_k);
 };
@@ -18,13 +18,23 @@
 #ifndef GRAPH_VERTEX_SIMILARITY_HH
 #define GRAPH_VERTEX_SIMILARITY_HH
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
 #include "graph_util.hh"
+#include "idx_map.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// cost of computing the similarity of a pair of vertices, per out-neighbour
+inline const openmp_kernel vertex_similarity_kernel("vertex_similarity", 4);
+
 template <class Graph, class Vertex, class Mark, class Weight>
 auto common_neighbors(Vertex u, Vertex v, Mark& mark, Weight& weight, Graph& g)
 {
@@ -166,8 +176,9 @@ void all_pairs_similarity(Graph& g, VMap s, Sim&& f, Weight& weight)
 {
     vector<typename property_traits<Weight>::value_type>
         mask(num_vertices(g));
-    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-        firstprivate(mask)
+    double work = double(num_vertices(g)) * (num_vertices(g) + num_edges(g)) *
+        vertex_similarity_kernel.get_cost();
+    #pragma omp parallel if (is_parallel_worth(work)) firstprivate(mask)
     parallel_vertex_loop_no_spawn
         (g,
          [&](auto v)
@@ -184,8 +195,9 @@ void some_pairs_similarity(Graph& g, Vlist& vlist, Slist& slist, Sim&& f,
 {
     vector<typename property_traits<Weight>::value_type>
         mark(num_vertices(g));
-    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-        firstprivate(mark)
+    double k = num_edges(g) / double(max(num_vertices(g), size_t(1)));
+    double work = vlist.size() * (k + 1) * vertex_similarity_kernel.get_cost();
+    #pragma omp parallel if (is_parallel_worth(work)) firstprivate(mark)
     parallel_loop_no_spawn
         (vlist,
          [&](size_t i, const auto& val)
@@ -196,6 +208,301 @@ void some_pairs_similarity(Graph& g, Vlist& vlist, Slist& slist, Sim&& f,
          });
 }
 
+// Sparse similarities
+// ===================
+//
+// All the similarities above vanish for pairs of vertices without common
+// neighbors, which are almost all pairs in a sparse graph. Hence, the nonzero
+// similarities of a vertex u are found by visiting only the vertices v which
+// share a neighbor w with u, through the paths u -> w <- v, while accumulating
+// the overlaps min(A_wu, A_wv) for every v, as well as the sums over the
+// common neighbors needed for "inv-log-weight" and "resource-allocation". This
+// takes time proportional to the number of such paths, instead of the sum of
+// the degrees of every pair. Only the k most similar vertices to u are kept,
+// among those with similarity at least equal to a threshold.
+//
+// The Jaccard similarity can also be approximated with MinHash signatures
+// [broder-resemblance-1997], i.e. the minima of several hash functions over
+// the neighborhoods, since two vertices have the same minimum with a
+// probability equal to their Jaccard similarity. The signatures are split in
+// bands of a few values, and only the pairs with identical signatures over
+// some band are considered [leskovec-mining-2014], so that the pairs with
+// small similarity are unlikely to be visited at all.
+//
+// [broder-resemblance-1997] A. Z. Broder, "On the resemblance and containment
+//    of documents", Compression and Complexity of Sequences, 1997,
+//    DOI: 10.1109/SEQUEN.1997.666900
+// [leskovec-mining-2014] J. Leskovec, A. Rajaraman, J. D. Ullman, "Mining of
+//    Massive Datasets", Chapter 3, Cambridge University Press, 2014
+
+enum class similarity_t
+{
+    dice,
+    salton,
+    hub_promoted,
+    hub_suppressed,
+    jaccard,
+    inv_log_weight,
+    r_allocation,
+    leicht_holme_newman
+};
+
+// Similarity given the overlap of the neighborhoods, their sizes, and the sum
+// over the common neighbors for "inv-log-weight" and "resource-allocation".
+inline double get_similarity(similarity_t sim, double count, double ku,
+                             double kv, double acc)
+{
+    switch (sim)
+    {
+    case similarity_t::dice:
+        return 2 * count / (ku + kv);
+    case similarity_t::salton:
+        return count / sqrt(ku * kv);
+    case similarity_t::hub_promoted:
+        return count / std::max(ku, kv);
+    case similarity_t::hub_suppressed:
+        return count / std::min(ku, kv);
+    case similarity_t::jaccard:
+        return count / (ku + kv - count);
+    case similarity_t::leicht_holme_newman:
+        return count / (ku * kv);
+    default:
+        return acc;
+    }
+}
+
+// Calls f(u, add) for every vertex u, which should call add(v, s) for the
+// vertices v with nonzero similarity s to u, and stores the k largest ones
+// (or all, if k == 0) with s >= threshold in the arrays (rows, cols, vals),
+// ordered by u, and for the same u by decreasing similarity. This must be
+// called from all the threads of a parallel region, with a shared vector pos
+// of size num_vertices(g) + 1, initialized to zero.
+template <class Graph, class F>
+void collect_similar_vertices_no_spawn(Graph& g, size_t k, double threshold,
+                                       F&& f, vector<size_t>& pos,
+                                       vector<int64_t>& rows,
+                                       vector<int64_t>& cols,
+                                       vector<double>& vals)
+{
+    size_t N = num_vertices(g);
+
+    vector<std::tuple<size_t, size_t, double>> buf;
+    vector<pair<size_t, double>> sel;
+    auto cmp = [](auto& a, auto& b)
+        {
+            return (a.second > b.second ||
+                    (a.second == b.second && a.first < b.first));
+        };
+
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto u)
+         {
+             sel.clear();
+             f(u, [&](size_t v, double s)
+                  {
+                      if (s >= threshold)
+                          sel.emplace_back(v, s);
+                  });
+             if (k > 0 && sel.size() > k)
+             {
+                 std::nth_element(sel.begin(), sel.begin() + k, sel.end(),
+                                  cmp);
+                 sel.resize(k);
+             }
+             std::sort(sel.begin(), sel.end(), cmp);
+             for (auto& [v, s] : sel)
+                 buf.emplace_back(u, v, s);
+             pos[u + 1] = sel.size();
+         });
+
+    #pragma omp single
+    {
+        for (size_t v = 0; v < N; ++v)
+            pos[v + 1] += pos[v];
+        rows.resize(pos[N]);
+        cols.resize(pos[N]);
+        vals.resize(pos[N]);
+    }
+
+    // the entries of each vertex are contiguous in the buffer
+    size_t start = 0;
+    for (size_t i = 0; i < buf.size(); ++i)
+    {
+        auto& [u, v, s] = buf[i];
+        if (i > 0 && get<0>(buf[i - 1]) != u)
+            start = i;
+        size_t j = pos[u] + (i - start);
+        rows[j] = u;
+        cols[j] = v;
+        vals[j] = s;
+    }
+}
+
+template <class Graph, class Weight>
+void top_k_similarity(Graph& g, similarity_t sim, Weight& weight, size_t k,
+                      double threshold, vector<int64_t>& rows,
+                      vector<int64_t>& cols, vector<double>& vals)
+{
+    typedef typename property_traits<Weight>::value_type wval_t;
+    typedef typename std::conditional<std::is_floating_point<wval_t>::value,
+                                      double, int64_t>::type val_t;
+
+    size_t N = num_vertices(g);
+    vector<val_t> kout(N);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             val_t d = 0;
+             for (auto e : out_edges_range(v, g))
+                 d += weight[e];
+             kout[v] = d;
+         });
+
+    idx_map<size_t, val_t> au, av;
+    idx_map<size_t, pair<val_t, double>> common;
+    vector<size_t> pos(N + 1, 0);
+    #pragma omp parallel if (is_parallel_worth(g, vertex_similarity_kernel)) \
+        firstprivate(au, av, common)
+    collect_similar_vertices_no_spawn
+        (g, k, threshold,
+         [&](auto u, auto&& add)
+         {
+             au.clear();
+             for (auto e : out_edges_range(u, g))
+                 au[target(e, g)] += weight[e];
+
+             common.clear();
+             for (auto& [w, a] : au)
+             {
+                 // multiplicities of the edges v -> w, and the weighted
+                 // (in-)degree of w
+                 av.clear();
+                 val_t kw = 0;
+                 for (auto e : in_or_out_edges_range(vertex(w, g), g))
+                 {
+                     size_t v = source(e, g);
+                     if (v == w)
+                         v = target(e, g);
+                     av[v] += weight[e];
+                     kw += weight[e];
+                 }
+
+                 for (auto& [v, b] : av)
+                 {
+                     auto m = std::min(a, b);
+                     if (v == u || m == 0)
+                         continue;
+                     auto& c = common[v];
+                     c.first += m;
+                     if (sim == similarity_t::inv_log_weight)
+                         c.second += m / log(kw);
+                     else if (sim == similarity_t::r_allocation)
+                         c.second += m / double(kw);
+                 }
+             }
+
+             for (auto& [v, c] : common)
+                 add(v, get_similarity(sim, c.first, kout[u], kout[v],
+                                       c.second));
+         },
+         pos, rows, cols, vals);
+}
+
+inline uint64_t minhash_mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+// One hash function is used for each value of seeds, and the signatures are
+// split in bands of size r.
+template <class Graph>
+void top_k_minhash_similarity(Graph& g, const vector<uint64_t>& seeds,
+                              size_t r, size_t k, double threshold,
+                              vector<int64_t>& rows, vector<int64_t>& cols,
+                              vector<double>& vals)
+{
+    size_t N = num_vertices(g);
+    size_t H = seeds.size();
+    size_t B = H / r;
+
+    vector<uint32_t> sig(N * H, numeric_limits<uint32_t>::max());
+    vector<uint8_t> empty(N, true);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto sv = &sig[v * H];
+             for (auto w : out_neighbors_range(v, g))
+             {
+                 empty[v] = false;
+                 for (size_t i = 0; i < H; ++i)
+                     sv[i] = std::min(sv[i],
+                                      uint32_t(minhash_mix(w ^ seeds[i])));
+             }
+         });
+
+    // the vertices of every band, sorted by the hash of their signature in it
+    vector<vector<pair<uint64_t, size_t>>> bands(B);
+    #pragma omp parallel for schedule(runtime) \
+        if (is_parallel_worth(N * H))
+    for (size_t j = 0; j < B; ++j)
+    {
+        auto& band = bands[j];
+        for (auto v : vertices_range(g))
+        {
+            if (empty[v])
+                continue;
+            uint64_t h = j;
+            for (size_t i = j * r; i < (j + 1) * r; ++i)
+                h = minhash_mix(h ^ sig[v * H + i]);
+            band.emplace_back(h, v);
+        }
+        std::sort(band.begin(), band.end());
+    }
+
+    idx_map<size_t, bool> visited;
+    vector<size_t> pos(N + 1, 0);
+    #pragma omp parallel if (is_parallel_worth(N * (B + 1) * H)) \
+        firstprivate(visited)
+    collect_similar_vertices_no_spawn
+        (g, k, threshold,
+         [&](auto u, auto&& add)
+         {
+             if (empty[u])
+                 return;
+             auto su = &sig[u * H];
+             visited.clear();
+             for (size_t j = 0; j < B; ++j)
+             {
+                 uint64_t h = j;
+                 for (size_t i = j * r; i < (j + 1) * r; ++i)
+                     h = minhash_mix(h ^ su[i]);
+                 auto& band = bands[j];
+                 auto iter = std::lower_bound(band.begin(), band.end(),
+                                              make_pair(h, size_t(0)));
+                 for (; iter != band.end() && iter->first == h; ++iter)
+                 {
+                     size_t v = iter->second;
+                     if (v == size_t(u) || visited.find(v) != visited.end())
+                         continue;
+                     visited[v] = true;
+                     auto sv = &sig[v * H];
+                     size_t m = 0;
+                     for (size_t i = 0; i < H; ++i)
+                         m += (su[i] == sv[i]);
+                     if (m > 0)
+                         add(v, m / double(H));
+                 }
+             }
+         },
+         pos, rows, cols, vals);
+}
+
 } // graph_tool namespace
 
 #endif // GRAPH_VERTEX_SIMILARITY_HH
@@ -52,6 +52,13 @@ Summary
    openmp_set_num_threads
    openmp_get_schedule
    openmp_set_schedule
+   openmp_get_min_work
+   openmp_set_min_work
+   openmp_get_kernel_costs
+   openmp_set_kernel_cost
+   openmp_calibrate
+   openmp_get_loop_balance
+   openmp_set_loop_balance
    show_config
 
 
@@ -132,6 +139,7 @@ import io
 import collections
 import itertools
 import csv
+import warnings
 
 if sys.version_info < (3,):
     import StringIO
@@ -150,14 +158,18 @@ __all__ = ["Graph", "GraphView", "Vertex", "Edge", "VertexBase", "EdgeBase",
            "Vector_bool", "Vector_int16_t", "Vector_int32_t", "Vector_int64_t",
            "Vector_double", "Vector_long_double", "Vector_string",
            "Vector_size_t", "Vector_cdouble", "value_types", "load_graph",
-           "load_graph_from_csv", "VertexPropertyMap", "EdgePropertyMap",
+           "load_graph_from_csv", "GraphWriter", "VertexPropertyMap", "EdgePropertyMap",
            "GraphPropertyMap", "PropertyMap", "PropertyArray",
            "group_vector_property", "ungroup_vector_property",
            "map_property_values", "infect_vertex_property",
            "edge_endpoint_property", "incident_edges_op", "perfect_prop_hash",
            "seed_rng", "show_config", "openmp_enabled",
            "openmp_get_num_threads", "openmp_set_num_threads",
-           "openmp_get_schedule", "openmp_set_schedule", "__author__",
+           "openmp_get_schedule", "openmp_set_schedule",
+           "openmp_get_min_work", "openmp_set_min_work",
+           "openmp_get_kernel_costs", "openmp_set_kernel_cost",
+           "openmp_calibrate",
+           "openmp_get_loop_balance", "openmp_set_loop_balance", "__author__",
            "__copyright__", "__URL__", "__version__"]
 
 # this is rather pointless, but it works around a sphinx bug
@@ -1370,12 +1382,61 @@ def perfect_prop_hash(props, htype="int32_t"):
 
 class InternalPropertyDict(dict):
     """Internal dictionary of property maps. It only accepts string keys and
-    :class:`PropertyMap` instances as values."""
+    :class:`PropertyMap` instances as values.
+
+    Entries may also be lazy, i.e. given by a function which returns the
+    property map, and is only called when the entry is first accessed. The
+    views returned by :meth:`items` and :meth:`values` resolve each lazy entry
+    only when it is reached during iteration."""
 
     def __init__(self, g):
         self.g = weakref.ref(g)
+        self.lazy = {}
         dict.__init__(self)
 
+    def __missing__(self, key):
+        if key not in self.lazy:
+            raise KeyError(key)
+        val = self.lazy[key]()
+        self[key] = val
+        return val
+
+    def __contains__(self, key):
+        return dict.__contains__(self, key) or key in self.lazy
+
+    def __len__(self):
+        return dict.__len__(self) + len(self.lazy)
+
+    def __iter__(self):
+        return iter(self.keys())
+
+    def get(self, key, default=None):
+        try:
+            return self[key]
+        except KeyError:
+            return default
+
+    def keys(self):
+        return list(dict.keys(self)) + list(self.lazy.keys())
+
+    def load_lazy(self):
+        """Materialize all lazy entries."""
+        for key in list(self.lazy.keys()):
+            self[key]
+
+    def items(self):
+        return collections.ItemsView(self)
+
+    def values(self):
+        return collections.ValuesView(self)
+
+    if sys.version_info < (3,):
+        def iteritems(self):
+            return iter(self.items())
+
+        def itervalues(self):
+            return iter(self.values())
+
     @_require("key", tuple)
     @_require("val", PropertyMap)
     def __setitem__(self, key, val):
@@ -1392,11 +1453,19 @@ class InternalPropertyDict(dict):
     @_limit_args({"t": ["v", "e", "g"]})
     @_require("key", str, unicode)
     def __set_property(self, t, key, v):
+        self.lazy.pop((t, key), None)
         dict.__setitem__(self, (t, key), v)
 
     @_require("key", tuple)
     def __delitem__(self, key):
-        dict.__delitem__(self, key)
+        if key in self.lazy:
+            del self.lazy[key]
+        else:
+            dict.__delitem__(self, key)
+
+    def clear(self):
+        self.lazy.clear()
+        dict.clear(self)
 
     @_require("key", tuple)
     def setdefault(self, key, default=None):
@@ -1513,36 +1582,34 @@ class PropertyDict(object):
                 yield k[0]
 
     def items(self):
-        for k, v in self.properties.items():
+        for k in self.properties.keys():
             if k[0] == self.t:
-                yield k[1], v
+                yield k[1], self.properties[k]
 
     if sys.version_info < (3,):
         def has_key(self, key):
             return self.properties.has_key((self.t, key))
 
         def iteritems(self):
-            for k, v in self.properties.iteritems():
-                if k[0] == self.t:
-                    yield k[1], v
+            return self.items()
 
     def itervalues(self):
-        for k, v in self.properties.iteritems():
+        for k in self.properties.keys():
             if k[0] == self.t:
-                yield v
+                yield self.properties[k]
 
     def keys(self):
         return [k[1] for k in self.properties.keys() if k[0] == self.t]
 
     if sys.version_info < (3,):
         def values(self):
-            return [v for k, v in self.properties.iteritems() if k[0] == self.t]
+            return list(self.itervalues())
         def __repr__(self):
             temp = dict([(k[1], v) for k, v in self.properties.iteritems() if k[0] == self.t])
             return repr(temp)
     else:
         def values(self):
-            return [v for k, v in self.properties.items() if k[0] == self.t]
+            return list(self.itervalues())
         def __repr__(self):
             temp = dict([(k[1], v) for k, v in self.properties.items() if k[0] == self.t])
             return repr(temp)
@@ -2440,6 +2507,31 @@ class Graph(object):
         maps that will be filled with the remaining values at each row, if there
         are more than two.
 
+        .. note::
+
+           If ``edge_list`` is a :class:`~numpy.ndarray`, large lists are
+           inserted at once. The edge indexes and the order of the in- and
+           out-edges of every vertex are nevertheless the same as if the edges
+           were added one by one with :meth:`~graph_tool.Graph.add_edge`.
+
+        Examples
+        --------
+        >>> edges = np.random.randint(0, 100, (1000, 2))
+        >>> g, h = gt.Graph(), gt.Graph()
+        >>> for u in [g, h]:
+        ...     vs = u.add_vertex(100)
+        ...     for s, t in edges[:100]:
+        ...         e = u.add_edge(s, t)
+        >>> g.add_edge_list(edges[100:])
+        >>> for s, t in edges[100:]:
+        ...     e = h.add_edge(s, t)
+        >>> all((g.get_in_edges(v, [g.edge_index]) ==
+        ...      h.get_in_edges(v, [h.edge_index])).all() and
+        ...     (g.get_out_edges(v, [g.edge_index]) ==
+        ...      h.get_out_edges(v, [h.edge_index])).all()
+        ...     for v in g.vertices())
+        True
+
         """
         if eprops is None:
             eprops = ()
@@ -2639,6 +2731,54 @@ class Graph(object):
         actual size, potentially freeing memory back to the system."""
         self.__graph.shrink_to_fit()
 
+    def freeze(self):
+        r"""Build a read-only snapshot of the graph, stored contiguously in
+        memory (in compressed sparse row form), which is used instead of the
+        regular adjacency lists by the algorithms that support it, such as
+        :func:`~graph_tool.centrality.pagerank`,
+        :func:`~graph_tool.centrality.closeness`,
+        :func:`~graph_tool.clustering.local_clustering` and
+        :func:`~graph_tool.topology.shortest_distance`. This requires an
+        additional :math:`O(V + E)` amount of memory, and is only worthwhile if
+        the graph is analyzed several times without being modified.
+
+        The snapshot is ignored for filtered graphs, and it becomes stale as
+        soon as the graph is modified or replaced by
+        :meth:`~graph_tool.Graph.load`, in which case it is no longer used until
+        :meth:`~graph_tool.Graph.freeze` is called again.
+
+        Examples
+        --------
+        >>> import tempfile, os.path
+        >>> g = gt.lattice([10, 10])
+        >>> g.freeze()
+        >>> g.is_frozen()
+        True
+        >>> pr = gt.pagerank(g)
+        >>> u = gt.lattice([10, 10])
+        >>> np.allclose(pr.a, gt.pagerank(u).a)
+        True
+        >>> with tempfile.TemporaryDirectory() as d:
+        ...     u = gt.circular_graph(100, 2)
+        ...     u.save(os.path.join(d, "u.gt"))
+        ...     g.load(os.path.join(d, "u.gt"))
+        >>> g.is_frozen()
+        False
+        >>> np.allclose(gt.pagerank(g).a, gt.pagerank(u).a)
+        True
+        """
+        self.__graph.freeze()
+
+    def unfreeze(self):
+        r"""Discard the read-only snapshot built by
+        :meth:`~graph_tool.Graph.freeze`."""
+        self.__graph.unfreeze()
+
+    def is_frozen(self):
+        r"""Return whether an up-to-date read-only snapshot built by
+        :meth:`~graph_tool.Graph.freeze` is available."""
+        return self.__graph.is_frozen()
+
     # Property map creation
 
     def new_property(self, key_type, value_type, vals=None):
@@ -2808,7 +2948,7 @@ class Graph(object):
         return fmt
 
     def load(self, file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
-             ignore_gp=None):
+             ignore_gp=None, lazy=False):
         """Load graph from ``file_name`` (which can be either a string or a file-like
         object). The format is guessed from ``file_name``, or can be specified
         by ``fmt``, which can be either "gt", "graphml", "xml", "dot" or "gml".
@@ -2818,12 +2958,71 @@ class Graph(object):
         ``ignore_gp``, should contain a list of property names (vertex, edge or
         graph, respectively) which should be ignored when reading the file.
 
+        If ``lazy == True``, and the file is an uncompressed "gt" file with
+        ``gt_version=2`` (see :meth:`~graph_tool.Graph.save`), only the
+        adjacency and the graph properties are read, and the vertex and edge
+        property maps are read from the file only when they are first
+        accessed. Iterating over the property maps, e.g. via
+        :attr:`~graph_tool.Graph.vertex_properties`, reads each one as it is
+        reached, whereas copying or saving the graph reads them all. This
+        requires the file to remain unchanged, and the graph to remain
+        unmodified, until then; otherwise an exception is raised when the
+        property maps are accessed. Changes to the file are detected by its
+        size and modification time. For other files, including compressed
+        ones, all property maps are read at once, and a
+        :class:`RuntimeWarning` is issued.
+
+        Files in the "graphml", "gml" and "dot" formats are parsed in
+        parallel, if OpenMP is enabled. Files which use features not supported
+        by the parallel parser (such as nested graphs or subgraphs) are parsed
+        sequentially instead. Files in the "gt" format are also read in
+        parallel, if they are given by their name, and are not compressed with
+        bzip2; gzip files are decompressed into memory first (in parallel, if
+        they were written by :meth:`~graph_tool.Graph.save`).
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
            internal property maps are "gt" and "graphml". Because of this,
            they should be preferred over the other formats whenever possible.
 
+        Examples
+        --------
+        >>> import tempfile, os.path, warnings
+        >>> g = gt.price_network(1000)
+        >>> g.ep.weight = g.new_ep("double", vals=np.random.random(g.num_edges()))
+        >>> g.vp.age = g.new_vp("int", vals=np.arange(g.num_vertices()))
+        >>> with tempfile.TemporaryDirectory() as d:
+        ...     fname = os.path.join(d, "g.gt")
+        ...     g.save(fname, gt_version=2)
+        ...     u = gt.Graph()
+        ...     u.load(fname, lazy=True)
+        ...     print(sorted(u.vp.keys()), sorted(u.ep.keys()))
+        ...     print(np.array_equal(g.vp.age.a, u.vp.age.a))
+        ...     v = u.add_vertex()
+        ...     try:
+        ...         w = u.ep.weight
+        ...     except ValueError:
+        ...         print("modified")
+        ...     u.load(fname, lazy=True)
+        ...     os.truncate(fname, 0)
+        ...     try:
+        ...         w = u.ep.weight
+        ...     except IOError:
+        ...         print("changed")
+        ...     g.save(fname + ".gz", gt_version=2)
+        ...     with warnings.catch_warnings(record=True) as ws:
+        ...         warnings.simplefilter("always")
+        ...         u.load(fname + ".gz", lazy=True)
+        ...     print([w.category.__name__ for w in ws])
+        ...     print(np.array_equal(g.ep.weight.a, u.ep.weight.a))
+        ['age'] ['weight']
+        True
+        modified
+        changed
+        ['RuntimeWarning']
+        True
+
         """
 
         if isinstance(file_name, (str, unicode)):
@@ -2847,18 +3046,34 @@ class Graph(object):
         if ignore_gp is None:
             ignore_gp = []
         if isinstance(file_name, (str, unicode)):
+            # the file is identified before it is read, so that lazy property
+            # maps are not read from a file which has changed meanwhile
+            fstat = _file_stamp(file_name)
             props = self.__graph.read_from_file(_c_str(file_name), None,
                                                 _c_str(fmt), ignore_vp,
-                                                ignore_ep, ignore_gp)
+                                                ignore_ep, ignore_gp, lazy)
         else:
             props = self.__graph.read_from_file("", file_name, _c_str(fmt),
-                                                ignore_vp, ignore_ep, ignore_gp)
+                                                ignore_vp, ignore_ep, ignore_gp,
+                                                False)
+        if lazy and not props[4]:
+            warnings.warn("the property maps can only be read lazily from " +
+                          "uncompressed 'gt' files of version 2, given by " +
+                          "their name; all of them have been read",
+                          RuntimeWarning)
         for name, prop in props[0].items():
             self.vertex_properties[name] = VertexPropertyMap(prop, self)
         for name, prop in props[1].items():
             self.edge_properties[name] = EdgePropertyMap(prop, self)
         for name, prop in props[2].items():
             self.graph_properties[name] = GraphPropertyMap(prop, self)
+        if len(props[3]) > 0:
+            mods = (self.__graph.get_instance_id(),
+                    self.__graph.get_num_modifications())
+            for t, name in props[3]:
+                self.__properties.lazy[(t, name)] = \
+                    _lazy_property_loader(self, file_name, t, name, mods,
+                                          fstat)
         if "_Graph__save__vfilter" in self.graph_properties:
             self.set_vertex_filter(self.vertex_properties["_Graph__save__vfilter"],
                                    self.graph_properties["_Graph__save__vfilter"])
@@ -2874,18 +3089,62 @@ class Graph(object):
             del self.graph_properties["_Graph__reversed"]
         self.shrink_to_fit()
 
-    def save(self, file_name, fmt="auto"):
+    def save(self, file_name, fmt="auto", gt_version=1):
         """Save graph to ``file_name`` (which can be either a string or a file-like
         object). The format is guessed from the ``file_name``, or can be
         specified by ``fmt``, which can be either "gt", "graphml", "xml", "dot"
         or "gml".  (Note that "graphml" and "xml" are synonyms).
 
+        If ``fmt == "gt"``, the parameter ``gt_version`` selects the version of
+        the :ref:`binary format <sec_gt_format>`. Version ``2`` stores the
+        adjacency and scalar property maps in aligned sections, which are
+        copied in bulk from a memory-mapped file instead of being parsed value
+        by value. This is much faster to load for large graphs, but it cannot
+        be read by graph-tool versions that predate it. Files with a ``.gz`` suffix are compressed in independent blocks,
+        using all available threads, and remain readable by any gzip
+        implementation.
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
            internal property maps are "gt" and "graphml". Because of this,
            they should be preferred over the other formats whenever possible.
 
+        Examples
+        --------
+        >>> import tempfile, os.path
+        >>> g = gt.price_network(1000)
+        >>> g.ep.weight = g.new_ep("double", vals=np.random.random(g.num_edges()))
+        >>> g.vp.age = g.new_vp("int", vals=np.arange(g.num_vertices()))
+        >>> g.gp.name = g.new_gp("string", val="price")
+        >>> with tempfile.TemporaryDirectory() as d:
+        ...     fname = os.path.join(d, "g.gt")
+        ...     g.save(fname, gt_version=2)
+        ...     u = gt.load_graph(fname)
+        >>> np.array_equal(g.get_edges([g.ep.weight]), u.get_edges([u.ep.weight]))
+        True
+        >>> np.array_equal(g.vp.age.a, u.vp.age.a)
+        True
+        >>> print(u.gp.name)
+        price
+
+        A compressed file holds exactly the same data as an uncompressed one:
+
+        >>> import gzip
+        >>> g = gt.price_network(100000)
+        >>> g.ep.weight = g.new_ep("double", vals=np.random.random(g.num_edges()))
+        >>> with tempfile.TemporaryDirectory() as d:
+        ...     g.save(os.path.join(d, "g.gt"), gt_version=2)
+        ...     g.save(os.path.join(d, "g.gt.gz"), gt_version=2)
+        ...     with open(os.path.join(d, "g.gt"), "rb") as f:
+        ...         data = f.read()
+        ...     with gzip.open(os.path.join(d, "g.gt.gz"), "rb") as f:
+        ...         print(f.read() == data)
+        ...     u = gt.load_graph(os.path.join(d, "g.gt.gz"))
+        True
+        >>> np.array_equal(g.get_edges([g.ep.weight]), u.get_edges([u.ep.weight]))
+        True
+
         """
 
         u = GraphView(self, reversed=self.is_reversed(), skip_vfilt=True,
@@ -2926,9 +3185,11 @@ class Graph(object):
             f = open(file_name, "w") # throw the appropriate exception, if
                                      # unable to open
             f.close()
-            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props)
+            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props,
+                                    gt_version)
         else:
-            u.__graph.write_to_file("", file_name, _c_str(fmt), props)
+            u.__graph.write_to_file("", file_name, _c_str(fmt), props,
+                                    gt_version)
 
 
     # Directedness
@@ -3283,8 +3544,34 @@ class Graph(object):
         return self
     base = property(__get_base, doc="Base graph (self).")
 
+def _file_stamp(file_name):
+    st = os.stat(file_name)
+    return (st.st_dev, st.st_ino, st.st_size, st.st_mtime)
+
+def _lazy_property_loader(g, file_name, t, name, mods, fstat):
+    g = weakref.ref(g)
+    def load():
+        u = g()
+        if (u._Graph__graph.get_instance_id(),
+            u._Graph__graph.get_num_modifications()) != mods:
+            raise ValueError("cannot load property map '%s' from file '%s': the graph has been modified since it was loaded" %
+                             (name, file_name))
+        try:
+            changed = _file_stamp(file_name) != fstat
+        except OSError:
+            changed = True
+        if changed:
+            raise IOError("cannot load property map '%s' from file '%s': the file has been changed or removed since the graph was loaded" %
+                          (name, file_name))
+        p = u._Graph__graph.read_property_from_file(_c_str(file_name), t,
+                                                    _c_str(name))
+        if t == "v":
+            return VertexPropertyMap(p, u)
+        return EdgePropertyMap(p, u)
+    return load
+
 def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
-               ignore_gp=None):
+               ignore_gp=None, lazy=False):
     """Load a graph from ``file_name`` (which can be either a string or a file-like object).
 
     The format is guessed from ``file_name``, or can be specified by ``fmt``,
@@ -3295,6 +3582,11 @@ def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
     ``ignore_gp``, should contain a list of property names (vertex, edge or
     graph, respectively) which should be ignored when reading the file.
 
+    If ``lazy == True``, the vertex and edge property maps of uncompressed
+    "gt" files of version 2 are only read when first accessed (see
+    :meth:`~graph_tool.Graph.load`). For other files, a
+    :class:`RuntimeWarning` is issued.
+
     .. warning::
 
        The only file formats which are capable of perfectly preserving the
@@ -3303,7 +3595,7 @@ def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
 
     """
     g = Graph()
-    g.load(file_name, fmt, ignore_vp, ignore_ep, ignore_gp)
+    g.load(file_name, fmt, ignore_vp, ignore_ep, ignore_gp, lazy)
     return g
 
 def load_graph_from_csv(file_name, directed=False, eprop_types=None,
@@ -3410,6 +3702,121 @@ def load_graph_from_csv(file_name, directed=False, eprop_types=None,
     return g
 
 
+class GraphWriter(object):
+    """Incremental writer of graphs in the "gt" format, which does not require
+    the graph to be held in memory.
+
+    Parameters
+    ----------
+    file_name : ``str``
+        Name of the file to be written. Temporary files with the same name
+        followed by the suffix ``.tmp.XXXXXX``, where ``XXXXXX`` are random
+        characters, are used while the graph is being written, and removed
+        when it is closed.
+    directed : ``bool`` (optional, default: ``True``)
+        Whether or not the graph is directed.
+
+    Notes
+    -----
+    Edges and property values are appended in batches via
+    :meth:`add_edge_list` and :meth:`add_values`, and the file is only
+    assembled when :meth:`close` is called. The number of vertices is the
+    largest between the number added via :meth:`add_vertices` and the largest
+    index seen in the edge list plus one. The edges are indexed in the order
+    they are added, and property values are appended in the order of the
+    indexes. Missing values at the end of a property map are filled with
+    defaults.
+
+    The resulting file uses version 2 of the format (see :ref:`sec_gt_format`),
+    and can be read with :func:`~graph_tool.load_graph`.
+
+    Examples
+    --------
+
+    >>> import tempfile, os.path
+    >>> with tempfile.TemporaryDirectory() as d:
+    ...     fname = os.path.join(d, "big.gt")
+    ...     with gt.GraphWriter(fname) as w:
+    ...         for i in range(10):
+    ...             edges = np.random.randint(0, 1000, (1000, 2))
+    ...             w.add_edge_list(edges)
+    ...             w.add_values("e", "weight", "double", np.random.random(1000))
+    ...     g = gt.load_graph(fname)
+    >>> print(g.num_edges())
+    10000
+
+    """
+
+    def __init__(self, file_name, directed=True):
+        self.__writer = libcore.GraphStreamWriter(file_name, directed)
+        self.__closed = False
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        if not self.__closed:
+            if exc_type is None:
+                self.close()
+            else:
+                # the temporary files are removed when the writer is destroyed
+                self.__closed = True
+                self.__writer = None
+
+    def num_vertices(self):
+        """Number of vertices written so far."""
+        return self.__writer.get_num_vertices()
+
+    def num_edges(self):
+        """Number of edges written so far."""
+        return self.__writer.get_num_edges()
+
+    def add_vertices(self, n):
+        """Add ``n`` vertices to the graph."""
+        self.__writer.add_vertices(int(n))
+
+    def add_edge_list(self, edge_list):
+        """Append the edges in ``edge_list``, which should be a
+        :class:`~numpy.ndarray` (or an iterable convertible to one) of shape
+        ``(E, 2)`` containing the source and target indexes of the edges.
+        Columns beyond the second are ignored."""
+        edge_list = numpy.asarray(edge_list, dtype="int64")
+        if edge_list.size == 0:
+            return
+        if edge_list.ndim != 2:
+            raise ValueError("edge list must be a two-dimensional array")
+        self.__writer.add_edge_list(edge_list)
+
+    def add_values(self, key_type, name, value_type, values):
+        """Append ``values`` to the property map with the given ``name``,
+        which is created if it does not yet exist. Parameter ``key_type``
+        must be either ``"v"``, ``"e"`` or ``"g"`` (for vertex, edge or graph
+        property maps, respectively), and ``value_type`` must be one of the
+        types listed in :func:`~graph_tool.value_types` (or an alias). Graph
+        property maps may receive only a single value."""
+        if key_type not in ["v", "e", "g"]:
+            raise ValueError("invalid key type: " + str(key_type))
+        value_type = _type_alias(value_type)
+        if key_type == "g":
+            values = [values]
+        dtype = {"bool": "uint8", "int16_t": "int16", "int32_t": "int32",
+                 "int64_t": "int64", "double": "float64",
+                 "long double": numpy.longdouble}.get(value_type)
+        if dtype is not None:
+            values = numpy.ascontiguousarray(values, dtype=dtype)
+        else:
+            convert = _converter(value_type)
+            values = [convert(x) for x in values]
+        self.__writer.add_values(key_type, name, value_type, values)
+
+    def close(self):
+        """Assemble the final file, and remove the temporary ones."""
+        if self.__closed:
+            return
+        self.__closed = True
+        self.__writer.close()
+
+
 class GraphView(Graph):
     """A view of selected vertices or edges of another graph.
 
@@ -3821,5 +4228,135 @@ def openmp_set_schedule(schedule, chunk=0):
     any of: ``"static"``, ``"dynamic"``, ``"guided"``, ``"auto"``."""
     return libcore.openmp_set_schedule(schedule, chunk)
 
+def openmp_get_min_work():
+    """Return the minimum amount of work, in elementary operations, for which a
+    parallel region is spawned. See :func:`~graph_tool.openmp_set_min_work`."""
+    return libcore.openmp_get_min_work()
+
+def openmp_set_min_work(work):
+    """Set the minimum amount of work, in elementary operations, for which a
+    parallel region is spawned. The work of an algorithm is estimated as the
+    number of vertices and edges of the graph multiplied by a per-algorithm cost
+    (see :func:`~graph_tool.openmp_get_kernel_costs`). Smaller problems are
+    computed serially, to avoid the overhead of starting the threads."""
+    return libcore.openmp_set_min_work(work)
+
+def openmp_get_kernel_costs():
+    """Return a dictionary with the estimated costs of the algorithms, in
+    elementary operations per vertex and edge, used to decide whether they
+    should run in parallel. Only the algorithms of modules which have already
+    been imported are listed."""
+    return libcore.openmp_get_kernel_costs()
+
+def openmp_set_kernel_cost(kernel, cost):
+    """Set the estimated cost of the algorithm ``kernel``, in elementary
+    operations per vertex and edge. See
+    :func:`~graph_tool.openmp_get_kernel_costs`.
+
+    Examples
+    --------
+
+    .. testsetup:: kernel_cost
+
+       cost = gt.openmp_get_kernel_costs()["clustering"]
+
+    .. doctest:: kernel_cost
+
+       >>> gt.openmp_set_kernel_cost("clustering", 20)
+       >>> gt.openmp_get_kernel_costs()["clustering"]
+       20.0
+
+    .. testcleanup:: kernel_cost
+
+       gt.openmp_set_kernel_cost("clustering", cost)
+    """
+    return libcore.openmp_set_kernel_cost(kernel, cost)
+
+def openmp_calibrate(repeats=1000):
+    """Measure the overhead of starting and joining a parallel region with the
+    current number of threads, and set the minimum amount of work for parallel
+    regions accordingly (see :func:`~graph_tool.openmp_set_min_work`).
+
+    The measurement is averaged over ``repeats`` parallel regions. The function
+    returns a tuple with the overhead, the time of an elementary operation
+    (both in nanoseconds) and the new minimum amount of work.
+
+    Examples
+    --------
+
+    .. testsetup:: calibrate
+
+       min_work = gt.openmp_get_min_work()
+
+    The minimum amount of work is at least the number of elementary operations
+    which take as long as the overhead:
+
+    .. doctest:: calibrate
+
+       >>> overhead, op_time, work = gt.openmp_calibrate()
+       >>> print(overhead > 0, op_time > 0)
+       True True
+       >>> print(work == gt.openmp_get_min_work(), work >= overhead / op_time)
+       True True
+
+    .. testcleanup:: calibrate
+
+       gt.openmp_set_min_work(min_work)
+    """
+    return libcore.openmp_calibrate(repeats)
+
+def openmp_get_loop_balance():
+    """Return how the parallel loops over vertices and edges are balanced
+    between threads. See :func:`~graph_tool.openmp_set_loop_balance`."""
+    return libcore.openmp_get_loop_balance()
+
+def openmp_set_loop_balance(balance):
+    """Set how the parallel loops over vertices and edges are balanced between
+    threads. The balance can be any of:
+
+    ``"vertex"`` (default)
+        The vertices are distributed according to the runtime schedule (see
+        :func:`~graph_tool.openmp_set_schedule`).
+    ``"degree"``
+        The vertices are grouped in contiguous ranges with approximately the
+        same number of out-edges, which are handed out dynamically to idle
+        threads. This is preferable for graphs with very skewed degree
+        distributions.
+    ``"split"``
+        Like ``"degree"``, but loops over edges additionally split the
+        out-edges of high-degree vertices between several threads.
+
+    Examples
+    --------
+
+    .. testsetup:: loop_balance
+
+       nthreads = gt.openmp_get_num_threads()
+       min_work = gt.openmp_get_min_work()
+
+    The balanced loops give the same results as the default ones. Here the
+    loops are made parallel even for a small graph, with several threads:
+
+    .. doctest:: loop_balance
+
+       >>> gt.openmp_set_num_threads(4)
+       >>> gt.openmp_set_min_work(0)
+       >>> g = gt.price_network(3000)
+       >>> c = gt.local_clustering(g)
+       >>> gt.openmp_set_loop_balance("split")
+       >>> gt.openmp_get_loop_balance()
+       'split'
+       >>> c_split = gt.local_clustering(g)
+       >>> print(np.array_equal(c.a, c_split.a))
+       True
+
+    .. testcleanup:: loop_balance
+
+       gt.openmp_set_loop_balance("vertex")
+       gt.openmp_set_num_threads(nthreads)
+       gt.openmp_set_min_work(min_work)
+    """
+    return libcore.openmp_set_loop_balance(balance)
+
 if openmp_enabled() and os.environ.get("OMP_SCHEDULE") is None:
     openmp_set_schedule("static", 0)
@@ -31,6 +31,7 @@ Summary
    :nosignatures:
 
    pagerank
+   personalized_pagerank
    betweenness
    central_point_dominance
    closeness
@@ -49,18 +50,20 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_centrality")
 
-from .. import _prop, ungroup_vector_property, Vector_size_t
+from .. import _prop, ungroup_vector_property, Vector_size_t, _get_rng
 from .. topology import shortest_distance
 import sys
 import numpy
 import numpy.linalg
+import scipy.sparse
 
-__all__ = ["pagerank", "betweenness", "central_point_dominance", "closeness",
-           "eigentrust", "eigenvector", "katz", "hits", "trust_transitivity"]
+__all__ = ["pagerank", "personalized_pagerank", "betweenness",
+           "central_point_dominance", "closeness", "eigentrust", "eigenvector",
+           "katz", "hits", "trust_transitivity"]
 
 
 def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
-             max_iter=None, ret_iter=False):
+             max_iter=None, ret_iter=False, added=None, removed=None):
     r"""Calculate the PageRank of each vertex.
 
     Parameters
@@ -84,6 +87,15 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
         If supplied, this will limit the total number of iterations.
     ret_iter : bool, optional (default: False)
         If true, the total number of iterations is also returned.
+    added : :class:`~numpy.ndarray` or iterable, optional (default: None)
+        Edges which have been inserted in the graph since ``prop`` was
+        computed, given as rows of source, target and, if ``weight`` is given,
+        the edge weight. If this or ``removed`` is supplied, ``prop`` must
+        contain the PageRank values of the graph before the modification,
+        which are then updated incrementally.
+    removed : :class:`~numpy.ndarray` or iterable, optional (default: None)
+        Edges which have been removed from the graph since ``prop`` was
+        computed, in the same format as ``added``.
 
     Returns
     -------
@@ -136,6 +148,13 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
     it no longer changes, according to the parameter epsilon. It has a
     topology-dependent running time.
 
+    If ``added`` or ``removed`` are given, the previous values in ``prop`` are
+    instead updated by pushing the residuals caused by the modified edges to
+    the neighbors, only from the vertices where they exceed
+    :math:`\epsilon/N`, until none remain. In this case ``max_iter`` and the
+    returned number of iterations refer to these push rounds, and the running
+    time depends only on the part of the graph affected by the modification.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -201,6 +220,23 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
        [adamic-polblogs]_, where vertices with very low degree are given
        artificially high scores.
 
+    After the graph is modified, the values can be updated incrementally,
+    giving the same result as a full recomputation:
+
+    .. doctest:: pagerank
+
+       >>> u = gt.price_network(1000)
+       >>> pr = gt.pagerank(u, epsilon=1e-10)
+       >>> removed = u.get_edges()[:20]
+       >>> for s, t in removed:
+       ...     u.remove_edge(u.edge(s, t))
+       >>> added = np.random.randint(0, 1000, (20, 2))
+       >>> u.add_edge_list(added)
+       >>> pr = gt.pagerank(u, prop=pr, added=added, removed=removed,
+       ...                  epsilon=1e-10)
+       >>> np.allclose(pr.a, gt.pagerank(u, epsilon=1e-10).a, atol=1e-8)
+       True
+
     References
     ----------
     .. [pagerank-wikipedia] http://en.wikipedia.org/wiki/Pagerank
@@ -217,6 +253,27 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
 
     if max_iter is None:
         max_iter = 0
+    if added is not None or removed is not None:
+        if prop is None:
+            raise ValueError("the previous PageRank values must be supplied " +
+                             "via 'prop' when 'added' or 'removed' are given")
+        ncols = 3 if weight is not None else 2
+        def get_edges(edges):
+            if edges is None:
+                return numpy.zeros((0, ncols), dtype="float")
+            edges = numpy.asarray(edges, dtype="float")
+            if edges.ndim < 2:
+                edges = edges.reshape((-1, ncols))
+            return edges
+        ic = libgraph_tool_centrality.\
+            get_pagerank_update(g._Graph__graph, _prop("v", g, prop),
+                                _prop("v", g, pers), _prop("e", g, weight),
+                                damping, epsilon, max_iter, get_edges(added),
+                                get_edges(removed))
+        if ret_iter:
+            return prop, ic
+        else:
+            return prop
     if prop is None:
         prop = g.new_vertex_property("double")
         N = len(prop.fa)
@@ -231,7 +288,139 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
         return prop
 
 
-def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
+def personalized_pagerank(g, pers, damping=0.85, weight=None, epsilon=1e-6,
+                          max_iter=None, local=False, block=32,
+                          ret_iter=False):
+    r"""Calculate the PageRank of each vertex, for many personalization vectors
+    at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    pers : :class:`~numpy.ndarray` or :mod:`scipy.sparse` matrix
+        Matrix of shape ``(K, N)``, where each row is a personalization vector,
+        and ``N`` is the number of vertices. Each row is normalized to sum to
+        one.
+    damping : float, optional (default: 0.85)
+        Damping factor.
+    weight : :class:`~graph_tool.EdgePropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: 1e-6)
+        Convergence condition. If ``local == False``, the iteration of each
+        vector will stop if the total delta of all vertices are below this
+        value. Otherwise, the residual of every vertex will be below
+        ``epsilon`` times its (weighted) out-degree.
+    max_iter : int, optional (default: None)
+        If supplied, this will limit the total number of iterations of each
+        vector. It is ignored if ``local == True``.
+    local : bool, optional (default: False)
+        If ``True``, the values are approximated by pushing the residuals from
+        the personalized vertices to their neighbors, which only touches the
+        neighborhood of these vertices, and the result is returned as a sparse
+        matrix.
+    block : int, optional (default: 32)
+        Number of vectors which are iterated together, with a single pass over
+        the edges. It is ignored if ``local == True``.
+    ret_iter : bool, optional (default: False)
+        If true, the number of iterations (or pushes, if ``local == True``) of
+        each vector is also returned.
+
+    Returns
+    -------
+    pagerank : :class:`~numpy.ndarray` or :class:`scipy.sparse.csr_matrix`
+        Matrix of shape ``(K, N)`` with the PageRank values of each vertex for
+        each personalization vector.
+
+    See Also
+    --------
+    pagerank: PageRank centrality
+
+    Notes
+    -----
+    The values are the same as given by :func:`~graph_tool.centrality.pagerank`
+    with the ``pers`` parameter set to each of the rows of the matrix.
+
+    If ``local == False``, the vectors are iterated in blocks of size
+    ``block``, so that the edges are traversed once for all vectors in the
+    block. A vector is removed from the block as soon as it converges, and its
+    place is taken by the next one. This requires :math:`O(NB)` memory, in
+    addition to the returned matrix, where :math:`B` is the block size.
+
+    If ``local == True``, the approximate algorithm of [andersen-local-2006]_
+    is used for each vector, and the running time is independent of the size
+    of the graph, depending only on the number of vertices with a
+    non-negligible value.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+
+    The values of each vector sum to one, and the seed vertices receive at
+    least the teleportation probability ``1 - damping``:
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> seeds = np.zeros((3, g.num_vertices()))
+    >>> seeds[[0, 1, 2], [0, 10, 20]] = 1
+    >>> pr = gt.personalized_pagerank(g, seeds)
+    >>> print(np.allclose(pr.sum(axis=1), 1))
+    True
+    >>> print((pr[[0, 1, 2], [0, 10, 20]] >= 1 - 0.85).all())
+    True
+    >>> pers = g.new_vp("double")
+    >>> pers[g.vertex(10)] = 1
+    >>> print(np.allclose(pr[1], gt.pagerank(g, pers=pers).a, atol=1e-5))
+    True
+
+    References
+    ----------
+    .. [andersen-local-2006] R. Andersen, F. Chung, K. Lang, "Local graph
+       partitioning using PageRank vectors", 47th Annual IEEE Symposium on
+       Foundations of Computer Science, pp. 475-486, 2006,
+       :DOI:`10.1109/FOCS.2006.44`
+    """
+
+    N = g.num_vertices(ignore_filter=True)
+    if scipy.sparse.issparse(pers):
+        pers = pers.tocoo()
+        K = pers.shape[0]
+        entries = numpy.array([pers.row, pers.col, pers.data], dtype="float").T
+    else:
+        pers = numpy.asarray(pers, dtype="float")
+        if pers.ndim == 1:
+            pers = pers.reshape((1, -1))
+        K = pers.shape[0]
+        idx = pers.nonzero()
+        entries = numpy.array([idx[0], idx[1], pers[idx]], dtype="float").T
+    entries = entries.reshape((-1, 3))
+    if pers.shape[1] != N:
+        raise ValueError("personalization matrix must have %d columns" % N)
+
+    iters = numpy.zeros(K, dtype="int64")
+    if local:
+        rank = libgraph_tool_centrality.\
+            get_pagerank_push(g._Graph__graph, _prop("e", g, weight), damping,
+                              epsilon, entries, iters)
+        rank = rank.reshape((-1, 3))
+        rank = scipy.sparse.csr_matrix((rank[:, 2], (rank[:, 0].astype("int64"),
+                                                     rank[:, 1].astype("int64"))),
+                                       shape=(K, N))
+    else:
+        if max_iter is None:
+            max_iter = 0
+        rank = numpy.zeros((K, N))
+        libgraph_tool_centrality.\
+            get_pagerank_multi(g._Graph__graph, _prop("e", g, weight), damping,
+                               epsilon, max_iter, block, entries, rank, iters)
+    if ret_iter:
+        return rank, iters
+    else:
+        return rank
+
+
+def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True,
+                epsilon=None, delta=0.1):
     r"""Calculate the betweenness centrality for each vertex and edge.
 
     Parameters
@@ -251,6 +440,13 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
         Edge property map corresponding to the weight value of each edge.
     norm : bool, optional (default: True)
         Whether or not the betweenness values should be normalized.
+    epsilon : float, optional (default: None)
+        If provided, the pivots (all vertices, if ``pivots`` is not given) are
+        sampled in random order, until the normalized betweenness of every
+        vertex is estimated within an absolute error ``epsilon``, with
+        probability at least ``1 - delta``.
+    delta : float, optional (default: 0.1)
+        Probability that the error bound given by ``epsilon`` is violated.
 
     Returns
     -------
@@ -289,7 +485,15 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
     :math:`O(PE)` for unweighted graphs and :math:`O(PE + P(V+E)\log V)` for
     weighted graphs, where :math:`P` is the number of pivot vertices.
 
-    If enabled during compilation, this algorithm runs in parallel.
+    If ``epsilon`` is given, the pivots are processed in batches of doubling
+    size, and the computation stops as soon as the empirical Bernstein bound on
+    the sampled dependencies guarantees the requested accuracy for all vertices
+    simultaneously (see also [brandes-centrality-2007]_).
+
+    If enabled during compilation, this algorithm runs in parallel, with the
+    sources distributed between the threads. Each thread accumulates the
+    betweenness values in its own buffers, which requires :math:`O(T(V+E))`
+    memory for :math:`T` threads.
 
     Examples
     --------
@@ -325,6 +529,21 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
 
        Betweenness values of the a political blogs network of [adamic-polblogs]_.
 
+    The betweenness can also be estimated from a subset of the vertices as
+    pivots, or from as many as needed to achieve a given accuracy:
+
+    .. doctest:: betweenness
+
+       >>> g = gt.price_network(3000, directed=False)
+       >>> vb, eb = gt.betweenness(g)
+       >>> pivots = np.random.permutation(g.num_vertices())[:1000]
+       >>> vp, ep = gt.betweenness(g, pivots=pivots)
+       >>> print(abs(vp.a - vb.a).max() < 0.1)
+       True
+       >>> vp, ep = gt.betweenness(g, epsilon=0.05)
+       >>> print(abs(vp.a - vb.a).max() < 0.05)
+       True
+
     References
     ----------
     .. [betweenness-wikipedia] http://en.wikipedia.org/wiki/Centrality#Betweenness_centrality
@@ -354,10 +573,13 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
     vpivots.a = pivots
     libgraph_tool_centrality.\
             get_betweenness(g._Graph__graph, vpivots, _prop("e", g, weight),
-                            _prop("e", g, eprop), _prop("v", g, vprop), norm)
+                            _prop("e", g, eprop), _prop("v", g, vprop), norm,
+                            epsilon if epsilon is not None else 0, delta,
+                            _get_rng())
     return vprop, eprop
 
-def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False):
+def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False,
+              index=None, samples=None, pivots=None, epsilon=None, delta=.1):
     r"""
     Calculate the closeness centrality for each vertex.
 
@@ -376,11 +598,33 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     harmonic : bool, optional (default: ``False``)
         If true, the sum of the inverse of the distances will be computed,
         instead of the inverse of the sum.
+    index : :class:`~graph_tool.topology.PrunedLandmarkLabeling`, optional (default: ``None``)
+        If specified, the unweighted distances are obtained from this index,
+        which must have been built for the same graph.
+    samples : int, optional (default: ``None``)
+        If specified together with ``index``, the closeness of each vertex is
+        estimated from the distances to this number of randomly chosen
+        vertices, instead of all of them.
+    pivots : int, optional (default: ``None``)
+        If specified, the closeness of every vertex is estimated from its
+        distances to this number of randomly chosen pivot vertices, together
+        with an error bound.
+    epsilon : float, optional (default: ``None``)
+        If specified, and ``pivots`` is not, the number of pivots is chosen as
+        :math:`\lceil\ln(2/\delta)/2\epsilon^2\rceil`, so that the error of the
+        normalized harmonic centrality is at most approximately ``epsilon``.
+    delta : float, optional (default: ``.1``)
+        Probability with which the error bounds of the estimate, if ``pivots``
+        or ``epsilon`` are given, are allowed to fail.
 
     Returns
     -------
     vertex_closeness : :class:`~graph_tool.VertexPropertyMap`
         A vertex property map with the vertex closeness values.
+    vertex_error : :class:`~graph_tool.VertexPropertyMap`
+        A vertex property map with the error bounds of the estimates, each of
+        which holds with probability at least ``1 - delta``. Only returned if
+        ``pivots`` or ``epsilon`` are given.
 
     See Also
     --------
@@ -422,6 +666,25 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     specified, this drops to :math:`O(V + E)` and :math:`O((V+E)\log V)`
     respectively.
 
+    If ``index`` is specified, each distance is obtained from the labels of the
+    two vertices, instead of a search. The complexity is then :math:`O(V^2L)`,
+    or :math:`O(V\,\text{samples}\,L)` if ``samples`` is given, where
+    :math:`L` is the typical label size, which is usually much smaller than
+    :math:`V`. With ``samples``, the sums of the distances and the component
+    sizes are extrapolated from the sampled vertices, so that the normalized
+    values remain comparable.
+
+    If ``pivots`` or ``epsilon`` are specified, one search is done from each
+    pivot vertex in the reversed graph, and the sums of the distances and the
+    component sizes are extrapolated from the pivots reached
+    [eppstein-fast-2004]_, with a complexity of :math:`O(k(V + E))` for
+    :math:`k` pivots. The error bounds follow from Hoeffding's inequality: for
+    the harmonic centrality, whose terms lie in :math:`[0, 1]`, the bound is
+    the same for every vertex, and proportional to :math:`\sqrt{\ln(2/\delta)/k}`.
+    For the closeness centrality, it depends on an upper bound of the largest
+    distance from each vertex, which is obtained from the first pivots in its
+    strongly connected component, and is infinite if there are none.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -456,6 +719,21 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
 
        Closeness values of the a political blogs network of [adamic-polblogs]_.
 
+    The values estimated from a sample of pivots lie within the returned error
+    bounds of the exact ones:
+
+    .. doctest:: closeness
+
+       >>> g = gt.price_network(300, directed=False)
+       >>> c = gt.closeness(g, harmonic=True)
+       >>> c_est, err = gt.closeness(g, harmonic=True, pivots=100)
+       >>> print(np.all(abs(c_est.a - c.a) <= err.a))
+       True
+       >>> c = gt.closeness(g)
+       >>> c_est, err = gt.closeness(g, epsilon=.1)
+       >>> print(np.all(abs(c_est.a - c.a) <= err.a))
+       True
+
     References
     ----------
     .. [closeness-wikipedia] https://en.wikipedia.org/wiki/Closeness_centrality
@@ -465,15 +743,55 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
+    .. [eppstein-fast-2004] D. Eppstein, J. Wang, "Fast approximation of
+       centrality", Journal of Graph Algorithms and Applications 8 (1),
+       39-45, 2004, :DOI:`10.7155/jgaa.00081`
 
     """
-    if source is None:
+    if pivots is not None or epsilon is not None:
+        if source is not None or index is not None:
+            raise ValueError("pivots cannot be combined with source or index")
+        if pivots is None:
+            pivots = int(numpy.ceil(numpy.log(2 / delta) / (2 * epsilon ** 2)))
         if vprop is None:
             vprop = g.new_vertex_property("double")
+        elif vprop.value_type() != "double":
+            raise ValueError("vprop must be of type 'double'")
+        err = g.new_vertex_property("double")
         libgraph_tool_centrality.\
-            closeness(g._Graph__graph, _prop("e", g, weight),
-                      _prop("v", g, vprop), harmonic, norm)
+            closeness_pivots(g._Graph__graph, _prop("e", g, weight),
+                             _prop("v", g, vprop), _prop("v", g, err),
+                             harmonic, norm, pivots, delta, _get_rng())
+        return vprop, err
+    if index is not None and weight is not None:
+        raise ValueError("a distance index can only be used for unweighted distances")
+    if source is None:
+        if vprop is None:
+            vprop = g.new_vertex_property("double")
+        if index is not None:
+            libgraph_tool_centrality.\
+                labeling_closeness(g._Graph__graph, index._pll,
+                                   _prop("v", g, vprop), harmonic, norm,
+                                   samples if samples is not None else 0,
+                                   _get_rng())
+        else:
+            libgraph_tool_centrality.\
+                closeness(g._Graph__graph, _prop("e", g, weight),
+                          _prop("v", g, vprop), harmonic, norm)
         return vprop
+    elif index is not None:
+        vs = g.get_vertices()
+        dist = index.distances(numpy.full(len(vs), int(source)), vs)
+        dists = dist[numpy.isfinite(dist) * (dist > 0)]
+        if harmonic:
+            c = (1. / dists).sum()
+            if norm:
+                c /= g.num_vertices() - 1
+        else:
+            c = 1. / dists.sum()
+            if norm:
+                c *= len(dists)
+        return c
     else:
         max_dist = g.num_vertices() + 1
         dist = shortest_distance(g, source=source, weights=weight,
@@ -102,6 +102,33 @@ __all__ = ["bfs_search", "bfs_iterator", "BFSVisitor", "dfs_search",
            "astar_search", "astar_iterator", "AStarVisitor", "StopSearch"]
 
 
+def _visitor_calls(visitor, base):
+    """Return the names of the event methods of ``visitor`` which do not
+    correspond to the (empty) methods of ``base``, and hence need to be
+    called."""
+    calls = []
+    for name, f in base.__dict__.items():
+        if name.startswith("_") or not callable(f):
+            continue
+        if name in getattr(visitor, "__dict__", {}):
+            calls.append(name)
+            continue
+        for c in type(visitor).__mro__:
+            if name in c.__dict__:
+                if c.__dict__[name] is not f:
+                    calls.append(name)
+                break
+        else:
+            calls.append(name)
+    return calls
+
+def _search_events(events):
+    """Reshape the recorded edge events as two-dimensional arrays."""
+    for name, a in list(events.items()):
+        if name != "dist" and not name.endswith("_vertex"):
+            events[name] = a.reshape((-1, 2))
+    return events
+
 class BFSVisitor(object):
     r"""A visitor object that is invoked at the event-points inside the
     :func:`~graph_tool.search.bfs_search` algorithm. By default, it performs no
@@ -157,7 +184,7 @@ class BFSVisitor(object):
         return
 
 
-def bfs_search(g, source=None, visitor=BFSVisitor()):
+def bfs_search(g, source=None, visitor=BFSVisitor(), record=None):
     r"""Breadth-first traversal of a directed or undirected graph.
 
     Parameters
@@ -172,6 +199,23 @@ def bfs_search(g, source=None, visitor=BFSVisitor()):
         A visitor object that is invoked at the event points inside the
         algorithm. This should be a subclass of
         :class:`~graph_tool.search.BFSVisitor`.
+    record : list of strings (optional, default: ``None``)
+        Names of the events to be recorded, which can be any of the methods of
+        :class:`~graph_tool.search.BFSVisitor`, or
+        ``"dist"`` for the distances from the source. The corresponding vertices or
+        edges are stored directly into arrays, in the order in which they
+        occur, without calling the visitor.
+
+    Returns
+    -------
+    events : dict
+        If ``record`` is given, a dictionary with an array for every event
+        recorded, containing the vertices (for the ``*_vertex`` events) or the
+        ``(source, target)`` pairs of the edges (for the others) in the order in
+        which they occurred, or, for ``"dist"``, the distances of every vertex from
+        the root of its search tree (or the largest ``int32`` value, if it was
+        not reached). This is also returned if the search is stopped by
+        :class:`~graph_tool.search.StopSearch`.
 
     See Also
     --------
@@ -189,6 +233,10 @@ def bfs_search(g, source=None, visitor=BFSVisitor()):
 
     The time complexity is :math:`O(V + E)`.
 
+    Only the methods overridden by the visitor are called, and the events given
+    by ``record`` are collected without any Python function calls, which is
+    much faster than doing the same with a visitor.
+
     The pseudo-code for the BFS algorithm is listed below, with the annotated
     event points, for which the given visitor object will be called with the
     appropriate method.
@@ -276,6 +324,14 @@ def bfs_search(g, source=None, visitor=BFSVisitor()):
     >>> print(pred.a)
     [0 3 6 0 0 1 0 0 1 6]
 
+    The same distances can be obtained without a visitor, by recording them:
+
+    >>> events = gt.bfs_search(g, g.vertex(0), record=["dist", "tree_edge"])
+    >>> print(events["dist"])
+    [0 2 2 1 1 3 1 1 3 2]
+    >>> print(events["tree_edge"].shape)
+    (9, 2)
+
 
     References
     ----------
@@ -285,16 +341,21 @@ def bfs_search(g, source=None, visitor=BFSVisitor()):
     .. [bfs-wikipedia] http://en.wikipedia.org/wiki/Breadth-first_search
     """
 
+    events = {}
     try:
         if source is None:
             source = _get_null_vertex()
         else:
             source = int(source)
-        libgraph_tool_search.bfs_search(g._Graph__graph,
-                                        source, visitor)
+        libgraph_tool_search.bfs_search(g._Graph__graph, source, visitor,
+                                        _visitor_calls(visitor, BFSVisitor),
+                                        record, events)
     except StopSearch:
         pass
 
+    if record is not None:
+        return _search_events(events)
+
 def bfs_iterator(g, source=None, array=False):
     r"""Return an iterator of the edges corresponding to a breath-first traversal of
     the graph.
@@ -436,7 +497,7 @@ class DFSVisitor(object):
         return
 
 
-def dfs_search(g, source=None, visitor=DFSVisitor()):
+def dfs_search(g, source=None, visitor=DFSVisitor(), record=None):
     r"""Depth-first traversal of a directed or undirected graph.
 
     Parameters
@@ -451,6 +512,20 @@ def dfs_search(g, source=None, visitor=DFSVisitor()):
         A visitor object that is invoked at the event points inside the
         algorithm. This should be a subclass of
         :class:`~graph_tool.search.DFSVisitor`.
+    record : list of strings (optional, default: ``None``)
+        Names of the events to be recorded, which can be any of the methods of
+        :class:`~graph_tool.search.DFSVisitor`. The corresponding vertices or
+        edges are stored directly into arrays, in the order in which they
+        occur, without calling the visitor.
+
+    Returns
+    -------
+    events : dict
+        If ``record`` is given, a dictionary with an array for every event
+        recorded, containing the vertices (for the ``*_vertex`` events) or the
+        ``(source, target)`` pairs of the edges (for the others) in the order in
+        which they occurred. This is also returned if the search is stopped by
+        :class:`~graph_tool.search.StopSearch`.
 
     See Also
     --------
@@ -582,6 +657,12 @@ def dfs_search(g, source=None, visitor=DFSVisitor()):
     >>> print(pred.a)
     [0 3 9 9 7 8 0 6 1 4]
 
+    The discover order can also be recorded without a visitor:
+
+    >>> events = gt.dfs_search(g, g.vertex(0), record=["discover_vertex"])
+    >>> print(events["discover_vertex"])
+    [0 6 7 4 9 2 3 1 8 5]
+
     References
     ----------
     .. [dfs-bgl] http://www.boost.org/doc/libs/release/libs/graph/doc/depth_first_search.html
@@ -589,16 +670,21 @@ def dfs_search(g, source=None, visitor=DFSVisitor()):
 
     """
 
+    events = {}
     try:
         if source is None:
             source = _get_null_vertex()
         else:
             source = int(source)
-        libgraph_tool_search.dfs_search(g._Graph__graph,
-                                        source, visitor)
+        libgraph_tool_search.dfs_search(g._Graph__graph, source, visitor,
+                                        _visitor_calls(visitor, DFSVisitor),
+                                        record, events)
     except StopSearch:
         pass
 
+    if record is not None:
+        return _search_events(events)
+
 def dfs_iterator(g, source=None, array=False):
     r"""Return an iterator of the edges corresponding to a depth-first traversal of
     the graph.
@@ -733,7 +819,8 @@ class DijkstraVisitor(object):
 
 def dijkstra_search(g, weight, source=None, visitor=DijkstraVisitor(), dist_map=None,
                     pred_map=None, combine=lambda a, b: a + b,
-                    compare=lambda a, b: a < b, zero=0, infinity=numpy.inf):
+                    compare=lambda a, b: a < b, zero=0, infinity=numpy.inf,
+                    record=None):
     r"""Dijkstra traversal of a directed or undirected graph, with non-negative weights.
 
     Parameters
@@ -768,6 +855,11 @@ def dijkstra_search(g, weight, source=None, visitor=DijkstraVisitor(), dist_map=
     infinity : int or float (optional, default: ``numpy.inf``)
          Value assumed to correspond to a distance of infinity by the combine and
          compare functions.
+    record : list of strings (optional, default: ``None``)
+        Names of the events to be recorded, which can be any of the methods of
+        :class:`~graph_tool.search.DijkstraVisitor`. The corresponding vertices or
+        edges are stored directly into arrays, in the order in which they
+        occur, without calling the visitor.
 
     Returns
     -------
@@ -775,6 +867,12 @@ def dijkstra_search(g, weight, source=None, visitor=DijkstraVisitor(), dist_map=
         A vertex property map with the computed distances from the source.
     pred_map : :class:`~graph_tool.VertexPropertyMap`
         A vertex property map with the predecessor tree.
+    events : dict
+        If ``record`` is given, a dictionary with an array for every event
+        recorded, containing the vertices (for the ``*_vertex`` events) or the
+        ``(source, target)`` pairs of the edges (for the others) in the order in
+        which they occurred. This is also returned if the search is stopped by
+        :class:`~graph_tool.search.StopSearch`.
 
     See Also
     --------
@@ -924,6 +1022,13 @@ def dijkstra_search(g, weight, source=None, visitor=DijkstraVisitor(), dist_map=
     [ 0.          8.91915887  9.27141329  4.29277116  4.02118246 12.23513866
       3.23790211  3.45487436 11.04391549  7.74858396]
 
+    The discover order can also be recorded without a visitor:
+
+    >>> dist, pred, events = gt.dijkstra_search(g, weight, g.vertex(0),
+    ...                                         record=["discover_vertex"])
+    >>> print(events["discover_vertex"])
+    [0 6 4 3 7 9 2 1 8 5]
+
     References
     ----------
     .. [dijkstra] E. Dijkstra, "A note on two problems in connexion with
@@ -956,6 +1061,7 @@ def dijkstra_search(g, weight, source=None, visitor=DijkstraVisitor(), dist_map=
         infinity = (weight.a.max() + 1) * g.num_vertices()
         infinity = _python_type(dist_map.value_type())(infinity)
 
+    events = {}
     try:
         if source is None:
             source = _get_null_vertex()
@@ -966,10 +1072,15 @@ def dijkstra_search(g, weight, source=None, visitor=DijkstraVisitor(), dist_map=
                                              _prop("v", g, dist_map),
                                              _prop("v", g, pred_map),
                                              _prop("e", g, weight), visitor,
-                                             compare, combine, zero, infinity)
+                                             compare, combine, zero, infinity,
+                                             _visitor_calls(visitor,
+                                                            DijkstraVisitor),
+                                             record, events)
     except StopSearch:
         pass
 
+    if record is not None:
+        return dist_map, pred_map, _search_events(events)
     return dist_map, pred_map
 
 def dijkstra_iterator(g, weight, source=None, dist_map=None, combine=None,
@@ -369,7 +369,7 @@ def remove_self_loops(g):
 
 
 def distance_histogram(g, weight=None, bins=[0, 1], samples=None,
-                       float_count=True):
+                       float_count=True, index=None):
     r"""
     Return the shortest-distance histogram for each vertex pair in the graph.
 
@@ -392,6 +392,11 @@ def distance_histogram(g, weight=None, bins=[0, 1], samples=None,
     float_count : bool (optional, default: `True`)
         If True, the counts in each histogram bin will be returned as floats. If
         False, they will be returned as integers.
+    index : :class:`~graph_tool.topology.PrunedLandmarkLabeling` (optional, default: `None`)
+        If supplied, the unweighted distances are obtained from this index,
+        which must have been built for the same graph. In this case, `samples`
+        is the number of randomly sampled pairs of distinct vertices, instead
+        of source vertices.
 
     Returns
     -------
@@ -414,6 +419,11 @@ def distance_histogram(g, weight=None, bins=[0, 1], samples=None,
     :math:`O(\text{samples}\times V)`  and
     :math:`O(\text{samples}\times V\log V)`, respectively.
 
+    If `index` is supplied, each distance is obtained from the labels of the
+    two vertices, in time proportional to their size, which is typically much
+    smaller than :math:`V`. This is advantageous when `samples` pairs are
+    enough for the required precision.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -433,7 +443,15 @@ def distance_histogram(g, weight=None, bins=[0, 1], samples=None,
     [array([  0.,  30.,  86., 213., 378., 262.,  21.]), array([0, 1, 2, 3, 4, 5, 6, 7], dtype=uint64)]
     """
 
-    if samples is not None:
+    if index is not None:
+        if weight is not None:
+            raise ValueError("a distance index can only be used for unweighted distances")
+        ret = libgraph_tool_stats.\
+              labeling_distance_histogram(g._Graph__graph, index._pll,
+                                          [float(x) for x in bins],
+                                          samples if samples is not None else 0,
+                                          _get_rng())
+    elif samples is not None:
         ret = libgraph_tool_stats.\
               sampled_distance_histogram(g._Graph__graph,
                                          _prop("e", g, weight),
@@ -30,6 +30,8 @@ Summary
 
    shortest_distance
    shortest_path
+   ContractionHierarchy
+   PrunedLandmarkLabeling
    all_shortest_paths
    all_predecessors
    all_paths
@@ -37,6 +39,7 @@ Summary
    pseudo_diameter
    similarity
    vertex_similarity
+   vertex_similarity_top_k
    isomorphism
    subgraph_isomorphism
    mark_subgraph
@@ -58,6 +61,7 @@ Summary
    vertex_percolation
    edge_percolation
    kcore_decomposition
+   kcore_update
    is_bipartite
    is_DAG
    is_planar
@@ -88,11 +92,13 @@ __all__ = ["isomorphism", "subgraph_isomorphism", "mark_subgraph", "max_cliques"
            "sequential_vertex_coloring", "label_components",
            "label_largest_component", "extract_largest_component",
            "label_biconnected_components", "label_out_component",
-           "vertex_percolation", "edge_percolation", "kcore_decomposition",
-           "shortest_distance", "shortest_path", "all_shortest_paths",
+           "vertex_percolation", "edge_percolation", "kcore_decomposition", "kcore_update",
+           "shortest_distance", "shortest_path", "ContractionHierarchy",
+           "PrunedLandmarkLabeling", "all_shortest_paths",
            "all_predecessors", "all_paths", "all_circuits", "pseudo_diameter",
            "is_bipartite", "is_DAG", "is_planar", "make_maximal_planar",
-           "similarity", "vertex_similarity", "edge_reciprocity"]
+           "similarity", "vertex_similarity", "vertex_similarity_top_k",
+           "edge_reciprocity"]
 
 def similarity(g1, g2, eweight1=None, eweight2=None, label1=None, label2=None,
                norm=True, p=1., distance=False, asymmetric=False):
@@ -409,7 +415,9 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, eweight=None,
 
     The algorithm runs with complexity :math:`O(\left<k\right>N^2)` if
     ``vertex_pairs is None``, otherwise with :math:`O(\left<k\right>P)` where
-    :math:`P` is the length of ``vertex_pairs``.
+    :math:`P` is the length of ``vertex_pairs``. For large graphs, the most
+    similar vertices can be obtained without considering all pairs with
+    :func:`~graph_tool.topology.vertex_similarity_top_k`.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -550,6 +558,126 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, eweight=None,
     return s
 
 
+def vertex_similarity_top_k(g, sim_type="jaccard", k=10, threshold=0,
+                            eweight=None, minhash=None):
+    r"""Return the most similar vertices to every vertex, as a sparse matrix.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        The graph to be used.
+    sim_type : ``str`` (optional, default: ``"jaccard"``)
+        Type of similarity to use. This must be one of ``"dice"``, ``"salton"``,
+        ``"hub-promoted"``, ``"hub-suppressed"``, ``"jaccard"``,
+        ``"inv-log-weight"``, ``"resource-allocation"`` or ``"leicht-holme-newman"``.
+    k : ``int`` (optional, default: ``10``)
+        Number of most similar vertices kept for every vertex. If ``None``, all
+        of them are kept.
+    threshold : ``float`` (optional, default: ``0``)
+        Only the pairs with a similarity at least equal to this value are
+        kept.
+    eweight : :class:`~graph_tool.EdgePropertyMap` (optional, default: ``None``)
+        Edge weights.
+    minhash : pair of ``int`` (optional, default: ``None``)
+        If provided, the Jaccard similarity is approximated with MinHash
+        signatures, with ``minhash = (bands, rows)`` giving the number of bands
+        and hash functions per band (see below). This requires ``sim_type ==
+        "jaccard"`` and ``eweight is None``.
+
+    Returns
+    -------
+    rows : :class:`numpy.ndarray`
+        First vertex of every pair.
+    cols : :class:`numpy.ndarray`
+        Second vertex of every pair, i.e. one of the most similar vertices to
+        the first.
+    sims : :class:`numpy.ndarray`
+        Similarity of every pair.
+
+    Notes
+    -----
+    The similarities are defined as in
+    :func:`~graph_tool.topology.vertex_similarity`. The pairs are ordered by
+    their first vertex, and then by decreasing similarity. The pairs of
+    identical vertices, and those with zero similarity, are never included.
+
+    Since all these similarities are zero for vertices without common
+    neighbors, only the pairs connected by a path :math:`u \to w \leftarrow v`
+    are considered, and the similarities of every vertex :math:`u` are
+    obtained together, by following these paths. Hence, the algorithm runs
+    with complexity :math:`O(\sum_u\sum_{w\in\Gamma(u)}|\Gamma^-(w)|)`,
+    where :math:`\Gamma^-(w)` are the in-neighbors of :math:`w` (or simply
+    its neighbors for undirected graphs), i.e. :math:`O(\left<k^2\right>N)`
+    for undirected graphs, and with :math:`O(N)` memory, besides the output.
+
+    For graphs where this is still too large, e.g. due to vertices of very
+    large degree, the Jaccard similarity can be approximated with MinHash
+    [broder-resemblance-1997]_, by passing ``minhash = (bands, rows)``. For
+    every vertex, a signature is computed with ``bands * rows`` values, each
+    being the minimum of a hash function over its neighbors, which is the same
+    for two vertices with probability equal to their Jaccard similarity, and
+    this fraction of identical values is used as an estimate of the
+    similarity. Only the pairs with identical signatures for all the ``rows``
+    values of at least one band are considered [leskovec-mining-2014]_, which
+    happens with probability :math:`1-(1-J^r)^b` for a pair with Jaccard
+    similarity :math:`J`, so that pairs with large similarity are found with
+    high probability, and those with small similarity are rarely visited. The
+    neighborhoods are taken to be sets, ignoring parallel edges.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polbooks"]
+    >>> rows, cols, sims = gt.vertex_similarity_top_k(g, "jaccard", k=3)
+    >>> pairs = numpy.array([rows, cols]).T
+    >>> s = gt.vertex_similarity(g, "jaccard", vertex_pairs=pairs)
+    >>> numpy.allclose(s, sims)
+    True
+
+    The result can be converted to a :mod:`scipy.sparse` matrix:
+
+    >>> import scipy.sparse
+    >>> S = scipy.sparse.coo_matrix((sims, (rows, cols)),
+    ...                             shape=(g.num_vertices(), g.num_vertices()))
+
+    References
+    ----------
+    .. [broder-resemblance-1997] Andrei Z. Broder, "On the resemblance and
+       containment of documents", Compression and Complexity of Sequences,
+       21-29 (1997), :doi:`10.1109/SEQUEN.1997.666900`
+    .. [leskovec-mining-2014] Jure Leskovec, Anand Rajaraman, and Jeffrey
+       D. Ullman, "Mining of Massive Datasets", Chapter 3, Cambridge University
+       Press (2014), :doi:`10.1017/CBO9781139924801`
+
+    """
+
+    if k is None:
+        k = 0
+    if minhash is None:
+        if eweight is None:
+            eweight = libcore.any()
+        else:
+            eweight = _prop("e", g, eweight)
+        rows, cols, sims = \
+            libgraph_tool_topology.similarity_top_k(g._Graph__graph, sim_type,
+                                                    k, threshold, eweight)
+    else:
+        if sim_type != "jaccard" or eweight is not None:
+            raise ValueError("MinHash is only available for the unweighted " +
+                             "Jaccard similarity")
+        bands, rows = minhash
+        if bands < 1 or rows < 1:
+            raise ValueError("invalid MinHash parameters: " + str(minhash))
+        rows, cols, sims = \
+            libgraph_tool_topology.minhash_similarity_top_k(g._Graph__graph,
+                                                            bands, rows, k,
+                                                            threshold,
+                                                            _get_rng())
+    return rows, cols, sims
+
+
 def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
     r"""Check whether two graphs are isomorphic.
 
@@ -682,6 +810,17 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
     of the two graphs. Time complexity is :math:`O(V^2)` in the best case and
     :math:`O(V!\times V)` in the worst case.
 
+    If ``subgraph == True``, the vertices of `sub` are matched in an order in
+    which each is adjacent to a previous one, so that only the neighbors of the
+    matched vertices are tried, as in [bonnici-subgraph-2013]_. The candidates
+    are first filtered by their labels, degrees, the largest degree of their
+    neighbors, and the labels of their neighbors and edges. The search is split
+    among the candidates for the first vertex, which, if enabled during
+    compilation, are processed in parallel, and hence the order in which the
+    matches are returned may vary. This is also the case if ``generator ==
+    True``, in which case the matches are kept in a queue of bounded size
+    until they are requested, and the search pauses while the queue is full.
+
     Examples
     --------
     >>> from numpy.random import poisson
@@ -723,6 +862,21 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
 
     **Left:** Subgraph searched, **Right:** One isomorphic subgraph found in main graph.
 
+    Parallel edges and edge labels are taken into account, and the induced
+    subgraph matches of a graph in itself are the same as the isomorphisms
+    found with ``subgraph=False``:
+
+    >>> g = gt.Graph()
+    >>> g.add_edge_list([(i, (i + 1) % 12) for i in range(12)] +
+    ...                 [(i, i + 1) for i in range(0, 12, 3)])
+    >>> elabel = g.new_ep("int", vals=np.arange(g.num_edges()) % 2)
+    >>> iso = gt.subgraph_isomorphism(g, g, edge_label=(elabel, elabel),
+    ...                               subgraph=False)
+    >>> sub = gt.subgraph_isomorphism(g, g, edge_label=(elabel, elabel),
+    ...                               induced=True)
+    >>> print(len(iso), len(sub))
+    2 2
+
     References
     ----------
     .. [cordella-improved-2001] L. P. Cordella, P. Foggia, C. Sansone, and M. Vento,
@@ -733,6 +887,10 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
        "A (Sub)Graph Isomorphism Algorithm for Matching Large Graphs.",
        IEEE Trans. Pattern Anal. Mach. Intell., vol. 26, no. 10, pp. 1367-1372, 2004.
        :doi:`10.1109/TPAMI.2004.75`
+    .. [bonnici-subgraph-2013] V. Bonnici, R. Giugno, A. Pulvirenti, D. Shasha,
+       A. Ferro, "A subgraph isomorphism algorithm and its application to
+       biochemical data", BMC Bioinformatics 14 (Suppl 7), S13 (2013),
+       :doi:`10.1186/1471-2105-14-S7-S13`
     .. [boost-subgraph-iso] http://www.boost.org/libs/graph/doc/vf2_sub_graph_iso.html
     .. [subgraph-isormophism-wikipedia] http://en.wikipedia.org/wiki/Subgraph_isomorphism_problem
 
@@ -816,30 +974,25 @@ def max_cliques(g):
 
     This implements the Bron-Kerbosh algorithm [bron_algorithm_1973]_
     [bron-kerbosh-wiki]_ with pivoting [tomita_worst-case_2006]_
-    [cazals_note_2008]_.
+    [cazals_note_2008]_, with the outer level in a degeneracy ordering
+    [eppstein_listing_2010]_. The cliques whose first vertex in this ordering
+    is a given vertex are found independently of the others, so that these
+    subproblems are solved in parallel. The cliques are generated in batches,
+    without keeping them all in memory.
 
     The worst-case complexity of this algorithm is :math:`O(3^{V/3})` for a
-    graph of :math:`V` vertices, but for sparse graphs it is typically much
+    graph of :math:`V` vertices, but for a graph with degeneracy :math:`d`
+    (i.e. the largest :math:`k` with a nonempty :math:`k`-core) it is
+    :math:`O(dV3^{d/3})`, so that for sparse graphs it is typically much
     faster.
 
     Examples
     --------
 
-    >>> g = gt.collection.data["polblogs"]
-    >>> for i, c in enumerate(gt.max_cliques(g)):
-    ...     print(c)
-    ...     if i == 9:
-    ...         break
-    [513   4]
-    [  4 720]
-    [   4  719 1436]
-    [736   5]
-    [453   6]
-    [  7 263  39 753 179 180]
-    [  7 263  39 179 603]
-    [  7 263 392  39 753 180 277 223]
-    [  7 263 392  39 180 277 571 223]
-    [  7 263  39 603 223]
+    >>> g = gt.Graph(directed=False)
+    >>> g.add_edge_list([(0, 1), (1, 2), (2, 0), (2, 3), (3, 4), (4, 2)])
+    >>> sorted(sorted(c.tolist()) for c in gt.max_cliques(g))
+    [[0, 1, 2], [2, 3, 4]]
 
 
     References
@@ -854,6 +1007,10 @@ def max_cliques(g):
     .. [cazals_note_2008] Frédéric Cazals, and Chinmay Karande, "A note on the
        problem of reporting maximal cliques." Theoretical Computer Science 407.1-3
        564-568 (2008), :doi:`10.1016/j.tcs.2008.05.010`
+    .. [eppstein_listing_2010] David Eppstein, Maarten Löffler, and Darren
+       Strash, "Listing all maximal cliques in sparse graphs in near-optimal
+       time", Algorithms and Computation (ISAAC 2010), 403-414 (2010),
+       :doi:`10.1007/978-3-642-17517-6_36`, :arxiv:`1006.5440`
     .. [bron-kerbosh-wiki] https://en.wikipedia.org/wiki/Bron%E2%80%93Kerbosch_algorithm
 
     """
@@ -861,8 +1018,10 @@ def max_cliques(g):
     if g.is_directed():
         g = GraphView(g, directed=False)
 
-    for c in libgraph_tool_topology.max_cliques(g._Graph__graph):
-        yield c
+    for cliques, pos in libgraph_tool_topology.max_cliques(g._Graph__graph,
+                                                           1 << 14):
+        for i in range(len(pos) - 1):
+            yield cliques[pos[i]:pos[i + 1]]
 
 def min_spanning_tree(g, weights=None, root=None, tree_map=None):
     """
@@ -1244,10 +1403,19 @@ def label_components(g, vprop=None, directed=None, attractors=False):
 
     Notes
     -----
-    The components are arbitrarily labeled from 0 to N-1, where N is the total
-    number of components.
-
-    The algorithm runs in :math:`O(V + E)` time.
+    The components are labeled from 0 to N-1, where N is the total number of
+    components, in the order of their smallest vertex.
+
+    If enabled during compilation, the components are found in parallel. The
+    weak components are found with a union-find structure
+    [sutton-afforest-2018]_, in :math:`O(V + E)` time. The strong components
+    of large graphs are found by trimming, forward-backward search and
+    coloring [slota-bfs-2014]_, and otherwise with Tarjan's algorithm, in
+    :math:`O(V + E)` time. Since coloring may need many rounds, for instance
+    for a long chain of components, it hands the remaining vertices over to
+    Tarjan's algorithm once it stops paying off, or once it has done as much
+    work as one serial search per thread, hence the parallel search takes
+    :math:`O(T(V + E))` total work for :math:`T` threads.
 
     Examples
     --------
@@ -1260,18 +1428,27 @@ def label_components(g, vprop=None, directed=None, attractors=False):
     >>> g = gt.random_graph(100, lambda: (poisson(2), poisson(2)))
     >>> comp, hist, is_attractor = gt.label_components(g, attractors=True)
     >>> print(comp.a)
-    [ 1 17  4 18 17 19 17 17 17 17 17 15 17 17 20 17 17 17 14 17  0 21 17 17
-     22 23 16 24 17 17 17 17 25 10 17 17 17  2 27 17  6 13 17 17 17  5 12 17
-     17 17 26  9 17 17 17  7 17 28 29 17 17  3 30 17 17 17 17 17 17 17 17 17
-     17 17 17 17 31 17 17 17 17 17 17 17  8 32 17 11 17 17 17 17 33 17 17 17
-     17 17 17 17]
+    [ 0  1  2  3  1  4  1  1  1  1  1  5  1  1  6  1  1  1  7  1  8  9  1  1
+     10 11 12 13  1  1  1  1 14 15  1  1  1 16 17  1 18 19  1  1  1 20 21  1
+      1  1 22 23  1  1  1 24  1 25 26  1  1 27 28  1  1  1  1  1  1  1  1  1
+      1  1  1  1 29  1  1  1  1  1  1  1 30 31  1 32  1  1  1  1 33  1  1  1
+      1  1  1  1]
     >>> print(hist)
-    [ 1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1 67  1  1  1  1  1  1
+    [ 1 67  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1
       1  1  1  1  1  1  1  1  1  1]
     >>> print(is_attractor)
-    [ True False  True  True False  True  True False  True False  True  True
-      True  True False False  True False False False False False False False
-      True False False False False False  True False False False]
+    [False False False False False False False False  True False False False
+      True  True False  True  True False  True  True  True  True False False
+     False False False  True  True False  True False  True False]
+
+    References
+    ----------
+    .. [sutton-afforest-2018] M. Sutton, T. Ben-Nun, A. Barak, "Optimizing
+       Parallel Graph Connectivity Computation via Subgraph Sampling", IPDPS
+       2018, :doi:`10.1109/IPDPS.2018.00012`
+    .. [slota-bfs-2014] G. M. Slota, S. Rajamanickam, K. Madduri, "BFS and
+       Coloring-Based Parallel Algorithms for Strongly Connected Components and
+       Related Problems", IPDPS 2014, :doi:`10.1109/IPDPS.2014.64`
     """
 
     if vprop is None:
@@ -1418,7 +1595,8 @@ def label_out_component(g, root, label=None):
 
     Notes
     -----
-    The algorithm runs in :math:`O(V + E)` time.
+    The algorithm runs in :math:`O(V + E)` time. If enabled during compilation,
+    the search runs in parallel.
 
     Examples
     --------
@@ -1752,7 +1930,12 @@ def kcore_decomposition(g, vprop=None):
     case these edges contribute to the degree in the usual fashion.
 
     This algorithm is described in [batagelj-algorithm]_ and runs in :math:`O(V + E)`
-    time.
+    time. All the vertices of the same core are removed concurrently, with
+    their neighbors' degrees decreased atomically, as described in
+    [dasari-park-2014]_, so that the decomposition runs in parallel.
+
+    The decomposition can be kept up to date as edges are added or removed
+    with :func:`~graph_tool.topology.kcore_update`.
 
     Examples
     --------
@@ -1781,6 +1964,10 @@ def kcore_decomposition(g, vprop=None):
        networks", Advances in Data Analysis and Classification
        Volume 5, Issue 2, pp 129-145 (2011), :DOI:`10.1007/s11634-010-0079-y`,
        :arxiv:`cs/0310049`
+    .. [dasari-park-2014] Naga Shailaja Dasari, Ranjan Desh, Mohammad
+       Zubair, "ParK: An efficient algorithm for k-core decomposition on
+       multicore processors", IEEE International Conference on Big Data,
+       pp. 9-16 (2014), :DOI:`10.1109/BigData.2014.7004366`
 
     """
 
@@ -1796,6 +1983,99 @@ def kcore_decomposition(g, vprop=None):
     return vprop
 
 
+def kcore_update(g, kval, added=None, removed=None):
+    """Add and remove edges from the graph, while updating its k-core
+    decomposition.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be modified.
+    kval : :class:`~graph_tool.VertexPropertyMap`
+        Vertex property map with the k-core decomposition of ``g``, as
+        returned by :func:`~graph_tool.topology.kcore_decomposition`, which
+        will be updated in place.
+    added : :class:`numpy.ndarray` or iterable (optional, default: ``None``)
+        Edges to be added, as pairs of vertex indices.
+    removed : :class:`numpy.ndarray` or iterable (optional, default: ``None``)
+        Edges to be removed, as pairs of vertex indices. They are removed after
+        the new edges are added.
+
+    Returns
+    -------
+    kval : :class:`~graph_tool.VertexPropertyMap`
+        The updated k-core decomposition.
+
+    Notes
+    -----
+
+    The edges are added or removed one at a time, and after each change only
+    the vertices whose core number can change are visited, as described in
+    [sariyuce-streaming-2013]_: those with the same core number as the
+    smallest one of the endpoints, and which are connected to it through
+    vertices with this same core number. Their core numbers change by at most
+    one.
+
+    This is typically much faster than recomputing the decomposition. If the
+    updates nevertheless visit more vertices and edges than the graph has in
+    total, as may happen if a single core contains most of the vertices, the
+    remaining edges are only added or removed, and the decomposition is
+    recomputed once at the end. Hence a call costs at most about two
+    decompositions, in addition to the modification of the graph.
+
+    If a removed edge does not exist, a :class:`ValueError` is raised, and the
+    changes made so far are not undone, nor is ``kval`` guaranteed to be up to
+    date.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["netscience"]
+    >>> kcore = gt.kcore_decomposition(g)
+    >>> kcore = gt.kcore_update(g, kcore, added=[(0, 1), (2, 3)],
+    ...                         removed=[(0, 1)])
+    >>> all(kcore.a == gt.kcore_decomposition(g).a)
+    True
+
+    The same holds for random changes, including self-loops and parallel
+    edges:
+
+    >>> g = gt.price_network(2000, m=3, directed=False)
+    >>> kcore = gt.kcore_decomposition(g)
+    >>> ok = True
+    >>> for i in range(20):
+    ...     added = np.random.randint(0, g.num_vertices(), (10, 2))
+    ...     added[:2, 1] = added[:2, 0]
+    ...     added[2:4] = g.get_edges()[:2]
+    ...     edges = g.get_edges()
+    ...     removed = edges[np.random.choice(len(edges), 10, replace=False)]
+    ...     kcore = gt.kcore_update(g, kcore, added=added, removed=removed)
+    ...     ok = ok and all(kcore.a == gt.kcore_decomposition(g).a)
+    >>> print(ok)
+    True
+
+    References
+    ----------
+    .. [sariyuce-streaming-2013] Ahmet Erdem Sarıyüce, Buğra Gedik, Gabriela
+       Jacques-Silva, Kun-Lung Wu, Ümit V. Çatalyürek, "Streaming algorithms
+       for k-core decomposition", Proceedings of the VLDB Endowment 6 (6),
+       pp. 433-444 (2013), :DOI:`10.14778/2536336.2536344`
+
+    """
+
+    _check_prop_writable(kval, name="kval")
+    _check_prop_scalar(kval, name="kval")
+
+    def edge_array(edges):
+        if edges is None:
+            return numpy.zeros((0, 2), dtype="int64")
+        return numpy.asarray(edges, dtype="int64").reshape((-1, 2))
+
+    libgraph_tool_topology.kcore_update(g._Graph__graph, _prop("v", g, kval),
+                                        edge_array(added), edge_array(removed))
+    return kval
+
+
 def shortest_distance(g, source=None, target=None, weights=None,
                       negative_weights=False, max_dist=None, directed=None,
                       dense=False, dist_map=None, pred_map=False,
@@ -1905,6 +2185,19 @@ def shortest_distance(g, source=None, target=None, weights=None,
     with complexity :math:`O(V (V + E))`, if weights are given it runs
     in :math:`O(VE\log V)` time, or :math:`O(V^3)` if dense == True.
 
+    If no weights are given, the searches are parallel: from a single source,
+    a level-synchronous direction-optimizing breadth-first search
+    [beamer-direction-optimizing-2012]_ is used for large graphs, and if no
+    source is given, the searches from 64 sources at a time are done together
+    with bit-parallel breadth-first search [then-more-2014]_. If weights are
+    given, a source is specified and ``dag == False``, large graphs are
+    searched in parallel with delta-stepping [meyer-delta-stepping-2003]_. The
+    parallel breadth-first search returns the same predecessors and reached
+    vertices, in the same order, as the sequential one. This is also the case
+    for delta-stepping if all distances are different; otherwise, the ties
+    between equal distances are broken by vertex index, so that the results
+    do not depend on the number of threads.
+
     Examples
     --------
     .. testcode::
@@ -1962,6 +2255,38 @@ def shortest_distance(g, source=None, target=None, weights=None,
     >>> print(dist)
     [6 6]
 
+    The parallel search, used here for a small graph by lowering the minimum
+    amount of work of parallel regions, gives the same results as the
+    sequential one:
+
+    >>> min_work = gt.openmp_get_min_work()
+    >>> g = gt.price_network(3000, m=2, directed=False)
+    >>> gt.openmp_set_min_work(2**62)
+    >>> dist, pred, reached = gt.shortest_distance(g, source=g.vertex(0), max_dist=3,
+    ...                                            pred_map=True, return_reached=True)
+    >>> gt.openmp_set_min_work(0)
+    >>> pdist, ppred, preached = gt.shortest_distance(g, source=g.vertex(0), max_dist=3,
+    ...                                               pred_map=True, return_reached=True)
+    >>> print((dist.a == pdist.a).all(), (pred.a == ppred.a).all(),
+    ...       (reached == preached).all())
+    True True True
+
+    The same holds with weights, which are searched in parallel with
+    delta-stepping:
+
+    >>> w = g.new_ep("double", vals=np.random.random(g.num_edges()))
+    >>> dist, pred, reached = gt.shortest_distance(g, source=g.vertex(0), weights=w,
+    ...                                            max_dist=1, pred_map=True,
+    ...                                            return_reached=True)
+    >>> gt.openmp_set_min_work(2**62)
+    >>> sdist, spred, sreached = gt.shortest_distance(g, source=g.vertex(0), weights=w,
+    ...                                               max_dist=1, pred_map=True,
+    ...                                               return_reached=True)
+    >>> gt.openmp_set_min_work(min_work)
+    >>> print((dist.a == sdist.a).all(), (pred.a == spred.a).all(),
+    ...       (reached == sreached).all())
+    True True True
+
     References
     ----------
     .. [bfs] Edward Moore, "The shortest path through a maze", International
@@ -1973,6 +2298,15 @@ def shortest_distance(g, source=None, target=None, weights=None,
     .. [johnson-apsp] http://www.boost.org/libs/graph/doc/johnson_all_pairs_shortest.html
     .. [floyd-warshall-apsp] http://www.boost.org/libs/graph/doc/floyd_warshall_shortest.html
     .. [bellman-ford] http://www.boost.org/libs/graph/doc/bellman_ford_shortest.html
+    .. [beamer-direction-optimizing-2012] S. Beamer, K. Asanović, D. Patterson,
+       "Direction-optimizing breadth-first search", SC '12, 2012,
+       :DOI:`10.1109/SC.2012.50`
+    .. [then-more-2014] M. Then, M. Kaufmann, F. Chirigati, et al., "The More
+       the Merrier: Efficient Multi-Source Graph Traversal", Proceedings of the
+       VLDB Endowment 8 (4), 2014, :DOI:`10.14778/2735496.2735507`
+    .. [meyer-delta-stepping-2003] U. Meyer, P. Sanders, "Delta-stepping: a
+       parallelizable shortest path algorithm", Journal of Algorithms 49 (1),
+       pp. 114-152, 2003, :DOI:`10.1016/S0196-6774(03)00076-2`
 
     """
 
@@ -2166,6 +2500,192 @@ def shortest_path(g, source, target, weights=None, negative_weights=False,
         v = p
     return vlist, elist
 
+class ContractionHierarchy(object):
+    r"""Index for repeated point-to-point shortest path queries.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    weights : :class:`~graph_tool.EdgePropertyMap` (optional, default: None)
+        The edge weights, which must be non-negative. If not given, all edges
+        have unit length.
+    max_settled : ``int`` (optional, default: ``500``)
+        Maximum number of vertices settled by each witness search during the
+        construction. Smaller values make the construction faster, at the
+        expense of more shortcuts.
+
+    Notes
+    -----
+    The index is a contraction hierarchy [geisberger-contraction-2008]_: the
+    vertices are ordered by importance and removed one by one, and shortcuts
+    are added between their remaining neighbors whenever needed to preserve
+    the shortest distances. A query is then answered by a bidirectional
+    Dijkstra search which only visits vertices of increasing importance, and
+    typically settles only a few hundred vertices, independently of the size
+    of the graph. The construction is sequential, except for the computation
+    of the initial importances, which runs in parallel.
+
+    The index does not refer to the graph after it is built, and does not
+    track its modifications. It can be pickled, and hence be stored as a graph
+    property of type ``object``, which is saved together with the graph.
+
+    Batched queries with :meth:`distances` run in parallel, if enabled during
+    compilation.
+
+    Examples
+    --------
+    >>> g = gt.lattice([100, 100])
+    >>> ch = gt.ContractionHierarchy(g)
+    >>> print(ch.distance(0, 9999))
+    198.0
+    >>> print(len(ch.path(0, 9999)))
+    199
+
+    The index of a filtered graph keeps the numbering of the vertices, and can
+    be pickled as well:
+
+    >>> import pickle
+    >>> u = gt.GraphView(g, vfilt=lambda v: int(v) % 100 != 50 or int(v) < 100)
+    >>> ch = pickle.loads(pickle.dumps(gt.ContractionHierarchy(u)))
+    >>> print(ch.distance(0, 9999), ch.distance(0, 150))
+    198.0 inf
+
+    References
+    ----------
+    .. [geisberger-contraction-2008] R. Geisberger, P. Sanders, D. Schultes,
+       D. Delling, "Contraction Hierarchies: Faster and Simpler Hierarchical
+       Routing in Road Networks", WEA 2008, :DOI:`10.1007/978-3-540-68552-4_24`
+    """
+
+    def __init__(self, g, weights=None, max_settled=500):
+        self._ch = libgraph_tool_topology.\
+            build_contraction_hierarchy(g._Graph__graph,
+                                        _prop("e", g, weights),
+                                        max_settled)
+
+    def __getstate__(self):
+        return dict(state=self._ch.get_state())
+
+    def __setstate__(self, state):
+        self._ch = libgraph_tool_topology.ContractionHierarchy()
+        self._ch.set_state(*state["state"])
+
+    def __repr__(self):
+        return "<ContractionHierarchy object with %d vertices and %d arcs, at 0x%x>" % \
+            (self._ch.get_num_vertices(), self._ch.get_num_arcs(), id(self))
+
+    def distance(self, source, target):
+        """Return the distance from ``source`` to ``target``, or ``inf`` if
+        there is no path."""
+        return self._ch.distance(int(source), int(target))
+
+    def distances(self, sources, targets):
+        """Return an array with the distances between every pair of vertices in
+        ``sources`` and ``targets``, which must have the same length."""
+        sources = numpy.asarray(sources, dtype="int64").ravel()
+        targets = numpy.asarray(targets, dtype="int64").ravel()
+        dist = numpy.zeros(len(sources), dtype="float")
+        self._ch.distances(sources, targets, dist)
+        return dist
+
+    def path(self, source, target):
+        """Return an array with the vertices in the shortest path from
+        ``source`` to ``target``, which is empty if there is no path."""
+        return self._ch.path(int(source), int(target))
+
+class PrunedLandmarkLabeling(object):
+    r"""Index for exact unweighted distance queries.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    order : ``str`` or :class:`~graph_tool.VertexPropertyMap` (optional, default: ``"degree"``)
+        Order in which the vertices are taken as landmarks. If ``"degree"``,
+        the vertices are taken in order of decreasing total degree; if
+        ``"random"``, in random order. If a vertex property map is given, the
+        vertices are taken in decreasing order of its values.
+
+    Notes
+    -----
+    The index is a pruned landmark labeling [akiba-fast-2013]_: every vertex
+    stores its distances to and from a set of landmark vertices, such that
+    every shortest path contains a landmark common to both of its endpoints.
+    The distance between two vertices is then obtained by intersecting their
+    labels, which is typically orders of magnitude faster than a
+    breadth-first search, in particular for small-world networks. The labels
+    are built by a breadth-first search from each landmark, which is pruned
+    at the vertices whose distances are already covered by the previous
+    landmarks. The order of the landmarks determines the size of the labels,
+    and decreasing degree works well for most real networks.
+
+    The construction runs in parallel, if enabled during compilation, in
+    batches of landmarks whose searches do not prune each other. The labels
+    obtained this way are slightly larger than the sequential ones.
+
+    The index ignores edge weights, does not refer to the graph after it is
+    built, and does not track its modifications. It can be pickled, and hence
+    be stored as a graph property of type ``object``, which is saved together
+    with the graph. It can also be passed to
+    :func:`~graph_tool.stats.distance_histogram` and
+    :func:`~graph_tool.centrality.closeness`.
+
+    Examples
+    --------
+    >>> g = gt.lattice([10, 10])
+    >>> pll = gt.PrunedLandmarkLabeling(g)
+    >>> print(pll.distance(0, 99))
+    18.0
+    >>> print(pll.distances([0, 1, 2], [99, 98, 97]))
+    [18. 16. 14.]
+
+    References
+    ----------
+    .. [akiba-fast-2013] T. Akiba, Y. Iwata, Y. Yoshida, "Fast exact
+       shortest-path distance queries on large networks by pruned landmark
+       labeling", SIGMOD '13, :DOI:`10.1145/2463676.2465315`
+    """
+
+    def __init__(self, g, order="degree"):
+        if isinstance(order, str):
+            if order == "degree":
+                prio = g.degree_property_map("total")
+            elif order == "random":
+                prio = g.new_vertex_property("double")
+                prio.a = numpy.random.random(len(prio.a))
+            else:
+                raise ValueError("invalid order: " + order)
+        else:
+            prio = order
+        self._pll = libgraph_tool_topology.\
+            build_landmark_labeling(g._Graph__graph, _prop("v", g, prio))
+
+    def __getstate__(self):
+        return dict(state=self._pll.get_state())
+
+    def __setstate__(self, state):
+        self._pll = libgraph_tool_topology.PrunedLandmarkLabeling()
+        self._pll.set_state(*state["state"])
+
+    def __repr__(self):
+        return "<PrunedLandmarkLabeling object with %d vertices and %d labels, at 0x%x>" % \
+            (self._pll.get_num_vertices(), self._pll.get_num_labels(), id(self))
+
+    def distance(self, source, target):
+        """Return the distance from ``source`` to ``target``, or ``inf`` if
+        there is no path."""
+        return self._pll.distance(int(source), int(target))
+
+    def distances(self, sources, targets):
+        """Return an array with the distances between every pair of vertices in
+        ``sources`` and ``targets``, which must have the same length."""
+        sources = numpy.asarray(sources, dtype="int64").ravel()
+        targets = numpy.asarray(targets, dtype="int64").ravel()
+        dist = numpy.zeros(len(sources), dtype="float")
+        self._pll.distances(sources, targets, dist)
+        return dist
+
 def all_predecessors(g, dist_map, pred_map, weights=None, epsilon=1e-8):
     """Return a property map with all possible predecessors in the search tree
         determined by ``dist_map`` and ``pred_map``.